@@ -85,6 +85,10 @@ namespace adh {
             GetInstance().Flush2();
         }
 
+        Array<Function<void()>> Allocator::TakeDestroyQueue() noexcept {
+            return Move(GetInstance().m_DestroyQueue);
+        }
+
         void Allocator::Destroy() noexcept {
             GetInstance().Clear();
         }
@@ -266,9 +270,7 @@ namespace adh {
                 bufferData.memoryData.memoryBlock->freeBlocks.EmplaceBack(bufferData.memoryData.head, bufferData.memoryData.tail);
                 bufferData.memoryData.memoryBlock->freeBlocks.Sort();
 
-                auto device{ Context::Get()->GetDevice() };
-                vkDeviceWaitIdle(device);
-                vkDestroyBuffer(device, bufferData.buffer, nullptr);
+                vkDestroyBuffer(Context::Get()->GetDevice(), bufferData.buffer, nullptr);
             });
         }
 
@@ -278,7 +280,6 @@ namespace adh {
                 imageData.memoryData.memoryBlock->freeBlocks.Sort();
 
                 auto device{ Context::Get()->GetDevice() };
-                vkDeviceWaitIdle(device);
                 vkDestroyImage(device, imageData.image, nullptr);
                 vkDestroyImageView(device, imageData.imageView, nullptr);
             });
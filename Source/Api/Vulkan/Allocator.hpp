@@ -113,6 +113,9 @@ namespace adh {
 
             static void Flush() noexcept;
 
+            // Destructions queued since the last call, run by the caller once no frame uses the resources
+            static Array<Function<void()>> TakeDestroyQueue() noexcept;
+
           private:
             Allocator() = default;
 
@@ -41,6 +41,14 @@ namespace adh {
             return m_CommandBuffers[index];
         }
 
+        VkCommandBuffer CommandBuffer::Begin(std::size_t index, const VkCommandBufferInheritanceInfo& inheritanceInfo, VkCommandBufferUsageFlagBits usageFlag) {
+            auto info{ initializers::CommandBufferBeginInfo(usageFlag) };
+            info.pInheritanceInfo = &inheritanceInfo;
+            ADH_THROW(vkBeginCommandBuffer(m_CommandBuffers[index], &info) == VK_SUCCESS,
+                      "Failed to begin command buffer!");
+            return m_CommandBuffers[index];
+        }
+
         void CommandBuffer::End(std::size_t index) {
             ADH_THROW(vkEndCommandBuffer(m_CommandBuffers[index]) == VK_SUCCESS,
                       "Failed to end command buffer!");
@@ -33,6 +33,10 @@ namespace adh {
 
             VkCommandBuffer Begin(std::size_t index = 0u, VkCommandBufferUsageFlagBits usageFlag = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
+            // Secondary command buffers continuing a render pass
+            VkCommandBuffer Begin(std::size_t index, const VkCommandBufferInheritanceInfo& inheritanceInfo,
+                                  VkCommandBufferUsageFlagBits usageFlag = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+
             void End(std::size_t index = 0u);
 
             void Reset();
@@ -5,11 +5,17 @@
 namespace adh {
     namespace vk {
         CommandPool::CommandPool() {
-            m_Pools.emplace(std::this_thread::get_id(), this);
+            std::lock_guard lock{ m_PoolsMutex };
+            m_Pools.insert_or_assign(std::this_thread::get_id(), this);
         }
 
         CommandPool::~CommandPool() {
             Clear();
+            std::lock_guard lock{ m_PoolsMutex };
+            auto itr{ m_Pools.find(std::this_thread::get_id()) };
+            if (itr != m_Pools.end() && itr->second == this) {
+                m_Pools.erase(itr);
+            }
         }
 
         VkCommandPool CommandPool::Get(VkCommandPoolCreateFlagBits flag, std::uint32_t queueIndex) {
@@ -35,6 +41,7 @@ namespace adh {
         }
 
         CommandPool* CommandPool::Get() noexcept {
+            std::lock_guard lock{ m_PoolsMutex };
             return m_Pools.find(std::this_thread::get_id())->second;
         }
 
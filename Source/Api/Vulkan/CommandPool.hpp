@@ -1,5 +1,6 @@
 #pragma once
 #include <Utility.hpp>
+#include <mutex>
 #include <set>
 #include <thread>
 #include <unordered_map>
@@ -53,7 +54,9 @@ namespace adh {
             std::set<_internal::CommandPoolData> m_CommandPools;
 
           private:
+            // Command pools are externally synchronized, every thread recording commands owns one
             inline static std::unordered_map<std::thread::id, CommandPool*> m_Pools;
+            inline static std::mutex m_PoolsMutex;
         };
     } // namespace vk
 } // namespace adh
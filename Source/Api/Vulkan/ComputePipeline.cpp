@@ -45,14 +45,18 @@ namespace adh {
             std::uint32_t elementSizeZ) ADH_NOEXCEPT {
             auto info{ initializers::ComputePipelineCreateInfo(layout, stage) };
 
+            // Replaces the pipeline when its shader is reloaded, the old one is kept if this fails
+            VkPipeline pipeline;
             ADH_THROW(vkCreateComputePipelines(
                           Context::Get()->GetDevice(),
-                          VK_NULL_HANDLE,
+                          Context::Get()->GetPipelineCache(),
                           1u,
                           &info,
                           nullptr,
-                          &m_Pipeline) == VK_SUCCESS,
+                          &pipeline) == VK_SUCCESS,
                       "Failed to create compute pipeline!");
+            Clear();
+            m_Pipeline = pipeline;
 
             ADH_THROW((localSizeX) && (localSizeY) && (localSizeZ), "Local size must be => 1!");
 
@@ -69,6 +73,10 @@ namespace adh {
             vkCmdDispatch(commandBuffer, x, y, z);
         }
 
+        void ComputePipeline::Dispatch(VkCommandBuffer commandBuffer, std::uint32_t groupsX, std::uint32_t groupsY, std::uint32_t groupsZ) noexcept {
+            vkCmdDispatch(commandBuffer, groupsX, groupsY, groupsZ);
+        }
+
         void ComputePipeline::Destroy() noexcept {
             Clear();
         }
@@ -44,6 +44,8 @@ namespace adh {
 
             void Dispatch(VkCommandBuffer commandBuffer) noexcept;
 
+            void Dispatch(VkCommandBuffer commandBuffer, std::uint32_t groupsX, std::uint32_t groupsY = 1u, std::uint32_t groupsZ = 1u) noexcept;
+
             void Destroy() noexcept;
 
             operator VkPipeline() noexcept;
@@ -17,6 +17,17 @@ namespace adh {
             m_Instance.Create(name);
             m_PhysicalDevice.Create(m_Instance);
             m_Surface.Create(m_Instance, window);
+            CreateDevice(path);
+        }
+
+        void Context::Create(const char* name, const char* path) {
+            m_Contexts.EmplaceBack(this);
+            m_Instance.Create(name, true);
+            m_PhysicalDevice.Create(m_Instance);
+            CreateDevice(path);
+        }
+
+        void Context::CreateDevice(const char* path) {
             m_DeviceQueues.Create(m_PhysicalDevice, m_Surface);
             m_Device.Create(m_PhysicalDevice, &m_DeviceQueues);
 
@@ -29,6 +40,8 @@ namespace adh {
                 int pos       = p.find("Exe");
                 m_Path        = p.substr(0, pos);
 #endif
+
+            m_PipelineCache.Create(m_Device, m_PhysicalDevice, GetDataDirectory() + "Resources/pipeline_cache.bin");
         }
 
         void Context::Destroy() noexcept {
@@ -37,6 +50,7 @@ namespace adh {
 
         void Context::Clear() noexcept {
             Allocator::Destroy();
+            m_PipelineCache.Destroy();
             m_Surface.Destroy();
             m_Device.Destroy();
             m_Instance.Destroy();
@@ -86,6 +100,14 @@ namespace adh {
             return m_Device;
         }
 
+        bool Context::IsHeadless() const noexcept {
+            return m_Surface == VK_NULL_HANDLE;
+        }
+
+        PipelineCache& Context::GetPipelineCache() noexcept {
+            return m_PipelineCache;
+        }
+
         const std::string Context::GetDataDirectory() const noexcept {
 #if defined(ADH_WINDOWS)
             return DATA_DIRECTORY;
@@ -3,6 +3,7 @@
 #include "DeviceQueues.hpp"
 #include "Instance.hpp"
 #include "PhysicalDevice.hpp"
+#include "PipelineCache.hpp"
 #include "Surface.hpp"
 #include <Std/Array.hpp>
 
@@ -20,6 +21,9 @@ namespace adh {
 
             void Create(const Window& window, const char* name, const char* path);
 
+            // Headless, without a surface and a present queue. Frames are rendered to offscreen images.
+            void Create(const char* name, const char* path);
+
             void Destroy() noexcept;
 
             VkInstance GetInstance() noexcept;
@@ -44,7 +48,14 @@ namespace adh {
 
             const std::string GetDataDirectory() const noexcept;
 
+            bool IsHeadless() const noexcept;
+
+            // Shared by every pipeline, persisted to the data directory
+            PipelineCache& GetPipelineCache() noexcept;
+
           private:
+            void CreateDevice(const char* path);
+
             void Clear() noexcept;
 
           public:
@@ -56,6 +67,7 @@ namespace adh {
             Surface m_Surface;
             DeviceQueues m_DeviceQueues;
             Device m_Device;
+            PipelineCache m_PipelineCache;
             std::string m_Path;
 
           private:
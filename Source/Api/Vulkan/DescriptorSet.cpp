@@ -35,9 +35,14 @@ namespace adh {
         }
 
         void DescriptorSet::Create(const Array<VkDescriptorSetLayout>& descriptorSetLayout) {
+            Create(descriptorSetLayout, static_cast<std::uint32_t>(descriptorSetLayout.GetSize()));
+        }
+
+        void DescriptorSet::Create(const Array<VkDescriptorSetLayout>& descriptorSetLayout, std::uint32_t setCount) {
             ADH_THROW(!m_PoolSizes.IsEmpty(), "No allocated pools! Call AddPool() before Create()!");
-            CreatePool(descriptorSetLayout.GetSize() * m_SwapChainImageViews);
-            AllocateDescriptors(descriptorSetLayout);
+            ADH_THROW(setCount <= descriptorSetLayout.GetSize(), "Set count exceeds the number of set layouts!");
+            CreatePool(setCount * m_SwapChainImageViews);
+            AllocateDescriptors(descriptorSetLayout, setCount);
         }
 
         void DescriptorSet::AddPool(VkDescriptorType type, std::uint32_t count) {
@@ -225,10 +230,10 @@ namespace adh {
                       "Failed to create descriptor pool!");
         }
 
-        void DescriptorSet::AllocateDescriptors(const Array<VkDescriptorSetLayout>& descriptorSetLayout) {
+        void DescriptorSet::AllocateDescriptors(const Array<VkDescriptorSetLayout>& descriptorSetLayout, std::uint32_t setCount) {
             Array<VkDescriptorSetLayout> setLayouts;
-            setLayouts.Reserve(descriptorSetLayout.GetSize() * m_SwapChainImageViews);
-            for (std::size_t i{}; i != descriptorSetLayout.GetSize() * m_SwapChainImageViews; ++i) {
+            setLayouts.Reserve(static_cast<std::size_t>(setCount) * m_SwapChainImageViews);
+            for (std::size_t i{}; i != static_cast<std::size_t>(setCount) * m_SwapChainImageViews; ++i) {
                 setLayouts.EmplaceBack(descriptorSetLayout[i / m_SwapChainImageViews]);
             }
             auto info{ initializers::DescriptorSetAllocateInfo(m_Pool, static_cast<std::uint32_t>(setLayouts.GetSize()), setLayouts.GetData()) };
@@ -8,10 +8,18 @@
 #include <Utility.hpp>
 #include <Vulkan/Initializers.hpp>
 
+#include <algorithm>
+#include <mutex>
+
 namespace adh {
     namespace vk {
+        // Bindless texture table: a single descriptor set with an array of combined image samplers.
+        // Shaders index it with the texture ID stored in the instance data, so it is bound once per pass.
         class TextureDescriptors {
           public:
+            static constexpr uint32_t invalidID{ ~0u };
+            static constexpr uint32_t maxTextures{ 4096u };
+
             static void Initialize(
                 uint32_t descriptorIndex,
                 uint32_t bindingIndex) {
@@ -19,15 +27,40 @@ namespace adh {
                 mDescriptorIndex = descriptorIndex;
                 mBindingIndex    = bindingIndex;
 
+                VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+                indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+                VkPhysicalDeviceProperties2 properties{};
+                properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+                properties.pNext = &indexingProperties;
+                vkGetPhysicalDeviceProperties2(Context::Get()->GetPhysicalDevice(), &properties);
+
+                mCapacity = maxTextures;
+                mCapacity = std::min(mCapacity, indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+                mCapacity = std::min(mCapacity, indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+
+                // No slot is pending or free twice, neither list grows past the table
+                freeDescriptors.Reserve(mCapacity);
+                clearDescriptors.Reserve(mCapacity);
+
                 VkDescriptorSetLayoutBinding uboLayoutBinding{};
                 uboLayoutBinding.binding            = bindingIndex;
-                uboLayoutBinding.descriptorCount    = 1;
+                uboLayoutBinding.descriptorCount    = mCapacity;
                 uboLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
                 uboLayoutBinding.pImmutableSamplers = nullptr;
                 uboLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
 
+                // Unused slots are never read and slots are written while frames are in flight
+                VkDescriptorBindingFlags bindingFlags{ VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT };
+
+                VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+                bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+                bindingFlagsInfo.bindingCount  = 1;
+                bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
                 VkDescriptorSetLayoutCreateInfo layoutInfo{};
                 layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+                layoutInfo.pNext        = &bindingFlagsInfo;
+                layoutInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
                 layoutInfo.bindingCount = 1;
                 layoutInfo.pBindings    = &uboLayoutBinding;
 
@@ -36,35 +69,45 @@ namespace adh {
 
                 VkDescriptorPoolSize poolSize{};
                 poolSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                poolSize.descriptorCount = 1000;
+                poolSize.descriptorCount = mCapacity;
 
                 VkDescriptorPoolCreateInfo info{};
-                info.flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+                info.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
                 info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-                info.maxSets       = 1000;
+                info.maxSets       = 1;
                 info.poolSizeCount = 1;
                 info.pPoolSizes    = &poolSize;
 
                 ADH_THROW(vkCreateDescriptorPool(Context::Get()->GetDevice(), &info, nullptr, &mPool) == VK_SUCCESS,
                           "Failed to create descriptor pool!");
-            }
-
-            static uint32_t GetDescriptorID(VkDescriptorImageInfo imageInfo) {
-                VkDescriptorSetAllocateInfo info{};
-                info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-                info.descriptorPool     = mPool;
-                info.descriptorSetCount = 1;
-                info.pSetLayouts        = &setLayout;
 
-                auto& set = mDescriptorSets.EmplaceBack();
+                VkDescriptorSetAllocateInfo allocateInfo{};
+                allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+                allocateInfo.descriptorPool     = mPool;
+                allocateInfo.descriptorSetCount = 1;
+                allocateInfo.pSetLayouts        = &setLayout;
 
-                ADH_THROW(vkAllocateDescriptorSets(vk::Context::Get()->GetDevice(), &info, &set) == VK_SUCCESS,
+                ADH_THROW(vkAllocateDescriptorSets(Context::Get()->GetDevice(), &allocateInfo, &mDescriptorSet) == VK_SUCCESS,
                           "Failed to allocate descriptor sets!");
+            }
+
+            // Writes the texture into a free slot of the table, the slot is the texture ID. Textures
+            // are created and destroyed on the asset workers as well as the main thread.
+            static uint32_t GetDescriptorID(VkDescriptorImageInfo imageInfo) {
+                std::lock_guard lock{ mMutex };
+                uint32_t id{ mCount };
+                if (!freeDescriptors.IsEmpty()) {
+                    id = freeDescriptors[freeDescriptors.GetSize() - 1];
+                    freeDescriptors.PopBack();
+                } else {
+                    ADH_THROW(mCount != mCapacity, "Texture table is full!");
+                    ++mCount;
+                }
 
                 VkWriteDescriptorSet writeSets = initializers::WriteDescriptorSet(
-                    set,
+                    mDescriptorSet,
                     mBindingIndex,
-                    0,
+                    id,
                     1,
                     VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                     &imageInfo,
@@ -73,23 +116,46 @@ namespace adh {
 
                 vkUpdateDescriptorSets(Context::Get()->GetDevice(), 1, &writeSets, 0, nullptr);
 
-                return mDescriptorSets.GetSize() - 1;
+                return id;
+            }
+
+            static VkDescriptorSet GetDescriptor() {
+                return mDescriptorSet;
             }
 
-            static VkDescriptorSet GetDescriptor(uint32_t index) {
-                return mDescriptorSets[index];
+            static VkDescriptorSetLayout GetSetLayout() {
+                return setLayout;
             }
 
-            static void FreeDescriptor(uint32_t id) {
-                clearDescriptors.EmplaceBack(id);
+            static uint32_t GetDescriptorIndex() {
+                return mDescriptorIndex;
             }
 
-            static void Flush() {
-                if (!clearDescriptors.IsEmpty()) {
-                    for (int i{}; i != clearDescriptors.GetSize(); ++i) {
-                        vkFreeDescriptorSets(Context::Get()->GetDevice(), mPool, 1, &mDescriptorSets[clearDescriptors[i]]);
-                    }
-                    clearDescriptors.Clear();
+            // The slot is reused once it was passed to Release(), frames in flight may still sample it.
+            // Never allocates, the pending list is reserved for the whole table.
+            static void FreeDescriptor(uint32_t id) noexcept {
+                std::lock_guard lock{ mMutex };
+                // Full only after CleanUp(), when every slot is gone anyway
+                if (id != invalidID && clearDescriptors.GetSize() != clearDescriptors.GetCapacity()) {
+                    clearDescriptors.EmplaceBack(id);
+                }
+            }
+
+            // Slots freed since the last call, the frame context releases them after the frame's fence
+            static Array<uint32_t> TakeFreed() {
+                std::lock_guard lock{ mMutex };
+                if (clearDescriptors.IsEmpty()) {
+                    return {};
+                }
+                auto ids{ Move(clearDescriptors) };
+                clearDescriptors.Reserve(mCapacity);
+                return ids;
+            }
+
+            static void Release(const Array<uint32_t>& ids) {
+                std::lock_guard lock{ mMutex };
+                for (auto id : ids) {
+                    freeDescriptors.EmplaceBack(id);
                 }
             }
 
@@ -97,15 +163,24 @@ namespace adh {
                 auto device{ Context::Get()->GetDevice() };
                 vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
                 vkDestroyDescriptorPool(device, mPool, nullptr);
+                std::lock_guard lock{ mMutex };
+                mDescriptorSet = VK_NULL_HANDLE;
+                mCount         = 0;
+                freeDescriptors.Clear();
+                clearDescriptors.Clear();
             }
 
           private:
             inline static VkDescriptorPool mPool;
             inline static VkDescriptorSetLayout setLayout;
-            inline static Array<VkDescriptorSet> mDescriptorSets;
+            inline static VkDescriptorSet mDescriptorSet;
             inline static uint32_t mDescriptorIndex;
             inline static uint32_t mBindingIndex;
+            inline static uint32_t mCapacity;
+            inline static uint32_t mCount;
 
+            inline static std::mutex mMutex; // Guards the count and both lists
+            inline static Array<uint32_t> freeDescriptors;
             inline static Array<uint32_t> clearDescriptors;
         };
     } // namespace vk
@@ -133,6 +208,9 @@ namespace adh {
 
             void Create(const Array<VkDescriptorSetLayout>& descriptorSetLayout);
 
+            // Allocates only the first setCount layouts, later sets are bound by their owners (e.g. TextureDescriptors)
+            void Create(const Array<VkDescriptorSetLayout>& descriptorSetLayout, std::uint32_t setCount);
+
             void AddPool(VkDescriptorType type, std::uint32_t count);
 
             void Update(
@@ -202,7 +280,7 @@ namespace adh {
           private:
             void CreatePool(std::uint32_t maxSize) ADH_NOEXCEPT;
 
-            void AllocateDescriptors(const Array<VkDescriptorSetLayout>& descriptorSetLayout);
+            void AllocateDescriptors(const Array<VkDescriptorSetLayout>& descriptorSetLayout, std::uint32_t setCount);
 
             void MoveConstruct(DescriptorSet&& rhs) noexcept;
 
@@ -43,7 +43,9 @@ namespace adh {
             auto physicalDeviceFeatures{ tools::GetPhysicalDeviceFeatures(physicalDevice) };
             auto physicalDeviceProperties{ tools::GetPhysicalDeviceProperties(physicalDevice) };
             Array<const char*> deviceExtentions;
-            deviceExtentions.EmplaceBack("VK_KHR_swapchain");
+            if (queues->present.index) {
+                deviceExtentions.EmplaceBack("VK_KHR_swapchain");
+            }
 #if !defined(ADH_APPLE)
             // deviceExtentions.EmplaceBack("VK_KHR_shader_non_semantic_info");
 #elif defined(ADH_APPLE)
@@ -64,6 +66,17 @@ namespace adh {
                 deviceExtentions.EmplaceBack("VK_KHR_maintenance3");
                 deviceExtentions.EmplaceBack("VK_KHR_maintenance1");
             }
+
+            auto supportedIndexing{ tools::GetPhysicalDeviceDescriptorIndexingFeatures(physicalDevice) };
+            ADH_THROW(supportedIndexing.shaderSampledImageArrayNonUniformIndexing &&
+                          supportedIndexing.descriptorBindingSampledImageUpdateAfterBind &&
+                          supportedIndexing.descriptorBindingPartiallyBound &&
+                          supportedIndexing.runtimeDescriptorArray,
+                      "Descriptor indexing is not supported!");
+            // Core in Vulkan 1.2, the extension is still needed by portability drivers
+            if (!m_SupportsRayTracing && tools::CheckForExtentionSupport(physicalDevice, "VK_EXT_descriptor_indexing")) {
+                deviceExtentions.EmplaceBack("VK_EXT_descriptor_indexing");
+            }
             tools::CheckDeviceExtensionAvailability(physicalDevice, deviceExtentions);
 
             auto createInfo{ initializers::DeviceCreateInfo(deviceExtentions) };
@@ -71,11 +84,14 @@ namespace adh {
             createInfo.pQueueCreateInfos    = deviceQueueCreateInfos.GetData();
             createInfo.pEnabledFeatures     = &physicalDeviceFeatures;
 
+            auto descriptorIndexingFeatures{ initializers::PhysicalDeviceDescriptorIndexingFeatures() };
+            createInfo.pNext = &descriptorIndexingFeatures;
+
             if (m_SupportsRayTracing) {
                 auto bufferDeviceAddressFeatures{ initializers::PhysicalDeviceBufferDeviceAddressFeatures() };
                 auto rayTracingPipelineFeatures{ initializers::PhysicalDeviceRayTracingPipelineFeatures(bufferDeviceAddressFeatures) };
                 auto accelerationStructureFeatures{ initializers::PhysicalDeviceAccelerationStructureFeatures(rayTracingPipelineFeatures) };
-                createInfo.pNext = &accelerationStructureFeatures;
+                descriptorIndexingFeatures.pNext = &accelerationStructureFeatures;
             }
 
             ADH_THROW(vkCreateDevice(physicalDevice, &createInfo, nullptr, &m_Device) == VK_SUCCESS,
@@ -34,6 +34,11 @@ namespace adh {
                     sparse.index = static_cast<std::int32_t>(i);
                 }
 
+                // Headless contexts have no surface and no present queue
+                if (surface == VK_NULL_HANDLE) {
+                    continue;
+                }
+
                 VkBool32 presentSupport{};
                 ADH_THROW(vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport) == VK_SUCCESS,
                           "Failed to get physical device surface support!");
@@ -0,0 +1,272 @@
+#include "FrameContext.hpp"
+#include "Allocator.hpp"
+#include "Context.hpp"
+#include "DescriptorSet.hpp"
+#include "GeometryBuffer.hpp"
+#include "Initializers.hpp"
+#include "Swapchain.hpp"
+
+#include <limits>
+
+namespace adh {
+    namespace vk {
+        namespace {
+            constexpr auto maxTimeout{ std::numeric_limits<std::uint64_t>::max() };
+        }
+
+        FrameContext::FrameContext() noexcept : m_Index{},
+                                                m_ImageIndex{} {
+        }
+
+        FrameContext::FrameContext(std::uint32_t framesInFlight, std::uint32_t imageCount) : FrameContext{} {
+            Create(framesInFlight, imageCount);
+        }
+
+        FrameContext::FrameContext(FrameContext&& rhs) noexcept {
+            MoveConstruct(Move(rhs));
+        }
+
+        FrameContext& FrameContext::operator=(FrameContext&& rhs) noexcept {
+            Clear();
+            MoveConstruct(Move(rhs));
+            return *this;
+        }
+
+        FrameContext::~FrameContext() {
+            Clear();
+        }
+
+        void FrameContext::Create(std::uint32_t framesInFlight, std::uint32_t imageCount) {
+            ADH_THROW(framesInFlight && framesInFlight <= maxFramesInFlight, "Unsupported number of frames in flight!");
+
+            auto device{ Context::Get()->GetDevice() };
+            auto fenceInfo{ initializers::FenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT) };
+            auto semaphoreInfo{ initializers::SemaphoreCreateInfo() };
+
+            m_Frames.Resize(framesInFlight);
+            for (auto& frame : m_Frames) {
+                ADH_THROW(vkCreateFence(device, &fenceInfo, nullptr, &frame.fence) == VK_SUCCESS,
+                          "Failed to create fence!");
+                ADH_THROW(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.acquireSemaphore) == VK_SUCCESS,
+                          "Failed to create semaphore!");
+            }
+            CreateRenderSemaphores(imageCount);
+
+            m_CommandBuffers.Create(VK_COMMAND_BUFFER_LEVEL_PRIMARY, framesInFlight, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, DeviceQueues::Family::eGraphics);
+            m_Index      = 0u;
+            m_ImageIndex = 0u;
+        }
+
+        void FrameContext::Destroy() noexcept {
+            Clear();
+        }
+
+        void FrameContext::Resize(std::uint32_t imageCount) {
+            WaitIdle();
+            DestroyRenderSemaphores();
+            CreateRenderSemaphores(imageCount);
+        }
+
+        bool FrameContext::Begin(Swapchain& swapchain) {
+            auto device{ Context::Get()->GetDevice() };
+            auto& frame{ m_Frames[m_Index] };
+
+            ADH_THROW(vkWaitForFences(device, 1u, &frame.fence, VK_TRUE, maxTimeout) == VK_SUCCESS,
+                      "Failed to wait for fences!");
+            RunDeletions(frame);
+
+            // Offscreen images are used in turn, the fence of the frame covers the last use of its image
+            if (swapchain.IsOffscreen()) {
+                m_ImageIndex = m_Index % swapchain.GetImageViewCount();
+                m_CommandBuffers.Begin(m_Index);
+                return true;
+            }
+
+            auto result{ vkAcquireNextImageKHR(device, swapchain, maxTimeout, frame.acquireSemaphore, VK_NULL_HANDLE, &m_ImageIndex) };
+            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                return false;
+            }
+            ADH_THROW(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR, "Failed to acquire swapchain image!");
+
+            m_CommandBuffers.Begin(m_Index);
+            return true;
+        }
+
+        bool FrameContext::End(Swapchain& swapchain) {
+            auto device{ Context::Get()->GetDevice() };
+            auto& frame{ m_Frames[m_Index] };
+
+            m_CommandBuffers.End(m_Index);
+            CollectDeletions(frame);
+
+            if (swapchain.IsOffscreen()) {
+                VkCommandBuffer commandBuffers[]{ m_CommandBuffers[m_Index] };
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = std::size(commandBuffers);
+                submitInfo.pCommandBuffers    = commandBuffers;
+
+                vkResetFences(device, 1u, &frame.fence);
+                ADH_THROW(vkQueueSubmit(Context::Get()->GetQueue(DeviceQueues::Family::eGraphics).queue, 1u, &submitInfo, frame.fence) == VK_SUCCESS,
+                          "Failed to submit to queue!");
+
+                m_Index = (m_Index + 1u) % GetFrameCount();
+                return true;
+            }
+
+            {
+                VkPipelineStageFlags waitStages[]{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+                VkSemaphore waitSemaphores[]{ frame.acquireSemaphore };
+                VkSemaphore signalSemaphores[]{ m_RenderSemaphores[m_ImageIndex] };
+                VkCommandBuffer commandBuffers[]{ m_CommandBuffers[m_Index] };
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount   = std::size(commandBuffers);
+                submitInfo.pCommandBuffers      = commandBuffers;
+                submitInfo.waitSemaphoreCount   = std::size(waitSemaphores);
+                submitInfo.pWaitSemaphores      = waitSemaphores;
+                submitInfo.pWaitDstStageMask    = waitStages;
+                submitInfo.signalSemaphoreCount = std::size(signalSemaphores);
+                submitInfo.pSignalSemaphores    = signalSemaphores;
+
+                vkResetFences(device, 1u, &frame.fence);
+                ADH_THROW(vkQueueSubmit(Context::Get()->GetQueue(DeviceQueues::Family::eGraphics).queue, 1u, &submitInfo, frame.fence) == VK_SUCCESS,
+                          "Failed to submit to queue!");
+            }
+
+            VkResult result;
+            {
+                VkSwapchainKHR swapchains[]{ swapchain };
+                VkSemaphore waitSemaphores[]{ m_RenderSemaphores[m_ImageIndex] };
+                VkPresentInfoKHR presentInfo{};
+                presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+                presentInfo.waitSemaphoreCount = std::size(waitSemaphores);
+                presentInfo.pWaitSemaphores    = waitSemaphores;
+                presentInfo.swapchainCount     = std::size(swapchains);
+                presentInfo.pSwapchains        = swapchains;
+                presentInfo.pImageIndices      = &m_ImageIndex;
+
+                result = vkQueuePresentKHR(Context::Get()->GetQueue(DeviceQueues::Family::ePrensent).queue, &presentInfo);
+            }
+
+            m_Index = (m_Index + 1u) % GetFrameCount();
+            return result != VK_ERROR_OUT_OF_DATE_KHR && result != VK_SUBOPTIMAL_KHR;
+        }
+
+        void FrameContext::Defer(Function<void()> destroy) {
+            m_PendingDeletions.EmplaceBack(Move(destroy));
+        }
+
+        void FrameContext::WaitIdle() noexcept {
+            vkDeviceWaitIdle(Context::Get()->GetDevice());
+            for (auto& frame : m_Frames) {
+                RunDeletions(frame);
+            }
+            if (!m_Frames.IsEmpty()) {
+                CollectDeletions(m_Frames[m_Index]);
+                RunDeletions(m_Frames[m_Index]);
+            }
+        }
+
+        VkCommandBuffer FrameContext::GetCommandBuffer() const noexcept {
+            return m_CommandBuffers[m_Index];
+        }
+
+        std::uint32_t FrameContext::GetIndex() const noexcept {
+            return m_Index;
+        }
+
+        std::uint32_t FrameContext::GetImageIndex() const noexcept {
+            return m_ImageIndex;
+        }
+
+        std::uint32_t FrameContext::GetFrameCount() const noexcept {
+            return static_cast<std::uint32_t>(m_Frames.GetSize());
+        }
+
+        void FrameContext::CollectDeletions(Frame& frame) {
+            for (auto&& destroy : m_PendingDeletions) {
+                frame.deletionQueue.EmplaceBack(Move(destroy));
+            }
+            m_PendingDeletions.Clear();
+
+            for (auto&& destroy : Allocator::TakeDestroyQueue()) {
+                frame.deletionQueue.EmplaceBack(Move(destroy));
+            }
+
+            // Texture slots are written again by the next texture, the frame may still sample the old one
+            auto textureIDs{ TextureDescriptors::TakeFreed() };
+            if (!textureIDs.IsEmpty()) {
+                frame.deletionQueue.EmplaceBack([textureIDs]() {
+                    TextureDescriptors::Release(textureIDs);
+                });
+            }
+
+            // Mesh ranges are written again by the next upload, the frame may still draw the old mesh
+            if (GeometryBuffer::IsCreated()) {
+                auto ranges{ GeometryBuffer::Get()->TakeFreed() };
+                if (!ranges.IsEmpty()) {
+                    frame.deletionQueue.EmplaceBack([ranges]() {
+                        if (GeometryBuffer::IsCreated()) {
+                            GeometryBuffer::Get()->Release(ranges);
+                        }
+                    });
+                }
+            }
+        }
+
+        void FrameContext::RunDeletions(Frame& frame) noexcept {
+            for (auto&& destroy : frame.deletionQueue) {
+                destroy();
+            }
+            frame.deletionQueue.Clear();
+        }
+
+        void FrameContext::CreateRenderSemaphores(std::uint32_t imageCount) {
+            auto info{ initializers::SemaphoreCreateInfo() };
+            m_RenderSemaphores.Resize(imageCount);
+            for (auto& semaphore : m_RenderSemaphores) {
+                ADH_THROW(vkCreateSemaphore(Context::Get()->GetDevice(), &info, nullptr, &semaphore) == VK_SUCCESS,
+                          "Failed to create semaphore!");
+            }
+        }
+
+        void FrameContext::DestroyRenderSemaphores() noexcept {
+            for (auto semaphore : m_RenderSemaphores) {
+                vkDestroySemaphore(Context::Get()->GetDevice(), semaphore, nullptr);
+            }
+            m_RenderSemaphores.Clear();
+        }
+
+        void FrameContext::MoveConstruct(FrameContext&& rhs) noexcept {
+            m_Frames           = Move(rhs.m_Frames);
+            m_RenderSemaphores = Move(rhs.m_RenderSemaphores);
+            m_PendingDeletions = Move(rhs.m_PendingDeletions);
+            m_CommandBuffers   = Move(rhs.m_CommandBuffers);
+            m_Index            = rhs.m_Index;
+            m_ImageIndex       = rhs.m_ImageIndex;
+
+            rhs.m_Index      = 0u;
+            rhs.m_ImageIndex = 0u;
+        }
+
+        void FrameContext::Clear() noexcept {
+            if (!m_Frames.IsEmpty()) {
+                WaitIdle();
+
+                auto device{ Context::Get()->GetDevice() };
+                for (auto& frame : m_Frames) {
+                    vkDestroyFence(device, frame.fence, nullptr);
+                    vkDestroySemaphore(device, frame.acquireSemaphore, nullptr);
+                }
+                m_Frames.Clear();
+                DestroyRenderSemaphores();
+
+                m_CommandBuffers.Free();
+                m_CommandBuffers.Destroy();
+                m_Index      = 0u;
+                m_ImageIndex = 0u;
+            }
+        }
+    } // namespace vk
+} // namespace adh
@@ -0,0 +1,103 @@
+#pragma once
+#include "CommandBuffer.hpp"
+#include <Std/Array.hpp>
+#include <Std/Function.hpp>
+
+#include <vulkan/vulkan.h>
+
+namespace adh {
+    namespace vk {
+        class Swapchain;
+
+        // Picked by the user, applied by recreating the swapchain and the frame context
+        struct FrameSettings {
+            VkPresentModeKHR presentMode{ VK_PRESENT_MODE_FIFO_KHR };
+            std::uint32_t framesInFlight{ 2u };
+        };
+
+        // Frames the CPU records while the GPU still works on the previous ones. Every frame owns a
+        // command buffer, the fence of its last submission, the semaphore its swapchain image is
+        // acquired with and a deletion queue. Begin() waits for the fence before anything else, so
+        // per-frame copies indexed by GetIndex() are never written while the GPU reads them.
+        // Buffers and descriptor sets are sized by maxFramesInFlight, changing the frame count at
+        // runtime only recreates the frame context.
+        class FrameContext {
+          public:
+            static constexpr std::uint32_t maxFramesInFlight{ 3u };
+
+          public:
+            FrameContext() noexcept;
+
+            FrameContext(std::uint32_t framesInFlight, std::uint32_t imageCount);
+
+            FrameContext(const FrameContext& rhs) = delete;
+
+            FrameContext& operator=(const FrameContext& rhs) = delete;
+
+            FrameContext(FrameContext&& rhs) noexcept;
+
+            FrameContext& operator=(FrameContext&& rhs) noexcept;
+
+            ~FrameContext();
+
+            void Create(std::uint32_t framesInFlight, std::uint32_t imageCount);
+
+            void Destroy() noexcept;
+
+            // Render semaphores are per swapchain image, called after the swapchain was recreated
+            void Resize(std::uint32_t imageCount);
+
+            // Waits for the next frame, runs its deletion queue, acquires a swapchain image and begins
+            // the command buffer. Returns false if the swapchain is out of date, nothing was begun.
+            bool Begin(Swapchain& swapchain);
+
+            // Submits the command buffer and presents. Returns false if the swapchain must be recreated.
+            // Offscreen swapchains are only submitted to.
+            bool End(Swapchain& swapchain);
+
+            // Runs once the GPU finished every frame submitted until the next End()
+            void Defer(Function<void()> destroy);
+
+            // Waits for the device and runs every deletion queue
+            void WaitIdle() noexcept;
+
+            VkCommandBuffer GetCommandBuffer() const noexcept;
+
+            // Frame slot, indexes per-frame copies
+            std::uint32_t GetIndex() const noexcept;
+
+            std::uint32_t GetImageIndex() const noexcept;
+
+            std::uint32_t GetFrameCount() const noexcept;
+
+          private:
+            struct Frame {
+                VkFence fence;
+                VkSemaphore acquireSemaphore;
+                Array<Function<void()>> deletionQueue;
+            };
+
+          private:
+            // Hands everything released since the last End() to the frame about to be submitted
+            void CollectDeletions(Frame& frame);
+
+            void RunDeletions(Frame& frame) noexcept;
+
+            void CreateRenderSemaphores(std::uint32_t imageCount);
+
+            void DestroyRenderSemaphores() noexcept;
+
+            void MoveConstruct(FrameContext&& rhs) noexcept;
+
+            void Clear() noexcept;
+
+          private:
+            Array<Frame> m_Frames;
+            Array<VkSemaphore> m_RenderSemaphores; // Per swapchain image
+            Array<Function<void()>> m_PendingDeletions;
+            CommandBuffer m_CommandBuffers;
+            std::uint32_t m_Index;
+            std::uint32_t m_ImageIndex;
+        };
+    } // namespace vk
+} // namespace adh
@@ -0,0 +1,205 @@
+#include "GeometryBuffer.hpp"
+#include "Memory.hpp"
+#include "StagingBuffer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace adh {
+    namespace vk {
+        GeometryBuffer* GeometryBuffer::Get() ADH_NOEXCEPT {
+            ADH_THROW(s_This, "Geometry buffer is not created!");
+            return s_This;
+        }
+
+        bool GeometryBuffer::IsCreated() noexcept {
+            return s_This;
+        }
+
+        GeometryBuffer::GeometryBuffer() noexcept : m_UsedSize{},
+                                                    m_VertexStride{},
+                                                    m_VertexCapacity{},
+                                                    m_IndexCapacity{} {
+        }
+
+        GeometryBuffer::~GeometryBuffer() {
+            Clear();
+        }
+
+        void GeometryBuffer::Create(std::uint32_t vertexStride, VkDeviceSize size) {
+            Clear();
+            if (auto megabytes{ std::getenv("ADH_GEOMETRY_MB") }) {
+                size = static_cast<VkDeviceSize>(std::strtoull(megabytes, nullptr, 10)) << 20u;
+            }
+            m_VertexStride   = vertexStride;
+            m_VertexCapacity = static_cast<std::uint32_t>(size / vertexStride);
+            m_IndexCapacity  = static_cast<std::uint32_t>(size / indexRatio / sizeof(std::uint32_t));
+            ADH_THROW(m_VertexCapacity && m_IndexCapacity, "Geometry buffer is too small!");
+
+            m_Vertices.Create(VkDeviceSize{ m_VertexStride } * m_VertexCapacity, 1u,
+                              VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            m_Indices.Create(VkDeviceSize{ sizeof(std::uint32_t) } * m_IndexCapacity, 1u,
+                             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            m_FreeVertices.Create(m_VertexCapacity);
+            m_FreeIndices.Create(m_IndexCapacity);
+            s_This = this;
+        }
+
+        void GeometryBuffer::Destroy() noexcept {
+            Clear();
+        }
+
+        bool GeometryBuffer::Allocate(const void* vertices, std::uint32_t vertexCount, const void* indices, std::uint32_t indexCount, Range& range) {
+            if (!vertexCount || !indexCount || !m_FreeVertices.Allocate(vertexCount, range.firstVertex)) {
+                return false;
+            }
+            if (!m_FreeIndices.Allocate(indexCount, range.firstIndex)) {
+                m_FreeVertices.Free(range.firstVertex, vertexCount);
+                return false;
+            }
+            range.vertexCount = vertexCount;
+            range.indexCount  = indexCount;
+
+            // Both copies are staged together, from the persistent staging buffer if it has room
+            auto vertexSize{ VkDeviceSize{ m_VertexStride } * vertexCount };
+            auto indexOffset{ (vertexSize + StagingBuffer::alignment - 1u) & ~(StagingBuffer::alignment - 1u) };
+            auto indexSize{ VkDeviceSize{ sizeof(std::uint32_t) } * indexCount };
+
+            StagingBuffer::Region region{};
+            Buffer fallback;
+            VkBuffer source;
+            void* data;
+            if (StagingBuffer::IsCreated() && StagingBuffer::Get()->Allocate(indexOffset + indexSize, region)) {
+                source = *StagingBuffer::Get();
+                data   = region.data;
+            } else {
+                fallback.Create(indexOffset + indexSize, 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+                fallback.Map(nullptr, data);
+                source = fallback;
+            }
+            std::memcpy(data, vertices, static_cast<std::size_t>(vertexSize));
+            std::memcpy(static_cast<char*>(data) + indexOffset, indices, static_cast<std::size_t>(indexSize));
+            if (fallback.Get() != VK_NULL_HANDLE) {
+                fallback.Unmap();
+            }
+
+            auto vertexCopy{ initializers::BufferCopy(vertexSize, region.offset, VkDeviceSize{ m_VertexStride } * range.firstVertex) };
+            CopyBuffer(source, m_Vertices, &vertexCopy, 1u);
+            auto indexCopy{ initializers::BufferCopy(indexSize, region.offset + indexOffset, VkDeviceSize{ sizeof(std::uint32_t) } * range.firstIndex) };
+            CopyBuffer(source, m_Indices, &indexCopy, 1u);
+
+            if (region.size) {
+                StagingBuffer::Get()->Free(region);
+            }
+            m_UsedSize += vertexSize + indexSize;
+            return true;
+        }
+
+        void GeometryBuffer::Free(Range& range) noexcept {
+            if (range.vertexCount) {
+                m_Freed.EmplaceBack(range);
+            }
+            range = {};
+        }
+
+        Array<GeometryBuffer::Range> GeometryBuffer::TakeFreed() noexcept {
+            return Move(m_Freed);
+        }
+
+        void GeometryBuffer::Release(const Array<Range>& ranges) noexcept {
+            for (const auto& range : ranges) {
+                m_FreeVertices.Free(range.firstVertex, range.vertexCount);
+                m_FreeIndices.Free(range.firstIndex, range.indexCount);
+                m_UsedSize -= VkDeviceSize{ m_VertexStride } * range.vertexCount + VkDeviceSize{ sizeof(std::uint32_t) } * range.indexCount;
+            }
+        }
+
+        void GeometryBuffer::Bind(VkCommandBuffer commandBuffer) noexcept {
+            VkDeviceSize offsets[]{ 0u };
+            VkBuffer buffer{ m_Vertices };
+            vkCmdBindVertexBuffers(commandBuffer, 0u, 1u, &buffer, offsets);
+            vkCmdBindIndexBuffer(commandBuffer, m_Indices, 0u, VK_INDEX_TYPE_UINT32);
+        }
+
+        std::uint32_t GeometryBuffer::GetVertexStride() const noexcept {
+            return m_VertexStride;
+        }
+
+        VkDeviceSize GeometryBuffer::GetUsedSize() const noexcept {
+            return m_UsedSize;
+        }
+
+        VkDeviceSize GeometryBuffer::GetSize() const noexcept {
+            return VkDeviceSize{ m_VertexStride } * m_VertexCapacity + VkDeviceSize{ sizeof(std::uint32_t) } * m_IndexCapacity;
+        }
+
+        void GeometryBuffer::Clear() noexcept {
+            m_Vertices.Destroy();
+            m_Indices.Destroy();
+            m_FreeVertices.Destroy();
+            m_FreeIndices.Destroy();
+            m_Freed.Clear();
+            m_UsedSize       = 0u;
+            m_VertexStride   = 0u;
+            m_VertexCapacity = 0u;
+            m_IndexCapacity  = 0u;
+            if (s_This == this) {
+                s_This = nullptr;
+            }
+        }
+
+        GeometryRange::GeometryRange(GeometryRange&& rhs) noexcept {
+            MoveConstruct(Move(rhs));
+        }
+
+        GeometryRange& GeometryRange::operator=(GeometryRange&& rhs) noexcept {
+            Clear();
+            MoveConstruct(Move(rhs));
+            return *this;
+        }
+
+        GeometryRange::~GeometryRange() {
+            Clear();
+        }
+
+        bool GeometryRange::Create(const void* vertices, std::uint32_t vertexCount, const void* indices, std::uint32_t indexCount) {
+            Clear();
+            if (!GeometryBuffer::IsCreated() || !GeometryBuffer::Get()->Allocate(vertices, vertexCount, indices, indexCount, m_Range)) {
+                m_Range = {};
+                return false;
+            }
+            return true;
+        }
+
+        void GeometryRange::Destroy() noexcept {
+            Clear();
+        }
+
+        std::uint32_t GeometryRange::GetFirstIndex() const noexcept {
+            return m_Range.firstIndex;
+        }
+
+        std::int32_t GeometryRange::GetVertexOffset() const noexcept {
+            return static_cast<std::int32_t>(m_Range.firstVertex);
+        }
+
+        GeometryRange::operator bool() const noexcept {
+            return m_Range.vertexCount;
+        }
+
+        void GeometryRange::MoveConstruct(GeometryRange&& rhs) noexcept {
+            m_Range     = rhs.m_Range;
+            rhs.m_Range = {};
+        }
+
+        void GeometryRange::Clear() noexcept {
+            // The buffer is destroyed before the last meshes at shutdown, their ranges went with it
+            if (m_Range.vertexCount && GeometryBuffer::IsCreated()) {
+                GeometryBuffer::Get()->Free(m_Range);
+            }
+            m_Range = {};
+        }
+    } // namespace vk
+} // namespace adh
@@ -0,0 +1,120 @@
+#pragma once
+#include "Allocator.hpp"
+#include "Buffer.hpp"
+#include <Std/Array.hpp>
+#include <Std/RangeAllocator.hpp>
+#include <Utility.hpp>
+#include <vulkan/vulkan.h>
+
+namespace adh {
+    namespace vk {
+        // One device local vertex buffer and one index buffer every mesh is sub-allocated from, so
+        // they're bound once per pass and draws of different meshes can be merged. Meshes draw with
+        // the firstIndex and vertexOffset of their range, their indices stay local to the mesh.
+        // Ranges are handed out first fit in vertices and indices on the main thread. Freed ranges
+        // are reused once the frames that may still read them are complete, see FrameContext.
+        class GeometryBuffer {
+          public:
+            static constexpr VkDeviceSize defaultSize{ VkDeviceSize{ 128u } << 20u }; // ADH_GEOMETRY_MB overrides it
+            static constexpr std::uint32_t indexRatio{ 2u };                         // Of the vertex buffer size, in bytes
+
+            struct Range {
+                std::uint32_t firstVertex;
+                std::uint32_t vertexCount;
+                std::uint32_t firstIndex;
+                std::uint32_t indexCount;
+            };
+
+          public:
+            static GeometryBuffer* Get() ADH_NOEXCEPT;
+
+            static bool IsCreated() noexcept;
+
+            GeometryBuffer() noexcept;
+
+            GeometryBuffer(const GeometryBuffer& rhs) = delete;
+
+            GeometryBuffer& operator=(const GeometryBuffer& rhs) = delete;
+
+            ~GeometryBuffer();
+
+            // Every mesh shares the vertex layout, the stride is the one of VertexPacker::GetFormat()
+            void Create(std::uint32_t vertexStride, VkDeviceSize size = defaultSize);
+
+            void Destroy() noexcept;
+
+            // Copies the vertices and the 32 bit indices into a free range. Returns false if either
+            // buffer has no free range large enough, the mesh then keeps buffers of its own.
+            bool Allocate(const void* vertices, std::uint32_t vertexCount, const void* indices, std::uint32_t indexCount, Range& range);
+
+            // Reused after the frames in flight, TakeFreed() hands it to the frame context
+            void Free(Range& range) noexcept;
+
+            Array<Range> TakeFreed() noexcept;
+
+            void Release(const Array<Range>& ranges) noexcept;
+
+            void Bind(VkCommandBuffer commandBuffer) noexcept;
+
+            std::uint32_t GetVertexStride() const noexcept;
+
+            // Bytes of both buffers handed out
+            VkDeviceSize GetUsedSize() const noexcept;
+
+            VkDeviceSize GetSize() const noexcept;
+
+          private:
+            void Clear() noexcept;
+
+          private:
+            inline static GeometryBuffer* s_This;
+
+          private:
+            Buffer m_Vertices;
+            Buffer m_Indices;
+            RangeAllocator m_FreeVertices; // In vertices
+            RangeAllocator m_FreeIndices;  // In indices
+            Array<Range> m_Freed;          // Waiting for the frames in flight
+            VkDeviceSize m_UsedSize;
+            std::uint32_t m_VertexStride;
+            std::uint32_t m_VertexCapacity;
+            std::uint32_t m_IndexCapacity;
+        };
+
+        // A range of the GeometryBuffer, freed with its owner
+        class GeometryRange {
+          public:
+            GeometryRange() noexcept = default;
+
+            GeometryRange(const GeometryRange& rhs) = delete;
+
+            GeometryRange& operator=(const GeometryRange& rhs) = delete;
+
+            GeometryRange(GeometryRange&& rhs) noexcept;
+
+            GeometryRange& operator=(GeometryRange&& rhs) noexcept;
+
+            ~GeometryRange();
+
+            // False if there is no GeometryBuffer or it's full
+            bool Create(const void* vertices, std::uint32_t vertexCount, const void* indices, std::uint32_t indexCount);
+
+            void Destroy() noexcept;
+
+            // Added to the firstIndex of the LODs
+            std::uint32_t GetFirstIndex() const noexcept;
+
+            std::int32_t GetVertexOffset() const noexcept;
+
+            operator bool() const noexcept;
+
+          private:
+            void MoveConstruct(GeometryRange&& rhs) noexcept;
+
+            void Clear() noexcept;
+
+          private:
+            GeometryBuffer::Range m_Range{};
+        };
+    } // namespace vk
+} // namespace adh
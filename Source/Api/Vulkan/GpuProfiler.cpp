@@ -0,0 +1,338 @@
+#include "GpuProfiler.hpp"
+#include "Context.hpp"
+#include "Tools.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace adh {
+    namespace vk {
+        namespace {
+            constexpr std::uint32_t invalidQuery{ ~0u };
+
+            // In bit order, pipeline statistics are written in the order of their flags
+            constexpr VkQueryPipelineStatisticFlags statisticFlags{
+                VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT
+            };
+
+            const char* statisticNames[]{
+                "input_vertices",
+                "vertex_invocations",
+                "clipping_primitives",
+                "fragment_invocations",
+                "compute_invocations"
+            };
+
+            VkQueryPool CreateQueryPool(VkQueryType type, std::uint32_t count, VkQueryPipelineStatisticFlags statistics) {
+                VkQueryPoolCreateInfo info{};
+                info.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                info.queryType          = type;
+                info.queryCount         = count;
+                info.pipelineStatistics = statistics;
+
+                VkQueryPool pool{ VK_NULL_HANDLE };
+                ADH_THROW(vkCreateQueryPool(Context::Get()->GetDevice(), &info, nullptr, &pool) == VK_SUCCESS,
+                          "Failed to create query pool!");
+                return pool;
+            }
+        } // namespace
+
+        GpuProfiler::GpuProfiler() noexcept : m_Frame{},
+                                              m_FrameIndex{},
+                                              m_StatisticFlags{},
+                                              m_TimestampMask{},
+                                              m_TimestampPeriod{},
+                                              m_MaxScopes{} {
+            m_Frame.name = "Frame";
+        }
+
+        GpuProfiler::GpuProfiler(std::uint32_t frameCount, std::uint32_t maxScopes) : GpuProfiler{} {
+            Create(frameCount, maxScopes);
+        }
+
+        GpuProfiler::GpuProfiler(GpuProfiler&& rhs) noexcept {
+            MoveConstruct(Move(rhs));
+        }
+
+        GpuProfiler& GpuProfiler::operator=(GpuProfiler&& rhs) noexcept {
+            Clear();
+            MoveConstruct(Move(rhs));
+            return *this;
+        }
+
+        GpuProfiler::~GpuProfiler() {
+            Clear();
+        }
+
+        void GpuProfiler::Create(std::uint32_t frameCount, std::uint32_t maxScopes) {
+            auto physicalDevice{ Context::Get()->GetPhysicalDevice() };
+            auto properties{ tools::GetPhysicalDeviceProperties(physicalDevice) };
+            auto features{ tools::GetPhysicalDeviceFeatures(physicalDevice) };
+            auto queueFamilies{ tools::GetPhysicalDeviceQueueFamilyProperties(physicalDevice) };
+            auto validBits{ queueFamilies[Context::Get()->GetQueue(DeviceQueues::Family::eGraphics).index.value()].timestampValidBits };
+
+            // Without timestamps the profiler records nothing and the results stay empty
+            if (!validBits || !properties.limits.timestampPeriod) {
+                ADH_LOG("GPU profiler: timestamps aren't supported by the graphics queue");
+                return;
+            }
+            m_TimestampMask   = validBits == 64u ? ~0ull : (1ull << validBits) - 1ull;
+            m_TimestampPeriod = properties.limits.timestampPeriod;
+            m_MaxScopes       = maxScopes;
+
+            // Scenes are drawn by secondaries, statistics can only stay active around them with inherited queries
+            m_StatisticFlags = features.pipelineStatisticsQuery && features.inheritedQueries ? statisticFlags : 0u;
+
+            m_Frames.Resize(frameCount);
+            for (auto& frame : m_Frames) {
+                // The first two timestamps bracket the whole frame
+                frame.timestamps = CreateQueryPool(VK_QUERY_TYPE_TIMESTAMP, 2u + 2u * maxScopes, 0u);
+                frame.statistics = m_StatisticFlags ? CreateQueryPool(VK_QUERY_TYPE_PIPELINE_STATISTICS, maxScopes, m_StatisticFlags) : VK_NULL_HANDLE;
+                frame.scopes.Reserve(maxScopes);
+                frame.statisticsCount = 0u;
+                frame.isRecorded      = false;
+            }
+            m_Timestamps.Resize(2u + 2u * maxScopes);
+            m_Statistics.Resize(eStatisticCount * maxScopes);
+            m_OpenScopes.Reserve(maxScopes);
+        }
+
+        void GpuProfiler::Destroy() noexcept {
+            Clear();
+        }
+
+        void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, std::uint32_t frameIndex) {
+            if (m_Frames.IsEmpty()) {
+                return;
+            }
+
+            ADH_THROW(frameIndex < m_Frames.GetSize(), "Invalid GPU profiler frame!");
+            m_FrameIndex = frameIndex;
+            auto& frame{ m_Frames[frameIndex] };
+            if (frame.isRecorded) {
+                Resolve(frame);
+            }
+
+            frame.scopes.Clear();
+            frame.statisticsCount = 0u;
+            frame.isRecorded      = true;
+            m_OpenScopes.Clear();
+
+            vkCmdResetQueryPool(commandBuffer, frame.timestamps, 0u, 2u + 2u * m_MaxScopes);
+            if (frame.statistics != VK_NULL_HANDLE) {
+                vkCmdResetQueryPool(commandBuffer, frame.statistics, 0u, m_MaxScopes);
+            }
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestamps, 0u);
+        }
+
+        void GpuProfiler::EndFrame(VkCommandBuffer commandBuffer) noexcept {
+            if (!m_Frames.IsEmpty()) {
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_Frames[m_FrameIndex].timestamps, 1u);
+            }
+        }
+
+        void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name) ADH_NOEXCEPT {
+            if (m_Frames.IsEmpty()) {
+                return;
+            }
+
+            auto& frame{ m_Frames[m_FrameIndex] };
+            ADH_THROW(frame.scopes.GetSize() < m_MaxScopes, "Too many GPU profiler scopes in a frame!");
+
+            auto index{ static_cast<std::uint32_t>(frame.scopes.GetSize()) };
+            auto depth{ static_cast<std::uint32_t>(m_OpenScopes.GetSize()) };
+
+            // Pipeline statistics queries can't nest, only top level scopes have them
+            auto statisticsQuery{ invalidQuery };
+            if (frame.statistics != VK_NULL_HANDLE && !depth) {
+                statisticsQuery = frame.statisticsCount++;
+                vkCmdBeginQuery(commandBuffer, frame.statistics, statisticsQuery, 0u);
+            }
+
+            frame.scopes.EmplaceBack(Scope{ name, depth, statisticsQuery });
+            m_OpenScopes.EmplaceBack(index);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestamps, 2u + 2u * index);
+        }
+
+        void GpuProfiler::EndScope(VkCommandBuffer commandBuffer) ADH_NOEXCEPT {
+            if (m_Frames.IsEmpty()) {
+                return;
+            }
+
+            ADH_THROW(!m_OpenScopes.IsEmpty(), "GPU profiler scope ended without being begun!");
+            auto& frame{ m_Frames[m_FrameIndex] };
+            auto index{ m_OpenScopes[m_OpenScopes.GetSize() - 1u] };
+            m_OpenScopes.PopBack();
+
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.timestamps, 3u + 2u * index);
+            if (frame.scopes[index].statisticsQuery != invalidQuery) {
+                vkCmdEndQuery(commandBuffer, frame.statistics, frame.scopes[index].statisticsQuery);
+            }
+        }
+
+        VkQueryPipelineStatisticFlags GpuProfiler::GetInheritedStatistics() const noexcept {
+            return m_StatisticFlags;
+        }
+
+        const Array<GpuProfiler::Result>& GpuProfiler::GetResults() const noexcept {
+            return m_Results;
+        }
+
+        const GpuProfiler::Result& GpuProfiler::GetFrame() const noexcept {
+            return m_Frame;
+        }
+
+        bool GpuProfiler::IsSupported() const noexcept {
+            return !m_Frames.IsEmpty();
+        }
+
+        bool GpuProfiler::HasStatistics() const noexcept {
+            return m_StatisticFlags;
+        }
+
+        bool GpuProfiler::WriteCSV(const std::string& path) const {
+            std::ofstream file{ path, std::ios::trunc };
+            if (!file) {
+                return false;
+            }
+
+            file << "scope,depth,time_ms,max_time_ms";
+            for (auto name : statisticNames) {
+                file << ',' << name;
+            }
+            file << '\n';
+
+            auto writeRow = [&file](const Result& result) {
+                file << result.name << ',' << result.depth << ',' << result.time << ',' << result.maxTime;
+                for (auto statistic : result.statistics) {
+                    file << ',';
+                    if (result.hasStatistics) {
+                        file << static_cast<std::uint64_t>(statistic);
+                    }
+                }
+                file << '\n';
+            };
+
+            writeRow(m_Frame);
+            for (const auto& result : m_Results) {
+                if (result.isActive) {
+                    writeRow(result);
+                }
+            }
+            return static_cast<bool>(file);
+        }
+
+        bool GpuProfiler::Resolve(Frame& frame) {
+            auto device{ Context::Get()->GetDevice() };
+            auto scopeCount{ static_cast<std::uint32_t>(frame.scopes.GetSize()) };
+            auto timestampCount{ 2u + 2u * scopeCount };
+
+            // The fence of the slot was waited on, the queries are only missing if the frame never ran
+            if (vkGetQueryPoolResults(device, frame.timestamps, 0u, timestampCount, timestampCount * sizeof(std::uint64_t),
+                                      m_Timestamps.GetData(), sizeof(std::uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+                return false;
+            }
+            auto hasStatistics{ frame.statisticsCount &&
+                                vkGetQueryPoolResults(device, frame.statistics, 0u, frame.statisticsCount,
+                                                      frame.statisticsCount * eStatisticCount * sizeof(std::uint64_t), m_Statistics.GetData(),
+                                                      eStatisticCount * sizeof(std::uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS };
+
+            auto toMilliseconds = [this](std::uint64_t begin, std::uint64_t end) {
+                auto ticks{ ((end & m_TimestampMask) - (begin & m_TimestampMask)) & m_TimestampMask };
+                return static_cast<float>(static_cast<double>(ticks) * m_TimestampPeriod * 1e-6);
+            };
+
+            AddSample(m_Frame, toMilliseconds(m_Timestamps[0], m_Timestamps[1]));
+            m_Frame.isActive = true;
+
+            for (auto& result : m_Results) {
+                result.isActive = false;
+            }
+            for (std::uint32_t i{}; i != scopeCount; ++i) {
+                const auto& scope{ frame.scopes[i] };
+                auto& result{ GetResult(scope.name, scope.depth) };
+                AddSample(result, toMilliseconds(m_Timestamps[2u + 2u * i], m_Timestamps[3u + 2u * i]));
+                result.isActive = true;
+
+                result.hasStatistics = hasStatistics && scope.statisticsQuery != invalidQuery;
+                if (result.hasStatistics) {
+                    // Running average, weighted like the time window once the history is full
+                    auto weight{ 1.0 / result.historyCount };
+                    for (std::uint32_t j{}; j != eStatisticCount; ++j) {
+                        auto sample{ static_cast<double>(m_Statistics[scope.statisticsQuery * eStatisticCount + j]) };
+                        result.statistics[j] += (sample - result.statistics[j]) * weight;
+                    }
+                }
+            }
+            return true;
+        }
+
+        GpuProfiler::Result& GpuProfiler::GetResult(const char* name, std::uint32_t depth) {
+            for (auto& result : m_Results) {
+                if (result.depth == depth && result.name == name) {
+                    return result;
+                }
+            }
+
+            auto& result{ m_Results.EmplaceBack() };
+            result       = {};
+            result.name  = name;
+            result.depth = depth;
+            return result;
+        }
+
+        void GpuProfiler::AddSample(Result& result, float time) noexcept {
+            result.history[result.historyIndex] = time;
+            result.historyIndex                 = (result.historyIndex + 1u) % historySize;
+            result.historyCount                 = std::min(result.historyCount + 1u, historySize);
+
+            float sum{};
+            float maxTime{};
+            for (std::uint32_t i{}; i != result.historyCount; ++i) {
+                sum += result.history[i];
+                maxTime = std::max(maxTime, result.history[i]);
+            }
+            result.time    = sum / result.historyCount;
+            result.maxTime = maxTime;
+        }
+
+        void GpuProfiler::MoveConstruct(GpuProfiler&& rhs) noexcept {
+            m_Frames          = Move(rhs.m_Frames);
+            m_Results         = Move(rhs.m_Results);
+            m_OpenScopes      = Move(rhs.m_OpenScopes);
+            m_Timestamps      = Move(rhs.m_Timestamps);
+            m_Statistics      = Move(rhs.m_Statistics);
+            m_Frame           = Move(rhs.m_Frame);
+            m_FrameIndex      = rhs.m_FrameIndex;
+            m_StatisticFlags  = rhs.m_StatisticFlags;
+            m_TimestampMask   = rhs.m_TimestampMask;
+            m_TimestampPeriod = rhs.m_TimestampPeriod;
+            m_MaxScopes       = rhs.m_MaxScopes;
+
+            rhs.m_FrameIndex     = 0u;
+            rhs.m_StatisticFlags = 0u;
+            rhs.m_MaxScopes      = 0u;
+        }
+
+        void GpuProfiler::Clear() noexcept {
+            if (!m_Frames.IsEmpty()) {
+                auto device{ Context::Get()->GetDevice() };
+                for (auto& frame : m_Frames) {
+                    vkDestroyQueryPool(device, frame.timestamps, nullptr);
+                    if (frame.statistics != VK_NULL_HANDLE) {
+                        vkDestroyQueryPool(device, frame.statistics, nullptr);
+                    }
+                }
+                m_Frames.Clear();
+                m_Results.Clear();
+                m_FrameIndex     = 0u;
+                m_StatisticFlags = 0u;
+                m_MaxScopes      = 0u;
+            }
+        }
+    } // namespace vk
+} // namespace adh
@@ -0,0 +1,129 @@
+#pragma once
+#include <Std/Array.hpp>
+#include <Utility.hpp>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+
+namespace adh {
+    namespace vk {
+        // GPU time of named scopes, measured with timestamp queries. Top level scopes also collect
+        // pipeline statistics where the device supports them, nested scopes only have timestamps.
+        // Every frame slot owns its query pools. BeginFrame() runs after the fence of the slot was
+        // waited on, reads the queries the slot wrote last time without stalling and resets them.
+        class GpuProfiler {
+          public:
+            static constexpr std::uint32_t historySize{ 64u };
+
+            enum Statistic : std::uint32_t {
+                eInputVertices,
+                eVertexInvocations,
+                eClippingPrimitives,
+                eFragmentInvocations,
+                eComputeInvocations,
+                eStatisticCount
+            };
+
+            // Averaged over the last historySize frames that ran the scope
+            struct Result {
+                std::string name;
+                std::uint32_t depth;
+                float time;    // ms
+                float maxTime; // ms, over the same frames
+                double statistics[eStatisticCount];
+                bool hasStatistics;
+                bool isActive; // Ran in the last frame read back
+
+                float history[historySize];
+                std::uint32_t historyCount;
+                std::uint32_t historyIndex;
+            };
+
+          public:
+            GpuProfiler() noexcept;
+
+            GpuProfiler(std::uint32_t frameCount, std::uint32_t maxScopes);
+
+            GpuProfiler(const GpuProfiler& rhs) = delete;
+
+            GpuProfiler& operator=(const GpuProfiler& rhs) = delete;
+
+            GpuProfiler(GpuProfiler&& rhs) noexcept;
+
+            GpuProfiler& operator=(GpuProfiler&& rhs) noexcept;
+
+            ~GpuProfiler();
+
+            void Create(std::uint32_t frameCount, std::uint32_t maxScopes);
+
+            void Destroy() noexcept;
+
+            // Outside of a render pass, before any other scope of the frame
+            void BeginFrame(VkCommandBuffer commandBuffer, std::uint32_t frameIndex);
+
+            void EndFrame(VkCommandBuffer commandBuffer) noexcept;
+
+            // The name must outlive the frame. Top level scopes with statistics must begin and end
+            // outside of render passes, secondaries executed inside them need GetInheritedStatistics().
+            void BeginScope(VkCommandBuffer commandBuffer, const char* name) ADH_NOEXCEPT;
+
+            void EndScope(VkCommandBuffer commandBuffer) ADH_NOEXCEPT;
+
+            // Flags for VkCommandBufferInheritanceInfo::pipelineStatistics, zero without statistics
+            VkQueryPipelineStatisticFlags GetInheritedStatistics() const noexcept;
+
+            // In the order the scopes were first recorded
+            const Array<Result>& GetResults() const noexcept;
+
+            const Result& GetFrame() const noexcept;
+
+            bool IsSupported() const noexcept;
+
+            bool HasStatistics() const noexcept;
+
+            // One row per result, returns false if the file can't be written
+            bool WriteCSV(const std::string& path) const;
+
+          private:
+            struct Scope {
+                const char* name;
+                std::uint32_t depth;
+                std::uint32_t statisticsQuery; // Invalid without statistics
+            };
+
+            struct Frame {
+                VkQueryPool timestamps;
+                VkQueryPool statistics;
+                Array<Scope> scopes;
+                std::uint32_t statisticsCount;
+                bool isRecorded;
+            };
+
+          private:
+            // Reads the queries of the last frame recorded in the slot, false if they aren't available
+            bool Resolve(Frame& frame);
+
+            Result& GetResult(const char* name, std::uint32_t depth);
+
+            static void AddSample(Result& result, float time) noexcept;
+
+            void MoveConstruct(GpuProfiler&& rhs) noexcept;
+
+            void Clear() noexcept;
+
+          private:
+            Array<Frame> m_Frames;
+            Array<Result> m_Results;
+            Array<std::uint32_t> m_OpenScopes;
+            Array<std::uint64_t> m_Timestamps;
+            Array<std::uint64_t> m_Statistics;
+            Result m_Frame;
+            std::uint32_t m_FrameIndex;
+            VkQueryPipelineStatisticFlags m_StatisticFlags;
+            std::uint64_t m_TimestampMask;
+            float m_TimestampPeriod; // ns per tick
+            std::uint32_t m_MaxScopes;
+        };
+    } // namespace vk
+} // namespace adh
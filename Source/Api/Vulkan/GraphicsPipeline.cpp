@@ -86,13 +86,17 @@ namespace adh {
                     renderPass)
             };
 
-            ADH_THROW(vkCreateGraphicsPipelines(Context::Get()->GetDevice(), VK_NULL_HANDLE, 1u, &graphicsPipelineInfo, nullptr, &m_Pipeline) == VK_SUCCESS,
+            ADH_THROW(vkCreateGraphicsPipelines(Context::Get()->GetDevice(), Context::Get()->GetPipelineCache(), 1u, &graphicsPipelineInfo, nullptr, &m_Pipeline) == VK_SUCCESS,
                       "Failed to create graphics pipeline!");
         }
 
         void GraphicsPipeline::Create(VkGraphicsPipelineCreateInfo createInfo) {
-            ADH_THROW(vkCreateGraphicsPipelines(Context::Get()->GetDevice(), VK_NULL_HANDLE, 1u, &createInfo, nullptr, &m_Pipeline) == VK_SUCCESS,
+            // Replaces the pipeline when its shaders are reloaded, the old one is kept if this fails
+            VkPipeline pipeline;
+            ADH_THROW(vkCreateGraphicsPipelines(Context::Get()->GetDevice(), Context::Get()->GetPipelineCache(), 1u, &createInfo, nullptr, &pipeline) == VK_SUCCESS,
                       "Failed to create graphics pipeline!");
+            Clear();
+            m_Pipeline = pipeline;
         }
 
         void GraphicsPipeline::Bind(VkCommandBuffer commandBuffer) {
@@ -100,6 +100,17 @@ namespace adh {
                 return deviceCreateInfo;
             }
 
+            // Features used by the bindless texture table
+            inline auto PhysicalDeviceDescriptorIndexingFeatures() noexcept {
+                VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
+                descriptorIndexingFeatures.sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+                descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing    = VK_TRUE;
+                descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                descriptorIndexingFeatures.descriptorBindingPartiallyBound              = VK_TRUE;
+                descriptorIndexingFeatures.runtimeDescriptorArray                       = VK_TRUE;
+                return descriptorIndexingFeatures;
+            }
+
             inline auto PhysicalDeviceBufferDeviceAddressFeatures() noexcept {
                 VkPhysicalDeviceBufferDeviceAddressFeaturesEXT bufferDeviceAddressFeatures{
                     .sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_EXT,
@@ -297,6 +308,15 @@ namespace adh {
                 return info;
             }
 
+            inline auto CommandBufferInheritanceInfo(VkRenderPass renderPass, std::uint32_t subpass, VkFramebuffer framebuffer) noexcept {
+                VkCommandBufferInheritanceInfo info{};
+                info.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+                info.renderPass  = renderPass;
+                info.subpass     = subpass;
+                info.framebuffer = framebuffer;
+                return info;
+            }
+
             inline auto DescriptorPoolCreateInfo(std::uint32_t maxSets, std::uint32_t count, const VkDescriptorPoolSize* poolSizes) noexcept {
                 VkDescriptorPoolCreateInfo info{};
                 info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
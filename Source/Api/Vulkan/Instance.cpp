@@ -9,8 +9,8 @@ namespace adh {
         Instance::Instance() noexcept : m_Instance{ VK_NULL_HANDLE } {
         }
 
-        Instance::Instance(const char* name) {
-            Create(name);
+        Instance::Instance(const char* name, bool isHeadless) {
+            Create(name, isHeadless);
         }
 
         Instance::Instance(Instance&& rhs) noexcept {
@@ -27,16 +27,18 @@ namespace adh {
             Clear();
         }
 
-        void Instance::Create(const char* name) {
+        void Instance::Create(const char* name, bool isHeadless) {
             auto applicationInfo{ initializers::ApplicationInfo("AdHoc", VK_API_VERSION_1_2) };
             Array<const char*> validationLayers;
 #if defined(ADH_DEBUG)
             validationLayers.EmplaceBack("VK_LAYER_KHRONOS_validation");
 #endif
-            Array<const char*> instanceExtentions{
-		    "VK_KHR_surface",
-		    ADH_VK_PLATFORM_SURFACE,
-	    	"VK_KHR_portability_enumeration" };
+            Array<const char*> instanceExtentions;
+            if (!isHeadless) {
+                instanceExtentions.EmplaceBack("VK_KHR_surface");
+                instanceExtentions.EmplaceBack(ADH_VK_PLATFORM_SURFACE);
+            }
+            instanceExtentions.EmplaceBack("VK_KHR_portability_enumeration");
             auto instanceCreateInfo{ initializers::InstanceCreateInfo(applicationInfo, instanceExtentions, validationLayers) };
             ADH_THROW(vkCreateInstance(&instanceCreateInfo, nullptr, &m_Instance) == VK_SUCCESS,
                       "Failed to create VkInstance!");
@@ -8,7 +8,7 @@ namespace adh {
           public:
             Instance() noexcept;
 
-            Instance(const char* name);
+            Instance(const char* name, bool isHeadless = false);
 
             Instance(const Instance&) = delete;
 
@@ -20,7 +20,8 @@ namespace adh {
 
             ~Instance();
 
-            void Create(const char* name);
+            // Headless instances don't enable the surface extensions
+            void Create(const char* name, bool isHeadless = false);
 
             void Destroy() noexcept;
 
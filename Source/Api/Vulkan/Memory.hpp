@@ -10,11 +10,10 @@
 
 namespace adh {
     namespace vk {
-        inline void CopyBuffer(VkBuffer src, VkBuffer dst, std::uint64_t size) {
+        inline void CopyBuffer(VkBuffer src, VkBuffer dst, const VkBufferCopy* regions, std::uint32_t regionCount) {
             CommandBuffer commandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, DeviceQueues::Family::eTransfer);
             commandBuffer.Begin();
-            auto bufferCopy{ initializers::BufferCopy(size) };
-            vkCmdCopyBuffer(commandBuffer[0], src, dst, 1u, &bufferCopy);
+            vkCmdCopyBuffer(commandBuffer[0], src, dst, regionCount, regions);
             commandBuffer.End();
 
             auto submitInfo{ initializers::SubmitInfo(
@@ -29,24 +28,26 @@ namespace adh {
             commandBuffer.Free();
         }
 
+        inline void CopyBuffer(VkBuffer src, VkBuffer dst, std::uint64_t size) {
+            auto bufferCopy{ initializers::BufferCopy(size) };
+            CopyBuffer(src, dst, &bufferCopy, 1u);
+        }
+
         inline void CopyBufferToImage(
             VkBuffer srcBuffer,
             VkImage dstImage,
-            VkImageAspectFlagBits aspectFlag,
-            VkExtent3D extent,
-            std::uint32_t mipLevel   = 0u,
-            std::uint32_t layerCount = 1u) {
+            const VkBufferImageCopy* regions,
+            std::uint32_t regionCount) {
             CommandBuffer commandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, DeviceQueues::Family::eTransfer);
             commandBuffer.Begin();
 
-            auto imageCopy{ initializers::BufferImageCopy(aspectFlag, extent, mipLevel, layerCount) };
             vkCmdCopyBufferToImage(
                 commandBuffer[0],
                 srcBuffer,
                 dstImage,
                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                1u,
-                &imageCopy);
+                regionCount,
+                regions);
 
             commandBuffer.End();
 
@@ -62,6 +63,17 @@ namespace adh {
             commandBuffer.Free();
         }
 
+        inline void CopyBufferToImage(
+            VkBuffer srcBuffer,
+            VkImage dstImage,
+            VkImageAspectFlagBits aspectFlag,
+            VkExtent3D extent,
+            std::uint32_t mipLevel   = 0u,
+            std::uint32_t layerCount = 1u) {
+            auto imageCopy{ initializers::BufferImageCopy(aspectFlag, extent, mipLevel, layerCount) };
+            CopyBufferToImage(srcBuffer, dstImage, &imageCopy, 1u);
+        }
+
         inline void TransferImageLayout(
             VkImage image,
             VkImageLayout oldLayout,
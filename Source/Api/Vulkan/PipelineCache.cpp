@@ -0,0 +1,165 @@
+#include "PipelineCache.hpp"
+#include <Std/Array.hpp>
+#include <Std/Hash.hpp>
+
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace adh {
+    namespace vk {
+        PipelineCache::PipelineCache() noexcept : m_PipelineCache{ VK_NULL_HANDLE },
+                                                  m_Device{ VK_NULL_HANDLE },
+                                                  m_Properties{},
+                                                  m_IsWarm{} {
+        }
+
+        PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath) : PipelineCache() {
+            Create(device, physicalDevice, filePath);
+        }
+
+        PipelineCache::PipelineCache(PipelineCache&& rhs) noexcept {
+            MoveConstruct(Move(rhs));
+        }
+
+        PipelineCache& PipelineCache::operator=(PipelineCache&& rhs) noexcept {
+            Clear();
+            MoveConstruct(Move(rhs));
+            return *this;
+        }
+
+        PipelineCache::~PipelineCache() {
+            Clear();
+        }
+
+        void PipelineCache::Create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath) {
+            Clear();
+            m_Device   = device;
+            m_FilePath = filePath;
+            vkGetPhysicalDeviceProperties(physicalDevice, &m_Properties);
+
+            Array<char> data;
+            if (std::ifstream file{ m_FilePath, std::ios::binary | std::ios::ate }; file) {
+                auto fileSize{ static_cast<std::uint64_t>(file.tellg()) };
+                file.seekg(0, std::ios::beg);
+                FileHeader header{};
+                file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+                if (file && header.magic == magic && header.version == version && header.dataSize == fileSize - sizeof(FileHeader)) {
+                    data.Resize(static_cast<std::size_t>(header.dataSize));
+                    file.read(data.GetData(), data.GetSize());
+                    if (!file || Fnv1a(data.GetData(), data.GetSize()) != header.dataHash || !IsCompatible(data.GetData(), data.GetSize())) {
+                        data.Clear();
+                    }
+                }
+            }
+            m_IsWarm = !data.IsEmpty();
+
+            VkPipelineCacheCreateInfo info{};
+            info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            info.initialDataSize = data.GetSize();
+            info.pInitialData    = data.GetData();
+            ADH_THROW(vkCreatePipelineCache(m_Device, &info, nullptr, &m_PipelineCache) == VK_SUCCESS,
+                      "Failed to create pipeline cache!");
+        }
+
+        void PipelineCache::Save() const noexcept {
+            if (m_PipelineCache == VK_NULL_HANDLE || m_FilePath.empty()) {
+                return;
+            }
+
+            try {
+                std::size_t size{};
+                if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr) != VK_SUCCESS || !size) {
+                    return;
+                }
+                Array<char> data;
+                data.Resize(size);
+                if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, data.GetData()) != VK_SUCCESS) {
+                    return;
+                }
+
+                // Written next to the cache and renamed over it, a crash never leaves a torn file behind
+                FileHeader header{ magic, version, size, Fnv1a(data.GetData(), size) };
+                auto tempPath{ m_FilePath + ".tmp" };
+                std::error_code error;
+                {
+                    std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+                    if (!file) {
+                        return;
+                    }
+                    file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+                    file.write(data.GetData(), size);
+                    if (!file) {
+                        file.close();
+                        std::filesystem::remove(tempPath, error);
+                        return;
+                    }
+                }
+                std::filesystem::rename(tempPath, m_FilePath, error);
+                if (error) {
+                    std::filesystem::remove(tempPath, error);
+                }
+            } catch (const std::exception&) {
+                // Called from Clear(), running out of memory only leaves the old file
+            }
+        }
+
+        void PipelineCache::Destroy() noexcept {
+            Clear();
+        }
+
+        bool PipelineCache::IsWarm() const noexcept {
+            return m_IsWarm;
+        }
+
+        VkPipelineCache PipelineCache::Get() noexcept {
+            return m_PipelineCache;
+        }
+
+        const VkPipelineCache PipelineCache::Get() const noexcept {
+            return m_PipelineCache;
+        }
+
+        PipelineCache::operator VkPipelineCache() noexcept {
+            return m_PipelineCache;
+        }
+
+        PipelineCache::operator const VkPipelineCache() const noexcept {
+            return m_PipelineCache;
+        }
+
+        bool PipelineCache::IsCompatible(const void* data, std::size_t size) const noexcept {
+            // Data from another driver or GPU is ignored by most drivers, some crash on it
+            VkPipelineCacheHeaderVersionOne header{};
+            if (size < sizeof(VkPipelineCacheHeaderVersionOne)) {
+                return false;
+            }
+            std::memcpy(&header, data, sizeof(VkPipelineCacheHeaderVersionOne));
+            return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+                   header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                   header.vendorID == m_Properties.vendorID &&
+                   header.deviceID == m_Properties.deviceID &&
+                   !std::memcmp(header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE);
+        }
+
+        void PipelineCache::MoveConstruct(PipelineCache&& rhs) noexcept {
+            m_PipelineCache = rhs.m_PipelineCache;
+            m_Device        = rhs.m_Device;
+            m_Properties    = rhs.m_Properties;
+            m_FilePath      = Move(rhs.m_FilePath);
+            m_IsWarm        = rhs.m_IsWarm;
+
+            rhs.m_PipelineCache = VK_NULL_HANDLE;
+        }
+
+        void PipelineCache::Clear() noexcept {
+            if (m_PipelineCache != VK_NULL_HANDLE) {
+                Save();
+                vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+                m_PipelineCache = VK_NULL_HANDLE;
+            }
+        }
+    } // namespace vk
+} // namespace adh
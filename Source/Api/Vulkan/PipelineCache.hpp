@@ -0,0 +1,72 @@
+#pragma once
+#include <Utility.hpp>
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+namespace adh {
+    namespace vk {
+        class PipelineCache {
+          public:
+            PipelineCache() noexcept;
+
+            PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath);
+
+            PipelineCache(const PipelineCache& rhs) = delete;
+
+            PipelineCache& operator=(const PipelineCache& rhs) = delete;
+
+            PipelineCache(PipelineCache&& rhs) noexcept;
+
+            PipelineCache& operator=(PipelineCache&& rhs) noexcept;
+
+            ~PipelineCache();
+
+            // Seeds the cache from filePath if the file was written by the same driver and device
+            void Create(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath);
+
+            // Serializes the cache back to the file it was created from
+            void Save() const noexcept;
+
+            // Saves and destroys the cache
+            void Destroy() noexcept;
+
+            // True if the cache was seeded from disk
+            bool IsWarm() const noexcept;
+
+            VkPipelineCache Get() noexcept;
+
+            const VkPipelineCache Get() const noexcept;
+
+            operator VkPipelineCache() noexcept;
+
+            operator const VkPipelineCache() const noexcept;
+
+          private:
+            // Written in front of the driver data, guards against truncated or foreign files
+            struct FileHeader {
+                std::uint32_t magic;
+                std::uint32_t version;
+                std::uint64_t dataSize;
+                std::uint64_t dataHash;
+            };
+
+            static constexpr std::uint32_t magic{ 0x43504441u }; // "ADPC"
+            static constexpr std::uint32_t version{ 1u };
+
+          private:
+            bool IsCompatible(const void* data, std::size_t size) const noexcept;
+
+            void MoveConstruct(PipelineCache&& rhs) noexcept;
+
+            void Clear() noexcept;
+
+          private:
+            VkPipelineCache m_PipelineCache;
+            VkDevice m_Device;
+            VkPhysicalDeviceProperties m_Properties;
+            std::string m_FilePath;
+            bool m_IsWarm;
+        };
+    } // namespace vk
+} // namespace adh
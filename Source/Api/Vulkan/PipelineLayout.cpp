@@ -57,9 +57,15 @@ namespace adh {
             auto& temp{ m_DescriptorSetLayout.EmplaceBack() };
             ADH_THROW(vkCreateDescriptorSetLayout(Context::Get()->GetDevice(), &layoutCreateInfo, nullptr, &temp) == VK_SUCCESS,
                       "Failed to create descriptor set layout!");
+            m_OwnsSetLayout.EmplaceBack(true);
             m_LayoutBindings.Clear();
         }
 
+        void PipelineLayout::AddSetLayout(VkDescriptorSetLayout setLayout) {
+            m_DescriptorSetLayout.EmplaceBack(setLayout);
+            m_OwnsSetLayout.EmplaceBack(false);
+        }
+
         VkPipelineLayout PipelineLayout::GetPipelineLayout() noexcept {
             return m_PipelineLayout;
         }
@@ -95,6 +101,7 @@ namespace adh {
         void PipelineLayout::MoveConstruct(PipelineLayout&& rhs) noexcept {
             m_LayoutBindings      = Move(rhs.m_LayoutBindings);
             m_DescriptorSetLayout = Move(rhs.m_DescriptorSetLayout);
+            m_OwnsSetLayout       = Move(rhs.m_OwnsSetLayout);
             m_PipelineLayout      = rhs.m_PipelineLayout;
 
             rhs.m_PipelineLayout = VK_NULL_HANDLE;
@@ -103,7 +110,9 @@ namespace adh {
         void PipelineLayout::Clear() noexcept {
             auto device{ Context::Get()->GetDevice() };
             for (std::size_t i{}; i != m_DescriptorSetLayout.GetSize(); ++i) {
-                vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout[i], nullptr);
+                if (m_OwnsSetLayout[i]) {
+                    vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout[i], nullptr);
+                }
                 m_DescriptorSetLayout[i] = VK_NULL_HANDLE;
             }
             if (m_PipelineLayout != VK_NULL_HANDLE) {
@@ -111,6 +120,7 @@ namespace adh {
             }
             m_LayoutBindings.Clear();
             m_DescriptorSetLayout.Clear();
+            m_OwnsSetLayout.Clear();
             m_PushConstants.Clear();
             m_PipelineLayout = VK_NULL_HANDLE;
         }
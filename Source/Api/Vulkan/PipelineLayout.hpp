@@ -29,6 +29,9 @@ namespace adh {
 
             void CreateSet() ADH_NOEXCEPT;
 
+            // Appends a set layout owned elsewhere, e.g. the bindless texture table
+            void AddSetLayout(VkDescriptorSetLayout setLayout);
+
             VkPipelineLayout GetPipelineLayout() noexcept;
 
             const VkPipelineLayout GetPipelineLayout() const noexcept;
@@ -54,6 +57,7 @@ namespace adh {
             VkPipelineLayout m_PipelineLayout;
             Array<VkDescriptorSetLayoutBinding> m_LayoutBindings;
             Array<VkDescriptorSetLayout> m_DescriptorSetLayout;
+            Array<bool> m_OwnsSetLayout;
             Array<VkPushConstantRange> m_PushConstants;
         };
     } // namespace vk
@@ -0,0 +1,711 @@
+#include "RenderGraph.hpp"
+#include "Attachments.hpp"
+#include "Context.hpp"
+#include "GpuProfiler.hpp"
+#include "Initializers.hpp"
+#include "Subpass.hpp"
+#include "Tools.hpp"
+#include <Std/Stopwatch.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace adh {
+    namespace vk {
+        namespace {
+            struct Placement {
+                VkDeviceSize size;
+                RenderGraph::Handle image;
+            };
+
+            // Largest images are placed first, they leave the fewest holes
+            struct PlacementOrder {
+                bool operator()(const Placement& lhs, const Placement& rhs) const noexcept {
+                    return lhs.size > rhs.size;
+                }
+            };
+
+            // Transient images alias each other, their first use waits for every attachment or storage
+            // write and sampled read of the previous frame and of the images that shared the memory before
+            constexpr VkPipelineStageFlags aliasStages{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                                        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                                        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+
+            constexpr VkAccessFlags writeAccess{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                                 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                                 VK_ACCESS_SHADER_WRITE_BIT };
+
+            constexpr VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) noexcept {
+                return (value + alignment - 1u) / alignment * alignment;
+            }
+
+            bool HasStencil(VkFormat format) noexcept {
+                return format == VK_FORMAT_D16_UNORM_S8_UINT ||
+                       format == VK_FORMAT_D24_UNORM_S8_UINT ||
+                       format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+            }
+        } // namespace
+
+        RenderGraph::RenderGraph() noexcept : m_Extent{},
+                                              m_Statistics{},
+                                              m_IsCompiled{} {
+        }
+
+        RenderGraph::~RenderGraph() {
+            Clear();
+        }
+
+        RenderGraph::Handle RenderGraph::CreateImage(const std::string& name, const ImageDesc& desc) {
+            ADH_THROW(!m_IsCompiled, "Render graph images must be created before Compile()!");
+            auto resource{ m_Resources.EmplaceBack(MakeUnique<Resource>()).Get() };
+            resource->name      = name;
+            resource->desc      = desc;
+            resource->aspect    = IsDepthFormat(desc.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+            resource->firstPass = invalidHandle;
+            resource->state     = { VK_IMAGE_LAYOUT_UNDEFINED, 0u, 0u };
+            return static_cast<Handle>(m_Resources.GetSize() - 1u);
+        }
+
+        RenderGraph::Handle RenderGraph::ImportImage(const std::string& name) {
+            ADH_THROW(!m_IsCompiled, "Render graph images must be imported before Compile()!");
+            auto resource{ m_Resources.EmplaceBack(MakeUnique<Resource>()).Get() };
+            resource->name       = name;
+            resource->firstPass  = invalidHandle;
+            resource->isImported = true;
+            return static_cast<Handle>(m_Resources.GetSize() - 1u);
+        }
+
+        RenderGraph::Handle RenderGraph::AddPass(const std::string& name, ExecuteFunc execute, VkSubpassContents contents) {
+            ADH_THROW(!m_IsCompiled, "Render graph passes must be added before Compile()!");
+            auto pass{ m_Passes.EmplaceBack(MakeUnique<Pass>()).Get() };
+            pass->name      = name;
+            pass->execute   = Move(execute);
+            pass->contents  = contents;
+            pass->isEnabled = true;
+            pass->isActive  = true;
+            return static_cast<Handle>(m_Passes.GetSize() - 1u);
+        }
+
+        RenderGraph::Handle RenderGraph::AddComputePass(const std::string& name, ExecuteFunc execute) {
+            auto pass{ AddPass(name, Move(execute)) };
+            m_Passes[pass]->isCompute = true;
+            return pass;
+        }
+
+        void RenderGraph::Read(Handle pass, Handle image) ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize() && image < m_Resources.GetSize(), "Invalid render graph handle!");
+            auto& resource{ *m_Resources[image] };
+            m_Passes[pass]->accesses.EmplaceBack(Access{ image, GetReadState(resource, m_Passes[pass]->isCompute), {}, false });
+            resource.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        void RenderGraph::Write(Handle pass, Handle image, VkClearValue clearValue) ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize() && image < m_Resources.GetSize(), "Invalid render graph handle!");
+            auto& resource{ *m_Resources[image] };
+            auto isCompute{ m_Passes[pass]->isCompute };
+            m_Passes[pass]->accesses.EmplaceBack(Access{ image, GetWriteState(resource, isCompute), clearValue, true });
+            if (isCompute) {
+                // Compute passes usually sample the levels they wrote before
+                resource.usage |= VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            } else {
+                resource.usage |= IsDepthFormat(resource.desc.format) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+            }
+        }
+
+        void RenderGraph::SetOutput(Handle image) ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize(), "Invalid render graph handle!");
+            m_Resources[image]->isOutput = true;
+        }
+
+        void RenderGraph::SetEnabled(Handle pass, bool isEnabled) ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize(), "Invalid render graph handle!");
+            if (m_Passes[pass]->isEnabled != isEnabled) {
+                m_Passes[pass]->isEnabled = isEnabled;
+                Cull();
+            }
+        }
+
+        void RenderGraph::Compile(VkExtent2D extent) {
+            ADH_THROW(!m_IsCompiled, "Render graph is already compiled!");
+            Stopwatch<> stopwatch;
+            m_Extent = extent;
+
+            // Lifetimes cover every declared pass, culling changes per frame and must not move memory
+            for (std::uint32_t i{}; i != m_Passes.GetSize(); ++i) {
+                for (const auto& access : m_Passes[i]->accesses) {
+                    auto& resource{ *m_Resources[access.image] };
+                    resource.firstPass = std::min(resource.firstPass, i);
+                    resource.lastPass  = std::max(resource.lastPass, i);
+                }
+            }
+            for (auto& resource : m_Resources) {
+                if (resource->firstPass == invalidHandle) {
+                    resource->firstPass = 0u;
+                    resource->lastPass  = static_cast<std::uint32_t>(m_Passes.GetSize());
+                }
+            }
+
+            for (std::uint32_t i{}; i != m_Passes.GetSize(); ++i) {
+                CreateRenderPass(i);
+            }
+            CreateImages();
+            m_IsCompiled = true;
+
+            Cull();
+            UpdateStatistics();
+            m_Statistics.compileTime = stopwatch.GetTime() * 1000.0f;
+
+            ADH_LOG("Render graph: " << m_Statistics.passCount << " passes (" << m_Statistics.culledCount << " culled), "
+                                     << m_Statistics.imageCount << " images compiled in " << m_Statistics.compileTime << " ms, transient memory "
+                                     << m_Statistics.transientMemory / (1024.0f * 1024.0f) << " MB ("
+                                     << m_Statistics.unaliasedMemory / (1024.0f * 1024.0f) << " MB without aliasing)");
+        }
+
+        void RenderGraph::Resize(VkExtent2D extent) {
+            ADH_THROW(m_IsCompiled, "Render graph must be compiled before Resize()!");
+            vkDeviceWaitIdle(Context::Get()->GetDevice());
+            m_Extent = extent;
+
+            DestroyImages(false);
+            CreateImages();
+            UpdateStatistics();
+
+            ADH_LOG("Render graph: resized to " << m_Extent.width << "x" << m_Extent.height << ", transient memory "
+                                                << m_Statistics.transientMemory / (1024.0f * 1024.0f) << " MB ("
+                                                << m_Statistics.unaliasedMemory / (1024.0f * 1024.0f) << " MB without aliasing)");
+        }
+
+        void RenderGraph::Execute(VkCommandBuffer commandBuffer, std::uint32_t imageIndex, GpuProfiler* profiler) {
+            for (auto& resource : m_Resources) {
+                if (resource->desc.isTransient && !resource->isImported) {
+                    resource->state = { VK_IMAGE_LAYOUT_UNDEFINED, aliasStages, writeAccess };
+                }
+            }
+
+            for (auto& pass : m_Passes) {
+                if (!pass->isActive) {
+                    continue;
+                }
+
+                if (profiler) {
+                    profiler->BeginScope(commandBuffer, pass->name.c_str());
+                }
+
+                m_Barriers.Clear();
+                VkPipelineStageFlags srcStages{};
+                VkPipelineStageFlags dstStages{};
+                for (const auto& access : pass->accesses) {
+                    auto& resource{ *m_Resources[access.image] };
+                    if (resource.isImported) {
+                        continue;
+                    }
+
+                    auto target{ access.state };
+                    auto isReadAfterRead{ !access.isWrite && resource.state.layout == target.layout && !(resource.state.access & writeAccess) };
+                    if (isReadAfterRead && (resource.state.stage & target.stage) == target.stage) {
+                        // Reads in the same layout don't wait on each other, a later write waits on all of them
+                        resource.state.access |= target.access;
+                        continue;
+                    }
+                    if (isReadAfterRead) {
+                        // A new stage reads, e.g. fragment after compute. Chaining after the earlier
+                        // readers makes the last write visible without a layout change.
+                        target.stage |= resource.state.stage;
+                        target.access |= resource.state.access;
+                    }
+
+                    auto aspect{ resource.aspect };
+                    if (HasStencil(resource.desc.format)) {
+                        aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+                    }
+                    m_Barriers.EmplaceBack(initializers::ImageMemoryBarrier(
+                        resource.state.access & writeAccess,
+                        target.access,
+                        resource.state.layout,
+                        target.layout,
+                        VK_QUEUE_FAMILY_IGNORED,
+                        VK_QUEUE_FAMILY_IGNORED,
+                        resource.image,
+                        static_cast<VkImageAspectFlagBits>(aspect),
+                        0u,
+                        resource.mipLevels,
+                        resource.layers));
+
+                    srcStages |= resource.state.stage ? resource.state.stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    dstStages |= access.state.stage;
+                    resource.state = target;
+                }
+
+                if (!m_Barriers.IsEmpty()) {
+                    vkCmdPipelineBarrier(
+                        commandBuffer,
+                        srcStages,
+                        dstStages,
+                        0u,
+                        0u, nullptr,
+                        0u, nullptr,
+                        static_cast<std::uint32_t>(m_Barriers.GetSize()), m_Barriers.GetData());
+                }
+
+                // Layered passes begin the render pass per layer in BeginLayer()
+                auto beginsRenderPass{ pass->hasAttachments && pass->layers == 1u };
+                if (beginsRenderPass) {
+                    pass->renderPass.Begin(commandBuffer, pass->framebuffers[0]->Get(), pass->contents);
+                }
+                pass->execute(commandBuffer, imageIndex);
+                if (beginsRenderPass) {
+                    pass->renderPass.End(commandBuffer);
+                }
+
+                if (profiler) {
+                    profiler->EndScope(commandBuffer);
+                }
+            }
+        }
+
+        void RenderGraph::BeginLayer(VkCommandBuffer commandBuffer, Handle pass, std::uint32_t layer) ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize() && m_Passes[pass]->hasAttachments && layer < m_Passes[pass]->layers, "Invalid render graph layer!");
+            auto& graphPass{ *m_Passes[pass] };
+            graphPass.renderPass.Begin(commandBuffer, graphPass.framebuffers[layer]->Get(), graphPass.contents);
+        }
+
+        void RenderGraph::EndLayer(VkCommandBuffer commandBuffer, Handle pass) ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize() && m_Passes[pass]->hasAttachments, "Render graph pass has no render pass!");
+            m_Passes[pass]->renderPass.End(commandBuffer);
+        }
+
+        void RenderGraph::Destroy() noexcept {
+            Clear();
+        }
+
+        bool RenderGraph::IsActive(Handle pass) const ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize(), "Invalid render graph handle!");
+            return m_Passes[pass]->isActive;
+        }
+
+        const RenderPass& RenderGraph::GetRenderPass(Handle pass) const ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize() && m_Passes[pass]->hasAttachments, "Render graph pass has no render pass!");
+            return m_Passes[pass]->renderPass;
+        }
+
+        VkFramebuffer RenderGraph::GetFramebuffer(Handle pass, std::uint32_t layer) const ADH_NOEXCEPT {
+            ADH_THROW(pass < m_Passes.GetSize() && m_Passes[pass]->hasAttachments, "Render graph pass has no framebuffer!");
+            ADH_THROW(layer < m_Passes[pass]->layers, "Invalid render graph layer!");
+            return m_Passes[pass]->framebuffers[layer]->Get();
+        }
+
+        VkExtent2D RenderGraph::GetExtent(Handle image) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && !m_Resources[image]->isImported, "Invalid render graph image!");
+            return m_Resources[image]->extent;
+        }
+
+        VkImage RenderGraph::GetImage(Handle image) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && !m_Resources[image]->isImported, "Invalid render graph image!");
+            return m_Resources[image]->image;
+        }
+
+        VkImageView RenderGraph::GetImageView(Handle image) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && !m_Resources[image]->isImported, "Invalid render graph image!");
+            return m_Resources[image]->view;
+        }
+
+        VkDescriptorImageInfo RenderGraph::GetDescriptor(Handle image, VkSampler sampler) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && !m_Resources[image]->isImported, "Invalid render graph image!");
+            const auto& resource{ *m_Resources[image] };
+            return { sampler, resource.view, GetReadState(resource, false).layout };
+        }
+
+        VkImageView RenderGraph::GetMipView(Handle image, std::uint32_t mip) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && mip < m_Resources[image]->mipLevels, "Invalid render graph mip level!");
+            const auto& resource{ *m_Resources[image] };
+            return resource.mipLevels > 1u ? resource.mipViews[mip] : resource.view;
+        }
+
+        std::uint32_t RenderGraph::GetMipLevels(Handle image) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && !m_Resources[image]->isImported, "Invalid render graph image!");
+            return m_Resources[image]->mipLevels;
+        }
+
+        std::uint32_t RenderGraph::GetLayers(Handle image) const ADH_NOEXCEPT {
+            ADH_THROW(image < m_Resources.GetSize() && !m_Resources[image]->isImported, "Invalid render graph image!");
+            return m_Resources[image]->layers;
+        }
+
+        const RenderGraph::Statistics& RenderGraph::GetStatistics() const noexcept {
+            return m_Statistics;
+        }
+
+        void RenderGraph::CreateRenderPass(Handle passIndex) {
+            auto& pass{ *m_Passes[passIndex] };
+            pass.layers = 1u;
+            if (pass.isCompute) {
+                pass.hasAttachments = false;
+                return;
+            }
+
+            Attachment attachment;
+            Array<VkClearValue> clearValues;
+            for (const auto& access : pass.accesses) {
+                const auto& resource{ *m_Resources[access.image] };
+                if (!access.isWrite || resource.isImported) {
+                    continue;
+                }
+
+                auto isDepth{ IsDepthFormat(resource.desc.format) };
+                ADH_THROW(!isDepth || attachment.GetDepthReferences().IsEmpty(), "Render graph pass writes more than one depth image!");
+
+                auto layers{ std::max(resource.desc.layers, 1u) };
+                ADH_THROW(clearValues.IsEmpty() || pass.layers == layers, "Render graph attachments of a pass must have the same layer count!");
+                pass.layers = layers;
+
+                // Nothing reads a transient image after its last pass
+                auto storeOp{ resource.desc.isTransient && resource.lastPass == passIndex ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE };
+                attachment.AddDescription(
+                    resource.desc.format,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    storeOp,
+                    VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                    VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                    access.state.layout,
+                    access.state.layout,
+                    isDepth ? Attachment::Type::eDepth : Attachment::Type::eColor);
+
+                // Execute() transitions the image before the pass begins, the render pass keeps the layout
+                attachment.GetDescriptions()[attachment.GetDescriptions().GetSize() - 1u].initialLayout = access.state.layout;
+                clearValues.EmplaceBack(access.clearValue);
+            }
+
+            pass.hasAttachments = !clearValues.IsEmpty();
+            if (!pass.hasAttachments) {
+                return;
+            }
+
+            Subpass subpass;
+            subpass.AddDescription(VK_PIPELINE_BIND_POINT_GRAPHICS, attachment);
+            pass.renderPass.Create(attachment, subpass, {}, Move(clearValues));
+        }
+
+        void RenderGraph::CreateImages() {
+            auto device{ Context::Get()->GetDevice() };
+            auto physicalDevice{ Context::Get()->GetPhysicalDevice() };
+
+            for (auto& resource : m_Resources) {
+                if (resource->isImported || resource->image != VK_NULL_HANDLE) {
+                    continue;
+                }
+
+                resource->extent = resource->desc.extent;
+                if (FollowsExtent(*resource)) {
+                    resource->extent.width  = std::max(static_cast<std::uint32_t>(m_Extent.width * resource->desc.scale), 1u);
+                    resource->extent.height = std::max(static_cast<std::uint32_t>(m_Extent.height * resource->desc.scale), 1u);
+                }
+
+                auto fullChain{ static_cast<std::uint32_t>(std::floor(std::log2(std::max(resource->extent.width, resource->extent.height)))) + 1u };
+                resource->mipLevels = std::clamp(resource->desc.mipLevels, 1u, fullChain);
+                resource->layers    = std::max(resource->desc.layers, 1u);
+
+                auto info{ initializers::ImageCreateInfo(
+                    { resource->extent.width, resource->extent.height, 1u },
+                    resource->desc.format,
+                    VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_TYPE_2D,
+                    VkImageCreateFlagBits(0),
+                    resource->mipLevels,
+                    resource->layers,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    static_cast<VkImageUsageFlagBits>(resource->usage),
+                    VK_SHARING_MODE_EXCLUSIVE) };
+
+                ADH_THROW(vkCreateImage(device, &info, nullptr, &resource->image) == VK_SUCCESS,
+                          "Failed to create render graph image!");
+                resource->requirements = tools::GetImageMemoryRequirements(device, resource->image);
+                resource->state        = { VK_IMAGE_LAYOUT_UNDEFINED, 0u, 0u };
+
+                if (!resource->desc.isTransient) {
+                    auto allocateInfo{ initializers::MemoryAllocateInfo(
+                        resource->requirements.size,
+                        tools::GetMemoryTypeIndex(physicalDevice, resource->requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) };
+                    ADH_THROW(vkAllocateMemory(device, &allocateInfo, nullptr, &resource->memory) == VK_SUCCESS,
+                              "Failed to allocate render graph image memory!");
+                    ADH_THROW(vkBindImageMemory(device, resource->image, resource->memory, 0u) == VK_SUCCESS,
+                              "Failed to bind render graph image memory!");
+                }
+            }
+
+            PlaceTransientImages();
+
+            for (auto& resource : m_Resources) {
+                if (resource->isImported || resource->view != VK_NULL_HANDLE) {
+                    continue;
+                }
+
+                auto info{ initializers::ImageViewCreateInfo(
+                    resource->image,
+                    resource->layers > 1u ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+                    resource->desc.format,
+                    static_cast<VkImageAspectFlagBits>(resource->aspect),
+                    resource->mipLevels,
+                    resource->layers) };
+                ADH_THROW(vkCreateImageView(device, &info, nullptr, &resource->view) == VK_SUCCESS,
+                          "Failed to create render graph image view!");
+
+                if (resource->layers > 1u) {
+                    auto layerInfo{ info };
+                    layerInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+                    layerInfo.subresourceRange.levelCount = 1u;
+                    layerInfo.subresourceRange.layerCount = 1u;
+                    resource->layerViews.Resize(resource->layers);
+                    for (std::uint32_t layer{}; layer != resource->layers; ++layer) {
+                        layerInfo.subresourceRange.baseArrayLayer = layer;
+                        ADH_THROW(vkCreateImageView(device, &layerInfo, nullptr, &resource->layerViews[layer]) == VK_SUCCESS,
+                                  "Failed to create render graph layer view!");
+                    }
+                }
+
+                if (resource->mipLevels > 1u) {
+                    resource->mipViews.Resize(resource->mipLevels);
+                    info.subresourceRange.levelCount = 1u;
+                    for (std::uint32_t mip{}; mip != resource->mipLevels; ++mip) {
+                        info.subresourceRange.baseMipLevel = mip;
+                        ADH_THROW(vkCreateImageView(device, &info, nullptr, &resource->mipViews[mip]) == VK_SUCCESS,
+                                  "Failed to create render graph mip view!");
+                    }
+                }
+            }
+
+            CreateFramebuffers();
+        }
+
+        void RenderGraph::CreateFramebuffers() {
+            Array<VkImageView> views;
+            for (auto& pass : m_Passes) {
+                if (!pass->hasAttachments) {
+                    continue;
+                }
+
+                pass->framebuffers.Clear();
+                for (std::uint32_t layer{}; layer != pass->layers; ++layer) {
+                    views.Clear();
+                    for (const auto& access : pass->accesses) {
+                        const auto& resource{ *m_Resources[access.image] };
+                        if (!access.isWrite || resource.isImported) {
+                            continue;
+                        }
+                        ADH_THROW(views.IsEmpty() || (pass->extent.width == resource.extent.width && pass->extent.height == resource.extent.height),
+                                  "Render graph attachments of a pass must have the same extent!");
+                        pass->extent = resource.extent;
+                        views.EmplaceBack(pass->layers > 1u ? resource.layerViews[layer] : resource.view);
+                    }
+
+                    auto& framebuffer{ pass->framebuffers.EmplaceBack(MakeUnique<Framebuffer>()) };
+                    framebuffer->Create(pass->renderPass, static_cast<std::uint32_t>(views.GetSize()), views.GetData(), pass->extent, 1u);
+                }
+                pass->renderPass.UpdateRenderArea({ {}, pass->extent });
+            }
+        }
+
+        void RenderGraph::DestroyImages(bool destroyAll) noexcept {
+            auto device{ Context::Get()->GetDevice() };
+            for (auto& resource : m_Resources) {
+                if (resource->isImported || (!destroyAll && !resource->desc.isTransient && !FollowsExtent(*resource))) {
+                    continue;
+                }
+
+                if (resource->view != VK_NULL_HANDLE) {
+                    vkDestroyImageView(device, resource->view, nullptr);
+                    resource->view = VK_NULL_HANDLE;
+                }
+                for (auto view : resource->mipViews) {
+                    vkDestroyImageView(device, view, nullptr);
+                }
+                resource->mipViews.Clear();
+                for (auto view : resource->layerViews) {
+                    vkDestroyImageView(device, view, nullptr);
+                }
+                resource->layerViews.Clear();
+                if (resource->image != VK_NULL_HANDLE) {
+                    vkDestroyImage(device, resource->image, nullptr);
+                    resource->image = VK_NULL_HANDLE;
+                }
+                if (resource->memory != VK_NULL_HANDLE) {
+                    vkFreeMemory(device, resource->memory, nullptr);
+                    resource->memory = VK_NULL_HANDLE;
+                }
+            }
+
+            // Only transient images live in the heaps and they are always recreated
+            for (auto& heap : m_Heaps) {
+                vkFreeMemory(device, heap.memory, nullptr);
+            }
+            m_Heaps.Clear();
+        }
+
+        void RenderGraph::PlaceTransientImages() {
+            auto device{ Context::Get()->GetDevice() };
+            auto physicalDevice{ Context::Get()->GetPhysicalDevice() };
+
+            Array<Placement> placements;
+            for (std::uint32_t i{}; i != m_Resources.GetSize(); ++i) {
+                const auto& resource{ *m_Resources[i] };
+                if (resource.desc.isTransient && !resource.isImported) {
+                    placements.EmplaceBack(Placement{ resource.requirements.size, i });
+                }
+            }
+            if (placements.IsEmpty()) {
+                return;
+            }
+            placements.Sort<PlacementOrder>();
+
+            Array<Handle> placed;
+            for (const auto& placement : placements) {
+                auto& resource{ *m_Resources[placement.image] };
+                auto memoryType{ tools::GetMemoryTypeIndex(physicalDevice, resource.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) };
+
+                resource.heap = static_cast<std::uint32_t>(m_Heaps.GetSize());
+                for (std::uint32_t i{}; i != m_Heaps.GetSize(); ++i) {
+                    if (m_Heaps[i].memoryType == memoryType) {
+                        resource.heap = i;
+                        break;
+                    }
+                }
+                if (resource.heap == m_Heaps.GetSize()) {
+                    m_Heaps.EmplaceBack(Heap{ VK_NULL_HANDLE, 0u, memoryType });
+                }
+
+                // Moves past every placed image that is alive at the same time and overlaps the range
+                VkDeviceSize offset{};
+                for (bool isMoved{ true }; isMoved;) {
+                    isMoved = false;
+                    for (auto handle : placed) {
+                        const auto& other{ *m_Resources[handle] };
+                        auto isAlive{ other.heap == resource.heap && other.firstPass <= resource.lastPass && resource.firstPass <= other.lastPass };
+                        auto isOverlapping{ offset < other.offset + other.requirements.size && other.offset < offset + resource.requirements.size };
+                        if (isAlive && isOverlapping) {
+                            offset  = AlignUp(other.offset + other.requirements.size, resource.requirements.alignment);
+                            isMoved = true;
+                        }
+                    }
+                }
+
+                resource.offset             = offset;
+                m_Heaps[resource.heap].size = std::max(m_Heaps[resource.heap].size, offset + resource.requirements.size);
+                placed.EmplaceBack(placement.image);
+            }
+
+            for (auto& heap : m_Heaps) {
+                auto allocateInfo{ initializers::MemoryAllocateInfo(heap.size, heap.memoryType) };
+                ADH_THROW(vkAllocateMemory(device, &allocateInfo, nullptr, &heap.memory) == VK_SUCCESS,
+                          "Failed to allocate render graph heap!");
+            }
+
+            for (auto handle : placed) {
+                const auto& resource{ *m_Resources[handle] };
+                ADH_THROW(vkBindImageMemory(device, resource.image, m_Heaps[resource.heap].memory, resource.offset) == VK_SUCCESS,
+                          "Failed to bind render graph image memory!");
+            }
+        }
+
+        void RenderGraph::Cull() noexcept {
+            // Walks back from the output, every write clears so it ends the interest in older contents
+            Array<bool> isNeeded;
+            isNeeded.Resize(m_Resources.GetSize());
+            for (std::uint32_t i{}; i != m_Resources.GetSize(); ++i) {
+                isNeeded[i] = m_Resources[i]->isOutput;
+            }
+
+            m_Statistics.culledCount = 0u;
+            for (auto i{ m_Passes.GetSize() }; i-- != 0u;) {
+                auto& pass{ *m_Passes[i] };
+                pass.isActive = false;
+                if (pass.isEnabled) {
+                    for (const auto& access : pass.accesses) {
+                        if (access.isWrite && isNeeded[access.image]) {
+                            pass.isActive = true;
+                        }
+                    }
+                }
+
+                if (!pass.isActive) {
+                    ++m_Statistics.culledCount;
+                    continue;
+                }
+                for (const auto& access : pass.accesses) {
+                    if (access.isWrite) {
+                        isNeeded[access.image] = false;
+                    }
+                }
+                for (const auto& access : pass.accesses) {
+                    if (!access.isWrite) {
+                        isNeeded[access.image] = true;
+                    }
+                }
+            }
+        }
+
+        RenderGraph::State RenderGraph::GetReadState(const Resource& image, bool isCompute) const noexcept {
+            auto stage{ isCompute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
+            if (IsDepthFormat(image.desc.format)) {
+                return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, stage, VK_ACCESS_SHADER_READ_BIT };
+            }
+            return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, stage, VK_ACCESS_SHADER_READ_BIT };
+        }
+
+        RenderGraph::State RenderGraph::GetWriteState(const Resource& image, bool isCompute) const noexcept {
+            if (isCompute) {
+                return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT };
+            }
+            if (IsDepthFormat(image.desc.format)) {
+                return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+            }
+            return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT };
+        }
+
+        bool RenderGraph::IsDepthFormat(VkFormat format) const noexcept {
+            return format == VK_FORMAT_D16_UNORM ||
+                   format == VK_FORMAT_X8_D24_UNORM_PACK32 ||
+                   format == VK_FORMAT_D32_SFLOAT ||
+                   HasStencil(format);
+        }
+
+        bool RenderGraph::FollowsExtent(const Resource& image) const noexcept {
+            return !image.desc.extent.width || !image.desc.extent.height;
+        }
+
+        void RenderGraph::UpdateStatistics() noexcept {
+            m_Statistics.passCount       = static_cast<std::uint32_t>(m_Passes.GetSize());
+            m_Statistics.imageCount      = 0u;
+            m_Statistics.transientMemory = 0u;
+            m_Statistics.unaliasedMemory = 0u;
+            for (const auto& resource : m_Resources) {
+                if (resource->isImported) {
+                    continue;
+                }
+                ++m_Statistics.imageCount;
+                if (resource->desc.isTransient) {
+                    m_Statistics.unaliasedMemory += resource->requirements.size;
+                }
+            }
+            for (const auto& heap : m_Heaps) {
+                m_Statistics.transientMemory += heap.size;
+            }
+        }
+
+        void RenderGraph::Clear() noexcept {
+            if (m_IsCompiled) {
+                DestroyImages(true);
+            }
+            m_Passes.Clear();
+            m_Resources.Clear();
+            m_Barriers.Clear();
+            m_Statistics = {};
+            m_IsCompiled = false;
+        }
+    } // namespace vk
+} // namespace adh
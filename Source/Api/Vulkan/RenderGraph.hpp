@@ -0,0 +1,218 @@
+#pragma once
+#include "Framebuffer.hpp"
+#include "RenderPass.hpp"
+#include <Std/Array.hpp>
+#include <Std/UniquePtr.hpp>
+#include <Utility.hpp>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace adh {
+    namespace vk {
+        class GpuProfiler;
+
+        // Frame described as passes that read and write images. Compile() creates a render pass and
+        // framebuffer per pass and the graph images, transient images share memory when their
+        // lifetimes don't overlap. Execute() records the layout transitions and barriers between
+        // passes and skips passes whose writes never reach the output.
+        class RenderGraph {
+          public:
+            using Handle      = std::uint32_t;
+            using ExecuteFunc = std::function<void(VkCommandBuffer, std::uint32_t)>;
+
+            static constexpr Handle invalidHandle{ ~0u };
+
+            struct ImageDesc {
+                VkFormat format;
+                VkExtent2D extent;       // Zero follows the graph extent
+                float scale;             // Applied to the graph extent
+                bool isTransient;        // Contents don't survive the frame, memory may be aliased
+                std::uint32_t mipLevels; // Zero is a single level, clamped to the full chain of the extent
+                std::uint32_t layers;    // Zero is a single layer, layered images are sampled as 2D arrays
+            };
+
+            struct Statistics {
+                std::uint32_t passCount;
+                std::uint32_t culledCount;
+                std::uint32_t imageCount;
+                VkDeviceSize transientMemory;
+                VkDeviceSize unaliasedMemory;
+                float compileTime; // ms
+            };
+
+          public:
+            RenderGraph() noexcept;
+
+            RenderGraph(const RenderGraph& rhs) = delete;
+
+            RenderGraph& operator=(const RenderGraph& rhs) = delete;
+
+            RenderGraph(RenderGraph&& rhs) = delete;
+
+            RenderGraph& operator=(RenderGraph&& rhs) = delete;
+
+            ~RenderGraph();
+
+            Handle CreateImage(const std::string& name, const ImageDesc& desc);
+
+            // Images owned elsewhere (swapchain, editor viewports). They only order and cull passes,
+            // their passes handle layouts and synchronization themselves.
+            Handle ImportImage(const std::string& name);
+
+            Handle AddPass(const std::string& name, ExecuteFunc execute, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
+            // Runs outside of a render pass, barriers between its own dispatches are up to the pass
+            Handle AddComputePass(const std::string& name, ExecuteFunc execute);
+
+            // Sampled in the fragment shader, or in the compute shader by compute passes
+            void Read(Handle pass, Handle image) ADH_NOEXCEPT;
+
+            // Color or depth attachment depending on the image format, cleared on load. Compute passes
+            // write every mip level as a storage image in the general layout. Passes that write layered
+            // images get a framebuffer per layer and begin the render pass themselves, see BeginLayer().
+            void Write(Handle pass, Handle image, VkClearValue clearValue = {}) ADH_NOEXCEPT;
+
+            void SetOutput(Handle image) ADH_NOEXCEPT;
+
+            // Disabled passes are culled together with every pass that only feeds them
+            void SetEnabled(Handle pass, bool isEnabled) ADH_NOEXCEPT;
+
+            void Compile(VkExtent2D extent);
+
+            // Recreates the images that follow the graph extent and every transient image
+            void Resize(VkExtent2D extent);
+
+            // Every active pass is a top level profiler scope named after the pass
+            void Execute(VkCommandBuffer commandBuffer, std::uint32_t imageIndex, GpuProfiler* profiler = nullptr);
+
+            // Begins the render pass of a layered pass on a single layer. Layers a frame skips keep
+            // their contents, the image stays in the same layout and is stored after every pass.
+            void BeginLayer(VkCommandBuffer commandBuffer, Handle pass, std::uint32_t layer) ADH_NOEXCEPT;
+
+            void EndLayer(VkCommandBuffer commandBuffer, Handle pass) ADH_NOEXCEPT;
+
+            void Destroy() noexcept;
+
+            bool IsActive(Handle pass) const ADH_NOEXCEPT;
+
+            const RenderPass& GetRenderPass(Handle pass) const ADH_NOEXCEPT;
+
+            VkFramebuffer GetFramebuffer(Handle pass, std::uint32_t layer = 0u) const ADH_NOEXCEPT;
+
+            VkExtent2D GetExtent(Handle image) const ADH_NOEXCEPT;
+
+            VkImage GetImage(Handle image) const ADH_NOEXCEPT;
+
+            VkImageView GetImageView(Handle image) const ADH_NOEXCEPT;
+
+            // View of a single mip level, for compute passes that bind the levels separately
+            VkImageView GetMipView(Handle image, std::uint32_t mip) const ADH_NOEXCEPT;
+
+            std::uint32_t GetMipLevels(Handle image) const ADH_NOEXCEPT;
+
+            std::uint32_t GetLayers(Handle image) const ADH_NOEXCEPT;
+
+            // Layout the image is in while a pass reads it
+            VkDescriptorImageInfo GetDescriptor(Handle image, VkSampler sampler) const ADH_NOEXCEPT;
+
+            const Statistics& GetStatistics() const noexcept;
+
+          private:
+            struct State {
+                VkImageLayout layout;
+                VkPipelineStageFlags stage;
+                VkAccessFlags access;
+            };
+
+            struct Access {
+                Handle image;
+                State state;
+                VkClearValue clearValue;
+                bool isWrite;
+            };
+
+            struct Pass {
+                std::string name;
+                ExecuteFunc execute;
+                VkSubpassContents contents;
+                Array<Access> accesses;
+                RenderPass renderPass;
+                Array<UniquePtr<Framebuffer>> framebuffers; // One per layer of the attachments
+                VkExtent2D extent;
+                std::uint32_t layers;
+                bool hasAttachments;
+                bool isCompute;
+                bool isEnabled;
+                bool isActive;
+            };
+
+            struct Resource {
+                std::string name;
+                ImageDesc desc;
+                VkImageUsageFlags usage;
+                VkImageAspectFlags aspect;
+                VkExtent2D extent;
+                std::uint32_t mipLevels;
+                std::uint32_t layers;
+                VkImage image;
+                VkImageView view;
+                Array<VkImageView> mipViews;   // Only for images with more than one level
+                Array<VkImageView> layerViews; // Only for images with more than one layer, attachments of layered passes
+                VkDeviceMemory memory; // Persistent images only, transient ones live in a heap
+                VkMemoryRequirements requirements;
+                std::uint32_t heap;
+                VkDeviceSize offset;
+                std::uint32_t firstPass;
+                std::uint32_t lastPass;
+                State state;
+                bool isImported;
+                bool isOutput;
+            };
+
+            struct Heap {
+                VkDeviceMemory memory;
+                VkDeviceSize size;
+                std::uint32_t memoryType;
+            };
+
+          private:
+            void CreateRenderPass(Handle pass);
+
+            void CreateImages();
+
+            void CreateFramebuffers();
+
+            void DestroyImages(bool destroyAll) noexcept;
+
+            // Packs the transient images into as few bytes as possible, images whose pass ranges
+            // don't overlap may share memory
+            void PlaceTransientImages();
+
+            void Cull() noexcept;
+
+            State GetReadState(const Resource& image, bool isCompute) const noexcept;
+
+            State GetWriteState(const Resource& image, bool isCompute) const noexcept;
+
+            bool IsDepthFormat(VkFormat format) const noexcept;
+
+            bool FollowsExtent(const Resource& image) const noexcept;
+
+            void UpdateStatistics() noexcept;
+
+            void Clear() noexcept;
+
+          private:
+            Array<UniquePtr<Pass>> m_Passes;
+            Array<UniquePtr<Resource>> m_Resources;
+            Array<Heap> m_Heaps;
+            Array<VkImageMemoryBarrier> m_Barriers;
+            VkExtent2D m_Extent;
+            Statistics m_Statistics;
+            bool m_IsCompiled;
+        };
+    } // namespace vk
+} // namespace adh
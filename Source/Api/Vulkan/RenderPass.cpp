@@ -45,13 +45,13 @@ namespace adh {
             Clear();
         }
 
-        void RenderPass::Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer) noexcept {
+        void RenderPass::Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkSubpassContents contents) noexcept {
             auto info{ initializers::RenderPassBeginInfo(m_RenderPass, framebuffer, m_RenderArea, m_ClearValues.GetSize(), m_ClearValues.GetData()) };
 
             vkCmdBeginRenderPass(
                 commandBuffer,
                 &info,
-                VK_SUBPASS_CONTENTS_INLINE);
+                contents);
         }
 
         void RenderPass::End(VkCommandBuffer commandBuffer) noexcept {
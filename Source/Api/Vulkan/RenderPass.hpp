@@ -27,7 +27,7 @@ namespace adh {
 
             void Destroy() noexcept;
 
-            void Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer) noexcept;
+            void Begin(VkCommandBuffer commandBuffer, VkFramebuffer framebuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) noexcept;
 
             void End(VkCommandBuffer commandBuffer) noexcept;
 
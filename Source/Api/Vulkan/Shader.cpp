@@ -1,7 +1,7 @@
 #include "Shader.hpp"
 #include "Context.hpp"
 #include "vulkan/vulkan_core.h"
-#include <Std/File.hpp>
+#include <Std/VirtualFileSystem.hpp>
 
 namespace adh {
     namespace vk {
@@ -34,6 +34,27 @@ namespace adh {
             return m_ShaderStageCreateInfo.GetSize();
         }
 
+        const std::vector<std::string>& Shader::GetFiles() const noexcept {
+            return m_Files;
+        }
+
+        void Shader::Reload() {
+            auto files{ Move(m_Files) };
+            Clear();
+            m_ShaderModules.Clear();
+            m_ShaderStageCreateInfo.Clear();
+            m_Files.clear();
+            try {
+                for (const auto& file : files) {
+                    Create(file);
+                }
+            } catch (...) {
+                // Left without stages, the next reload tries every file again
+                m_Files = Move(files);
+                throw;
+            }
+        }
+
         void Shader::Destroy() noexcept {
             Clear();
         }
@@ -42,14 +63,10 @@ namespace adh {
             ADH_THROW(!shader.empty(), "Null shader file path!");
             auto context{ Context::Get() };
             std::string path{ Context::Get()->GetDataDirectory() + "Resources/Shaders/" + shader + ".spv" };
-            File file(path.data(), File::Mode::ReadBinary);
-            auto size{ file.GetSize() };
-            char* buffer{ static_cast<char*>(ADH_STACK_ALLOC(size)) };
-            std::memset(buffer, 0, size);
-            if (buffer) {
-                file.Read(buffer, size);
-            }
-            auto info{ initializers::ShaderModuleCreateInfo(size, buffer) };
+            // SPIR-V is read in place, mapped pages and pak blobs are aligned for its words
+            MappedFile file;
+            ADH_THROW(VirtualFileSystem::Open(path, file), "Failed to open file!");
+            auto info{ initializers::ShaderModuleCreateInfo(file.GetSize(), static_cast<const char*>(file.GetData())) };
             VkShaderModule returnValue;
             ADH_THROW(vkCreateShaderModule(context->GetDevice(), &info, nullptr, &returnValue) == VK_SUCCESS,
                       "Failed to create shader module!");
@@ -59,6 +76,7 @@ namespace adh {
         void Shader::MoveConstruct(Shader&& rhs) noexcept {
             m_ShaderModules         = Move(rhs.m_ShaderModules);
             m_ShaderStageCreateInfo = Move(rhs.m_ShaderStageCreateInfo);
+            m_Files                 = Move(rhs.m_Files);
             m_SpecializationEntry   = rhs.m_SpecializationEntry;
             m_SpecializationInfo    = rhs.m_SpecializationInfo;
             m_EnablePCF             = rhs.m_EnablePCF;
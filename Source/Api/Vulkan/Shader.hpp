@@ -4,6 +4,7 @@
 #include <Utility.hpp>
 
 #include <string>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 // TODO: Add --target-env vulkan1.2 to shaders for ray tracing
@@ -35,6 +36,12 @@ namespace adh {
 
             std::size_t GetSize() const noexcept;
 
+            // The stage file names it was created with, like "pbr.frag"
+            const std::vector<std::string>& GetFiles() const noexcept;
+
+            // Reads every stage again from its .spv file, pipelines created with it must be recreated
+            void Reload();
+
             void Destroy() noexcept;
 
           private:
@@ -47,6 +54,7 @@ namespace adh {
           private:
             Array<VkShaderModule> m_ShaderModules;
             Array<VkPipelineShaderStageCreateInfo> m_ShaderStageCreateInfo;
+            std::vector<std::string> m_Files;
             VkSpecializationMapEntry m_SpecializationEntry{};
             VkSpecializationInfo m_SpecializationInfo{};
             std::uint32_t m_EnablePCF{ 1u };
@@ -29,6 +29,7 @@ namespace adh {
                 stageFlag = VK_SHADER_STAGE_MISS_BIT_KHR;
             }
             ADH_THROW(stageFlag, "Invalid shader type!");
+            m_Files.emplace_back(shader);
             m_ShaderStageCreateInfo.EmplaceBack(
                 initializers::PipelineShaderStageCreateInfo(stageFlag,
                                                             m_ShaderModules.EmplaceBack(LoadFile(shader)),
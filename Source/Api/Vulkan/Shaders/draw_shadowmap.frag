@@ -2,7 +2,7 @@
 #extension GL_GOOGLE_include_directive    : enable
 // #extension GL_EXT_debug_printf : enable
 
-layout (binding = 1) uniform sampler2D samplerColor;
+layout (binding = 1) uniform sampler2DArray samplerColor; // Shows the first cascade
 
 layout (location = 0) in vec2 inUV;
 
@@ -17,6 +17,6 @@ float LinearizeDepth(float depth) {
 }
 
 void main() {
-	float depth  = texture(samplerColor, inUV).r;
+	float depth  = texture(samplerColor, vec3(inUV, 0.0f)).r;
 	outFragColor = vec4(vec3(LinearizeDepth(depth)), 1.0f);
 }
@@ -1,5 +1,6 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_GOOGLE_include_directive    : enable
+#extension GL_EXT_nonuniform_qualifier    : enable
 //#extension GL_EXT_debug_printf : enable
 
 #include "pbr_data.glsl"
@@ -8,7 +9,8 @@
  layout(location = 0) in vec3 inNormals;
  layout(location = 1) in vec2 inTextureCoords;
  layout(location = 2) in vec3 inWorldPosition;
- layout(location = 3) in vec4 inLightPosition;
+ layout(location = 3) in vec4 inLightPositions[CASCADE_COUNT];
+ layout(location = 7) flat in uint inInstanceIndex;
 
  layout(location = 0) out vec4 outFragColor;
 
@@ -23,12 +25,33 @@
  };
 
 // layout (set = 1, binding = 2) uniform samplerCube cubeShadowMap[1];
-layout (set = 1, binding = 2) uniform sampler2D shadowMap;
-layout (set = 2, binding = 0) uniform sampler2D texture1;
+layout (set = 1, binding = 2) uniform sampler2DArray shadowMap; // One layer per cascade
+layout (set = 2, binding = 0) uniform sampler2D textures[];
 
- layout(push_constant) uniform Materials {
-	layout(offset = 64) Material material;
- };
+layout(std430, set = 0, binding = 2) readonly buffer Instances {
+	Instance instances[];
+};
+
+// Light lists of the camera this set draws with, see LightClusters.hpp
+layout (set = 1, binding = 3) uniform ClusterData {
+	mat4  viewProjection;
+	uvec4 gridSize;		// xyz = clusters per axis, w = light count
+	vec4  depthSlicing;	// near, far, scale, bias
+} clusterData;
+
+layout(std430, set = 1, binding = 4) readonly buffer Lights {
+	Light lights[];
+};
+
+layout(std430, set = 1, binding = 5) readonly buffer Clusters {
+	uvec2 clusters[];	// x = first light index, y = light count
+};
+
+layout(std430, set = 1, binding = 6) readonly buffer LightIndices {
+	uint lightIndices[];
+};
+
+Material material;
 
 vec3 CalculateDirectionalLights(vec3 N, vec3 V, vec3 reflectivity, DirectionalLight light) {
 	vec3 L = normalize(light.direction);
@@ -127,24 +150,53 @@ vec3 CalculateSpotLights(vec3 N, vec3 V, vec3 reflectivity, SpotLight light) {
 	return ((diffuse * materialAlbedo / PI + specular) * radiance * NdotL) * intensity;
 }
 
-float ShadowCalculation(vec4 shadowCoords, int pcf, float bias) {
+// Only the lights binned into the cluster of the fragment are shaded
+vec3 CalculateClusteredLights(vec3 N, vec3 V, vec3 reflectivity) {
+	vec4 clip = clusterData.viewProjection * vec4(inWorldPosition, 1.0f);
+	if (clip.w <= clusterData.depthSlicing.x || clip.w >= clusterData.depthSlicing.y) {
+		return vec3(0.0f);
+	}
+
+	vec2  tile  = clamp((clip.xy / clip.w * 0.5f + 0.5f) * vec2(clusterData.gridSize.xy), vec2(0.0f), vec2(clusterData.gridSize.xy - 1u));
+	float slice = clamp(log(clip.w) * clusterData.depthSlicing.z + clusterData.depthSlicing.w, 0.0f, float(clusterData.gridSize.z - 1u));
+	uvec2 list  = clusters[(uint(slice) * clusterData.gridSize.y + uint(tile.y)) * clusterData.gridSize.x + uint(tile.x)];
+
+	vec3 reflectance = vec3(0.0f);
+	for (uint i = 0u; i != list.y; ++i) {
+		Light light = lights[lightIndices[list.x + i]];
+		if (distance(light.position.xyz, inWorldPosition) > light.position.w) {
+			continue;
+		}
+
+		Attenuation attenuation = Attenuation(light.attenuation.x, light.attenuation.y, light.attenuation.z);
+		if (light.type == LIGHT_TYPE_POINT) {
+			reflectance += CalculatePointLights(N, V, reflectivity, PointLight(light.color.a, light.position.xyz, light.color.rgb, attenuation));
+		} else {
+			reflectance += CalculateSpotLights(N, V, reflectivity, SpotLight(light.position.xyz, light.color.rgb, attenuation,
+																			 light.direction.xyz, light.direction.w, light.attenuation.w, light.color.a));
+		}
+	}
+	return reflectance;
+}
+
+float ShadowCalculation(vec4 shadowCoords, int cascade, int pcf, float bias) {
     vec3 projCoords    = shadowCoords.xyz / shadowCoords.w;
     float currentDepth = projCoords.z;
 
 	if (pcf == 0){
-    	float closestDepth = texture(shadowMap, projCoords.xy).r;
+    	float closestDepth = texture(shadowMap, vec3(projCoords.xy, cascade)).r;
 		return  currentDepth > closestDepth ? 1.0f : 0.0f;
 	} else {
 
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+	vec2 texelSize = 1.0 / textureSize(shadowMap, 0).xy;
 
 	float retDiv = 0.0;
 	for(int x = -pcf; x <= pcf; ++x)
 	{
     	for(int y = -pcf; y <= pcf; ++y)
    		{
-        	float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+        	float pcfDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
         	shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
 			retDiv += 1.0;
     	}
@@ -155,7 +207,22 @@ float ShadowCalculation(vec4 shadowCoords, int pcf, float bias) {
 	}
 }
 
+// Cascades go from near to far, the first one that holds the fragment and its PCF kernel wins.
+// Fragments beyond the last cascade are lit.
+float CascadedShadowCalculation(int pcf, float bias) {
+	vec2 margin = vec2(pcf + 1) / vec2(textureSize(shadowMap, 0).xy);
+	for (int i = 0; i != CASCADE_COUNT; ++i) {
+		vec3 projCoords = inLightPositions[i].xyz / inLightPositions[i].w;
+		if (all(greaterThanEqual(projCoords, vec3(margin, 0.0f))) && all(lessThanEqual(projCoords, vec3(1.0f - margin, 1.0f)))) {
+			return ShadowCalculation(inLightPositions[i], i, pcf, bias);
+		}
+	}
+	return 0.0f;
+}
+
  void main() {
+	material = instances[inInstanceIndex].material;
+
  	vec3 N = normalize(inNormals);
 	vec3 V = normalize(ubo.cameraPosition - inWorldPosition);
 
@@ -165,9 +232,10 @@ float ShadowCalculation(vec4 shadowCoords, int pcf, float bias) {
 	vec3 reflectance  = vec3(0.0f);
 
 	// float bias = max(0.05 * (1.0 - dot(inNormals, inLightPosition.xyz)), 0.001);
-	float shadow      = ShadowCalculation(inLightPosition, ubo.pcf2, 0.001);
+	float shadow      = CascadedShadowCalculation(ubo.pcf2, 0.001);
 
 	reflectance += (1.0f - shadow) * CalculateDirectionalLights(N, V, reflectivity, directionalLight);
+	reflectance += CalculateClusteredLights(N, V, reflectivity);
 
 	vec3 ambient = ubo.ambient * materialAlbedo;
 	/* vec3 ambient = ubo.ambient * texture(texture1, inTextureCoords).rgb; */
@@ -181,7 +249,7 @@ float ShadowCalculation(vec4 shadowCoords, int pcf, float bias) {
 	// outFragColor = vec4(color * tex.rgb, tex.a);
 
 	if(material.hasTexture == 1){
-		vec4 tex = texture(texture1, inTextureCoords);
+		vec4 tex = texture(textures[nonuniformEXT(instances[inInstanceIndex].textureIndex)], inTextureCoords);
 		outFragColor = vec4(color * tex.rgb, tex.a);
 	} else {
 		outFragColor = vec4(color, material.transparency);
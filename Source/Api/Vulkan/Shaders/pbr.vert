@@ -3,6 +3,8 @@
 // #extension GL_EXT_debug_printf : enable
 // debugPrintfEXT("currentDepth %f", currentDepth);
 
+#include "pbr_data.glsl"
+
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inNormals;
 layout (location = 2) in vec2 inTextureCoords;
@@ -10,18 +12,23 @@ layout (location = 2) in vec2 inTextureCoords;
 layout(location = 0) out vec3 outNormals;
 layout(location = 1) out vec2 outTextureCoords;
 layout(location = 2) out vec3 outWorldPosition;
-layout(location = 3) out vec4 outLightPosition;
+layout(location = 3) out vec4 outLightPositions[CASCADE_COUNT];
+layout(location = 7) flat out uint outInstanceIndex;
 
 layout(set = 0, binding = 0) uniform UBO  {
 	mat4 projView;
 };
 
 layout(set = 0, binding = 1) uniform LightSpace {
-    mat4 lightSpace;
+    mat4 lightSpace[CASCADE_COUNT];
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Instances {
+	Instance instances[];
 };
 
-layout(push_constant) uniform Model {
-     mat4 model;
+layout(std430, set = 0, binding = 3) readonly buffer Visible {
+	uint visibleIndices[];
 };
 
 out gl_PerVertex {
@@ -29,9 +36,14 @@ out gl_PerVertex {
 };
 
 void main() {
-	outNormals       = mat3(transpose(inverse(model))) * inNormals;
-	outWorldPosition = vec3(model * vec4(inPosition, 1.0f));
-	outLightPosition = lightSpace * vec4(outWorldPosition, 1.0f);
+	uint instance    = visibleIndices[gl_InstanceIndex];
+	mat4 model       = instances[instance].model;
+	outInstanceIndex = instance;
+	outNormals       = mat3(transpose(inverse(model))) * UnpackNormal(instances[instance], inNormals);
+	outWorldPosition = vec3(model * vec4(UnpackPosition(instances[instance], inPosition), 1.0f));
+	for (int i = 0; i != CASCADE_COUNT; ++i) {
+		outLightPositions[i] = lightSpace[i] * vec4(outWorldPosition, 1.0f);
+	}
     outTextureCoords = inTextureCoords;
 	gl_Position      = projView * vec4(outWorldPosition, 1.0f);
 }
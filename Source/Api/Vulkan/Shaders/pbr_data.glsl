@@ -7,6 +7,13 @@
 //************************************************************************
 const float PI = 3.14159265359;
 
+// Matches shadowCascadeCount in Main.cpp
+const int CASCADE_COUNT = 4;
+
+// Matches LightType in LightClusters.hpp
+const uint LIGHT_TYPE_POINT = 0u;
+const uint LIGHT_TYPE_SPOT  = 1u;
+
 //************************************************************************
 // @brief	Data structures.
 //
@@ -25,6 +32,14 @@ struct Material {
 	vec3  albedo;
 };
 
+struct Instance {
+	mat4     model;
+	Material material;
+	uint     textureIndex;
+	vec4     positionScale;  // Packed positions are scaled by xyz, w is 1 if the normals are octahedral
+	vec4     positionOffset; // and offset by xyz, float positions have scale 1 and offset 0
+};
+
 struct DirectionalLight {
 	vec3  direction;
 	vec3  color;
@@ -50,3 +65,31 @@ struct SpotLight {
 	float smoothness;	 // Gamma
 	float intensity;
 };
+
+// Clustered point and spot lights, matches LightData in LightClusters.hpp
+struct Light {
+	vec4 position;		// xyz = world position, w = range
+	vec4 color;			// rgb = color, a = intensity
+	vec4 direction;		// xyz = spot direction, w = cone size
+	vec4 attenuation;	// xyz = constant, linear, quadratic, w = spot smoothness
+	uint type;
+};
+
+//************************************************************************
+// @brief	Vertex decoding, matches VertexPacker.hpp.
+//
+//************************************************************************
+vec3 UnpackPosition(Instance instance, vec3 position) {
+	return position * instance.positionScale.xyz + instance.positionOffset.xyz;
+}
+
+// Packed normals only fill xy, the lower half of the octahedron is unfolded
+vec3 UnpackNormal(Instance instance, vec3 normal) {
+	if (instance.positionScale.w == 0.0f) {
+		return normal;
+	}
+	vec3 n  = vec3(normal.xy, 1.0f - abs(normal.x) - abs(normal.y));
+	float t = max(-n.z, 0.0f);
+	n.xy   += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+	return normalize(n);
+}
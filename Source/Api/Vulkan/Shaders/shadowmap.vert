@@ -2,16 +2,27 @@
 #extension GL_GOOGLE_include_directive    : enable
 //#extension GL_EXT_debug_printf : enable
 
+#include "pbr_data.glsl"
+
 layout(location = 0) in vec3 inPosition;
 
 layout (set = 0, binding = 0) uniform LightSpace {
-   mat4 uLightSpace;
+   mat4 uLightSpace[CASCADE_COUNT];
+};
+
+layout(push_constant) uniform Cascade {
+   uint uCascade;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+   Instance instances[];
 };
 
-layout(push_constant) uniform Model {
-   mat4 uModel;
+layout(std430, set = 0, binding = 2) readonly buffer Visible {
+   uint visibleIndices[];
 };
 
 void main() {
-   gl_Position = uLightSpace * uModel * vec4(inPosition, 1.0f);
+   Instance instance = instances[visibleIndices[gl_InstanceIndex]];
+   gl_Position       = uLightSpace[uCascade] * instance.model * vec4(UnpackPosition(instance, inPosition), 1.0f);
 }
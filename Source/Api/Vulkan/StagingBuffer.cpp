@@ -0,0 +1,137 @@
+#include "StagingBuffer.hpp"
+#include "Context.hpp"
+#include "Initializers.hpp"
+#include "Tools.hpp"
+
+#include <cstdlib>
+
+namespace adh {
+    namespace vk {
+        StagingBuffer* StagingBuffer::Get() ADH_NOEXCEPT {
+            ADH_THROW(s_This, "Staging buffer is not created!");
+            return s_This;
+        }
+
+        bool StagingBuffer::IsCreated() noexcept {
+            return s_This;
+        }
+
+        StagingBuffer::StagingBuffer() noexcept : m_Buffer{ VK_NULL_HANDLE },
+                                                  m_Memory{ VK_NULL_HANDLE },
+                                                  m_Data{},
+                                                  m_Size{} {
+        }
+
+        StagingBuffer::~StagingBuffer() {
+            Clear();
+        }
+
+        void StagingBuffer::Create(VkDeviceSize size) {
+            Clear();
+            if (auto megabytes{ std::getenv("ADH_STAGING_MB") }) {
+                size = static_cast<VkDeviceSize>(std::strtoull(megabytes, nullptr, 10)) << 20u;
+            }
+            m_Size = (size + alignment - 1u) & ~(alignment - 1u);
+
+            auto* context{ Context::Get() };
+            auto info{ initializers::BufferCreateInfo(m_Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT) };
+            ADH_THROW(vkCreateBuffer(context->GetDevice(), &info, nullptr, &m_Buffer) == VK_SUCCESS,
+                      "Failed to create staging buffer!");
+
+            auto memoryRequirements{ tools::GetBufferMemoryRequirements(context->GetDevice(), m_Buffer) };
+            auto memoryTypeIndex{ tools::GetMemoryTypeIndex(
+                context->GetPhysicalDevice(),
+                memoryRequirements,
+                VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) };
+            auto allocateInfo{ initializers::MemoryAllocateInfo(memoryRequirements.size, memoryTypeIndex) };
+            ADH_THROW(vkAllocateMemory(context->GetDevice(), &allocateInfo, nullptr, &m_Memory) == VK_SUCCESS,
+                      "Failed to allocate staging memory!");
+            ADH_THROW(vkBindBufferMemory(context->GetDevice(), m_Buffer, m_Memory, 0u) == VK_SUCCESS,
+                      "Failed to bind staging memory!");
+            ADH_THROW(vkMapMemory(context->GetDevice(), m_Memory, 0u, VK_WHOLE_SIZE, 0u, &m_Data) == VK_SUCCESS,
+                      "Failed to map staging memory!");
+
+            m_FreeBlocks.emplace_back(VkDeviceSize{}, m_Size);
+            s_This = this;
+        }
+
+        void StagingBuffer::Destroy() noexcept {
+            Clear();
+        }
+
+        bool StagingBuffer::Allocate(VkDeviceSize size, Region& region) {
+            size = (size + alignment - 1u) & ~(alignment - 1u);
+            std::lock_guard lock{ m_Mutex };
+            for (std::size_t i{}; i != m_FreeBlocks.size(); ++i) {
+                auto& block{ m_FreeBlocks[i] };
+                if (block.tail - block.head < size) {
+                    continue;
+                }
+                region.offset = block.head;
+                region.size   = size;
+                region.data   = static_cast<char*>(m_Data) + block.head;
+                block.head += size;
+                if (block.head == block.tail) {
+                    m_FreeBlocks.erase(m_FreeBlocks.begin() + i);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void StagingBuffer::Free(Region& region) noexcept {
+            if (!region.size) {
+                return;
+            }
+            {
+                std::lock_guard lock{ m_Mutex };
+                // Merged with the free blocks right before and after it
+                std::size_t i{};
+                while (i != m_FreeBlocks.size() && m_FreeBlocks[i].head < region.offset) {
+                    ++i;
+                }
+                NextFreeBlock freed{ region.offset, region.offset + region.size };
+                if (i != m_FreeBlocks.size() && m_FreeBlocks[i].head == freed.tail) {
+                    freed.tail = m_FreeBlocks[i].tail;
+                    m_FreeBlocks.erase(m_FreeBlocks.begin() + i);
+                }
+                if (i && m_FreeBlocks[i - 1u].tail == freed.head) {
+                    m_FreeBlocks[i - 1u].tail = freed.tail;
+                } else {
+                    m_FreeBlocks.insert(m_FreeBlocks.begin() + i, freed);
+                }
+            }
+            region = {};
+        }
+
+        VkDeviceSize StagingBuffer::GetSize() const noexcept {
+            return m_Size;
+        }
+
+        StagingBuffer::operator VkBuffer() noexcept {
+            return m_Buffer;
+        }
+
+        StagingBuffer::operator const VkBuffer() const noexcept {
+            return m_Buffer;
+        }
+
+        void StagingBuffer::Clear() noexcept {
+            if (m_Buffer == VK_NULL_HANDLE) {
+                return;
+            }
+            auto device{ Context::Get()->GetDevice() };
+            vkUnmapMemory(device, m_Memory);
+            vkDestroyBuffer(device, m_Buffer, nullptr);
+            vkFreeMemory(device, m_Memory, nullptr);
+            m_Buffer = VK_NULL_HANDLE;
+            m_Memory = VK_NULL_HANDLE;
+            m_Data   = nullptr;
+            m_Size   = 0u;
+            m_FreeBlocks.clear();
+            if (s_This == this) {
+                s_This = nullptr;
+            }
+        }
+    } // namespace vk
+} // namespace adh
@@ -0,0 +1,71 @@
+#pragma once
+#include "Allocator.hpp"
+#include <Utility.hpp>
+#include <vulkan/vulkan.h>
+
+#include <mutex>
+#include <vector>
+
+namespace adh {
+    namespace vk {
+        // Host visible buffer that stays mapped for the whole run, images are decoded straight into
+        // it instead of into a CPU copy that is copied again. It has its own device memory, the
+        // blocks of the Allocator are mapped and unmapped by the buffers in them. Regions are handed
+        // out first fit on any thread, the copies out of them are recorded on the main thread.
+        class StagingBuffer {
+          public:
+            static constexpr VkDeviceSize defaultSize{ VkDeviceSize{ 64u } << 20u }; // ADH_STAGING_MB overrides it
+            static constexpr VkDeviceSize alignment{ 16u };                         // Enough for any texel block
+            static constexpr VkDeviceSize tileSize{ VkDeviceSize{ 4u } << 20u };    // Larger images are uploaded in bands of rows
+
+            struct Region {
+                VkDeviceSize offset;
+                VkDeviceSize size;
+                void* data;
+            };
+
+          public:
+            static StagingBuffer* Get() ADH_NOEXCEPT;
+
+            static bool IsCreated() noexcept;
+
+            StagingBuffer() noexcept;
+
+            StagingBuffer(const StagingBuffer& rhs) = delete;
+
+            StagingBuffer& operator=(const StagingBuffer& rhs) = delete;
+
+            ~StagingBuffer();
+
+            void Create(VkDeviceSize size = defaultSize);
+
+            void Destroy() noexcept;
+
+            // Thread safe, false if no free range of size bytes is left
+            bool Allocate(VkDeviceSize size, Region& region);
+
+            // Thread safe, once the copies out of the region are complete
+            void Free(Region& region) noexcept;
+
+            VkDeviceSize GetSize() const noexcept;
+
+            operator VkBuffer() noexcept;
+
+            operator const VkBuffer() const noexcept;
+
+          private:
+            void Clear() noexcept;
+
+          private:
+            inline static StagingBuffer* s_This;
+
+          private:
+            VkBuffer m_Buffer;
+            VkDeviceMemory m_Memory;
+            void* m_Data;
+            VkDeviceSize m_Size;
+            std::vector<NextFreeBlock> m_FreeBlocks; // Guarded by m_Mutex, by head, tail is one past the end
+            std::mutex m_Mutex;
+        };
+    } // namespace vk
+} // namespace adh
@@ -41,6 +41,37 @@ namespace adh {
             isValid = true;
         }
 
+        void Swapchain::CreateOffscreen(std::uint32_t imageCount, VkFormat format, VkExtent2D extent) {
+            m_ImageBuffersCount = imageCount;
+            m_Format            = { format, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+            m_PresentMode       = VK_PRESENT_MODE_FIFO_KHR;
+            m_Extent            = extent;
+
+            // Copied from after the last frame, e.g. to hash it
+            m_OffscreenImages.Resize(imageCount);
+            for (auto& image : m_OffscreenImages) {
+                image.Create(
+                    { extent.width, extent.height, 1u },
+                    format,
+                    VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_TYPE_2D,
+                    VkImageCreateFlagBits(0u),
+                    1u,
+                    1u,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    VkImageUsageFlagBits(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT),
+                    VK_IMAGE_ASPECT_COLOR_BIT,
+                    VK_IMAGE_VIEW_TYPE_2D,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    VK_SHARING_MODE_EXCLUSIVE);
+                m_Images.EmplaceBack(image.GetImage());
+                m_ImageViews.EmplaceBack(image.GetImageView());
+            }
+            CreateDepthBuffer();
+
+            isValid = true;
+        }
+
         void Swapchain::Destroy() noexcept {
             Clear();
         }
@@ -61,6 +92,10 @@ namespace adh {
             return m_ImageViews;
         }
 
+        const Array<VkImage>& Swapchain::GetImages() const noexcept {
+            return m_Images;
+        }
+
         VkFormat Swapchain::GetFormat() const noexcept {
             return m_Format.format;
         }
@@ -69,6 +104,10 @@ namespace adh {
             return m_Extent;
         }
 
+        VkPresentModeKHR Swapchain::GetPresentMode() const noexcept {
+            return m_PresentMode;
+        }
+
         Image& Swapchain::GetColorBuffer() noexcept {
             return m_ColorBuffer;
         }
@@ -81,6 +120,10 @@ namespace adh {
             return static_cast<std::uint32_t>(m_ImageViews.GetSize());
         }
 
+        bool Swapchain::IsOffscreen() const noexcept {
+            return !m_OffscreenImages.IsEmpty();
+        }
+
         Swapchain::operator VkSwapchainKHR() noexcept {
             return m_Swapchain;
         }
@@ -128,6 +171,8 @@ namespace adh {
             swapchainCreateInfo.surface = context->GetSurface();
             if (m_ImageBuffersCount < surfaceCapabilities.minImageCount) {
                 swapchainCreateInfo.minImageCount = surfaceCapabilities.minImageCount;
+            } else if (surfaceCapabilities.maxImageCount && m_ImageBuffersCount > surfaceCapabilities.maxImageCount) {
+                swapchainCreateInfo.minImageCount = surfaceCapabilities.maxImageCount;
             } else {
                 swapchainCreateInfo.minImageCount = m_ImageBuffersCount;
             }
@@ -175,6 +220,7 @@ namespace adh {
             m_DepthBuffer       = Move(rhs.m_DepthBuffer);
             m_Images            = Move(rhs.m_Images);
             m_ImageViews        = Move(rhs.m_ImageViews);
+            m_OffscreenImages   = Move(rhs.m_OffscreenImages);
             m_ImageBuffersCount = rhs.m_ImageBuffersCount;
 
             rhs.m_Swapchain = VK_NULL_HANDLE;
@@ -184,11 +230,16 @@ namespace adh {
             auto device{ Context::Get()->GetDevice() };
             vkDeviceWaitIdle(device);
 
-            for (std::uint32_t i{}; i != m_ImageViews.GetSize(); ++i) {
-                vkDestroyImageView(device, m_ImageViews[i], nullptr);
-                m_ImageViews[i] = VK_NULL_HANDLE;
+            // Offscreen images own their views
+            if (m_OffscreenImages.IsEmpty()) {
+                for (std::uint32_t i{}; i != m_ImageViews.GetSize(); ++i) {
+                    vkDestroyImageView(device, m_ImageViews[i], nullptr);
+                    m_ImageViews[i] = VK_NULL_HANDLE;
+                }
             }
             m_ImageViews.Clear();
+            m_Images.Clear();
+            m_OffscreenImages.Clear();
 
             if (m_DepthBuffer != VK_NULL_HANDLE) {
                 m_DepthBuffer.Destroy();
@@ -26,6 +26,10 @@ namespace adh {
 
             void Create(std::uint32_t imageBuffersCount, VkFormat format, VkPresentModeKHR presentMode);
 
+            // Headless, renders to images owned by the swapchain instead of a VkSwapchainKHR. They are
+            // never presented, the frame context submits without acquiring and leaves them readable.
+            void CreateOffscreen(std::uint32_t imageCount, VkFormat format, VkExtent2D extent);
+
             void Destroy() noexcept;
 
             VkSwapchainKHR Get() noexcept;
@@ -36,16 +40,23 @@ namespace adh {
 
             const Array<VkImageView>& GetImageView() const noexcept;
 
+            const Array<VkImage>& GetImages() const noexcept;
+
             VkFormat GetFormat() const noexcept;
 
             VkExtent2D GetExtent() const noexcept;
 
+            // The mode asked for in Create() if the surface supports it, FIFO otherwise
+            VkPresentModeKHR GetPresentMode() const noexcept;
+
             Image& GetColorBuffer() noexcept;
 
             Image& GetDepthBuffer() noexcept;
 
             std::uint32_t GetImageViewCount() const noexcept;
 
+            bool IsOffscreen() const noexcept;
+
             operator VkSwapchainKHR() noexcept;
 
             operator const VkSwapchainKHR() const noexcept;
@@ -77,6 +88,7 @@ namespace adh {
             Array<VkImageView> m_ImageViews;
             Image m_DepthBuffer;
             Image m_ColorBuffer;
+            Array<Image> m_OffscreenImages;
             std::uint32_t m_ImageBuffersCount;
         };
     } // namespace vk
@@ -2,12 +2,17 @@
 #include "CommandBuffer.hpp"
 #include "Context.hpp"
 #include "Memory.hpp"
+#include "Tools.hpp"
 #include <Std/TGALoader.hpp>
+#include <Std/VirtualFileSystem.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <limits>
 
 #include <Vulkan/DescriptorSet.hpp>
 
@@ -72,28 +77,38 @@ namespace adh {
                                bool isEntityComponent,
                                VkBool32 generateMinMap,
                                VkSharingMode sharingMode) {
-            int texWidth, texHeight, texChannels;
-            stbi_set_flip_vertically_on_load(true);
-            stbi_uc* pixels        = stbi_load(filePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-            VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-            m_Extent = { static_cast<std::uint32_t>(texWidth), static_cast<std::uint32_t>(texHeight) };
-            UniformBuffer staging{ pixels, imageSize, 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
-            auto usageFlag{ SelectImageUsage(imageUsage, generateMinMap) };
-            SelectImageLayout(imageUsage);
-
-            CreateImage(
-                staging,
-                generateMinMap,
-                usageFlag,
-                sharingMode);
+            // TGAs are decoded into staging memory, the rest through stbi
+            TGALoader tga;
+            if (tga.Open(filePath)) {
+                m_Extent = { tga.GetWidth(), tga.GetHeight() };
+                auto usageFlag{ SelectImageUsage(imageUsage, generateMinMap) };
+                SelectImageLayout(imageUsage);
+
+                BeginUpload(VK_FORMAT_R8G8B8A8_UNORM, usageFlag, sharingMode);
+                ADH_THROW(UploadRows(tga), "Failed to load texture!");
+                EndUpload(generateMinMap);
+            } else {
+                Array<std::uint8_t> pixels;
+                if (!Decode(filePath, pixels, m_Extent)) {
+                    ADH_THROW(false, "Failed to load texture!");
+                    return;
+                }
+                UniformBuffer staging{ pixels.GetData(), pixels.GetSize(), 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
+                auto usageFlag{ SelectImageUsage(imageUsage, generateMinMap) };
+                SelectImageLayout(imageUsage);
+
+                CreateImage(
+                    staging,
+                    generateMinMap,
+                    usageFlag,
+                    sharingMode);
+            }
 
             mFilePath = filePath;
             auto pos  = mFilePath.find_last_of('/');
             mFileName = mFilePath.substr(pos + 1, mFilePath.size());
 
             InitializeDescriptor(sampler, isEntityComponent);
-            stbi_image_free(pixels);
         }
 
         void Texture2D::Create(const void* data,
@@ -141,6 +156,162 @@ namespace adh {
             Create(filePath, imageUsage, &m_DefaultSamplers[samplerId], isEntityComponent, generateMinMap, sharingMode);
         }
 
+        void Texture2D::CreatePlaceholder(const char* filePath, const Texture2D& placeholder, bool isEntityComponent) {
+            CreateView(filePath, placeholder, isEntityComponent);
+        }
+
+        void Texture2D::CreateShared(const char* filePath, const SharedPtr<Texture2D>& texture, bool isEntityComponent) {
+            CreateView(filePath, *texture, isEntityComponent);
+            m_Shared = texture;
+        }
+
+        void Texture2D::CreateFromPixels(const void* pixels, VkExtent2D extent, bool isEntityComponent) {
+            m_Image.Destroy();
+            m_Extent = extent;
+            UniformBuffer staging{ pixels, std::size_t{ 4u } * extent.width * extent.height, 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
+            auto usageFlag{ SelectImageUsage(VK_IMAGE_USAGE_SAMPLED_BIT, VK_FALSE) };
+            SelectImageLayout(VK_IMAGE_USAGE_SAMPLED_BIT);
+
+            CreateImage(
+                staging,
+                VK_FALSE,
+                usageFlag,
+                VK_SHARING_MODE_EXCLUSIVE);
+
+            // A new texture ID, frames in flight still sample the placeholder under the old one
+            InitializeDescriptor(&m_DefaultSamplers[0], isEntityComponent);
+        }
+
+        void Texture2D::CreateFromStaging(const StagingBuffer::Region& region, VkExtent2D extent, bool isEntityComponent) {
+            m_Image.Destroy();
+            m_Extent = extent;
+            auto usageFlag{ SelectImageUsage(VK_IMAGE_USAGE_SAMPLED_BIT, VK_FALSE) };
+            SelectImageLayout(VK_IMAGE_USAGE_SAMPLED_BIT);
+
+            BeginUpload(VK_FORMAT_R8G8B8A8_UNORM, usageFlag, VK_SHARING_MODE_EXCLUSIVE);
+            auto imageCopy{ initializers::BufferImageCopy(VK_IMAGE_ASPECT_COLOR_BIT, { m_Extent.width, m_Extent.height, 1u }, 0u, 1u) };
+            imageCopy.bufferOffset = region.offset;
+            CopyBufferToImage(*StagingBuffer::Get(), m_Image, &imageCopy, 1u);
+            EndUpload(VK_FALSE);
+
+            InitializeDescriptor(&m_DefaultSamplers[0], isEntityComponent);
+        }
+
+        bool Texture2D::CreateFromTGA(TGALoader& tga, bool isEntityComponent) {
+            m_Image.Destroy();
+            m_Extent = { tga.GetWidth(), tga.GetHeight() };
+            auto usageFlag{ SelectImageUsage(VK_IMAGE_USAGE_SAMPLED_BIT, VK_FALSE) };
+            SelectImageLayout(VK_IMAGE_USAGE_SAMPLED_BIT);
+
+            BeginUpload(VK_FORMAT_R8G8B8A8_UNORM, usageFlag, VK_SHARING_MODE_EXCLUSIVE);
+            if (!UploadRows(tga)) {
+                m_Image.Destroy();
+                return false;
+            }
+            EndUpload(VK_FALSE);
+
+            InitializeDescriptor(&m_DefaultSamplers[0], isEntityComponent);
+            return true;
+        }
+
+        void Texture2D::CreateCompressed(const void* blocks, std::size_t size, VkFormat format, VkExtent2D extent, std::uint32_t mipLevels, bool isEntityComponent) {
+            m_Image.Destroy();
+            m_Extent    = extent;
+            m_MipLevels = mipLevels;
+            SelectImageLayout(VK_IMAGE_USAGE_SAMPLED_BIT);
+
+            // Every level is a run of whole blocks, BC1 and BC4 blocks are 8 bytes and the others 16
+            std::size_t blockSize{ format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK ? 8u : 16u };
+            Array<VkBufferImageCopy> regions;
+            VkDeviceSize offset{};
+            for (std::uint32_t i{}; i != m_MipLevels; ++i) {
+                VkExtent3D mipExtent{ std::max(extent.width >> i, 1u), std::max(extent.height >> i, 1u), 1u };
+                auto region{ initializers::BufferImageCopy(VK_IMAGE_ASPECT_COLOR_BIT, mipExtent, i, 1u) };
+                region.bufferOffset = offset;
+                regions.EmplaceBack(region);
+                offset += blockSize * ((mipExtent.width + 3u) / 4u) * ((mipExtent.height + 3u) / 4u);
+            }
+            ADH_THROW(offset <= size, "Compressed texture is truncated!");
+
+            UniformBuffer staging{ blocks, size, 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
+            BeginUpload(format, VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT), VK_SHARING_MODE_EXCLUSIVE);
+            CopyBufferToImage(staging, m_Image, regions.GetData(), static_cast<std::uint32_t>(regions.GetSize()));
+            EndUpload(VK_FALSE);
+
+            InitializeDescriptor(&m_DefaultSamplers[0], isEntityComponent);
+        }
+
+        bool Texture2D::Decode(const char* filePath, Array<std::uint8_t>& pixels, VkExtent2D& extent) {
+            TGALoader tga;
+            if (tga.Open(filePath)) {
+                extent = { tga.GetWidth(), tga.GetHeight() };
+                pixels.Resize(tga.GetSize());
+                return tga.Read(pixels.GetData());
+            }
+
+            MappedFile file;
+            if (!VirtualFileSystem::Open(filePath, file) || file.GetSize() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+                return false;
+            }
+            int texWidth, texHeight, texChannels;
+            stbi_set_flip_vertically_on_load_thread(true);
+            stbi_uc* data = stbi_load_from_memory(static_cast<const stbi_uc*>(file.GetData()), static_cast<int>(file.GetSize()),
+                                                  &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (!data) {
+                return false;
+            }
+
+            extent = { static_cast<std::uint32_t>(texWidth), static_cast<std::uint32_t>(texHeight) };
+            pixels.Resize(std::size_t{ 4u } * extent.width * extent.height);
+            std::memcpy(pixels.GetData(), data, pixels.GetSize());
+            stbi_image_free(data);
+            return true;
+        }
+
+        void Texture2D::CopyRegion(VkCommandBuffer commandBuffer, VkBuffer source, VkDeviceSize sourceOffset, VkOffset2D offset, VkExtent2D extent) noexcept {
+            ImageBarrier(
+                commandBuffer,
+                VkAccessFlagBits{},
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                m_Descriptor.imageLayout,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                m_Image,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                0u);
+
+            auto imageCopy{ initializers::BufferImageCopy(VK_IMAGE_ASPECT_COLOR_BIT, { extent.width, extent.height, 1u }, 0u, 1u) };
+            imageCopy.bufferOffset = sourceOffset;
+            imageCopy.imageOffset  = { offset.x, offset.y, 0 };
+            vkCmdCopyBufferToImage(commandBuffer, source, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1u, &imageCopy);
+
+            ImageBarrier(
+                commandBuffer,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                m_Descriptor.imageLayout,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                m_Image,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                0u);
+        }
+
+        bool Texture2D::IsPlaceholder() const noexcept {
+            return m_Image.GetImage() == VK_NULL_HANDLE && !m_Shared;
+        }
+
+        bool Texture2D::IsBlockCompressionSupported() noexcept {
+            // The device enables every feature the physical device has
+            return tools::GetPhysicalDeviceFeatures(Context::Get()->GetPhysicalDevice()).textureCompressionBC;
+        }
+
         void Texture2D::InitializeDefaultSamplers() {
             if (m_DefaultSamplers.IsEmpty()) {
                 m_DefaultSamplers.EmplaceBack(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_MIPMAP_MODE_LINEAR, VK_COMPARE_OP_NEVER, VK_FALSE, VK_TRUE);
@@ -230,9 +401,23 @@ namespace adh {
                                     VkBool32 generateMinMap,
                                     VkImageUsageFlagBits usageFlag,
                                     VkSharingMode sharingMode) {
+            BeginUpload(VK_FORMAT_R8G8B8A8_UNORM, usageFlag, sharingMode);
+
+            CopyBufferToImage(
+                staging,
+                m_Image,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                { m_Extent.width, m_Extent.height, 1u },
+                0u,
+                1u);
+
+            EndUpload(generateMinMap);
+        }
+
+        void Texture2D::BeginUpload(VkFormat format, VkImageUsageFlagBits usageFlag, VkSharingMode sharingMode) {
             m_Image.Create(
                 { m_Extent.width, m_Extent.height, 1u },
-                VK_FORMAT_R8G8B8A8_UNORM,
+                format,
                 VK_IMAGE_TILING_OPTIMAL,
                 VK_IMAGE_TYPE_2D,
                 (VkImageCreateFlagBits)0,
@@ -254,15 +439,9 @@ namespace adh {
                 VK_PIPELINE_STAGE_TRANSFER_BIT,
                 m_MipLevels,
                 1u);
+        }
 
-            CopyBufferToImage(
-                staging,
-                m_Image,
-                VK_IMAGE_ASPECT_COLOR_BIT,
-                { m_Extent.width, m_Extent.height, 1u },
-                0u,
-                1u);
-
+        void Texture2D::EndUpload(VkBool32 generateMinMap) {
             if (!generateMinMap) {
                 TransferImageLayout(
                     m_Image,
@@ -280,6 +459,46 @@ namespace adh {
             }
         }
 
+        bool Texture2D::UploadRows(TGALoader& tga) {
+            std::size_t rowSize{ std::size_t{ 4u } * m_Extent.width };
+            auto bandRows{ static_cast<std::uint32_t>(std::clamp<std::size_t>(StagingBuffer::tileSize / rowSize, 1u, m_Extent.height)) };
+
+            // A band of the staging ring, a buffer of its own while the ring is full
+            StagingBuffer::Region region{};
+            Buffer fallback;
+            VkBuffer source;
+            void* band;
+            if (StagingBuffer::Get()->Allocate(rowSize * bandRows, region)) {
+                source = *StagingBuffer::Get();
+                band   = region.data;
+            } else {
+                fallback.Create(rowSize * bandRows, 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+                fallback.Map(nullptr, band);
+                source = fallback;
+            }
+
+            bool isRead{ true };
+            while (isRead && tga.GetRowsLeft()) {
+                auto rowCount{ std::min(bandRows, tga.GetRowsLeft()) };
+                std::uint32_t firstRow;
+                isRead = tga.ReadRows(static_cast<std::uint8_t*>(band), rowCount, firstRow);
+                if (isRead) {
+                    // The copy waits for the queue, the band is free again when it returns
+                    auto imageCopy{ initializers::BufferImageCopy(VK_IMAGE_ASPECT_COLOR_BIT, { m_Extent.width, rowCount, 1u }, 0u, 1u) };
+                    imageCopy.bufferOffset  = region.offset;
+                    imageCopy.imageOffset.y = static_cast<std::int32_t>(firstRow);
+                    CopyBufferToImage(source, m_Image, &imageCopy, 1u);
+                }
+            }
+
+            if (region.size) {
+                StagingBuffer::Get()->Free(region);
+            } else {
+                fallback.Unmap();
+            }
+            return isRead;
+        }
+
         void Texture2D::CreateImage(VkImageUsageFlagBits usageFlag, VkImageLayout imageLayout, VkSharingMode sharingMode) {
             m_Image.Create(
                 { m_Extent.width, m_Extent.height, 1u },
@@ -415,12 +634,30 @@ namespace adh {
             m_Descriptor.imageView = m_Image.GetImageView();
 
             if (isEntityComponent) {
+                TextureDescriptors::FreeDescriptor(mDescriptorSetID);
                 mDescriptorSetID = TextureDescriptors::GetDescriptorID(m_Descriptor);
             }
         }
 
+        void Texture2D::CreateView(const char* filePath, const Texture2D& source, bool isEntityComponent) noexcept {
+            Clear();
+            m_Extent                 = source.m_Extent;
+            m_MipLevels              = source.m_MipLevels;
+            m_Descriptor.imageLayout = source.m_Descriptor.imageLayout;
+            m_Descriptor.imageView   = source.m_Descriptor.imageView;
+            m_Descriptor.sampler     = m_DefaultSamplers[0].Get();
+            if (isEntityComponent) {
+                mDescriptorSetID = TextureDescriptors::GetDescriptorID(m_Descriptor);
+            }
+
+            mFilePath = filePath;
+            auto pos  = mFilePath.find_last_of('/');
+            mFileName = mFilePath.substr(pos + 1, mFilePath.size());
+        }
+
         void Texture2D::MoveConstruct(Texture2D&& rhs) noexcept {
-            m_Image = Move(rhs.m_Image);
+            m_Image  = Move(rhs.m_Image);
+            m_Shared = Move(rhs.m_Shared);
 
             m_Descriptor = rhs.m_Descriptor;
             m_Extent     = rhs.m_Extent;
@@ -431,18 +668,22 @@ namespace adh {
             mFilePath        = rhs.mFilePath;
             mIsLinearFilter  = rhs.mIsLinearFilter;
 
-            rhs.m_Descriptor = {};
-            rhs.m_Extent     = {};
-            rhs.m_MipLevels  = 0u;
+            rhs.m_Descriptor     = {};
+            rhs.m_Extent         = {};
+            rhs.m_MipLevels      = 0u;
+            rhs.mDescriptorSetID = TextureDescriptors::invalidID;
         }
 
         void Texture2D::Clear() noexcept {
             m_Image.Destroy();
+            // The registry keeps a shared image until no frame in flight reads it
+            m_Shared        = {};
             m_Descriptor    = {};
             m_Extent        = {};
             m_MipLevels     = 0u;
             mIsLinearFilter = true;
-            // TextureDescriptors::FreeDescriptor(mDescriptorSetID);
+            TextureDescriptors::FreeDescriptor(mDescriptorSetID);
+            mDescriptorSetID = TextureDescriptors::invalidID;
         }
     } // namespace vk
 } // namespace adh
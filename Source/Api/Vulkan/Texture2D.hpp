@@ -1,15 +1,19 @@
 #pragma once
 #include "Image.hpp"
 #include "Sampler.hpp"
+#include "StagingBuffer.hpp"
 #include "UniformBuffer.hpp"
 
 #include <Std/Array.hpp>
+#include <Std/SharedPtr.hpp>
 
 #include <vulkan/vulkan.h>
 
 #include <string>
 
 namespace adh {
+    class TGALoader;
+
     namespace vk {
         class Texture2D {
           public:
@@ -89,6 +93,39 @@ namespace adh {
                 VkBool32 generateMinMap   = VK_FALSE,
                 VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
 
+            // Shows placeholder under its own texture ID until CreateFromPixels(), keeps the path
+            void CreatePlaceholder(const char* filePath, const Texture2D& placeholder, bool isEntityComponent = false);
+
+            // Samples the image of texture under its own texture ID and keeps it alive, filePath is
+            // this texture's own file that may be an identical copy
+            void CreateShared(const char* filePath, const SharedPtr<Texture2D>& texture, bool isEntityComponent = false);
+
+            // RGBA8 pixels decoded by Decode(), the sampler is the default linear one
+            void CreateFromPixels(const void* pixels, VkExtent2D extent, bool isEntityComponent = false);
+
+            // RGBA8 pixels decoded straight into a region of the StagingBuffer
+            void CreateFromStaging(const StagingBuffer::Region& region, VkExtent2D extent, bool isEntityComponent = false);
+
+            // Decodes the rest of an open TGA into the image a band of rows at a time, returns false
+            // and stays a placeholder if the file is truncated
+            bool CreateFromTGA(TGALoader& tga, bool isEntityComponent = false);
+
+            // Block compressed levels packed from the largest, the sampler is the default linear one
+            void CreateCompressed(const void* blocks, std::size_t size, VkFormat format, VkExtent2D extent, std::uint32_t mipLevels, bool isEntityComponent = false);
+
+            // Reads an image file into RGBA8 pixels, flipped like the file path Create(). Thread safe,
+            // returns false if the file can't be read.
+            static bool Decode(const char* filePath, Array<std::uint8_t>& pixels, VkExtent2D& extent);
+
+            // Records a copy of RGBA8 pixels into a region of the first level, outside of a render
+            // pass. Fragment shaders of earlier submissions are done reading the image before it.
+            void CopyRegion(VkCommandBuffer commandBuffer, VkBuffer source, VkDeviceSize sourceOffset, VkOffset2D offset, VkExtent2D extent) noexcept;
+
+            bool IsPlaceholder() const noexcept;
+
+            // BC1 to BC7 can be sampled
+            static bool IsBlockCompressionSupported() noexcept;
+
             VkImage GetImage() noexcept;
 
             const VkImage GetImage() const noexcept;
@@ -145,6 +182,14 @@ namespace adh {
                 VkImageUsageFlagBits usageFlag,
                 VkSharingMode sharingMode);
 
+            // Creates the image with m_MipLevels levels ready to be copied to
+            void BeginUpload(VkFormat format, VkImageUsageFlagBits usageFlag, VkSharingMode sharingMode);
+
+            void EndUpload(VkBool32 generateMinMap);
+
+            // Each band is decoded into staging memory and copied before the next one is decoded
+            bool UploadRows(TGALoader& tga);
+
             void CreateImage(
                 VkImageUsageFlagBits usageFlag,
                 VkImageLayout imageLayout,
@@ -158,6 +203,9 @@ namespace adh {
 
             void InitializeDescriptor(const Sampler* sampler, bool isEntityComponent = false) noexcept;
 
+            // Descriptor of the image of source, nothing is owned
+            void CreateView(const char* filePath, const Texture2D& source, bool isEntityComponent) noexcept;
+
             void MoveConstruct(Texture2D&& rhs) noexcept;
 
             void Clear() noexcept;
@@ -167,6 +215,7 @@ namespace adh {
 
           private:
             Image m_Image;
+            SharedPtr<Texture2D> m_Shared; // Owns the image when it's shared
             VkDescriptorImageInfo m_Descriptor;
             VkExtent2D m_Extent;
             std::uint32_t m_MipLevels;
@@ -176,7 +225,7 @@ namespace adh {
 
             inline static Array<Sampler> m_DefaultSamplers;
 
-            uint32_t mDescriptorSetID = 0;
+            uint32_t mDescriptorSetID = ~0u; // Slot in the bindless texture table
         };
     } // namespace vk
 } // namespace adh
@@ -24,6 +24,19 @@ namespace adh {
                 return deviceFeatures;
             }
 
+            inline auto GetPhysicalDeviceDescriptorIndexingFeatures(VkPhysicalDevice physicalDevice) noexcept {
+                VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
+                descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+                VkPhysicalDeviceFeatures2 deviceFeatures{};
+                deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                deviceFeatures.pNext = &descriptorIndexingFeatures;
+                vkGetPhysicalDeviceFeatures2(physicalDevice, &deviceFeatures);
+
+                descriptorIndexingFeatures.pNext = nullptr;
+                return descriptorIndexingFeatures;
+            }
+
             inline auto GetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice) noexcept {
                 VkPhysicalDeviceProperties deviceProperties;
                 vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
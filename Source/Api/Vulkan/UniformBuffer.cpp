@@ -5,6 +5,7 @@
 namespace adh {
     namespace vk {
         UniformBuffer::UniformBuffer() noexcept : m_Descriptor{},
+                                                  m_Stride{},
                                                   m_Data{},
                                                   m_MappedPtr{} {
         }
@@ -29,14 +30,29 @@ namespace adh {
         }
 
         void UniformBuffer::Create(const void* data, std::size_t size, std::uint32_t count, VkBufferUsageFlagBits bufferUsage) {
-            auto memoryProperty{ tools::IsUniformMemoryAccess(Context::Get()->GetPhysicalDevice()) ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-            m_Buffer.Create(size, count, bufferUsage, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | memoryProperty));
+            auto physicalDevice{ Context::Get()->GetPhysicalDevice() };
+            auto memoryProperty{ tools::IsUniformMemoryAccess(physicalDevice) ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+
+            m_Stride = static_cast<VkDeviceSize>(size);
+            if (count > 1u && (bufferUsage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)) {
+                auto alignment{ tools::GetPhysicalDeviceProperties(physicalDevice).limits.minUniformBufferOffsetAlignment };
+                m_Stride = (m_Stride + alignment - 1u) & ~(alignment - 1u);
+            }
+
+            m_Buffer.Create(m_Stride, count, bufferUsage, VkMemoryPropertyFlagBits(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | memoryProperty));
             m_Data = data;
-            m_Buffer.Map(m_Data, m_MappedPtr);
+            m_Buffer.Map(nullptr, m_MappedPtr);
             m_Buffer.Unmap();
             m_Descriptor.buffer = m_Buffer;
             m_Descriptor.offset = 0u;
             m_Descriptor.range  = static_cast<VkDeviceSize>(size);
+
+            // The source only holds one copy
+            if (m_Data) {
+                for (std::uint32_t i{}; i != count; ++i) {
+                    Update(i);
+                }
+            }
         }
 
         void UniformBuffer::Destroy() noexcept {
@@ -48,7 +64,7 @@ namespace adh {
         }
 
         void UniformBuffer::Update(const void* data, std::uint32_t imageIndex) noexcept {
-            const std::size_t offset{ m_Descriptor.range * imageIndex };
+            const std::size_t offset{ m_Stride * imageIndex };
             void* const ptr{ static_cast<char* const>(m_MappedPtr) + offset };
             std::memcpy(ptr, data, static_cast<std::size_t>(m_Descriptor.range));
         }
@@ -61,6 +77,12 @@ namespace adh {
             return m_Descriptor;
         }
 
+        VkDescriptorBufferInfo UniformBuffer::GetDescriptor(std::uint32_t index) const noexcept {
+            auto info{ m_Descriptor };
+            info.offset = m_Stride * index;
+            return info;
+        }
+
         std::uint64_t UniformBuffer::GetSize() const noexcept {
             return static_cast<std::uint64_t>(m_Descriptor.range);
         }
@@ -84,10 +106,12 @@ namespace adh {
         void UniformBuffer::MoveConstruct(UniformBuffer&& rhs) noexcept {
             m_Buffer     = Move(rhs.m_Buffer);
             m_Descriptor = rhs.m_Descriptor;
+            m_Stride     = rhs.m_Stride;
             m_Data       = rhs.m_Data;
             m_MappedPtr  = rhs.m_MappedPtr;
 
             rhs.m_Descriptor = {};
+            rhs.m_Stride     = 0u;
             rhs.m_Data       = nullptr;
             rhs.m_MappedPtr  = nullptr;
         }
@@ -95,6 +119,7 @@ namespace adh {
         void UniformBuffer::Clear() noexcept {
             m_Buffer.Destroy();
             m_Descriptor = {};
+            m_Stride     = 0u;
             m_Data       = nullptr;
             m_MappedPtr  = nullptr;
         }
@@ -39,6 +39,9 @@ namespace adh {
 
             const VkDescriptorBufferInfo GetDescriptor() const noexcept;
 
+            // Copy index of a buffer created with one copy per frame
+            VkDescriptorBufferInfo GetDescriptor(std::uint32_t index) const noexcept;
+
             std::uint64_t GetSize() const noexcept;
 
             void* GetMappedPtr() noexcept;
@@ -57,6 +60,7 @@ namespace adh {
           private:
             Buffer m_Buffer;
             VkDescriptorBufferInfo m_Descriptor;
+            VkDeviceSize m_Stride; // Between copies, uniform buffer copies start on the offset alignment
             const void* m_Data;
             void* m_MappedPtr;
         };
@@ -0,0 +1,293 @@
+#include "AssetManager.hpp"
+#include "AssetRegistry.hpp"
+#include <Event/Event.hpp>
+#include <Scene/Components/Mesh.hpp>
+#include <Std/Hash.hpp>
+#include <Vulkan/Context.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <exception>
+
+namespace adh {
+    namespace {
+        // Identical pixels under another extent, format or mip count are another texture
+        std::uint64_t HashTexture(std::uint64_t contentHash, VkFormat format, VkExtent2D extent, std::uint32_t mipLevels) noexcept {
+            struct {
+                std::uint64_t contentHash;
+                std::uint32_t format;
+                std::uint32_t width;
+                std::uint32_t height;
+                std::uint32_t mipLevels;
+            } key{ contentHash, static_cast<std::uint32_t>(format), extent.width, extent.height, mipLevels };
+            return Fnv1a(&key, sizeof(key));
+        }
+
+        // Uncompressed textures get the full chain generated on the GPU
+        std::uint64_t HashTexture(std::uint64_t contentHash, VkExtent2D extent) noexcept {
+            auto mipLevels{ static_cast<std::uint32_t>(std::bit_width(std::max(extent.width, extent.height))) };
+            return HashTexture(contentHash, VK_FORMAT_R8G8B8A8_UNORM, extent, mipLevels);
+        }
+    } // namespace
+
+    AssetManager* AssetManager::Get() ADH_NOEXCEPT {
+        ADH_THROW(s_This, "Asset manager is not created!");
+        return s_This;
+    }
+
+    AssetManager::AssetManager() noexcept : m_PendingCount{},
+                                            m_IsStopping{},
+                                            m_TextureEncoding{},
+                                            m_UploadBudget{ defaultUploadBudget } {
+    }
+
+    AssetManager::~AssetManager() {
+        Destroy();
+    }
+
+    void AssetManager::Create(std::uint32_t threadCount, float uploadBudget) {
+        s_This         = this;
+        m_UploadBudget    = uploadBudget;
+        m_IsStopping      = false;
+        m_TextureEncoding = TextureCache::GetEncoding();
+        m_ThreadPool.Create(threadCount);
+
+        // Magenta and black checker, a missing texture stands out
+        constexpr std::uint32_t size{ 8u };
+        std::uint32_t pixels[size * size];
+        for (std::uint32_t y{}; y != size; ++y) {
+            for (std::uint32_t x{}; x != size; ++x) {
+                pixels[y * size + x] = ((x / 2u + y / 2u) & 1u) ? 0xFF000000u : 0xFFFF00FFu;
+            }
+        }
+        m_PlaceholderTexture.Create(pixels, sizeof(pixels), { size, size }, VK_IMAGE_USAGE_SAMPLED_BIT, nullptr);
+
+        Mesh cube;
+        cube.Load(vk::Context::Get()->GetDataDirectory() + "Assets/Models/cube.obj");
+        Mesh::placeholder = cube.bufferData;
+    }
+
+    void AssetManager::Destroy() noexcept {
+        if (s_This != this) {
+            return;
+        }
+        // Queued decodes are skipped, the workers only hand the jobs back
+        m_IsStopping = true;
+        m_ThreadPool.Destroy();
+        {
+            std::lock_guard lock{ m_Mutex };
+            m_Decoded = {};
+        }
+        m_PendingCount = 0u;
+
+        Mesh::placeholder = {};
+        m_PlaceholderTexture.Destroy();
+        s_This = nullptr;
+    }
+
+    void AssetManager::Submit(std::string name, DecodeFunc decode, FinishFunc finish) {
+        ++m_PendingCount;
+        // Pool tasks must be copyable, the job is owned by the task until it's queued
+        auto job{ MakeUnique<Job>(Job{ Move(name), Move(decode), Move(finish), {}, 0.0, false }).Release() };
+        m_ThreadPool.Submit([this, job](std::uint32_t) {
+            if (!m_IsStopping) {
+                Stopwatch<double> stopwatch;
+                try {
+                    job->isDecoded = job->decode();
+                } catch (const std::exception& e) {
+                    ADH_LOG("Asset: " << job->name << " " << e.what());
+                    job->isDecoded = false;
+                }
+                job->decodeTime = stopwatch.GetTime();
+            }
+            {
+                std::lock_guard lock{ m_Mutex };
+                m_Decoded.emplace(job);
+            }
+            m_DecodedCondition.notify_one();
+        });
+    }
+
+    void AssetManager::LoadTexture(ecs::World& world, ecs::Entity entity, const std::string& filePath) {
+        auto [texture]{ world.Get<vk::Texture2D>(entity) };
+        if (auto resident{ AssetRegistry::Get()->Find<vk::Texture2D>(filePath) }) {
+            texture.CreateShared(filePath.data(), resident, true);
+            return;
+        }
+        texture.CreatePlaceholder(filePath.data(), m_PlaceholderTexture, true);
+
+        auto payload{ MakeShared<TexturePayload>() };
+        Submit(
+            filePath.substr(filePath.find_last_of("/") + 1u),
+            [filePath, payload, encoding = m_TextureEncoding]() {
+                return DecodeTexture(filePath, encoding, *payload);
+            },
+            [this, &world, entity, filePath, payload, id = texture.GetDescriptorID()](bool isDecoded) {
+                if (!isDecoded || !world.Contains<vk::Texture2D>(entity)) {
+                    return;
+                }
+                auto [texture]{ world.Get<vk::Texture2D>(entity) };
+                if (!texture.IsPlaceholder() || texture.GetDescriptorID() != id || texture.GetFilePath() != filePath) {
+                    return;
+                }
+                texture.CreateShared(filePath.data(), InsertTexture(filePath, *payload), true);
+            });
+    }
+
+    void AssetManager::ReloadTexture(ecs::World& world, const std::string& filePath) {
+        // The registry would hand out the old image, it's dropped once nothing shows it anymore
+        if (auto resident{ AssetRegistry::Get()->Find<vk::Texture2D>(filePath) }) {
+            AssetRegistry::Get()->Remove<vk::Texture2D>(filePath, resident.Get());
+        }
+
+        auto payload{ MakeShared<TexturePayload>() };
+        Submit(
+            filePath.substr(filePath.find_last_of("/") + 1u),
+            [filePath, payload, encoding = m_TextureEncoding]() {
+                return DecodeTexture(filePath, encoding, *payload);
+            },
+            [this, &world, filePath, payload](bool isDecoded) {
+                if (!isDecoded) {
+                    return;
+                }
+                SharedPtr<vk::Texture2D> resident;
+                world.GetSystem<vk::Texture2D>().ForEach([&](vk::Texture2D& texture) {
+                    if (texture.GetFilePath() != filePath) {
+                        return;
+                    }
+                    if (!resident) {
+                        resident = InsertTexture(filePath, *payload);
+                    }
+                    texture.CreateShared(filePath.data(), resident, true);
+                });
+            });
+    }
+
+    void AssetManager::Update() {
+        Stopwatch<double> stopwatch;
+        while (auto job{ TakeDecoded(false) }) {
+            Finish(*job);
+            if (stopwatch.GetTime() * 1000.0 >= m_UploadBudget) {
+                break;
+            }
+        }
+    }
+
+    void AssetManager::Wait() {
+        while (auto job{ TakeDecoded(true) }) {
+            Finish(*job);
+        }
+    }
+
+    void AssetManager::Wait(const std::function<bool()>& isDone) {
+        while (!isDone()) {
+            auto job{ TakeDecoded(true) };
+            if (!job) {
+                return;
+            }
+            Finish(*job);
+        }
+    }
+
+    std::uint32_t AssetManager::GetPendingCount() const noexcept {
+        return m_PendingCount;
+    }
+
+    const vk::Texture2D& AssetManager::GetPlaceholderTexture() const noexcept {
+        return m_PlaceholderTexture;
+    }
+
+    AssetManager::TexturePayload::~TexturePayload() {
+        if (staging.size) {
+            vk::StagingBuffer::Get()->Free(staging);
+        }
+    }
+
+    bool AssetManager::DecodeTexture(const std::string& filePath, TextureCache::Encoding encoding, TexturePayload& payload) {
+        auto isCompressed{ encoding != TextureCache::Encoding::eNone };
+        if (isCompressed && TextureCache::Read(filePath, encoding, payload.cooked, payload.cache)) {
+            payload.hash = HashTexture(payload.cooked.sourceHash, payload.cooked.format, payload.cooked.extent, payload.cooked.mipLevels);
+            return true;
+        }
+        // Uncooked TGAs skip the pixel array, small ones are decoded into staging memory here
+        // and larger ones in bands into the image when they're uploaded
+        if (!isCompressed && payload.tga.Open(filePath.data())) {
+            auto& tga{ payload.tga };
+            payload.extent = { tga.GetWidth(), tga.GetHeight() };
+            payload.hash   = HashTexture(Fnv1a(tga.GetFileData(), tga.GetFileSize()), payload.extent);
+            if (tga.GetSize() <= vk::StagingBuffer::tileSize && vk::StagingBuffer::Get()->Allocate(tga.GetSize(), payload.staging)) {
+                auto isRead{ tga.Read(static_cast<std::uint8_t*>(payload.staging.data)) };
+                tga.Close();
+                return isRead;
+            }
+            return true;
+        }
+        if (!vk::Texture2D::Decode(filePath.data(), payload.pixels, payload.extent)) {
+            return false;
+        }
+        if (isCompressed && TextureCache::Cook(filePath, encoding, payload.pixels.GetData(), payload.extent) &&
+            TextureCache::Read(filePath, encoding, payload.cooked, payload.cache)) {
+            payload.hash = HashTexture(payload.cooked.sourceHash, payload.cooked.format, payload.cooked.extent, payload.cooked.mipLevels);
+            payload.pixels.Clear();
+            return true;
+        }
+        payload.hash = HashTexture(Fnv1a(payload.pixels.GetData(), payload.pixels.GetSize()), payload.extent);
+        return true;
+    }
+
+    SharedPtr<vk::Texture2D> AssetManager::InsertTexture(const std::string& filePath, TexturePayload& payload) {
+        // Another entity may have loaded the file or an identical one meanwhile
+        const auto& cooked{ payload.cooked };
+        auto size{ payload.cache.IsOpen() ? cooked.size : std::size_t{ 4u } * payload.extent.width * payload.extent.height };
+        return AssetRegistry::Get()->Insert<vk::Texture2D>(filePath, payload.hash, size, [&]() {
+            auto newTexture{ MakeShared<vk::Texture2D>() };
+            if (payload.cache.IsOpen()) {
+                newTexture->CreateCompressed(cooked.data, cooked.size, cooked.format, cooked.extent, cooked.mipLevels);
+            } else if (payload.staging.size) {
+                newTexture->CreateFromStaging(payload.staging, payload.extent);
+                vk::StagingBuffer::Get()->Free(payload.staging);
+            } else if (payload.tga.IsOpen()) {
+                // A truncated file is only found out here, it keeps showing the placeholder
+                if (!newTexture->CreateFromTGA(payload.tga)) {
+                    newTexture->CreatePlaceholder(filePath.data(), m_PlaceholderTexture);
+                }
+                payload.tga.Close();
+            } else {
+                newTexture->CreateFromPixels(payload.pixels.GetData(), payload.extent);
+            }
+            return newTexture;
+        });
+    }
+
+    UniquePtr<AssetManager::Job> AssetManager::TakeDecoded(bool isBlocking) {
+        std::unique_lock lock{ m_Mutex };
+        if (isBlocking) {
+            // Pending jobs that aren't queued are still decoding and will be
+            m_DecodedCondition.wait(lock, [this]() { return !m_Decoded.empty() || !m_PendingCount; });
+        }
+        if (m_Decoded.empty()) {
+            return {};
+        }
+        auto job{ Move(m_Decoded.front()) };
+        m_Decoded.pop();
+        return job;
+    }
+
+    void AssetManager::Finish(Job& job) {
+        Stopwatch<double> stopwatch;
+        job.finish(job.isDecoded);
+        auto uploadTime{ stopwatch.GetTime() };
+        --m_PendingCount;
+
+        if (!job.isDecoded) {
+            std::string s{ "[" + job.name + "] Failed to load!" };
+            Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eError, s.data());
+            return;
+        }
+        std::string s{ "[" + job.name + "] Loaded in " + std::to_string(job.stopwatch.GetTime() * 1000.0) +
+                       " ms (decode " + std::to_string(job.decodeTime * 1000.0) + " ms, upload " +
+                       std::to_string(uploadTime * 1000.0) + " ms)" };
+        ADH_LOG("Asset: " << s);
+        Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eLog, s.data());
+    }
+} // namespace adh
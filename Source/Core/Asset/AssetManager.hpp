@@ -0,0 +1,128 @@
+#pragma once
+#include "TextureCache.hpp"
+#include <Entity/Entity.hpp>
+#include <Std/Stopwatch.hpp>
+#include <Std/TGALoader.hpp>
+#include <Std/ThreadPool.hpp>
+#include <Std/UniquePtr.hpp>
+#include <Vulkan/StagingBuffer.hpp>
+#include <Vulkan/Texture2D.hpp>
+#include <Utility.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+
+namespace adh {
+    class Mesh;
+
+    // Streams assets in without stalling the frame. Files are read and decoded on worker threads,
+    // the GPU and audio objects are created on the main thread by Update() until its upload budget
+    // is spent, the copies go through the transfer queue. Meshes and textures resolve to a
+    // placeholder until they're uploaded. Every asset logs how long it took from the request until
+    // it was ready to the editor console.
+    class AssetManager {
+      public:
+        // Runs on a worker, returns false if the asset can't be read
+        using DecodeFunc = std::function<bool()>;
+        // Runs on the main thread, also after a failed decode to clean up
+        using FinishFunc = std::function<void(bool isDecoded)>;
+
+        static constexpr float defaultUploadBudget{ 4.0f }; // Milliseconds per Update()
+
+      public:
+        static AssetManager* Get() ADH_NOEXCEPT;
+
+        AssetManager() noexcept;
+
+        AssetManager(const AssetManager& rhs) = delete;
+
+        AssetManager& operator=(const AssetManager& rhs) = delete;
+
+        ~AssetManager();
+
+        // Loads the placeholders, they must be loadable synchronously
+        void Create(std::uint32_t threadCount, float uploadBudget = defaultUploadBudget);
+
+        // Drops every request still in flight, decodes that already started finish first
+        void Destroy() noexcept;
+
+        void Submit(std::string name, DecodeFunc decode, FinishFunc finish);
+
+        // The texture component of the entity shows the placeholder until the image is uploaded,
+        // a file in the AssetRegistry is shared right away. The image comes from the TextureCache
+        // if the device samples block compressed images, it's cooked if there is no cache yet.
+        // Otherwise TGAs are decoded straight into the StagingBuffer.
+        // The component is looked up again once the image is decoded, nothing happens if it was
+        // removed or loaded another file meanwhile.
+        void LoadTexture(ecs::World& world, ecs::Entity entity, const std::string& filePath);
+
+        // Decodes a changed file again and swaps every texture component showing it over once the
+        // new image is uploaded, they keep the old image until then
+        void ReloadTexture(ecs::World& world, const std::string& filePath);
+
+        // Finishes decoded assets in the order they were decoded, at least one per call
+        void Update();
+
+        // Blocks until every asset requested so far is finished
+        void Wait();
+
+        // Blocks until isDone returns true or nothing is left to finish
+        void Wait(const std::function<bool()>& isDone);
+
+        std::uint32_t GetPendingCount() const noexcept;
+
+        const vk::Texture2D& GetPlaceholderTexture() const noexcept;
+
+      private:
+        struct Job {
+            std::string name;
+            DecodeFunc decode;
+            FinishFunc finish;
+            Stopwatch<double> stopwatch; // Started at the request
+            double decodeTime;
+            bool isDecoded;
+        };
+
+        struct TexturePayload {
+            ~TexturePayload();
+
+            Array<std::uint8_t> pixels;
+            VkExtent2D extent;
+            std::uint64_t hash;
+            TextureCache::Texture cooked;
+            MappedFile cache;                  // Open if the image is cooked, until it's uploaded
+            TGALoader tga;                     // Open if the image is decoded while it's uploaded
+            vk::StagingBuffer::Region staging; // The decoded image if it's neither
+        };
+
+      private:
+        // Takes one decoded job, blocks for it if isBlocking. Returns null if none is left.
+        UniquePtr<Job> TakeDecoded(bool isBlocking);
+
+        void Finish(Job& job);
+
+        // On a worker, from the TextureCache if the device samples block compressed images
+        static bool DecodeTexture(const std::string& filePath, TextureCache::Encoding encoding, TexturePayload& payload);
+
+        // The registered texture of the file, created from the payload unless it's resident
+        SharedPtr<vk::Texture2D> InsertTexture(const std::string& filePath, TexturePayload& payload);
+
+      private:
+        inline static AssetManager* s_This;
+
+      private:
+        ThreadPool m_ThreadPool;
+        std::queue<UniquePtr<Job>> m_Decoded; // Guarded by m_Mutex, in decode order
+        std::mutex m_Mutex;
+        std::condition_variable m_DecodedCondition;
+        std::atomic<std::uint32_t> m_PendingCount;
+        std::atomic<bool> m_IsStopping;
+        vk::Texture2D m_PlaceholderTexture;
+        TextureCache::Encoding m_TextureEncoding;
+        float m_UploadBudget;
+    };
+} // namespace adh
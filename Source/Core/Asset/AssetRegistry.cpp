@@ -0,0 +1,101 @@
+#include "AssetRegistry.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace adh {
+    AssetRegistry* AssetRegistry::Get() ADH_NOEXCEPT {
+        ADH_THROW(s_This, "Asset registry is not created!");
+        return s_This;
+    }
+
+    AssetRegistry::AssetRegistry() noexcept : m_Statistics{},
+                                              m_Budget{ defaultBudget },
+                                              m_Frame{},
+                                              m_FrameCount{} {
+    }
+
+    AssetRegistry::~AssetRegistry() {
+        Destroy();
+    }
+
+    void AssetRegistry::Create(std::uint32_t frameCount, std::size_t budget) {
+        s_This       = this;
+        m_Budget     = budget;
+        m_FrameCount = frameCount;
+        if (auto megabytes{ std::getenv("ADH_ASSET_BUDGET_MB") }) {
+            m_Budget = static_cast<std::size_t>(std::strtoull(megabytes, nullptr, 10)) << 20u;
+        }
+    }
+
+    void AssetRegistry::Destroy() noexcept {
+        if (s_This != this) {
+            return;
+        }
+        m_Contents.clear();
+        m_Paths.clear();
+        m_Entries.clear();
+        m_Statistics = {};
+        s_This       = nullptr;
+    }
+
+    void AssetRegistry::SetSize(const std::string& path, std::size_t size) noexcept {
+        if (auto it{ m_Paths.find(path) }; it != m_Paths.end()) {
+            m_Statistics.residentBytes += size - it->second->size;
+            it->second->size = size;
+        }
+    }
+
+    void AssetRegistry::Update() {
+        ++m_Frame;
+        Array<Entry*> unused;
+        for (const auto& [path, entry] : m_Entries) {
+            if (entry->IsUsed()) {
+                entry->lastUse = m_Frame;
+            } else if (m_Frame - entry->lastUse > m_FrameCount) {
+                unused.EmplaceBack(entry.get());
+            }
+        }
+        if (m_Statistics.residentBytes <= m_Budget || unused.IsEmpty()) {
+            return;
+        }
+
+        std::sort(unused.GetData(), unused.GetData() + unused.GetSize(), [](const Entry* lhs, const Entry* rhs) {
+            return lhs->lastUse < rhs->lastUse;
+        });
+        for (auto entry : unused) {
+            if (m_Statistics.residentBytes <= m_Budget) {
+                break;
+            }
+            RemoveEntry(entry);
+            ++m_Statistics.evictions;
+        }
+    }
+
+    const AssetRegistry::Statistics& AssetRegistry::GetStatistics() const noexcept {
+        return m_Statistics;
+    }
+
+    void AssetRegistry::AddEntry(const std::string& path, std::unique_ptr<Entry> entry) {
+        m_Statistics.residentBytes += entry->size;
+        ++m_Statistics.assetCount;
+        m_Paths[path] = entry.get();
+        if (entry->content.hash) {
+            m_Contents.emplace(entry->content, entry.get());
+        }
+        m_Entries[path] = Move(entry);
+    }
+
+    void AssetRegistry::RemoveEntry(Entry* entry) noexcept {
+        m_Statistics.residentBytes -= entry->size;
+        --m_Statistics.assetCount;
+        if (auto it{ m_Contents.find(entry->content) }; it != m_Contents.end() && it->second == entry) {
+            m_Contents.erase(it);
+        }
+        for (const auto& path : entry->paths) {
+            m_Paths.erase(path);
+        }
+        // Last, the path is owned by the entry
+        m_Entries.erase(std::string{ entry->paths[0] });
+    }
+} // namespace adh
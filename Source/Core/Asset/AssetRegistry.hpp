@@ -0,0 +1,184 @@
+#pragma once
+#include <Std/Array.hpp>
+#include <Std/SharedPtr.hpp>
+#include <Utility.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace adh {
+    // Loaded assets of every type, looked up by file path and by the type, hash and size of their
+    // contents so a file copied under another name shares the first one. Handles are SharedPtrs, an asset is
+    // unused once the registry holds its only reference. Unused assets are evicted least recently
+    // used first while more than the budget is resident.
+    class AssetRegistry {
+      public:
+        static constexpr std::size_t defaultBudget{ std::size_t{ 1024u } << 20u }; // Bytes, ADH_ASSET_BUDGET_MB overrides it
+
+        struct Statistics {
+            std::uint64_t hits;       // Found by path
+            std::uint64_t misses;     // Not resident, decoded
+            std::uint64_t duplicates; // Decoded, but the contents were already resident
+            std::uint64_t evictions;
+            std::size_t residentBytes;
+            std::uint32_t assetCount;
+        };
+
+      public:
+        static AssetRegistry* Get() ADH_NOEXCEPT;
+
+        AssetRegistry() noexcept;
+
+        AssetRegistry(const AssetRegistry& rhs) = delete;
+
+        AssetRegistry& operator=(const AssetRegistry& rhs) = delete;
+
+        ~AssetRegistry();
+
+        // Unused assets are kept for frameCount frames, until no frame in flight can read them
+        void Create(std::uint32_t frameCount, std::size_t budget = defaultBudget);
+
+        // Assets still in use stay alive with their handles
+        void Destroy() noexcept;
+
+        // Null if the file isn't resident, counted as a hit or a miss
+        template <typename T>
+        SharedPtr<T> Find(const std::string& path) {
+            auto entry{ GetEntry<T>(path) };
+            if (!entry) {
+                ++m_Statistics.misses;
+                return {};
+            }
+            ++m_Statistics.hits;
+            entry->lastUse = m_Frame;
+            return entry->asset;
+        }
+
+        // Registers the asset create() makes for a decoded file of size bytes. If the file, or
+        // contents of the same type, hash and size, are resident already that asset is returned
+        // instead and create() isn't called. hash is zero if the contents aren't compared.
+        template <typename T, typename Func>
+        SharedPtr<T> Insert(const std::string& path, std::uint64_t hash, std::size_t size, Func&& create) {
+            if (auto entry{ GetEntry<T>(path) }) {
+                ++m_Statistics.hits;
+                entry->lastUse = m_Frame;
+                return entry->asset;
+            }
+            ContentKey content{ typeid(T), hash, size };
+            if (hash) {
+                if (auto it{ m_Contents.find(content) }; it != m_Contents.end()) {
+                    auto entry{ static_cast<TypedEntry<T>*>(it->second) };
+                    m_Paths[path] = entry;
+                    entry->paths.emplace_back(path);
+                    ++m_Statistics.duplicates;
+                    entry->lastUse = m_Frame;
+                    return entry->asset;
+                }
+            }
+
+            auto newEntry{ std::make_unique<TypedEntry<T>>() };
+            newEntry->asset   = create();
+            newEntry->content = content;
+            newEntry->size    = size;
+            newEntry->lastUse = m_Frame;
+            newEntry->paths.emplace_back(path);
+            AddEntry(path, Move(newEntry));
+            return GetEntry<T>(path)->asset;
+        }
+
+        // For assets that only know their size once they're uploaded
+        void SetSize(const std::string& path, std::size_t size) noexcept;
+
+        // Removes path if it still refers to asset, the asset lives on with its handles
+        template <typename T>
+        void Remove(const std::string& path, const T* asset) {
+            if (auto entry{ GetEntry<T>(path) }; entry && entry->asset.Get() == asset) {
+                RemoveEntry(entry);
+            }
+        }
+
+        // Drops every asset of type T, used or not
+        template <typename T>
+        void Clear() {
+            Array<Entry*> entries;
+            for (const auto& [path, entry] : m_Entries) {
+                if (dynamic_cast<TypedEntry<T>*>(entry.get())) {
+                    entries.EmplaceBack(entry.get());
+                }
+            }
+            for (auto entry : entries) {
+                RemoveEntry(entry);
+            }
+        }
+
+        // Once per frame
+        void Update();
+
+        const Statistics& GetStatistics() const noexcept;
+
+      private:
+        // The size is the one inserted with, SetSize() doesn't change it
+        struct ContentKey {
+            std::type_index type{ typeid(void) };
+            std::uint64_t hash;
+            std::size_t size;
+
+            bool operator==(const ContentKey& rhs) const noexcept = default;
+        };
+
+        struct ContentKeyHash {
+            std::size_t operator()(const ContentKey& key) const noexcept {
+                return static_cast<std::size_t>(key.hash ^ (key.size * 0x9e3779b97f4a7c15ull)) ^ key.type.hash_code();
+            }
+        };
+
+        struct Entry {
+            virtual ~Entry() = default;
+
+            virtual bool IsUsed() const noexcept = 0;
+
+            std::vector<std::string> paths; // The first one owns the entry, the rest are identical files
+            ContentKey content;
+            std::size_t size;
+            std::uint64_t lastUse; // Frame
+        };
+
+        template <typename T>
+        struct TypedEntry : Entry {
+            bool IsUsed() const noexcept override {
+                return asset.GetReferenceCount() > 1u;
+            }
+
+            SharedPtr<T> asset;
+        };
+
+      private:
+        template <typename T>
+        TypedEntry<T>* GetEntry(const std::string& path) {
+            auto it{ m_Paths.find(path) };
+            return it == m_Paths.end() ? nullptr : dynamic_cast<TypedEntry<T>*>(it->second);
+        }
+
+        void AddEntry(const std::string& path, std::unique_ptr<Entry> entry);
+
+        void RemoveEntry(Entry* entry) noexcept;
+
+      private:
+        inline static AssetRegistry* s_This;
+
+      private:
+        std::unordered_map<std::string, std::unique_ptr<Entry>> m_Entries; // By the first path
+        std::unordered_map<std::string, Entry*> m_Paths;
+        std::unordered_map<ContentKey, Entry*, ContentKeyHash> m_Contents;
+        Statistics m_Statistics;
+        std::size_t m_Budget;
+        std::uint64_t m_Frame;
+        std::uint32_t m_FrameCount;
+    };
+} // namespace adh
@@ -0,0 +1,308 @@
+#include "BlockCompressor.hpp"
+#include <Math/Math.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace adh {
+    namespace {
+        // Pixels of one block, rows of four
+        struct Block {
+            alignas(16) std::uint8_t pixels[64];
+        };
+
+        void LoadBlock(const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height, std::uint32_t x, std::uint32_t y, Block& block) noexcept {
+            for (std::uint32_t row{}; row != 4u; ++row) {
+                // Blocks at the edges repeat the last row and column
+                auto source{ pixels + std::size_t{ 4u } * width * std::min(y + row, height - 1u) };
+                if (x + 4u <= width) {
+                    std::memcpy(block.pixels + row * 16u, source + std::size_t{ 4u } * x, 16u);
+                    continue;
+                }
+                for (std::uint32_t column{}; column != 4u; ++column) {
+                    std::memcpy(block.pixels + row * 16u + column * 4u, source + std::size_t{ 4u } * std::min(x + column, width - 1u), 4u);
+                }
+            }
+        }
+
+        void GetBounds(const Block& block, std::uint8_t* min, std::uint8_t* max) noexcept {
+            auto p0{ _mm_load_si128(reinterpret_cast<const __m128i*>(block.pixels)) };
+            auto p1{ _mm_load_si128(reinterpret_cast<const __m128i*>(block.pixels + 16u)) };
+            auto p2{ _mm_load_si128(reinterpret_cast<const __m128i*>(block.pixels + 32u)) };
+            auto p3{ _mm_load_si128(reinterpret_cast<const __m128i*>(block.pixels + 48u)) };
+            auto low{ _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3)) };
+            auto high{ _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3)) };
+            // Folds the four pixels of a register into the first one
+            low  = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+            low  = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+            high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+            high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+            auto lowPixel{ _mm_cvtsi128_si32(low) };
+            auto highPixel{ _mm_cvtsi128_si32(high) };
+            std::memcpy(min, &lowPixel, 4u);
+            std::memcpy(max, &highPixel, 4u);
+        }
+
+        // Points the box diagonal along the pixels, a channel falling while the widest one rises
+        // swaps its ends
+        void SelectDiagonal(const Block& block, int* min, int* max, std::uint32_t channelCount) noexcept {
+            std::uint32_t widest{};
+            for (std::uint32_t c{ 1u }; c != channelCount; ++c) {
+                if (max[c] - min[c] > max[widest] - min[widest]) {
+                    widest = c;
+                }
+            }
+            int covariance[4]{};
+            for (std::uint32_t i{}; i != 16u; ++i) {
+                auto pixel{ block.pixels + i * 4u };
+                auto d{ 2 * pixel[widest] - min[widest] - max[widest] };
+                for (std::uint32_t c{}; c != channelCount; ++c) {
+                    covariance[c] += d * (2 * pixel[c] - min[c] - max[c]);
+                }
+            }
+            for (std::uint32_t c{}; c != channelCount; ++c) {
+                if (covariance[c] < 0) {
+                    std::swap(min[c], max[c]);
+                }
+            }
+        }
+
+        // Moves the ends in by a sixteenth, the extremes are rarely worth a whole palette entry
+        void Inset(int* min, int* max, std::uint32_t channelCount) noexcept {
+            for (std::uint32_t c{}; c != channelCount; ++c) {
+                auto inset{ (max[c] - min[c]) / 16 };
+                min[c] += inset;
+                max[c] -= inset;
+            }
+        }
+
+        // Palette position of every pixel on the line from e0 to e1 with levelCount evenly spaced
+        // entries, four pixels per iteration. Channels that are equal in e0 and e1 don't count.
+        void Project(const Block& block, const int* e0, const int* e1, int levelCount, std::uint8_t* positions) noexcept {
+            int d[4];
+            int lengthSquared{};
+            for (std::uint32_t c{}; c != 4u; ++c) {
+                d[c] = e1[c] - e0[c];
+                lengthSquared += d[c] * d[c];
+            }
+            if (!lengthSquared) {
+                std::memset(positions, 0, 16u);
+                return;
+            }
+
+            auto axis{ _mm_setr_epi16(d[0], d[1], d[2], d[3], d[0], d[1], d[2], d[3]) };
+            auto origin{ _mm_setr_epi16(e0[0], e0[1], e0[2], e0[3], e0[0], e0[1], e0[2], e0[3]) };
+            auto scale{ _mm_set1_ps(static_cast<float>(levelCount - 1) / static_cast<float>(lengthSquared)) };
+            auto last{ _mm_set1_epi16(static_cast<short>(levelCount - 1)) };
+            auto zero{ _mm_setzero_si128() };
+            for (std::uint32_t i{}; i != 16u; i += 4u) {
+                auto p{ _mm_load_si128(reinterpret_cast<const __m128i*>(block.pixels + i * 4u)) };
+                auto low{ _mm_sub_epi16(_mm_unpacklo_epi8(p, zero), origin) };
+                auto high{ _mm_sub_epi16(_mm_unpackhi_epi8(p, zero), origin) };
+                // rg and ba halves of the dot products of two pixels each, added across registers
+                auto lowDot{ _mm_castsi128_ps(_mm_madd_epi16(low, axis)) };
+                auto highDot{ _mm_castsi128_ps(_mm_madd_epi16(high, axis)) };
+                auto rg{ _mm_castps_si128(_mm_shuffle_ps(lowDot, highDot, _MM_SHUFFLE(2, 0, 2, 0))) };
+                auto ba{ _mm_castps_si128(_mm_shuffle_ps(lowDot, highDot, _MM_SHUFFLE(3, 1, 3, 1))) };
+                auto dot{ _mm_add_epi32(rg, ba) };
+
+                auto t{ _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(dot), scale)) };
+                auto t16{ _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(t, t), zero), last) };
+                auto bytes{ _mm_cvtsi128_si32(_mm_packus_epi16(t16, t16)) };
+                std::memcpy(positions + i, &bytes, 4u);
+            }
+        }
+
+        std::uint16_t To565(const int* color) noexcept {
+            return static_cast<std::uint16_t>(((color[0] * 31 + 127) / 255) << 11 |
+                                              ((color[1] * 63 + 127) / 255) << 5 |
+                                              ((color[2] * 31 + 127) / 255));
+        }
+
+        void From565(std::uint16_t value, int* color) noexcept {
+            int r{ value >> 11 };
+            int g{ (value >> 5) & 63 };
+            int b{ value & 31 };
+            color[0] = (r << 3) | (r >> 2);
+            color[1] = (g << 2) | (g >> 4);
+            color[2] = (b << 3) | (b >> 2);
+            color[3] = 0;
+        }
+
+        // BC1 block, also the colour half of BC3
+        void CompressColor(const Block& block, std::uint8_t* out) noexcept {
+            std::uint8_t low[4], high[4];
+            GetBounds(block, low, high);
+            int min[4]{ low[0], low[1], low[2] };
+            int max[4]{ high[0], high[1], high[2] };
+            SelectDiagonal(block, min, max, 3u);
+            Inset(min, max, 3u);
+
+            // c0 > c1 is the four colour mode
+            auto c0{ To565(max) };
+            auto c1{ To565(min) };
+            if (c0 < c1) {
+                std::swap(c0, c1);
+            }
+            std::uint32_t indices{};
+            if (c0 != c1) {
+                int e0[4], e1[4];
+                From565(c0, e0);
+                From565(c1, e1);
+                std::uint8_t positions[16];
+                Project(block, e0, e1, 4, positions);
+                // The palette is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+                constexpr std::uint32_t palette[4]{ 0u, 2u, 3u, 1u };
+                for (std::uint32_t i{}; i != 16u; ++i) {
+                    indices |= palette[positions[i]] << (i * 2u);
+                }
+            }
+            std::memcpy(out, &c0, 2u);
+            std::memcpy(out + 2u, &c1, 2u);
+            std::memcpy(out + 4u, &indices, 4u);
+        }
+
+        // BC4 block of one channel, the alpha half of BC3 and both halves of BC5
+        void CompressChannel(const Block& block, std::uint32_t channel, std::uint8_t* out) noexcept {
+            std::uint8_t low[4], high[4];
+            GetBounds(block, low, high);
+
+            // a0 > a1 is the eight value mode, both ends stay exact so cutouts remain cutouts
+            std::uint64_t indices{};
+            if (high[channel] != low[channel]) {
+                int e0[4]{};
+                int e1[4]{};
+                e0[channel] = high[channel];
+                e1[channel] = low[channel];
+                std::uint8_t positions[16];
+                Project(block, e0, e1, 8, positions);
+                // The palette is a0, a1, then six steps from a0 towards a1
+                constexpr std::uint64_t palette[8]{ 0u, 2u, 3u, 4u, 5u, 6u, 7u, 1u };
+                for (std::uint32_t i{}; i != 16u; ++i) {
+                    indices |= palette[positions[i]] << (i * 3u);
+                }
+            }
+            out[0] = high[channel];
+            out[1] = low[channel];
+            std::memcpy(out + 2u, &indices, 6u);
+        }
+
+        // Seven bits per channel and a p-bit that is the lowest bit of all four, the p-bit with the
+        // smaller error wins
+        std::uint32_t QuantizeEndpoint(const int* color, int* quantized, int* expanded) noexcept {
+            std::uint32_t bestBit{};
+            int bestError{ -1 };
+            for (std::uint32_t bit{}; bit != 2u; ++bit) {
+                int error{};
+                int values[4];
+                for (std::uint32_t c{}; c != 4u; ++c) {
+                    values[c] = std::min((color[c] - static_cast<int>(bit) + 1) >> 1, 127);
+                    auto d{ ((values[c] << 1) | static_cast<int>(bit)) - color[c] };
+                    error += d * d;
+                }
+                if (bestError < 0 || error < bestError) {
+                    bestError = error;
+                    bestBit   = bit;
+                    std::memcpy(quantized, values, sizeof(values));
+                }
+            }
+            for (std::uint32_t c{}; c != 4u; ++c) {
+                expanded[c] = (quantized[c] << 1) | static_cast<int>(bestBit);
+            }
+            return bestBit;
+        }
+
+        class BitWriter {
+          public:
+            BitWriter(std::uint8_t* out, std::size_t size) noexcept : m_Out{ out }, m_Offset{} {
+                std::memset(out, 0, size);
+            }
+
+            void Write(std::uint32_t value, std::uint32_t count) noexcept {
+                for (std::uint32_t i{}; i != count; ++i, ++m_Offset) {
+                    m_Out[m_Offset >> 3u] |= static_cast<std::uint8_t>(((value >> i) & 1u) << (m_Offset & 7u));
+                }
+            }
+
+          private:
+            std::uint8_t* m_Out;
+            std::uint32_t m_Offset;
+        };
+
+        // BC7 mode 6, one subset of RGBA endpoints with 16 palette entries
+        void CompressBC7(const Block& block, std::uint8_t* out) noexcept {
+            std::uint8_t low[4], high[4];
+            GetBounds(block, low, high);
+            int min[4]{ low[0], low[1], low[2], low[3] };
+            int max[4]{ high[0], high[1], high[2], high[3] };
+            SelectDiagonal(block, min, max, 4u);
+
+            int q0[4], q1[4], e0[4], e1[4];
+            auto p0{ QuantizeEndpoint(min, q0, e0) };
+            auto p1{ QuantizeEndpoint(max, q1, e1) };
+            std::uint8_t positions[16];
+            Project(block, e0, e1, 16, positions);
+
+            // The highest index bit of the first pixel is implied zero
+            if (positions[0] & 8u) {
+                std::swap(q0, q1);
+                std::swap(p0, p1);
+                for (auto& position : positions) {
+                    position = static_cast<std::uint8_t>(15u - position);
+                }
+            }
+
+            BitWriter writer{ out, 16u };
+            writer.Write(1u << 6u, 7u);
+            for (std::uint32_t c{}; c != 4u; ++c) {
+                writer.Write(static_cast<std::uint32_t>(q0[c]), 7u);
+                writer.Write(static_cast<std::uint32_t>(q1[c]), 7u);
+            }
+            writer.Write(p0, 1u);
+            writer.Write(p1, 1u);
+            writer.Write(positions[0], 3u);
+            for (std::uint32_t i{ 1u }; i != 16u; ++i) {
+                writer.Write(positions[i], 4u);
+            }
+        }
+    } // namespace
+
+    std::size_t BlockCompressor::GetBlockSize(Format format) noexcept {
+        return format == Format::eBC1 ? 8u : 16u;
+    }
+
+    std::size_t BlockCompressor::GetSize(Format format, std::uint32_t width, std::uint32_t height) noexcept {
+        return GetBlockSize(format) * ((width + 3u) / 4u) * ((height + 3u) / 4u);
+    }
+
+    void BlockCompressor::Compress(Format format, const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height, std::uint8_t* blocks) noexcept {
+        auto blockSize{ GetBlockSize(format) };
+        Block block;
+        for (std::uint32_t y{}; y < height; y += 4u) {
+            for (std::uint32_t x{}; x < width; x += 4u) {
+                LoadBlock(pixels, width, height, x, y, block);
+                switch (format) {
+                case Format::eBC1:
+                    CompressColor(block, blocks);
+                    break;
+
+                case Format::eBC3:
+                    CompressChannel(block, 3u, blocks);
+                    CompressColor(block, blocks + 8u);
+                    break;
+
+                case Format::eBC5:
+                    CompressChannel(block, 0u, blocks);
+                    CompressChannel(block, 1u, blocks + 8u);
+                    break;
+
+                case Format::eBC7:
+                    CompressBC7(block, blocks);
+                    break;
+                }
+                blocks += blockSize;
+            }
+        }
+    }
+} // namespace adh
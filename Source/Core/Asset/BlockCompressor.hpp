@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace adh {
+    // Encodes RGBA8 pixels into 4x4 blocks of the BC formats. Endpoints are the corners of the
+    // bounding box of each block along the diagonal the pixels follow, the pixels are projected
+    // onto it four at a time with SSE. Good enough for cooking textures offline, it doesn't search
+    // for better endpoints or partitions.
+    class BlockCompressor {
+      public:
+        enum class Format : std::uint32_t {
+            eBC1, // RGB, 4 bits per pixel
+            eBC3, // RGBA, 8 bits per pixel
+            eBC5, // RG, 8 bits per pixel
+            eBC7  // RGBA, 8 bits per pixel, only mode 6
+        };
+
+      public:
+        static std::size_t GetBlockSize(Format format) noexcept;
+
+        // Bytes of a width x height image, partial blocks at the edges are whole blocks
+        static std::size_t GetSize(Format format, std::uint32_t width, std::uint32_t height) noexcept;
+
+        // blocks must hold GetSize() bytes, rows of blocks from the top left
+        static void Compress(Format format, const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height, std::uint8_t* blocks) noexcept;
+    };
+} // namespace adh
@@ -0,0 +1,130 @@
+#include "CacheFile.hpp"
+#include <Std/Hash.hpp>
+#include <Std/VirtualFileSystem.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+namespace adh {
+    std::string CacheFile::GetPath(const std::string& dataDirectory, const std::string& sourcePath, std::string_view directory,
+                                   std::string_view extension) {
+        // Files with the same name in different directories get their own cache
+        std::string_view key{ sourcePath };
+        if (!key.compare(0u, dataDirectory.size(), dataDirectory)) {
+            key.remove_prefix(dataDirectory.size());
+        }
+        char hash[16];
+        auto end{ std::to_chars(hash, hash + sizeof(hash), Fnv1a(key), 16).ptr };
+        auto name{ sourcePath.substr(sourcePath.find_last_of('/') + 1u) };
+        std::string path{ dataDirectory };
+        path.append("Resources/").append(directory).append("/").append(name).append(".").append(hash, end).append(extension);
+        return path;
+    }
+
+    bool CacheFile::GetSource(const std::string& sourcePath, Source& source) {
+        if (!VirtualFileSystem::GetStatus(sourcePath, source.size, source.time)) {
+            return false;
+        }
+        source.hash = HashFile(sourcePath);
+        return true;
+    }
+
+    bool CacheFile::Validate(const std::string& sourcePath, const std::string& cachePath, std::size_t sourceOffset, MappedFile& cache) {
+        if (cache.GetSize() < sourceOffset + sizeof(Source)) {
+            return false;
+        }
+        const auto* bytes{ static_cast<const char*>(cache.GetData()) };
+        Source cached;
+        std::memcpy(&cached, bytes + sourceOffset, sizeof(Source));
+        std::uint64_t sourceSize;
+        std::int64_t sourceTime;
+        if (!VirtualFileSystem::GetStatus(sourcePath, sourceSize, sourceTime) || sourceSize != cached.size) {
+            return false;
+        }
+        if (sourceTime == cached.time) {
+            return true;
+        }
+        if (HashFile(sourcePath) != cached.hash) {
+            return false;
+        }
+
+        // Same contents under a new time. Never patched in place, other workers may have the cache
+        // mapped. The copy is renamed over it once this mapping is closed.
+        if (VirtualFileSystem::IsPacked(cachePath)) {
+            return true;
+        }
+        cached.time = sourceTime;
+        auto tempPath{ GetTempPath(cachePath) };
+        auto tailOffset{ sourceOffset + sizeof(Source) };
+        if (!WriteTemp(tempPath, { { 0u, bytes, sourceOffset },
+                                   { sourceOffset, &cached, sizeof(Source) },
+                                   { tailOffset, bytes + tailOffset, cache.GetSize() - tailOffset } })) {
+            return true;
+        }
+        cache.Close();
+        Commit(tempPath, cachePath);
+        return VirtualFileSystem::Open(cachePath, cache);
+    }
+
+    bool CacheFile::Write(const std::string& cachePath, std::initializer_list<Blob> blobs) {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path{ cachePath }.parent_path(), error);
+        auto tempPath{ GetTempPath(cachePath) };
+        return WriteTemp(tempPath, blobs) && Commit(tempPath, cachePath);
+    }
+
+    std::uint64_t CacheFile::HashFile(const std::string& filePath) noexcept {
+        MappedFile file;
+        if (!VirtualFileSystem::Open(filePath, file)) {
+            return 0u;
+        }
+        return Fnv1a(file.GetData(), file.GetSize());
+    }
+
+    std::string CacheFile::GetTempPath(const std::string& cachePath) {
+        return cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    }
+
+    bool CacheFile::WriteTemp(const std::string& tempPath, std::initializer_list<Blob> blobs) {
+        {
+            std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+            if (!file) {
+                return false;
+            }
+            const char zeros[64]{};
+            std::uint64_t offset{};
+            for (const auto& blob : blobs) {
+                while (file && offset < blob.offset) {
+                    auto size{ std::min<std::uint64_t>(blob.offset - offset, sizeof(zeros)) };
+                    file.write(zeros, static_cast<std::streamsize>(size));
+                    offset += size;
+                }
+                file.write(static_cast<const char*>(blob.data), static_cast<std::streamsize>(blob.size));
+                offset += blob.size;
+            }
+            file.close();
+            if (file) {
+                return true;
+            }
+        }
+        std::error_code error;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    bool CacheFile::Commit(const std::string& tempPath, const std::string& cachePath) {
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error) {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+} // namespace adh
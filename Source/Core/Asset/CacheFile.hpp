@@ -0,0 +1,58 @@
+#pragma once
+#include <Std/MappedFile.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace adh {
+    // What the caches share, each only adds its header layout and payload. A cache is kept next to
+    // the data directory, named after its source and keyed on the source path below the data
+    // directory. It's reused while its source has the size and last write time it was written
+    // with. A source with a new time but the same size is hashed, if the contents didn't change
+    // the cache is kept and its time refreshed.
+    class CacheFile {
+      public:
+        // Stored in the cache headers, as the loaders read the source, packed or loose
+        struct Source {
+            std::uint64_t size;
+            std::int64_t time; // Ticks of the file clock
+            std::uint64_t hash;
+        };
+
+        struct Blob {
+            std::uint64_t offset; // Ascending, the gaps before are zeros
+            const void* data;
+            std::size_t size;
+        };
+
+      public:
+        // dataDirectory/Resources/directory/<file name>.<hash of the path below dataDirectory>extension
+        static std::string GetPath(const std::string& dataDirectory, const std::string& sourcePath, std::string_view directory,
+                                   std::string_view extension);
+
+        // False if the source can't be read
+        static bool GetSource(const std::string& sourcePath, Source& source);
+
+        // Checks the Source at sourceOffset of the mapped cache against sourcePath. If only the time
+        // moved on, the cache is written again with the new time and mapped again. Thread safe.
+        static bool Validate(const std::string& sourcePath, const std::string& cachePath, std::size_t sourceOffset, MappedFile& cache);
+
+        // Written next to the cache and renamed over it, a crash never leaves a torn file behind.
+        // Workers may write the same cache at once, each writes its own temp file.
+        static bool Write(const std::string& cachePath, std::initializer_list<Blob> blobs);
+
+        // FNV-1a of the whole file, zero if it can't be read
+        static std::uint64_t HashFile(const std::string& filePath) noexcept;
+
+      private:
+        static std::string GetTempPath(const std::string& cachePath);
+
+        static bool WriteTemp(const std::string& tempPath, std::initializer_list<Blob> blobs);
+
+        // Removes the temp file if it can't be renamed
+        static bool Commit(const std::string& tempPath, const std::string& cachePath);
+    };
+} // namespace adh
@@ -0,0 +1,185 @@
+#include "FileWatcher.hpp"
+#include <Event/Event.hpp>
+
+#if defined(ADH_LINUX)
+#    include <poll.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <filesystem>
+
+namespace adh {
+    FileWatcher* FileWatcher::Get() ADH_NOEXCEPT {
+        ADH_THROW(s_This, "File watcher is not created!");
+        return s_This;
+    }
+
+    FileWatcher::FileWatcher() noexcept : m_IsStopping{},
+                                          m_Handle{ -1 } {
+    }
+
+    FileWatcher::~FileWatcher() {
+        Clear();
+    }
+
+    bool FileWatcher::Create(const std::vector<std::string>& directories) {
+        Clear();
+#if defined(ADH_LINUX)
+        m_Handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_Handle == -1) {
+            return false;
+        }
+        for (const auto& directory : directories) {
+            std::error_code error;
+            if (std::filesystem::is_directory(directory, error)) {
+                AddWatch(directory.back() == '/' ? directory.substr(0u, directory.size() - 1u) : directory, false);
+            }
+        }
+        if (m_Directories.empty()) {
+            Clear();
+            return false;
+        }
+        m_IsStopping = false;
+        m_Thread     = std::thread{ [this]() { Run(); } };
+        s_This       = this;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void FileWatcher::Destroy() noexcept {
+        Clear();
+    }
+
+    void FileWatcher::Update() {
+        std::vector<Change> changes;
+        {
+            std::lock_guard lock{ m_Mutex };
+            changes.swap(m_Changes);
+        }
+        for (std::size_t i{}; i != changes.size(); ++i) {
+            const auto& change{ changes[i] };
+            auto isLast{ std::none_of(changes.begin() + i + 1u, changes.end(), [&change](const Change& next) {
+                return next.filePath == change.filePath;
+            }) };
+            if (isLast) {
+                Event::Dispatch<FileEvent>(change.type, change.filePath.data());
+            }
+        }
+    }
+
+    bool FileWatcher::IsWatching() const noexcept {
+        return m_Thread.joinable();
+    }
+
+    void FileWatcher::Run() {
+#if defined(ADH_LINUX)
+        alignas(inotify_event) char buffer[16u * 1024u];
+        pollfd descriptor{ m_Handle, POLLIN, 0 };
+        while (!m_IsStopping) {
+            if (poll(&descriptor, 1u, pollTimeout) <= 0) {
+                continue;
+            }
+            ssize_t size;
+            while ((size = read(m_Handle, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t offset{}; offset < size;) {
+                    const auto* event{ reinterpret_cast<const inotify_event*>(buffer + offset) };
+                    offset += sizeof(inotify_event) + event->len;
+
+                    // The watch is gone, its directory was removed or unwatched. The descriptor may be
+                    // handed out again for another directory.
+                    if (event->mask & IN_IGNORED) {
+                        m_Directories.erase(event->wd);
+                        continue;
+                    }
+                    auto directory{ m_Directories.find(event->wd) };
+                    if (directory == m_Directories.end() || !event->len) {
+                        continue;
+                    }
+                    auto filePath{ directory->second + "/" + event->name };
+                    if (event->mask & IN_ISDIR) {
+                        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                            AddWatch(filePath, true);
+                        } else if (event->mask & IN_MOVED_FROM) {
+                            // Watched again under its new path if it stays below a watched directory
+                            RemoveWatch(filePath);
+                        }
+                        continue;
+                    }
+
+                    // A file created empty is reported again once it's written and closed
+                    FileEvent::Type type;
+                    if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        type = FileEvent::Type::eRemoved;
+                    } else if (event->mask & IN_MOVED_TO) {
+                        type = FileEvent::Type::eCreated;
+                    } else if (event->mask & IN_CLOSE_WRITE) {
+                        type = FileEvent::Type::eModified;
+                    } else {
+                        continue;
+                    }
+                    std::lock_guard lock{ m_Mutex };
+                    m_Changes.push_back({ Move(filePath), type });
+                }
+            }
+        }
+#endif
+    }
+
+    void FileWatcher::AddWatch(const std::string& path, bool isNew) {
+#if defined(ADH_LINUX)
+        constexpr std::uint32_t mask{ IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR };
+        auto watch{ inotify_add_watch(m_Handle, path.data(), mask) };
+        if (watch == -1) {
+            return;
+        }
+        m_Directories[watch] = path;
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+            auto entryPath{ path + "/" + entry.path().filename().string() };
+            if (entry.is_directory(error)) {
+                AddWatch(entryPath, isNew);
+            } else if (isNew && entry.is_regular_file(error)) {
+                // Written before the watch existed, or moved in along with the directory
+                std::lock_guard lock{ m_Mutex };
+                m_Changes.push_back({ Move(entryPath), FileEvent::Type::eCreated });
+            }
+        }
+#endif
+    }
+
+    void FileWatcher::RemoveWatch(const std::string& path) {
+#if defined(ADH_LINUX)
+        for (auto it{ m_Directories.begin() }; it != m_Directories.end();) {
+            if (it->second == path || !it->second.compare(0u, path.size() + 1u, path + "/")) {
+                inotify_rm_watch(m_Handle, it->first);
+                it = m_Directories.erase(it);
+            } else {
+                ++it;
+            }
+        }
+#endif
+    }
+
+    void FileWatcher::Clear() noexcept {
+        m_IsStopping = true;
+        if (m_Thread.joinable()) {
+            m_Thread.join();
+        }
+#if defined(ADH_LINUX)
+        if (m_Handle != -1) {
+            close(m_Handle);
+        }
+#endif
+        m_Handle = -1;
+        m_Directories.clear();
+        m_Changes.clear();
+        if (s_This == this) {
+            s_This = nullptr;
+        }
+    }
+} // namespace adh
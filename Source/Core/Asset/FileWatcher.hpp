@@ -0,0 +1,73 @@
+#pragma once
+#include <Event/EventTypes.hpp>
+#include <Utility.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace adh {
+    // Watches directories and everything below them for files that are written, created, moved or
+    // removed. A thread blocks on inotify and queues the changes, Update() dispatches them as
+    // FileEvents on the main thread, so listeners reload assets without any locking. Writes are
+    // reported once the file is closed, editors that save through a rename report the new name.
+    // Only Linux is watched, Create() does nothing elsewhere.
+    class FileWatcher {
+      public:
+        static constexpr int pollTimeout{ 100 }; // Milliseconds, how long Destroy() waits at most
+
+      public:
+        static FileWatcher* Get() ADH_NOEXCEPT;
+
+        FileWatcher() noexcept;
+
+        FileWatcher(const FileWatcher& rhs) = delete;
+
+        FileWatcher& operator=(const FileWatcher& rhs) = delete;
+
+        ~FileWatcher();
+
+        // Directories that don't exist are skipped. Returns false if nothing can be watched.
+        bool Create(const std::vector<std::string>& directories);
+
+        void Destroy() noexcept;
+
+        // Once per frame, dispatches the changes queued since the last call. A file changed several
+        // times in between is dispatched once, with its last change.
+        void Update();
+
+        bool IsWatching() const noexcept;
+
+      private:
+        struct Change {
+            std::string filePath;
+            FileEvent::Type type;
+        };
+
+      private:
+        void Run();
+
+        // Every directory below path as well, new directories are watched once they're created.
+        // isNew reports the files already inside as created.
+        void AddWatch(const std::string& path, bool isNew);
+
+        // path and every directory below it, for a directory moved away
+        void RemoveWatch(const std::string& path);
+
+        void Clear() noexcept;
+
+      private:
+        inline static FileWatcher* s_This;
+
+      private:
+        std::thread m_Thread;
+        std::unordered_map<int, std::string> m_Directories; // By watch descriptor, only the watcher thread touches it after Create()
+        std::vector<Change> m_Changes;                        // Guarded by m_Mutex, in order
+        std::mutex m_Mutex;
+        std::atomic<bool> m_IsStopping;
+        int m_Handle; // inotify instance
+    };
+} // namespace adh
@@ -0,0 +1,256 @@
+#include "PakBuilder.hpp"
+#include <Std/Array.hpp>
+#include <Std/Hash.hpp>
+#include <Std/MappedFile.hpp>
+#include <Std/Stopwatch.hpp>
+#include <Std/VirtualFileSystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace adh {
+    namespace {
+        constexpr std::size_t minMatch{ 4u };
+        constexpr std::size_t lastLiterals{ 5u };  // The block ends with at least this many literals
+        constexpr std::size_t matchLimit{ 12u };   // No match starts closer to the end
+        constexpr std::size_t maxOffset{ 65535u };
+        constexpr std::uint32_t hashBits{ 16u };
+
+        std::uint32_t Read32(const std::uint8_t* data) noexcept {
+            std::uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        std::uint8_t* WriteLength(std::uint8_t* target, std::size_t length) noexcept {
+            for (; length >= 255u; length -= 255u) {
+                *target++ = 255u;
+            }
+            *target++ = static_cast<std::uint8_t>(length);
+            return target;
+        }
+
+        std::uint8_t* WriteLiterals(std::uint8_t* target, std::uint8_t* token, const std::uint8_t* literals, std::size_t size) noexcept {
+            *token = static_cast<std::uint8_t>(std::min(size, std::size_t{ 15u }) << 4u);
+            if (size >= 15u) {
+                target = WriteLength(target, size - 15u);
+            }
+            std::memcpy(target, literals, size);
+            return target + size;
+        }
+
+        struct File {
+            std::string filePath;
+            std::string path; // Relative to the root
+        };
+
+        std::uint64_t Align(std::uint64_t offset) noexcept {
+            return (offset + PakFile::blobAlignment - 1u) & ~static_cast<std::uint64_t>(PakFile::blobAlignment - 1u);
+        }
+    } // namespace
+
+    bool PakBuilder::Build(const std::string& rootDirectory, const std::vector<std::string>& directories, const std::string& pakPath,
+                           Statistics& statistics) {
+        statistics = {};
+        std::vector<File> files;
+        std::error_code error;
+        for (const auto& directory : directories) {
+            for (auto it{ std::filesystem::recursive_directory_iterator(rootDirectory + directory, error) };
+                 it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+                auto name{ it->path().filename().string() };
+                if (name.empty() || name[0] == '.' || name.find(".tmp") != std::string::npos) {
+                    if (it->is_directory(error)) {
+                        it.disable_recursion_pending();
+                    }
+                    continue;
+                }
+                if (!it->is_regular_file(error)) {
+                    continue;
+                }
+                auto filePath{ it->path().generic_string() };
+                if (filePath.compare(0u, rootDirectory.size(), rootDirectory)) {
+                    continue;
+                }
+                files.push_back({ filePath, filePath.substr(rootDirectory.size()) });
+            }
+        }
+        if (files.empty()) {
+            return false;
+        }
+        std::sort(files.begin(), files.end(), [](const File& lhs, const File& rhs) { return lhs.path < rhs.path; });
+
+        std::vector<PakFile::Entry> entries;
+        std::string names;
+        auto tempPath{ pakPath + ".tmp" };
+        {
+            std::ofstream pak{ tempPath, std::ios::binary | std::ios::trunc };
+            if (!pak) {
+                return false;
+            }
+            const char zeros[PakFile::blobAlignment]{};
+            auto writeBlob{ [&](std::uint64_t offset, const void* blob, std::size_t size) {
+                pak.write(zeros, static_cast<std::streamsize>(offset - static_cast<std::uint64_t>(pak.tellp())));
+                pak.write(static_cast<const char*>(blob), static_cast<std::streamsize>(size));
+            } };
+
+            PakFile::Header header{};
+            pak.write(reinterpret_cast<const char*>(&header), sizeof(PakFile::Header));
+            std::uint64_t offset{ sizeof(PakFile::Header) };
+            Array<std::uint8_t> compressed;
+            for (const auto& file : files) {
+                // Read loose, a pak mounted while building isn't packed into the new one
+                MappedFile source;
+                source.Open(file.filePath.data());
+                auto size{ static_cast<std::uint64_t>(std::filesystem::file_size(file.filePath, error)) };
+                if (error || size != source.GetSize()) {
+                    continue;
+                }
+                auto time{ static_cast<std::int64_t>(std::filesystem::last_write_time(file.filePath, error).time_since_epoch().count()) };
+                if (error) {
+                    continue;
+                }
+
+                PakFile::Entry entry{};
+                entry.hash         = Fnv1a(file.path);
+                entry.offset       = Align(offset);
+                entry.size         = size;
+                entry.originalSize = size;
+                entry.time         = time;
+                entry.nameOffset   = static_cast<std::uint32_t>(names.size());
+                entry.nameSize     = static_cast<std::uint32_t>(file.path.size());
+                entry.compression  = PakFile::Compression::eNone;
+
+                const void* blob{ source.GetData() };
+                if (size) {
+                    compressed.Resize(GetCompressBound(source.GetSize()));
+                    auto compressedSize{ Compress(static_cast<const std::uint8_t*>(source.GetData()), source.GetSize(), compressed.GetData()) };
+                    if (compressedSize <= source.GetSize() - source.GetSize() / minSaving) {
+                        entry.size        = compressedSize;
+                        entry.compression = PakFile::Compression::eLZ4;
+                        blob              = compressed.GetData();
+                        ++statistics.compressedCount;
+                    }
+                }
+                writeBlob(entry.offset, blob, static_cast<std::size_t>(entry.size));
+                offset = entry.offset + entry.size;
+                names += file.path;
+                entries.push_back(entry);
+
+                ++statistics.fileCount;
+                statistics.originalSize += entry.originalSize;
+                statistics.packedSize += entry.size;
+            }
+
+            // Equal hashes are told apart by their paths
+            std::sort(entries.begin(), entries.end(), [&names](const PakFile::Entry& lhs, const PakFile::Entry& rhs) {
+                if (lhs.hash != rhs.hash) {
+                    return lhs.hash < rhs.hash;
+                }
+                return names.compare(lhs.nameOffset, lhs.nameSize, names, rhs.nameOffset, rhs.nameSize) < 0;
+            });
+            header.magic       = PakFile::magic;
+            header.version     = PakFile::version;
+            header.entryCount  = static_cast<std::uint32_t>(entries.size());
+            header.indexOffset = Align(offset);
+            header.nameOffset  = header.indexOffset + sizeof(PakFile::Entry) * entries.size();
+            header.nameSize    = names.size();
+            writeBlob(header.indexOffset, entries.data(), sizeof(PakFile::Entry) * entries.size());
+            writeBlob(header.nameOffset, names.data(), names.size());
+            pak.seekp(0);
+            pak.write(reinterpret_cast<const char*>(&header), sizeof(PakFile::Header));
+            if (!pak || entries.empty()) {
+                pak.close();
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+        // Renamed over the old pak, a failed build leaves it as it was
+        std::filesystem::rename(tempPath, pakPath, error);
+        if (error) {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    void PakBuilder::Benchmark(const std::string& rootDirectory) {
+        const auto& pak{ VirtualFileSystem::GetPak() };
+        if (!pak.IsOpen()) {
+            ADH_LOG("Pak benchmark: no pak is mounted");
+            return;
+        }
+        // Every byte is hashed so the pages are actually read, the loose files go second and may
+        // find theirs in the OS cache already
+        double packedTime{};
+        double looseTime{};
+        std::uint32_t looseCount{};
+        std::uint32_t changedCount{};
+        for (const auto& entry : pak) {
+            auto filePath{ rootDirectory + std::string{ pak.GetPath(entry) } };
+            Stopwatch<double> stopwatch;
+            MappedFile file;
+            std::uint64_t packedHash{};
+            if (pak.Read(entry, file)) {
+                packedHash = Fnv1a(file.GetData(), file.GetSize());
+            }
+            packedTime += stopwatch.Lap();
+
+            if (file.Open(filePath.data())) {
+                auto looseHash{ Fnv1a(file.GetData(), file.GetSize()) };
+                looseTime += stopwatch.Lap();
+                changedCount += looseHash != packedHash;
+                ++looseCount;
+            }
+        }
+        ADH_LOG("Pak benchmark: " << pak.GetEntryCount() << " files read packed in " << packedTime * 1000.0 << " ms, " << looseCount
+                                  << " loose in " << looseTime * 1000.0 << " ms, " << changedCount << " changed since packing");
+    }
+
+    std::size_t PakBuilder::Compress(const std::uint8_t* source, std::size_t size, std::uint8_t* target) noexcept {
+        auto* targetBegin{ target };
+        std::size_t anchor{};
+        if (size > matchLimit) {
+            // Last position of each hashed 4 bytes plus one, zero is empty
+            Array<std::uint32_t> table;
+            table.Resize(std::size_t{ 1u } << hashBits, 0u);
+            std::size_t i{};
+            while (i + matchLimit <= size) {
+                auto sequence{ Read32(source + i) };
+                auto hash{ (sequence * 2654435761u) >> (32u - hashBits) };
+                std::size_t candidate{ table[hash] };
+                table[hash] = static_cast<std::uint32_t>(i + 1u);
+                if (!candidate || i - (candidate - 1u) > maxOffset || Read32(source + candidate - 1u) != sequence) {
+                    ++i;
+                    continue;
+                }
+
+                auto match{ candidate - 1u };
+                auto length{ minMatch };
+                while (i + length < size - lastLiterals && source[match + length] == source[i + length]) {
+                    ++length;
+                }
+                auto* token{ target++ };
+                target = WriteLiterals(target, token, source + anchor, i - anchor);
+                auto offset{ i - match };
+                *target++ = static_cast<std::uint8_t>(offset);
+                *target++ = static_cast<std::uint8_t>(offset >> 8u);
+                *token |= static_cast<std::uint8_t>(std::min(length - minMatch, std::size_t{ 15u }));
+                if (length - minMatch >= 15u) {
+                    target = WriteLength(target, length - minMatch - 15u);
+                }
+                i += length;
+                anchor = i;
+            }
+        }
+        auto* token{ target++ };
+        target = WriteLiterals(target, token, source + anchor, size - anchor);
+        return static_cast<std::size_t>(target - targetBegin);
+    }
+
+    std::size_t PakBuilder::GetCompressBound(std::size_t size) noexcept {
+        return size + size / 255u + 16u;
+    }
+} // namespace adh
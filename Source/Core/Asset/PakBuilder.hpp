@@ -0,0 +1,39 @@
+#pragma once
+#include <Std/PakFile.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace adh {
+    // Writes the PakFile a shipping build mounts instead of reading loose files. Blobs are laid
+    // out in path order so a directory is read from neighbouring pages, and compressed with LZ4
+    // only where that saves at least an eighth. Cooked caches rarely do and stay readable in place.
+    class PakBuilder {
+      public:
+        static constexpr std::size_t minSaving{ 8u }; // Compressed blobs are at most 7/8 of the file
+
+        struct Statistics {
+            std::uint32_t fileCount;
+            std::uint32_t compressedCount;
+            std::uint64_t originalSize;
+            std::uint64_t packedSize;
+        };
+
+      public:
+        // Every file below the directories, relative to rootDirectory which ends with a '/'. Hidden
+        // and temporary files are skipped. Written next to pakPath and renamed over it, returns
+        // false if nothing was written.
+        static bool Build(const std::string& rootDirectory, const std::vector<std::string>& directories, const std::string& pakPath,
+                          Statistics& statistics);
+
+        // Reads every file in the mounted pak through it and again from the loose file, logs both
+        static void Benchmark(const std::string& rootDirectory);
+
+        // LZ4 block into target, which holds GetCompressBound(size) bytes. Returns its size.
+        static std::size_t Compress(const std::uint8_t* source, std::size_t size, std::uint8_t* target) noexcept;
+
+        static std::size_t GetCompressBound(std::size_t size) noexcept;
+    };
+} // namespace adh
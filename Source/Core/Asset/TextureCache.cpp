@@ -0,0 +1,199 @@
+#include "TextureCache.hpp"
+#include <Std/Stopwatch.hpp>
+#include <Std/VirtualFileSystem.hpp>
+#include <Vulkan/Context.hpp>
+#include <Vulkan/Texture2D.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace adh {
+    namespace {
+        BlockCompressor::Format SelectFormat(const std::string& texturePath, TextureCache::Encoding encoding, const std::uint8_t* pixels, VkExtent2D extent) noexcept {
+            auto name{ std::filesystem::path{ texturePath }.stem().string() };
+            std::string suffix{ "_normal" };
+            if (name.size() >= suffix.size() && !name.compare(name.size() - suffix.size(), suffix.size(), suffix)) {
+                return BlockCompressor::Format::eBC5;
+            }
+            if (encoding == TextureCache::Encoding::eHighQuality) {
+                return BlockCompressor::Format::eBC7;
+            }
+            std::size_t pixelCount{ std::size_t{ extent.width } * extent.height };
+            for (std::size_t i{}; i != pixelCount; ++i) {
+                if (pixels[i * 4u + 3u] != 255u) {
+                    return BlockCompressor::Format::eBC3;
+                }
+            }
+            return BlockCompressor::Format::eBC1;
+        }
+
+        std::uint32_t GetMipLevels(VkExtent2D extent) noexcept {
+            auto levels{ static_cast<std::uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1u };
+            return std::min(levels, TextureCache::maxMipLevels);
+        }
+
+        // 2x2 box filter, the last row or column of an odd size is dropped
+        void Downsample(const std::uint8_t* pixels, VkExtent2D extent, std::uint8_t* half) noexcept {
+            auto halfExtent{ TextureCache::GetMipExtent(extent, 1u) };
+            for (std::uint32_t y{}; y != halfExtent.height; ++y) {
+                auto row0{ pixels + std::size_t{ 4u } * extent.width * std::min(y * 2u, extent.height - 1u) };
+                auto row1{ pixels + std::size_t{ 4u } * extent.width * std::min(y * 2u + 1u, extent.height - 1u) };
+                for (std::uint32_t x{}; x != halfExtent.width; ++x) {
+                    auto x0{ std::size_t{ 4u } * std::min(x * 2u, extent.width - 1u) };
+                    auto x1{ std::size_t{ 4u } * std::min(x * 2u + 1u, extent.width - 1u) };
+                    for (std::size_t c{}; c != 4u; ++c) {
+                        *half++ = static_cast<std::uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2u) >> 2u);
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    TextureCache::Encoding TextureCache::GetEncoding() noexcept {
+        if (!vk::Texture2D::IsBlockCompressionSupported()) {
+            return Encoding::eNone;
+        }
+        auto format{ std::getenv("ADH_TEXTURE_FORMAT") };
+        if (!format) {
+            return Encoding::eDefault;
+        }
+        if (!std::strcmp(format, "rgba8")) {
+            return Encoding::eNone;
+        }
+        return std::strcmp(format, "bc7") ? Encoding::eDefault : Encoding::eHighQuality;
+    }
+
+    bool TextureCache::Read(const std::string& texturePath, Encoding encoding, Texture& texture, MappedFile& cache) {
+        auto cachePath{ GetCachePath(texturePath) };
+        if (!VirtualFileSystem::Open(cachePath, cache) || cache.GetSize() < sizeof(FileHeader)) {
+            cache.Close();
+            return false;
+        }
+        FileHeader header{};
+        std::memcpy(&header, cache.GetData(), sizeof(FileHeader));
+        if (!IsValid(header, cache.GetSize(), encoding)) {
+            cache.Close();
+            return false;
+        }
+
+        if (!CacheFile::Validate(texturePath, cachePath, offsetof(FileHeader, source), cache)) {
+            cache.Close();
+            return false;
+        }
+
+        texture.data       = static_cast<const char*>(cache.GetData()) + header.dataOffset;
+        texture.size       = header.dataSize;
+        texture.format     = static_cast<VkFormat>(header.format);
+        texture.extent     = { header.width, header.height };
+        texture.mipLevels  = header.mipLevels;
+        texture.sourceHash = header.source.hash;
+        return true;
+    }
+
+    bool TextureCache::Cook(const std::string& texturePath, Encoding encoding, const std::uint8_t* pixels, VkExtent2D extent) {
+        if (encoding == Encoding::eNone || !extent.width || !extent.height || extent.width > maxExtent || extent.height > maxExtent) {
+            return false;
+        }
+        CacheFile::Source source;
+        if (!CacheFile::GetSource(texturePath, source)) {
+            return false;
+        }
+
+        auto format{ SelectFormat(texturePath, encoding, pixels, extent) };
+        auto mipLevels{ GetMipLevels(extent) };
+        Array<std::uint8_t> blocks;
+        blocks.Resize(GetDataSize(format, extent, mipLevels));
+
+        // Each level is filtered from the one before, ping-ponging between two buffers
+        Array<std::uint8_t> mips[2];
+        const auto* level{ pixels };
+        std::size_t offset{};
+        for (std::uint32_t i{}; i != mipLevels; ++i) {
+            auto mipExtent{ GetMipExtent(extent, i) };
+            BlockCompressor::Compress(format, level, mipExtent.width, mipExtent.height, blocks.GetData() + offset);
+            offset += BlockCompressor::GetSize(format, mipExtent.width, mipExtent.height);
+            if (i + 1u != mipLevels) {
+                auto& next{ mips[i & 1u] };
+                auto nextExtent{ GetMipExtent(mipExtent, 1u) };
+                next.Resize(std::size_t{ 4u } * nextExtent.width * nextExtent.height);
+                Downsample(level, mipExtent, next.GetData());
+                level = next.GetData();
+            }
+        }
+
+        FileHeader header{};
+        header.magic      = magic;
+        header.version    = version;
+        header.encoding   = static_cast<std::uint32_t>(encoding);
+        header.format     = static_cast<std::uint32_t>(formats[static_cast<std::uint32_t>(format)].vkFormat);
+        header.source     = source;
+        header.width      = extent.width;
+        header.height     = extent.height;
+        header.mipLevels  = mipLevels;
+        header.dataOffset = (sizeof(FileHeader) + blobAlignment - 1u) & ~static_cast<std::uint64_t>(blobAlignment - 1u);
+        header.dataSize   = blocks.GetSize();
+
+        return CacheFile::Write(GetCachePath(texturePath), { { 0u, &header, sizeof(FileHeader) },
+                                                             { header.dataOffset, blocks.GetData(), blocks.GetSize() } });
+    }
+
+    void TextureCache::Benchmark(const std::string& directory) {
+        auto encoding{ GetEncoding() };
+        std::size_t totalPixelSize{};
+        std::size_t totalCookedSize{};
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            auto texturePath{ entry.path().generic_string() };
+            Stopwatch<double> stopwatch;
+            Array<std::uint8_t> pixels;
+            VkExtent2D extent;
+            if (!vk::Texture2D::Decode(texturePath.data(), pixels, extent)) {
+                continue;
+            }
+            vk::Texture2D decoded;
+            decoded.CreateFromPixels(pixels.GetData(), extent);
+            auto decodeTime{ stopwatch.Lap() };
+
+            Cook(texturePath, encoding, pixels.GetData(), extent);
+            auto cookTime{ stopwatch.Lap() };
+
+            Texture texture;
+            MappedFile cache;
+            auto isCooked{ Read(texturePath, encoding, texture, cache) };
+            if (isCooked) {
+                vk::Texture2D cooked;
+                cooked.CreateCompressed(texture.data, texture.size, texture.format, texture.extent, texture.mipLevels);
+            }
+            auto cacheTime{ stopwatch.Lap() };
+
+            auto name{ entry.path().filename().string() };
+            if (!isCooked) {
+                ADH_LOG("Texture load: " << name << " decode " << decodeTime * 1000.0 << " ms (not cooked)");
+                continue;
+            }
+            totalPixelSize += pixels.GetSize();
+            totalCookedSize += texture.size;
+            ADH_LOG("Texture load: " << name << " decode " << decodeTime * 1000.0 << " ms, cooked " << cacheTime * 1000.0
+                                     << " ms (cooking took " << cookTime * 1000.0 << " ms), RGBA8 " << (pixels.GetSize() >> 10u)
+                                     << " KB, " << FindFormat(texture.format)->name << " " << (texture.size >> 10u) << " KB with "
+                                     << texture.mipLevels << " mips");
+        }
+        if (totalPixelSize) {
+            ADH_LOG("Texture memory: RGBA8 " << (totalPixelSize >> 10u) << " KB, cooked " << (totalCookedSize >> 10u) << " KB ("
+                                             << 100.0 - 100.0 * static_cast<double>(totalCookedSize) / static_cast<double>(totalPixelSize)
+                                             << "% saved)");
+        }
+    }
+
+    std::string TextureCache::GetCachePath(const std::string& texturePath) {
+        return CacheFile::GetPath(vk::Context::Get()->GetDataDirectory(), texturePath, "TextureCache", ".adhtex");
+    }
+} // namespace adh
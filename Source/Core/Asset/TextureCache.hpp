@@ -0,0 +1,126 @@
+#pragma once
+#include "BlockCompressor.hpp"
+#include "CacheFile.hpp"
+#include <Std/MappedFile.hpp>
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace adh {
+    // Cooked copy of a texture in a block compressed format with its whole mip chain, written the
+    // first time the texture is decoded so later loads skip the image decoder. Like KTX2 the file
+    // is a header with the Vulkan format, the extent and the mip count followed by the levels from
+    // the largest, it's mapped and the image is uploaded straight from the mapped pages.
+    // Opaque textures are BC1, the others BC3 and files ending in _normal BC5. ADH_TEXTURE_FORMAT=bc7
+    // cooks colour textures as BC7 instead, ADH_TEXTURE_FORMAT=rgba8 turns cooking off.
+    // Kept and reused as a CacheFile.
+    class TextureCache {
+      public:
+        static constexpr std::uint32_t magic{ 0x54484441u }; // "ADHT"
+        static constexpr std::uint32_t version{ 1u };
+        static constexpr std::uint32_t maxMipLevels{ 16u };
+        static constexpr std::uint32_t maxExtent{ 1u << (maxMipLevels - 1u) }; // Larger textures aren't cooked
+        static constexpr std::size_t blobAlignment{ 16u };
+
+        enum class Encoding : std::uint32_t {
+            eNone,
+            eDefault,
+            eHighQuality
+        };
+
+        // Points into the mapped cache
+        struct Texture {
+            const void* data;
+            std::size_t size;
+            VkFormat format;
+            VkExtent2D extent;
+            std::uint32_t mipLevels;
+            std::uint64_t sourceHash;
+        };
+
+      public:
+        // ADH_TEXTURE_FORMAT, eNone if the device can't sample block compressed images
+        static Encoding GetEncoding() noexcept;
+
+        // Maps the cache, which stays mapped for the upload. Returns false if there is no cache for
+        // the source, it's stale or it was cooked with another encoding. Thread safe.
+        static bool Read(const std::string& texturePath, Encoding encoding, Texture& texture, MappedFile& cache);
+
+        // Compresses the RGBA8 pixels Texture2D::Decode() read from the source and their mip chain,
+        // errors only leave the cache unwritten. Thread safe.
+        static bool Cook(const std::string& texturePath, Encoding encoding, const std::uint8_t* pixels, VkExtent2D extent);
+
+        // Loads every texture in directory decoded and cooked, logs the times and the memory saved
+        static void Benchmark(const std::string& directory);
+
+        static std::string GetCachePath(const std::string& texturePath);
+
+      public:
+        // At the start of every cache, read with memcpy() so the mapping needs no alignment
+        struct FileHeader {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t encoding;
+            std::uint32_t format; // VkFormat
+            CacheFile::Source source;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint32_t mipLevels;
+            std::uint32_t padding;
+            std::uint64_t dataOffset;
+            std::uint64_t dataSize;
+        };
+
+        // The header was written with encoding, the levels its format, extent and mip count take
+        // are inside a file of fileSize bytes
+        static bool IsValid(const FileHeader& header, std::size_t fileSize, Encoding encoding) noexcept {
+            auto format{ FindFormat(static_cast<VkFormat>(header.format)) };
+            if (header.magic != magic || header.version != version || header.encoding != static_cast<std::uint32_t>(encoding) ||
+                !format || !header.width || !header.height || header.width > maxExtent || header.height > maxExtent ||
+                !header.mipLevels || header.mipLevels > maxMipLevels) {
+                return false;
+            }
+            // Every level inside the file, a truncated file is rejected
+            return header.dataOffset >= sizeof(FileHeader) && header.dataOffset <= fileSize &&
+                   header.dataSize == GetDataSize(format->format, { header.width, header.height }, header.mipLevels) &&
+                   header.dataSize <= fileSize - header.dataOffset;
+        }
+
+        // Bytes of mipLevels levels from extent down
+        static std::size_t GetDataSize(BlockCompressor::Format format, VkExtent2D extent, std::uint32_t mipLevels) noexcept {
+            std::size_t size{};
+            for (std::uint32_t i{}; i != mipLevels; ++i) {
+                auto mipExtent{ GetMipExtent(extent, i) };
+                size += BlockCompressor::GetSize(format, mipExtent.width, mipExtent.height);
+            }
+            return size;
+        }
+
+        static VkExtent2D GetMipExtent(VkExtent2D extent, std::uint32_t level) noexcept {
+            return { std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u) };
+        }
+
+      private:
+        struct FormatInfo {
+            BlockCompressor::Format format;
+            VkFormat vkFormat;
+            const char* name;
+        };
+
+        static constexpr FormatInfo formats[]{
+            { BlockCompressor::Format::eBC1, VK_FORMAT_BC1_RGB_UNORM_BLOCK, "BC1" },
+            { BlockCompressor::Format::eBC3, VK_FORMAT_BC3_UNORM_BLOCK, "BC3" },
+            { BlockCompressor::Format::eBC5, VK_FORMAT_BC5_UNORM_BLOCK, "BC5" },
+            { BlockCompressor::Format::eBC7, VK_FORMAT_BC7_UNORM_BLOCK, "BC7" }
+        };
+
+        static const FormatInfo* FindFormat(VkFormat vkFormat) noexcept {
+            auto it{ std::find_if(std::begin(formats), std::end(formats), [vkFormat](const auto& format) { return format.vkFormat == vkFormat; }) };
+            return it == std::end(formats) ? nullptr : it;
+        }
+    };
+} // namespace adh
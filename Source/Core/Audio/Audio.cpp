@@ -2,6 +2,9 @@
 
 #include "LoadWav.hpp"
 
+#include <Asset/AssetManager.hpp>
+#include <Asset/AssetRegistry.hpp>
+#include <Std/Hash.hpp>
 #include <Vulkan/Context.hpp>
 
 #include <Event/Event.hpp>
@@ -48,54 +51,104 @@ namespace adh {
 } // namespace adh
 
 namespace adh {
-    Audio::~Audio() {
-        alDeleteSources(1, &mSource);
-        alDeleteBuffers(1, &mBuffer);
+    AudioClip::AudioClip() : buffer{} {
+        alGenBuffers(1, &buffer);
     }
 
-    void Audio::Create(const char* filePath) {
-        // Generate buffer
-        alGenBuffers(1, &mBuffer);
-        std::uint8_t channel, bps;
-        std::int32_t sampleRate;
-        std::int32_t size;
-        // int channel, sampleRate, bps, size;
-        char* data = load_wav(filePath, channel, sampleRate, bps, size);
-        if (!data) {
-            std::string file = filePath;
-            int pos          = file.find("Audio");
-            file             = "[" + file.substr(pos + 6) + "] " + "Invalid audio file.";
-            Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eError, file.data());
-            return;
+    AudioClip::~AudioClip() {
+        alDeleteBuffers(1, &buffer);
+    }
+
+    Audio::~Audio() {
+        if (mState) {
+            mState->status = Status::eDestroyed;
+            alDeleteSources(1, &mSource);
         }
+    }
 
-        if (channel == 1) {
-            if (bps == 8) {
-                mFormat = AL_FORMAT_MONO8;
-            } else {
-                mFormat = AL_FORMAT_MONO16;
-            }
-        } else {
-            if (bps == 8) {
-                mFormat = AL_FORMAT_STEREO8;
-            } else {
-                mFormat = AL_FORMAT_STEREO16;
-            }
+    void Audio::Create(const char* filePath) {
+        if (mState) {
+            mState->status = Status::eDestroyed;
+            alDeleteSources(1, &mSource);
         }
-        alBufferData(mBuffer, mFormat, data, size, sampleRate);
+        mState = MakeShared<LoadState>();
 
-        // Generate source
+        // Generate source, the clip is attached once the file is read
         alGenSources(1, &mSource);
         alSourcef(mSource, AL_PITCH, mPitch);
         alSourcef(mSource, AL_GAIN, mGain);
         alSource3f(mSource, AL_POSITION, mPosition[0], mPosition[1], mPosition[2]);
         alSource3f(mSource, AL_VELOCITY, mVelocity[0], mVelocity[1], mVelocity[2]);
         alSourcei(mSource, AL_LOOPING, mLoop);
-        alSourcei(mSource, AL_BUFFER, mBuffer);
 
-        delete[] data;
+        std::string file{ filePath };
+        if (auto clip{ AssetRegistry::Get()->Find<AudioClip>(file) }) {
+            alSourcei(mSource, AL_BUFFER, clip->buffer);
+            mState->clip   = Move(clip);
+            mState->status = Status::eReady;
+            return;
+        }
+
+        struct Payload {
+            std::uint8_t channel;
+            std::uint8_t bps;
+            std::int32_t sampleRate;
+            std::int32_t size;
+            char* data;
+            std::uint64_t hash;
 
-        mReady = true;
+            ~Payload() {
+                delete[] data;
+            }
+        };
+        auto payload{ MakeShared<Payload>() };
+        AssetManager::Get()->Submit(
+            file.substr(file.find_last_of("/") + 1u),
+            [file, payload]() {
+                payload->data = load_wav(file, payload->channel, payload->sampleRate, payload->bps, payload->size);
+                if (!payload->data) {
+                    return false;
+                }
+                payload->hash = Fnv1a(payload->data, static_cast<std::size_t>(payload->size));
+                return true;
+            },
+            [file, payload, state = mState, source = mSource](bool isDecoded) {
+                // The AssetManager logs the failure
+                if (state->status == Status::eDestroyed) {
+                    return;
+                }
+                if (!isDecoded) {
+                    state->status = Status::eFailed;
+                    return;
+                }
+
+                // Another Audio may have loaded the file or an identical one meanwhile
+                state->clip = AssetRegistry::Get()->Insert<AudioClip>(file, payload->hash, static_cast<std::size_t>(payload->size), [&payload]() {
+                    ALuint format;
+                    if (payload->channel == 1) {
+                        if (payload->bps == 8) {
+                            format = AL_FORMAT_MONO8;
+                        } else {
+                            format = AL_FORMAT_MONO16;
+                        }
+                    } else {
+                        if (payload->bps == 8) {
+                            format = AL_FORMAT_STEREO8;
+                        } else {
+                            format = AL_FORMAT_STEREO16;
+                        }
+                    }
+                    auto clip{ MakeShared<AudioClip>() };
+                    alBufferData(clip->buffer, format, payload->data, payload->size, payload->sampleRate);
+                    return clip;
+                });
+                alSourcei(source, AL_BUFFER, state->clip->buffer);
+
+                state->status = Status::eReady;
+                if (state->isPlayQueued) {
+                    alSourcePlay(source);
+                }
+            });
     }
 
     void Audio::Create2(const char* fileName) {
@@ -111,32 +164,45 @@ namespace adh {
     // }
 
     void Audio::Play() {
-        if (mReady) {
+        if (!mState) {
+            return;
+        }
+        if (mState->status == Status::eReady) {
             alSourcePlay(mSource);
+        } else if (mState->status == Status::eLoading) {
+            mState->isPlayQueued = true;
         }
     }
 
     void Audio::Stop() {
-        if (mReady) {
+        if (!mState) {
+            return;
+        }
+        mState->isPlayQueued = false;
+        if (mState->status == Status::eReady) {
             alSourceStop(mSource);
         }
     }
 
     void Audio::Pause() {
-        if (mReady) {
+        if (!mState) {
+            return;
+        }
+        mState->isPlayQueued = false;
+        if (mState->status == Status::eReady) {
             alSourcePause(mSource);
         }
     }
 
     void Audio::Loop(bool loop) {
-        if (mReady) {
+        if (mState) {
             mLoop = loop;
             alSourcei(mSource, AL_LOOPING, mLoop);
         }
     }
 
     bool Audio::IsPlaying() const noexcept {
-        if (mReady) {
+        if (mState && mState->status == Status::eReady) {
             ALint state;
             alGetSourcei(mSource, AL_SOURCE_STATE, &state);
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <Std/SharedPtr.hpp>
 #include <Std/Stopwatch.hpp>
 
 #include <iostream>
@@ -48,6 +49,18 @@ namespace adh {
 } // namespace adh
 
 namespace adh {
+    // Samples of a decoded file, shared through the AssetRegistry by every Audio of the file
+    struct AudioClip {
+        AudioClip();
+
+        AudioClip(const AudioClip&)            = delete;
+        AudioClip& operator=(const AudioClip&) = delete;
+
+        ~AudioClip();
+
+        ALuint buffer;
+    };
+
     class Audio {
         // enum class Status {
         //     eInvalid,
@@ -61,6 +74,8 @@ namespace adh {
 
         ~Audio();
 
+        // The file is read on an AssetManager worker unless the AssetRegistry has it, Play() before
+        // it's ready plays once it is
         void Create(const char* filePath);
 
         void Create2(const char* fileName);
@@ -90,15 +105,27 @@ namespace adh {
         // std::atomic<Status> mStatus{ Status::eInvalid };
         // int mDuration{};
 
-        bool mReady{ false };
+        enum class Status {
+            eLoading,
+            eReady,
+            eFailed,
+            eDestroyed
+        };
+
+        // Shared with the pending load, the Audio may be gone before the file is decoded
+        struct LoadState {
+            Status status;
+            bool isPlayQueued;
+            SharedPtr<AudioClip> clip;
+        };
+
+        SharedPtr<LoadState> mState;
 
-        ALuint mFormat;
         ALuint mSource;
         float mPitch{ 1 };
         float mGain{ 1 };
         float mPosition[3]{};
         float mVelocity[3]{};
         bool mLoop{ false };
-        ALuint mBuffer;
     };
 } // namespace adh
@@ -1,9 +1,12 @@
 #ifndef ADH_LOAD_WAV_HPP_
 #define ADH_LOAD_WAV_HPP_
 
+#include <Std/VirtualFileSystem.hpp>
+
 #include <iostream>
 #include <bit>
-#include <fstream>
+#include <istream>
+#include <streambuf>
 #include <string>
 #include <cstring>
 
@@ -17,14 +20,20 @@ static std::int32_t convert_to_int(char* buffer, std::size_t len) {
     return a;
 }
 
-static bool load_wav_file_header(std::ifstream& file,
+// Reads memory the caller keeps alive through a std::istream
+struct memory_buffer : std::streambuf {
+    memory_buffer(const char* data, std::size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+};
+
+static bool load_wav_file_header(std::istream& file,
                           std::uint8_t& channels,
                           std::int32_t& sampleRate,
                           std::uint8_t& bitsPerSample,
                           std::int32_t& size) {
     char buffer[4];
-    if (!file.is_open())
-        return false;
 
     // the RIFF
     if (!file.read(buffer, 4)) {
@@ -138,19 +147,31 @@ static char* load_wav(const std::string& filename,
                std::int32_t& sampleRate,
                std::uint8_t& bitsPerSample,
                std::int32_t& size) {
-    std::ifstream in(filename, std::ios::binary);
-    if (!in.is_open()) {
+    // Parsed in place, from the pak or the mapped file
+    adh::MappedFile file;
+    if (!adh::VirtualFileSystem::Open(filename, file)) {
         std::cerr << "ERROR: Could not open \"" << filename << "\"" << std::endl;
         return nullptr;
     }
+    memory_buffer buffer(static_cast<const char*>(file.GetData()), file.GetSize());
+    std::istream in(&buffer);
     if (!load_wav_file_header(in, channels, sampleRate, bitsPerSample, size)) {
         std::cerr << "ERROR: Could not load wav header of \"" << filename << "\"" << std::endl;
         return nullptr;
     }
 
+    if (size < 0 || static_cast<std::size_t>(size) > file.GetSize()) {
+        std::cerr << "ERROR: wav data of \"" << filename << "\" is truncated" << std::endl;
+        return nullptr;
+    }
+
     char* data = new char[size];
 
-    in.read(data, size);
+    if (!in.read(data, size)) {
+        std::cerr << "ERROR: Could not read wav data of \"" << filename << "\"" << std::endl;
+        delete[] data;
+        return nullptr;
+    }
 
     return data;
 }
@@ -187,6 +187,24 @@ namespace adh {
         Type type;
     };
 
+    // Dispatched by the FileWatcher on the main thread, the path is the watched directory followed
+    // by the path below it, the way assets are loaded from the data directory
+    struct FileEvent : BaseEvent {
+        enum class Type : char {
+            eModified,
+            eCreated,
+            eRemoved
+        };
+
+        FileEvent(Type type, const char* filePath)
+            : type{ type },
+              filePath{ filePath } {
+        }
+
+        Type type;
+        const char* filePath;
+    };
+
     struct EditorLogEvent : BaseEvent {
         enum class Type {
             eLog,
@@ -52,6 +52,7 @@ namespace adh {
 #include "source/Vector2D.hpp"
 #include "source/Vector3D.hpp"
 #include "source/Vector4D.hpp"
+#include "source/XmmFrustum.hpp"
 #include "source/XmmMatrix.hpp"
 #include "source/XmmVector.hpp"
 
@@ -64,5 +65,6 @@ namespace adh {
 #include "source/Vector2D.inl"
 #include "source/Vector3D.inl"
 #include "source/Vector4D.inl"
+#include "source/XmmFrustum.inl"
 #include "source/XmmMatrix.inl"
 #include "source/XmmVector.inl"
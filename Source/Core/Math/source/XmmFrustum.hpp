@@ -0,0 +1,52 @@
+#pragma once
+#include "XmmMatrix.hpp"
+#include "XmmVector.hpp"
+
+namespace adh {
+    namespace xmm {
+        class Frustum {
+          public:
+            enum Plane : std::size_t {
+                eLeft,
+                eRight,
+                eBottom,
+                eTop,
+                eNear,
+                eFar,
+                eCount
+            };
+
+          public:
+            inline Frustum() noexcept = default;
+
+            inline Frustum(const Matrix& viewProjection) noexcept;
+
+            // Normalized planes (xyz = normal, w = distance), normals point inside
+            inline Frustum(const Vector (&planes)[Plane::eCount]) noexcept;
+
+            inline Frustum& Update(const Matrix& viewProjection) noexcept;
+
+            inline bool Intersects(const Vector& center, float radius) const noexcept;
+
+            // Axis aligned box given by its center and half extents
+            inline bool Intersects(const Vector& center, const Vector& extents) const noexcept;
+
+            // Local space box transformed by model (column vectors), tests the box enclosing the transformed one
+            inline bool Intersects(const Matrix& model, const Vector& center, const Vector& extents) const noexcept;
+
+            inline const Vector& operator[](std::size_t index) const ADH_NOEXCEPT;
+
+          private:
+            Vector m_Planes[Plane::eCount];
+
+            // Planes transposed into x, y, z, w lanes, 4 planes per row (last two repeat the first two)
+            Vector m_Soa[2][4];
+        };
+    } // namespace xmm
+} // namespace adh
+
+namespace adh {
+    namespace xmm {
+        inline Frustum ExtractFrustum(const Matrix& viewProjection) noexcept;
+    } // namespace xmm
+} // namespace adh
@@ -0,0 +1,129 @@
+namespace adh {
+    namespace xmm {
+        Frustum::Frustum(const Matrix& viewProjection) noexcept {
+            Update(viewProjection);
+        }
+
+        Frustum::Frustum(const Vector (&planes)[Plane::eCount]) noexcept {
+            for (std::size_t i{}; i != Plane::eCount; ++i) {
+                m_Planes[i] = planes[i];
+            }
+
+            __m128 row0{ m_Planes[eLeft].v };
+            __m128 row1{ m_Planes[eRight].v };
+            __m128 row2{ m_Planes[eBottom].v };
+            __m128 row3{ m_Planes[eTop].v };
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            m_Soa[0][0] = row0;
+            m_Soa[0][1] = row1;
+            m_Soa[0][2] = row2;
+            m_Soa[0][3] = row3;
+
+            row0 = m_Planes[eNear].v;
+            row1 = m_Planes[eFar].v;
+            row2 = m_Planes[eLeft].v;
+            row3 = m_Planes[eRight].v;
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            m_Soa[1][0] = row0;
+            m_Soa[1][1] = row1;
+            m_Soa[1][2] = row2;
+            m_Soa[1][3] = row3;
+        }
+
+        Frustum& Frustum::Update(const Matrix& viewProjection) noexcept {
+            return *this = adh::xmm::ExtractFrustum(viewProjection);
+        }
+
+        bool Frustum::Intersects(const Vector& center, float radius) const noexcept {
+            const __m128 x{ _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0)) };
+            const __m128 y{ _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1)) };
+            const __m128 z{ _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2)) };
+            const __m128 r{ _mm_set1_ps(-radius) };
+
+            for (const auto& soa : m_Soa) {
+                __m128 distance{ _mm_add_ps(_mm_mul_ps(soa[0], x), soa[3]) };
+                distance = _mm_add_ps(_mm_mul_ps(soa[1], y), distance);
+                distance = _mm_add_ps(_mm_mul_ps(soa[2], z), distance);
+                if (_mm_movemask_ps(_mm_cmplt_ps(distance, r))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool Frustum::Intersects(const Vector& center, const Vector& extents) const noexcept {
+            const __m128 signMask{ _mm_set1_ps(-0.0f) };
+
+            const __m128 x{ _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0)) };
+            const __m128 y{ _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1)) };
+            const __m128 z{ _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2)) };
+            const __m128 ex{ _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(0, 0, 0, 0)) };
+            const __m128 ey{ _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(1, 1, 1, 1)) };
+            const __m128 ez{ _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(2, 2, 2, 2)) };
+
+            for (const auto& soa : m_Soa) {
+                // Signed distance of the center and projected radius of the box on the plane normal
+                __m128 distance{ _mm_add_ps(_mm_mul_ps(soa[0], x), soa[3]) };
+                distance = _mm_add_ps(_mm_mul_ps(soa[1], y), distance);
+                distance = _mm_add_ps(_mm_mul_ps(soa[2], z), distance);
+
+                __m128 radius{ _mm_mul_ps(_mm_andnot_ps(signMask, soa[0]), ex) };
+                radius = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, soa[1]), ey), radius);
+                radius = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, soa[2]), ez), radius);
+
+                if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool Frustum::Intersects(const Matrix& model, const Vector& center, const Vector& extents) const noexcept {
+            const __m128 signMask{ _mm_set1_ps(-0.0f) };
+
+            __m128 worldCenter{ model.m[3].v };
+            worldCenter = _mm_add_ps(_mm_mul_ps(model.m[0], _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0))), worldCenter);
+            worldCenter = _mm_add_ps(_mm_mul_ps(model.m[1], _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1))), worldCenter);
+            worldCenter = _mm_add_ps(_mm_mul_ps(model.m[2], _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2))), worldCenter);
+
+            __m128 worldExtents{ _mm_mul_ps(_mm_andnot_ps(signMask, model.m[0]), _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(0, 0, 0, 0))) };
+            worldExtents = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, model.m[1]), _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(1, 1, 1, 1))), worldExtents);
+            worldExtents = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, model.m[2]), _mm_shuffle_ps(extents, extents, _MM_SHUFFLE(2, 2, 2, 2))), worldExtents);
+
+            return Intersects(Vector{ worldCenter }, Vector{ worldExtents });
+        }
+
+        const Vector& Frustum::operator[](std::size_t index) const ADH_NOEXCEPT {
+            ADH_THROW(index < Plane::eCount, "Frustum plane out of range!");
+            return m_Planes[index];
+        }
+    } // namespace xmm
+} // namespace adh
+
+namespace adh {
+    namespace xmm {
+        Frustum ExtractFrustum(const Matrix& viewProjection) noexcept {
+            // Gribb/Hartmann: rows of the (column vector) clip matrix
+            const Matrix rows{ Transpose(viewProjection) };
+
+            Vector planes[Frustum::eCount];
+            planes[Frustum::eLeft]   = rows.m[3] + rows.m[0];
+            planes[Frustum::eRight]  = rows.m[3] - rows.m[0];
+            planes[Frustum::eBottom] = rows.m[3] + rows.m[1];
+            planes[Frustum::eTop]    = rows.m[3] - rows.m[1];
+            if (ADH_MATH_DEPTH_TO_MINUS_ONE) {
+                planes[Frustum::eNear] = rows.m[3] + rows.m[2];
+            } else {
+                planes[Frustum::eNear] = rows.m[2];
+            }
+            planes[Frustum::eFar] = rows.m[3] - rows.m[2];
+
+            for (auto& plane : planes) {
+                const float length{ std::sqrt(Vector{ _mm_dp_ps(plane, plane, 0x7f) }[0]) };
+                plane = Divide(plane, length);
+            }
+
+            return Frustum{ planes };
+        }
+    } // namespace xmm
+} // namespace adh
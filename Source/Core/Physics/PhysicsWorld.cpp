@@ -90,14 +90,18 @@ namespace adh {
         return physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxCapsuleGeometry(radius, halfHeight), &material, 1);
     }
 
-    [[nodiscard]] physx::PxShape* PhysicsWorld::CreateMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, const Mesh& mesh) {
+    [[nodiscard]] physx::PxShape* PhysicsWorld::CreateMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, Mesh& mesh) {
+        if (!mesh.LoadCollision()) {
+            return NULL;
+        }
         auto&& meshBuffer{ mesh.Get() };
         PxTriangleMeshDesc meshDesc;
         meshDesc.points.count  = meshBuffer->vertices2.GetSize();
         meshDesc.points.stride = sizeof(meshBuffer->vertices2[0]);
         meshDesc.points.data   = meshBuffer->vertices2.GetData();
 
-        meshDesc.triangles.count  = meshBuffer->indices.GetSize() / 3;
+        // LOD 0 only, the simplified levels follow it in the same index array
+        meshDesc.triangles.count  = mesh.GetIndexCount() / 3;
         meshDesc.triangles.stride = 3 * sizeof(meshBuffer->indices[0]);
         meshDesc.triangles.data   = meshBuffer->indices.GetData();
 
@@ -115,7 +119,10 @@ namespace adh {
         return aConvexShape;
     }
 
-    [[nodiscard]] physx::PxShape* PhysicsWorld::CreateConvexMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, const Mesh& mesh) {
+    [[nodiscard]] physx::PxShape* PhysicsWorld::CreateConvexMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, Mesh& mesh) {
+        if (!mesh.LoadCollision()) {
+            return NULL;
+        }
         auto&& meshBuffer{ mesh.Get() };
 
         PxConvexMeshDesc convexDesc;
@@ -40,9 +40,9 @@ namespace adh {
 
         [[nodiscard]] physx::PxShape* CreateCapsuleShape(physx::PxRigidActor* actor, physx::PxMaterial* material, float radius, float halfHeight);
 
-        [[nodiscard]] physx::PxShape* CreateMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, const Mesh& mesh);
+        [[nodiscard]] physx::PxShape* CreateMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, Mesh& mesh);
 
-        [[nodiscard]] physx::PxShape* CreateConvexMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, const Mesh& mesh);
+        [[nodiscard]] physx::PxShape* CreateConvexMeshShape(physx::PxRigidActor* actor, physx::PxMaterial* material, Mesh& mesh);
 
         [[nodiscard]] physx::PxRigidDynamic* CreateDynamicActor();
 
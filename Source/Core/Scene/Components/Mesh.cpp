@@ -1,65 +1,396 @@
 #include "Mesh.hpp"
 #include "Math/source/Numbers.hpp"
+#include <Asset/AssetManager.hpp>
+#include <Asset/AssetRegistry.hpp>
 #include <Event/Event.hpp>
 #include <Math/Math.hpp>
+#include <Scene/MeshCache.hpp>
+#include <Scene/MeshOptimizer.hpp>
+#include <Scene/MeshSimplifier.hpp>
+#include <Scene/VertexPacker.hpp>
+#include <Std/Stopwatch.hpp>
 #include <Utility.hpp>
 #include <Vulkan/Context.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
 namespace adh {
-    // FIXME: Assimp fails with big .obj files
+    namespace {
+        // Levels with fewer triangles than this aren't worth a draw of their own
+        constexpr std::size_t minLodIndexCount{ 3u * 128u };
+
+        // Every level halves the triangles of the one before. Levels are simplified from the previous
+        // one, their errors add up. The chain stops early once a level barely shrinks, the rest of
+        // the mesh is locked by borders and seams.
+        void GenerateLods(MeshBufferData& data) {
+            data.lods.EmplaceBack(MeshLod{ 0u, static_cast<std::uint32_t>(data.indices.GetSize()), 0.0f });
+
+            Array<std::uint32_t> lodIndices{ data.indices };
+            auto error{ 0.0f };
+            while (data.lods.GetSize() != MeshBufferData::maxLodCount && lodIndices.GetSize() / 2u >= minLodIndexCount) {
+                auto target{ (lodIndices.GetSize() / 6u) * 3u };
+                auto result{ MeshSimplifier::Simplify(data.vertices2, lodIndices, target) };
+                if (result.indices.GetSize() > lodIndices.GetSize() * 3u / 4u) {
+                    break;
+                }
+
+                error += result.error;
+                data.lods.EmplaceBack(MeshLod{ static_cast<std::uint32_t>(data.indices.GetSize()), static_cast<std::uint32_t>(result.indices.GetSize()), error });
+                for (auto index : result.indices) {
+                    data.indices.EmplaceBack(index);
+                }
+                lodIndices = Move(result.indices);
+            }
+        }
+
+        // ADH_MESH_OPTIMIZE lists the import passes to run, any of "cache", "overdraw" and "fetch"
+        // separated by commas. Every pass runs by default, "none" runs none. The vertex format is
+        // an import option as well, the cache holds the packed vertices.
+        std::uint32_t GetImportOptions() {
+            std::uint32_t result{ VertexPacker::GetFormat() == VertexPacker::Format::ePacked ? MeshCache::packedVertices : 0u };
+            auto passes{ std::getenv("ADH_MESH_OPTIMIZE") };
+            if (!passes) {
+                return result | MeshOptimizer::eAllPasses;
+            }
+            result |= std::strstr(passes, "cache") ? MeshOptimizer::eVertexCache : 0u;
+            result |= std::strstr(passes, "overdraw") ? MeshOptimizer::eOverdraw : 0u;
+            result |= std::strstr(passes, "fetch") ? MeshOptimizer::eVertexFetch : 0u;
+            return result;
+        }
+
+        // Of every LOD, the levels are packed one after another
+        std::size_t GetTotalIndexCount(const MeshBufferData& data) {
+            if (data.lods.IsEmpty()) {
+                return 0u;
+            }
+            const auto& last{ data.lods[data.lods.GetSize() - 1u] };
+            return std::size_t{ last.firstIndex } + last.indexCount;
+        }
+
+        // GPU vertices and indices plus the CPU positions and indices if physics read them back
+        std::size_t GetResidentSize(const MeshBufferData& data) {
+            auto format{ data.isPacked ? VertexPacker::Format::ePacked : VertexPacker::Format::eFloat };
+            return std::size_t{ VertexPacker::GetStride(format) } * data.vertexCount + sizeof(std::uint32_t) * GetTotalIndexCount(data) +
+                   sizeof(Vector3D) * data.vertices2.GetSize() + sizeof(std::uint32_t) * data.indices.GetSize();
+        }
+
+        // Every LOD is its own draw and is reordered on its own, the vertex order follows LOD 0
+        void Optimize(MeshBufferData& data, std::uint32_t passes) {
+            auto vertexCount{ static_cast<std::uint32_t>(data.vertices.GetSize()) };
+            auto before{ MeshOptimizer::Analyze(data.indices, 0u, data.lods[0].indexCount, vertexCount) };
+
+            for (const auto& lod : data.lods) {
+                if (passes & MeshOptimizer::eVertexCache) {
+                    MeshOptimizer::OptimizeVertexCache(data.indices, lod.firstIndex, lod.indexCount, vertexCount);
+                }
+                if (passes & MeshOptimizer::eOverdraw) {
+                    MeshOptimizer::OptimizeOverdraw(data.indices, lod.firstIndex, lod.indexCount, data.vertices2);
+                }
+            }
+            if (passes & MeshOptimizer::eVertexFetch) {
+                Array<std::uint32_t> remap;
+                vertexCount = MeshOptimizer::OptimizeVertexFetch(data.indices, vertexCount, remap);
+                RemapVertices(data.vertices, remap, vertexCount);
+                RemapVertices(data.vertices2, remap, vertexCount);
+            }
+
+            auto after{ MeshOptimizer::Analyze(data.indices, 0u, data.lods[0].indexCount, vertexCount) };
+            ADH_LOG("Mesh optimize: " << data.meshName << " ACMR " << before.acmr << " -> " << after.acmr
+                                   << ", ATVR " << before.atvr << " -> " << after.atvr);
+        }
+    } // namespace
+
     void Mesh::Load(const std::string& meshPath) {
-        Assimp::Importer imp;
-        auto pModel = imp.ReadFile(
-            meshPath.data(),
-            aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+        bufferData = AssetRegistry::Get()->Find<MeshBufferData>(meshPath);
+        if (bufferData && !bufferData->isReady) {
+            // Being streamed in, the triangles are needed now
+            AssetManager::Get()->Wait([this]() { return bufferData->isReady; });
+        }
+        if (IsReady()) {
+            return;
+        }
 
-        ADH_THROW(pModel, imp.GetErrorString());
+        bufferData = {};
+        auto data{ MakeShared<MeshBufferData>() };
+        MappedFile cache;
+        if (!Decode(meshPath, *data, cache)) {
+            std::string s{ "[" + meshPath + "] " + "Model does not exit!" };
+            Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eError, s.data());
+            return;
+        }
+        Upload(*data, cache);
+        bufferData = AssetRegistry::Get()->Insert<MeshBufferData>(meshPath, 0u, GetResidentSize(*data), [&data]() { return data; });
+    }
 
-        if (pModel) {
-            bufferData = Mesh::meshes[meshPath];
+    void MeshBufferData::CreateBuffers(const void* vertexData, std::uint32_t vertexStride, const void* indexData, std::uint32_t indexCount) {
+        if (vk::GeometryBuffer::IsCreated() && vk::GeometryBuffer::Get()->GetVertexStride() == vertexStride &&
+            geometry.Create(vertexData, vertexCount, indexData, indexCount)) {
+            return;
+        }
+        vertex.Create(vertexData, std::size_t{ vertexStride } * vertexCount);
+        index.Create(indexData, sizeof(std::uint32_t) * indexCount, indexCount);
+    }
+
+    void MeshBufferData::Bind(VkCommandBuffer commandBuffer) noexcept {
+        if (IsShared()) {
+            vk::GeometryBuffer::Get()->Bind(commandBuffer);
+        } else {
+            index.Bind(commandBuffer);
+            vertex.Bind(commandBuffer);
+        }
+    }
 
-            if (!bufferData) {
-                bufferData             = MakeShared<MeshBufferData>();
-                Mesh::meshes[meshPath] = bufferData;
+    bool Mesh::LoadCollision() {
+        if (bufferData && !bufferData->isReady) {
+            AssetManager::Get()->Wait([this]() { return bufferData->isReady; });
+        }
+        if (!IsReady()) {
+            return false;
+        }
+        auto& data{ *bufferData };
+        if (!data.vertices2.IsEmpty()) {
+            return true;
+        }
+
+        MeshBufferData source;
+        MappedFile cache;
+        if (!Decode(data.meshFilePath, source, cache)) {
+            return false;
+        }
+        if (cache.IsOpen()) {
+            MeshCache::ReadCollision(source, cache);
+        }
+        // Kept, rigid bodies are created again whenever the scene starts playing
+        data.vertices2 = Move(source.vertices2);
+        data.indices   = Move(source.indices);
+        AssetRegistry::Get()->SetSize(data.meshFilePath, GetResidentSize(data));
+        return true;
+    }
 
-                auto pMesh = pModel->mMeshes[0];
+    void Mesh::LoadAsync(const std::string& meshPath) {
+        bufferData = AssetRegistry::Get()->Find<MeshBufferData>(meshPath);
+        if (bufferData) {
+            return;
+        }
 
-                bufferData->vertices.Reserve(pMesh->mNumVertices);
+        // Shared by every mesh of the file right away, filled in once it's decoded
+        auto shell{ MakeShared<MeshBufferData>() };
+        shell->meshName     = meshPath.substr(meshPath.find_last_of("/") + 1u);
+        shell->meshFilePath = meshPath;
+        bufferData          = AssetRegistry::Get()->Insert<MeshBufferData>(meshPath, 0u, 0u, [&shell]() { return shell; });
 
-                for (std::size_t i{}; i != pMesh->mNumVertices; ++i) {
-                    bufferData->vertices.EmplaceBack(
-                        Vector3D{ pMesh->mVertices[i].x, pMesh->mVertices[i].y, pMesh->mVertices[i].z },
-                        Vector3D{ pMesh->mNormals[i].x, pMesh->mNormals[i].y, pMesh->mNormals[i].z },
-                        Vector2D{ pMesh->mTextureCoords[0][i].x, pMesh->mTextureCoords[0][i].y });
-                    bufferData->vertices2.EmplaceBack(Vector3D{ pMesh->mVertices[i].x, pMesh->mVertices[i].y, pMesh->mVertices[i].z });
+        struct Payload {
+            MeshBufferData data;
+            MappedFile cache;
+        };
+        auto payload{ MakeShared<Payload>() };
+        AssetManager::Get()->Submit(
+            bufferData->meshName,
+            [meshPath, payload]() {
+                return Decode(meshPath, payload->data, payload->cache);
+            },
+            [meshPath, payload, target = bufferData](bool isDecoded) {
+                if (!isDecoded) {
+                    // A failed file is tried again by the next load
+                    AssetRegistry::Get()->Remove(meshPath, target.Get());
+                    return;
                 }
+                Upload(payload->data, payload->cache);
+                *target = Move(payload->data);
+                AssetRegistry::Get()->SetSize(meshPath, GetResidentSize(*target));
+            });
+    }
 
-                bufferData->indices.Reserve(pMesh->mNumFaces * 3);
-                for (std::size_t i{}; i != pMesh->mNumFaces; ++i) {
-                    const auto& face = pMesh->mFaces[i];
-                    bufferData->indices.EmplaceBack(face.mIndices[0]);
-                    bufferData->indices.EmplaceBack(face.mIndices[1]);
-                    bufferData->indices.EmplaceBack(face.mIndices[2]);
+    void Mesh::Reload(const std::string& meshPath) {
+        auto target{ AssetRegistry::Get()->Find<MeshBufferData>(meshPath) };
+        if (!target || !target->isReady) {
+            return;
+        }
+
+        struct Payload {
+            MeshBufferData data;
+            MappedFile cache;
+        };
+        auto payload{ MakeShared<Payload>() };
+        AssetManager::Get()->Submit(
+            target->meshName,
+            [meshPath, payload]() {
+                return Decode(meshPath, payload->data, payload->cache);
+            },
+            [meshPath, payload, target](bool isDecoded) {
+                // A broken file keeps the old mesh, its buffers are freed after the frames in flight
+                if (!isDecoded) {
+                    return;
                 }
-                bufferData->vertex.Create(bufferData->vertices);
+                Upload(payload->data, payload->cache);
+                *target = Move(payload->data);
+                AssetRegistry::Get()->SetSize(meshPath, GetResidentSize(*target));
+            });
+    }
 
-                bufferData->index.Create(bufferData->indices);
+    bool Mesh::ReadTriangles(const std::string& meshPath, Array<Vector3D>& positions, Array<std::uint32_t>& indices, std::uint32_t& indexCount) {
+        MeshBufferData data;
+        MappedFile cache;
+        if (!Decode(meshPath, data, cache) || data.lods.IsEmpty()) {
+            return false;
+        }
+        if (cache.IsOpen()) {
+            MeshCache::ReadCollision(data, cache);
+        }
+        positions  = Move(data.vertices2);
+        indices    = Move(data.indices);
+        indexCount = data.lods[0].indexCount;
+        return true;
+    }
+
+    void Mesh::Clear() noexcept {
+        AssetRegistry::Get()->Clear<MeshBufferData>();
+    }
 
-                auto p = meshPath.find_last_of("/");
+    void Mesh::Benchmark(const std::string& directory) {
+        static const auto options{ GetImportOptions() };
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            auto meshPath{ entry.path().generic_string() };
+            Stopwatch<double> stopwatch;
+            MeshBufferData imported;
+            if (!Import(meshPath, options, imported)) {
+                continue;
+            }
+            MeshCache::Save(imported, meshPath, options);
+            Upload(imported, MappedFile{});
+            auto importTime{ stopwatch.Lap() };
 
-                bufferData->meshName     = meshPath.substr(p + 1);
-                bufferData->meshFilePath = meshPath;
+            MeshBufferData cached;
+            MappedFile cache;
+            auto isCached{ MeshCache::Read(meshPath, options, cached, cache) };
+            if (isCached) {
+                Upload(cached, cache);
             }
+            auto cacheTime{ stopwatch.Lap() };
+            ADH_LOG("Mesh load: " << imported.meshName << " import " << importTime * 1000.0 << " ms, cache "
+                                  << (isCached ? cacheTime * 1000.0 : 0.0) << " ms"
+                                  << (isCached ? "" : " (not cached)"));
+        }
+    }
+
+    bool Mesh::Decode(const std::string& meshPath, MeshBufferData& data, MappedFile& cache) {
+        static const auto options{ GetImportOptions() };
+        if (MeshCache::Read(meshPath, options, data, cache)) {
+            return true;
+        }
+        if (!Import(meshPath, options, data)) {
+            return false;
+        }
+        MeshCache::Save(data, meshPath, options);
+        return true;
+    }
+
+    void Mesh::Upload(MeshBufferData& data, const MappedFile& cache) {
+        if (cache.IsOpen()) {
+            MeshCache::Upload(data, cache);
+        } else if (data.isPacked) {
+            data.CreateBuffers(data.packedVertices.GetData(), sizeof(PackedVertex), data.indices.GetData(), static_cast<std::uint32_t>(data.indices.GetSize()));
         } else {
-            std::string s{ "[" + meshPath + "] " + "Model does not exit!" };
-            Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eError, s.data());
+            data.CreateBuffers(data.vertices.GetData(), sizeof(Vertex), data.indices.GetData(), static_cast<std::uint32_t>(data.indices.GetSize()));
+        }
+
+        // Only the GPU reads the vertices once they're uploaded, physics reads the rest back
+        auto format{ data.isPacked ? VertexPacker::Format::ePacked : VertexPacker::Format::eFloat };
+        auto packingSaved{ (sizeof(Vertex) - VertexPacker::GetStride(format)) * std::size_t{ data.vertexCount } };
+        auto released{ sizeof(Vertex) * data.vertices.GetSize() + sizeof(PackedVertex) * data.packedVertices.GetSize() +
+                       sizeof(Vector3D) * data.vertices2.GetSize() + sizeof(std::uint32_t) * data.indices.GetSize() };
+        ADH_LOG("Mesh memory: " << data.meshName << " " << VertexPacker::GetStride(format) << " bytes per vertex, "
+                                << packingSaved / 1024u << " KB saved by packing, " << released / 1024u << " KB of CPU copies released, "
+                                << (data.IsShared() ? "shared geometry buffer" : "own buffers"));
+        data.vertices.Clear();
+        data.packedVertices.Clear();
+        data.vertices2.Clear();
+        data.indices.Clear();
+        data.isReady = true;
+    }
+
+    // FIXME: Assimp fails with big .obj files
+    bool Mesh::Import(const std::string& meshPath, std::uint32_t options, MeshBufferData& data) {
+        Assimp::Importer imp;
+        auto pModel = imp.ReadFile(
+            meshPath.data(),
+            aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+
+        ADH_THROW(pModel, imp.GetErrorString());
+
+        if (!pModel) {
+            return false;
+        }
+        auto pMesh = pModel->mMeshes[0];
+
+        data.vertices.Reserve(pMesh->mNumVertices);
+
+        for (std::size_t i{}; i != pMesh->mNumVertices; ++i) {
+            data.vertices.EmplaceBack(
+                Vector3D{ pMesh->mVertices[i].x, pMesh->mVertices[i].y, pMesh->mVertices[i].z },
+                Vector3D{ pMesh->mNormals[i].x, pMesh->mNormals[i].y, pMesh->mNormals[i].z },
+                Vector2D{ pMesh->mTextureCoords[0][i].x, pMesh->mTextureCoords[0][i].y });
+            data.vertices2.EmplaceBack(Vector3D{ pMesh->mVertices[i].x, pMesh->mVertices[i].y, pMesh->mVertices[i].z });
+        }
+
+        auto& min{ data.boundsMin };
+        auto& max{ data.boundsMax };
+        if (pMesh->mNumVertices) {
+            min = max = data.vertices2[0];
+        }
+        for (const auto& v : data.vertices2) {
+            for (std::size_t j{}; j != 3u; ++j) {
+                min[j] = std::min(min[j], v[j]);
+                max[j] = std::max(max[j], v[j]);
+            }
+        }
+        data.boundsCenter = (min + max) * 0.5f;
+        data.boundsRadius = 0.0f;
+        for (const auto& v : data.vertices2) {
+            data.boundsRadius = std::max(data.boundsRadius, (v - data.boundsCenter).Magnitude());
+        }
+
+        data.indices.Reserve(pMesh->mNumFaces * 3);
+        for (std::size_t i{}; i != pMesh->mNumFaces; ++i) {
+            const auto& face = pMesh->mFaces[i];
+            data.indices.EmplaceBack(face.mIndices[0]);
+            data.indices.EmplaceBack(face.mIndices[1]);
+            data.indices.EmplaceBack(face.mIndices[2]);
+        }
+        auto p = meshPath.find_last_of("/");
+
+        data.meshName     = meshPath.substr(p + 1);
+        data.meshFilePath = meshPath;
+
+        GenerateLods(data);
+        Optimize(data, options);
+        data.vertexCount = static_cast<std::uint32_t>(data.vertices.GetSize());
+        if (options & MeshCache::packedVertices) {
+            VertexPacker::Pack(data.vertices, data.boundsMin, data.boundsMax, data.packedVertices);
+            data.vertices.Clear();
+            data.isPacked = true;
+        }
+
+        std::string lodTriangles;
+        for (const auto& lod : data.lods) {
+            lodTriangles += (lodTriangles.empty() ? "" : ", ") + std::to_string(lod.indexCount / 3u);
         }
+        ADH_LOG("Mesh LODs: " << data.meshName << " " << lodTriangles << " triangles");
+        return true;
     }
 
     void Mesh::Load2(const char* fileName) {
-        Load(vk::Context::Get()->GetDataDirectory() + "Assets/Models/" + fileName);
+        LoadAsync(vk::Context::Get()->GetDataDirectory() + "Assets/Models/" + fileName);
     }
 } // namespace adh
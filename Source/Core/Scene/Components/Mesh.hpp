@@ -1,6 +1,9 @@
 #pragma once
+#include "MeshLod.hpp"
 #include <Std/Array.hpp>
+#include <Std/MappedFile.hpp>
 #include <Std/SharedPtr.hpp>
+#include <Vulkan/GeometryBuffer.hpp>
 #include <Vulkan/IndexBuffer.hpp>
 #include <Vulkan/VertexBuffer.hpp>
 #include <string>
@@ -10,30 +13,88 @@
 
 namespace adh {
     struct MeshBufferData {
-        vk::IndexBuffer index;
+        static constexpr std::uint32_t maxLodCount{ MeshLod::maxCount };
+
+        // Into the shared GeometryBuffer, or buffers of its own if it's full or the vertex layout
+        // differs. The vertex count is vertexCount.
+        void CreateBuffers(const void* vertexData, std::uint32_t vertexStride, const void* indexData, std::uint32_t indexCount);
+
+        // The GeometryBuffer if the mesh is in it, draws skip the bind while the previous mesh was too
+        void Bind(VkCommandBuffer commandBuffer) noexcept;
+
+        bool IsShared() const noexcept {
+            return geometry;
+        }
+
+        // Of a LOD inside the bound index buffer
+        std::uint32_t GetFirstIndex(std::uint32_t lod) const noexcept {
+            return geometry.GetFirstIndex() + lods[lod].firstIndex;
+        }
+
+        std::int32_t GetVertexOffset() const noexcept {
+            return geometry.GetVertexOffset();
+        }
+
+        vk::GeometryRange geometry;
+        vk::IndexBuffer index; // Without a geometry range
         vk::VertexBuffer vertex;
         Array<Vertex> vertices;
+        Array<PackedVertex> packedVertices; // Instead of vertices with ADH_VERTEX_FORMAT=packed
+        // CPU positions and indices, released once uploaded. Mesh::LoadCollision() reads them back
+        // for physics cooking.
         Array<Vector3D> vertices2;
-        Array<std::uint32_t> indices;
+        Array<std::uint32_t> indices; // Every LOD, LOD 0 first
+        Array<MeshLod> lods;
+        std::uint32_t vertexCount{};
         std::string meshName;
         std::string meshFilePath;
+        // Local space bounds, used for frustum culling
+        Vector3D boundsMin;
+        Vector3D boundsMax;
+        Vector3D boundsCenter;
+        float boundsRadius{};
+        bool isPacked{}; // Positions are quantized inside the bounds, see VertexPacker
+        bool isReady{}; // False while it's streamed in, meshes draw the placeholder until then
     };
 
     class Mesh {
       public:
         void Bind(VkCommandBuffer commandBuffer) noexcept {
-            bufferData->index.Bind(commandBuffer);
-            bufferData->vertex.Bind(commandBuffer);
+            GetDrawable()->Bind(commandBuffer);
         }
 
+        // Of LOD 0 of the drawable
         std::uint32_t GetIndexCount() const noexcept {
-            return bufferData->index.GetCount();
+            auto drawable{ GetDrawable() };
+            return !drawable || drawable->lods.IsEmpty() ? 0u : drawable->lods[0].indexCount;
         }
 
+        // Blocks until the mesh is uploaded, physics shapes need the real triangles
         void Load(const std::string& meshPath);
 
+        // Decodes on an AssetManager worker, the mesh draws the placeholder until it's uploaded
+        void LoadAsync(const std::string& meshPath);
+
+        // The CPU positions and indices physics cooking needs, read back from the cache if the
+        // upload released them. Blocks until the mesh is uploaded, returns false if it can't be read.
+        bool LoadCollision();
+
+        // Streamed in, scripts load meshes while the scene plays
         void Load2(const char* fileName);
 
+        bool IsReady() const noexcept {
+            return bufferData && bufferData->isReady;
+        }
+
+        // What draws, the placeholder while the mesh is streamed in
+        MeshBufferData* GetDrawable() noexcept {
+            return IsReady() || !bufferData ? bufferData.Get() : placeholder.Get();
+        }
+
+        const MeshBufferData* GetDrawable() const noexcept {
+            return IsReady() || !bufferData ? bufferData.Get() : placeholder.Get();
+        }
+
         MeshBufferData* Get() noexcept {
             return bufferData.Get();
         }
@@ -42,15 +103,39 @@ namespace adh {
             return bufferData.Get();
         }
 
-        static void Clear() noexcept {
-            meshes.clear();
-        }
+        // Decodes a changed file again if it's resident, every mesh of the file draws the new one
+        // once it's uploaded. Collision shapes keep the old triangles until they're cooked again.
+        static void Reload(const std::string& meshPath);
+
+        // CPU positions and indices of a file, the first indexCount indices are LOD 0. Thread safe,
+        // the cache is written if there is none. Returns false if the file can't be read.
+        static bool ReadTriangles(const std::string& meshPath, Array<Vector3D>& positions, Array<std::uint32_t>& indices, std::uint32_t& indexCount);
+
+        // Drops every mesh from the AssetRegistry, meshes in use stay alive
+        static void Clear() noexcept;
+
+        // Logs the Assimp import and the cached load time of every model in directory, writes
+        // their caches on the way
+        static void Benchmark(const std::string& directory);
 
       public:
         bool toDraw{ true };
 
       private:
-        SharedPtr<MeshBufferData> bufferData;
-        inline static std::unordered_map<std::string, SharedPtr<MeshBufferData>> meshes;
+        friend class AssetManager;
+
+        // CPU side of a load, thread safe. Maps the cache, or imports the source and writes the
+        // cache. Returns false if the file can't be read.
+        static bool Decode(const std::string& meshPath, MeshBufferData& data, MappedFile& cache);
+
+        // Creates the GPU buffers, from the mapped cache if Decode() found one
+        static void Upload(MeshBufferData& data, const MappedFile& cache);
+
+        // Assimp import, LOD generation, optimization and packing
+        static bool Import(const std::string& meshPath, std::uint32_t options, MeshBufferData& data);
+
+      private:
+        SharedPtr<MeshBufferData> bufferData; // Shared through the AssetRegistry by every mesh of the file
+        inline static SharedPtr<MeshBufferData> placeholder; // Set by the AssetManager
     };
 } // namespace adh
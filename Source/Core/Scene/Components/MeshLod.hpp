@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+namespace adh {
+    // A range of MeshBufferData::indices, every LOD indexes the same vertices
+    struct MeshLod {
+        static constexpr std::uint32_t maxCount{ 4u };
+
+        std::uint32_t firstIndex;
+        std::uint32_t indexCount;
+        float error; // Local space distance the simplified surface deviates by, zero for LOD 0
+    };
+} // namespace adh
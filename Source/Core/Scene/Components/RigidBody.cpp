@@ -37,7 +37,7 @@ namespace adh {
                            const Vector3D& scale,
                            float radius,
                            float halfHeight,
-                           const Mesh* const mesh) {
+                           Mesh* const mesh) {
         this->entity           = entity;
         this->scaleSameAsModel = scaleSameAsModel;
 
@@ -101,13 +101,19 @@ namespace adh {
                 break;
             }
         }
+        actor->userData = this;
+
+        // Only the mesh shapes fail, when the mesh has no triangles to read. The body is kept
+        // without a shape and collides with nothing until the mesh is fixed.
+        if (!shape) {
+            ADH_LOG("Rigid body: no collision mesh for entity " << entity << ", the body has no shape");
+            return;
+        }
         SetTrigger(isTrigger);
         physx::PxFilterData filter;
         filter.word0 = 1;
         filter.word1 = 1;
         shape->setSimulationFilterData(filter);
-
-        actor->userData = this;
     }
 
     void RigidBody::OnUpdate(Transform& transform) noexcept {
@@ -262,6 +268,9 @@ namespace adh {
 
     void RigidBody::SetTrigger(bool isTrigger) noexcept {
         this->isTrigger = isTrigger;
+        if (!shape) {
+            return;
+        }
         if (isTrigger) {
             shape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
             shape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
@@ -301,10 +310,15 @@ namespace adh {
     }
 
     void RigidBody::SetGeometry(const physx::PxGeometry& geometry) {
-        shape->setGeometry(geometry);
+        if (shape) {
+            shape->setGeometry(geometry);
+        }
     }
 
     void RigidBody::UpdateGeometry() noexcept {
+        if (!shape) {
+            return;
+        }
         if (colliderShape == PhysicsColliderShape::eBox) {
             SetGeometry(physx::PxBoxGeometry{ scale.x, scale.y, scale.z });
         } else if (colliderShape == PhysicsColliderShape::eSphere) {
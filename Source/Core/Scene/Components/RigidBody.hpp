@@ -56,7 +56,7 @@ namespace adh {
                     const Vector3D& scale,
                     float radius,
                     float halfHeight,
-                    const Mesh* const mesh = nullptr);
+                    Mesh* const mesh = nullptr);
 
         void OnUpdate(Transform& transform) noexcept;
 
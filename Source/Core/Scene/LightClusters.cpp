@@ -0,0 +1,242 @@
+#include "LightClusters.hpp"
+#include "Components.hpp"
+#include "Scene.hpp"
+
+#include <Std/Stopwatch.hpp>
+#include <Vulkan/Context.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace adh {
+    static_assert(sizeof(LightData) == 80u, "LightData must match the std430 layout of Light in pbr_data.glsl!");
+    static_assert(sizeof(ClusterData) == 256u, "ClusterData must fill a uniform buffer offset alignment!");
+    static_assert(sizeof(LightClusters::Cluster) * LightClusters::clusterCount % 256u == 0u, "Cluster slices must stay 256 byte aligned!");
+
+    LightClusters::LightClusters() noexcept : m_Statistics{},
+                                              m_MaxLights{},
+                                              m_MaxIndices{},
+                                              m_FrameCount{} {
+    }
+
+    LightClusters::LightClusters(std::uint32_t maxLights, std::uint32_t frameCount, std::uint32_t viewCount) : m_Statistics{} {
+        Create(maxLights, frameCount, viewCount);
+    }
+
+    LightClusters::LightClusters(LightClusters&& rhs) noexcept {
+        MoveConstruct(Move(rhs));
+    }
+
+    LightClusters& LightClusters::operator=(LightClusters&& rhs) noexcept {
+        Clear();
+        MoveConstruct(Move(rhs));
+        return *this;
+    }
+
+    LightClusters::~LightClusters() {
+        Clear();
+    }
+
+    void LightClusters::Create(std::uint32_t maxLights, std::uint32_t frameCount, std::uint32_t viewCount) {
+        ADH_THROW(frameCount, "Light clusters need at least one frame!");
+        // Keep every per-frame and per-view slice 256 byte aligned (sizeof(LightData) * 16 == 1280)
+        m_MaxLights  = (std::max(maxLights, 1u) + 15u) & ~15u;
+        m_MaxIndices = (m_MaxLights * 8u + 63u) & ~63u;
+        m_FrameCount = frameCount;
+        m_Grid.Create(viewCount, m_MaxIndices);
+        m_Lights.Reserve(m_MaxLights);
+        CreateBuffers();
+    }
+
+    void LightClusters::Destroy() noexcept {
+        Clear();
+    }
+
+    void LightClusters::SetView(std::uint32_t viewIndex, const xmm::Matrix& view, const xmm::Matrix& projection, float nearZ, float farZ) ADH_NOEXCEPT {
+        m_Grid.SetView(viewIndex, view, projection, nearZ, farZ);
+    }
+
+    bool LightClusters::Build(Scene& scene) {
+        Stopwatch<> stopwatch;
+        m_Lights.Clear();
+
+        auto& world{ scene.GetWorld() };
+        world.GetSystem<PointLight>().ForEach([&](ecs::Entity e, PointLight& pointLight) {
+            auto position{ pointLight.position };
+            if (world.Contains<Transform>(e)) {
+                auto [transform] = world.Get<Transform>(e);
+                position         = transform.translate;
+            }
+
+            const float attenuation[]{ pointLight.attenuation.constant, pointLight.attenuation.linear, pointLight.attenuation.quadratic };
+            const auto range{ GetRange(pointLight.color, pointLight.intensity, attenuation) };
+            if (range <= 0.0f) {
+                return;
+            }
+
+            auto& light{ m_Lights.EmplaceBack() };
+            light.position    = xmm::Vector{ position.x, position.y, position.z, range };
+            light.color       = xmm::Vector{ pointLight.color.x, pointLight.color.y, pointLight.color.z, pointLight.intensity };
+            light.direction   = xmm::Vector{ 0.0f };
+            light.attenuation = xmm::Vector{ attenuation[0], attenuation[1], attenuation[2], 0.0f };
+            light.type        = LightType::ePoint;
+        });
+
+        world.GetSystem<SpotLight>().ForEach([&](ecs::Entity e, SpotLight& spotLight) {
+            auto position{ spotLight.position };
+            if (world.Contains<Transform>(e)) {
+                auto [transform] = world.Get<Transform>(e);
+                position         = transform.translate;
+            }
+
+            const float attenuation[]{ spotLight.attenuation.constant, spotLight.attenuation.linear, spotLight.attenuation.quadratic };
+            const auto range{ GetRange(spotLight.color, spotLight.intensity, attenuation) };
+            if (range <= 0.0f) {
+                return;
+            }
+
+            // Bound by the sphere of its range like a point light, the cone only matters in the shader
+            auto& light{ m_Lights.EmplaceBack() };
+            light.position    = xmm::Vector{ position.x, position.y, position.z, range };
+            light.color       = xmm::Vector{ spotLight.color.x, spotLight.color.y, spotLight.color.z, spotLight.intensity };
+            light.direction   = xmm::Vector{ spotLight.direction.x, spotLight.direction.y, spotLight.direction.z, spotLight.coneSize };
+            light.attenuation = xmm::Vector{ attenuation[0], attenuation[1], attenuation[2], spotLight.smoothness };
+            light.type        = LightType::eSpot;
+        });
+
+        const auto maxIndices{ m_Grid.Bin(m_Lights) };
+        m_Statistics.lightCount = static_cast<std::uint32_t>(m_Lights.GetSize());
+        m_Statistics.indexCount = 0u;
+        for (std::uint32_t i{}; i != m_Grid.GetViewCount(); ++i) {
+            m_Statistics.indexCount += static_cast<std::uint32_t>(m_Grid.GetIndices(i).GetSize());
+        }
+        m_Statistics.buildTime = stopwatch.GetTime() * 1000.0f;
+
+        if (m_Lights.GetSize() > m_MaxLights || maxIndices > m_MaxIndices) {
+            vkDeviceWaitIdle(vk::Context::Get()->GetDevice());
+            m_MaxLights  = std::max(m_MaxLights, (static_cast<std::uint32_t>(m_Lights.GetSize()) * 2u + 15u) & ~15u);
+            m_MaxIndices = std::max(m_MaxIndices, (maxIndices * 2u + 63u) & ~63u);
+            DestroyBuffers();
+            CreateBuffers();
+            return true;
+        }
+        return false;
+    }
+
+    void LightClusters::Upload(std::uint32_t frameIndex) noexcept {
+        auto* lights{ static_cast<char*>(m_LightBuffer.GetMappedPtr()) + GetLightDescriptor(frameIndex).offset };
+        if (!m_Lights.IsEmpty()) {
+            std::memcpy(lights, m_Lights.GetData(), sizeof(LightData) * m_Lights.GetSize());
+        }
+
+        for (std::uint32_t i{}; i != m_Grid.GetViewCount(); ++i) {
+            auto* data{ static_cast<char*>(m_DataBuffer.GetMappedPtr()) + GetDataDescriptor(frameIndex, i).offset };
+            std::memcpy(data, &m_Grid.GetData(i), sizeof(ClusterData));
+
+            auto* clusters{ static_cast<char*>(m_ClusterBuffer.GetMappedPtr()) + GetClusterDescriptor(frameIndex, i).offset };
+            std::memcpy(clusters, m_Grid.GetClusters(i).GetData(), sizeof(Cluster) * clusterCount);
+
+            const auto& viewIndices{ m_Grid.GetIndices(i) };
+            if (!viewIndices.IsEmpty()) {
+                auto* indices{ static_cast<char*>(m_IndexBuffer.GetMappedPtr()) + GetIndexDescriptor(frameIndex, i).offset };
+                std::memcpy(indices, viewIndices.GetData(), sizeof(std::uint32_t) * viewIndices.GetSize());
+            }
+        }
+    }
+
+    VkDescriptorBufferInfo LightClusters::GetDataDescriptor(std::uint32_t frameIndex, std::uint32_t viewIndex) const noexcept {
+        auto info{ m_DataBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex + sizeof(ClusterData) * viewIndex;
+        info.range  = sizeof(ClusterData);
+        return info;
+    }
+
+    VkDescriptorBufferInfo LightClusters::GetLightDescriptor(std::uint32_t frameIndex) const noexcept {
+        auto info{ m_LightBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex;
+        return info;
+    }
+
+    VkDescriptorBufferInfo LightClusters::GetClusterDescriptor(std::uint32_t frameIndex, std::uint32_t viewIndex) const noexcept {
+        auto info{ m_ClusterBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex + sizeof(Cluster) * clusterCount * viewIndex;
+        info.range  = sizeof(Cluster) * clusterCount;
+        return info;
+    }
+
+    VkDescriptorBufferInfo LightClusters::GetIndexDescriptor(std::uint32_t frameIndex, std::uint32_t viewIndex) const noexcept {
+        auto info{ m_IndexBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex + sizeof(std::uint32_t) * m_MaxIndices * viewIndex;
+        info.range  = sizeof(std::uint32_t) * m_MaxIndices;
+        return info;
+    }
+
+    const LightClusters::Statistics& LightClusters::GetStatistics() const noexcept {
+        return m_Statistics;
+    }
+
+    std::uint32_t LightClusters::GetViewCount() const noexcept {
+        return m_Grid.GetViewCount();
+    }
+
+    float LightClusters::GetRange(const Vector3D& color, float intensity, const float (&attenuation)[3]) const noexcept {
+        // Solves intensity * color / (constant + linear * d + quadratic * d^2) = cutoff for d
+        const auto radiance{ intensity * std::max({ color.x, color.y, color.z }) / lightCutoff };
+        const auto [constant, linear, quadratic] = attenuation;
+        if (radiance <= constant) {
+            return 0.0f;
+        }
+        if (quadratic > 0.0f) {
+            return (-linear + std::sqrt(linear * linear + 4.0f * quadratic * (radiance - constant))) / (2.0f * quadratic);
+        }
+        if (linear > 0.0f) {
+            return (radiance - constant) / linear;
+        }
+        return std::numeric_limits<float>::max();
+    }
+
+    void LightClusters::CreateBuffers() {
+        const auto viewCount{ m_Grid.GetViewCount() };
+        m_DataBuffer.Create(nullptr, sizeof(ClusterData) * viewCount, m_FrameCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        m_LightBuffer.Create(nullptr, sizeof(LightData) * m_MaxLights, m_FrameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        m_ClusterBuffer.Create(nullptr, sizeof(Cluster) * clusterCount * viewCount, m_FrameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        m_IndexBuffer.Create(nullptr, sizeof(std::uint32_t) * m_MaxIndices * viewCount, m_FrameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    void LightClusters::DestroyBuffers() noexcept {
+        m_DataBuffer.Destroy();
+        m_LightBuffer.Destroy();
+        m_ClusterBuffer.Destroy();
+        m_IndexBuffer.Destroy();
+    }
+
+    void LightClusters::MoveConstruct(LightClusters&& rhs) noexcept {
+        m_DataBuffer    = Move(rhs.m_DataBuffer);
+        m_LightBuffer   = Move(rhs.m_LightBuffer);
+        m_ClusterBuffer = Move(rhs.m_ClusterBuffer);
+        m_IndexBuffer   = Move(rhs.m_IndexBuffer);
+        m_Grid          = Move(rhs.m_Grid);
+        m_Lights        = Move(rhs.m_Lights);
+        m_Statistics    = rhs.m_Statistics;
+        m_MaxLights     = rhs.m_MaxLights;
+        m_MaxIndices    = rhs.m_MaxIndices;
+        m_FrameCount    = rhs.m_FrameCount;
+
+        rhs.m_Statistics = {};
+        rhs.m_MaxLights  = 0u;
+        rhs.m_MaxIndices = 0u;
+        rhs.m_FrameCount = 0u;
+    }
+
+    void LightClusters::Clear() noexcept {
+        DestroyBuffers();
+        m_Grid.Destroy();
+        m_Lights.Clear();
+        m_Statistics = {};
+        m_MaxLights  = 0u;
+        m_MaxIndices = 0u;
+        m_FrameCount = 0u;
+    }
+} // namespace adh
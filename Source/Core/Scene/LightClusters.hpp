@@ -0,0 +1,94 @@
+#pragma once
+#include "LightGrid.hpp"
+
+#include <Vulkan/UniformBuffer.hpp>
+
+#include <vulkan/vulkan.h>
+
+namespace adh {
+    class Scene;
+
+    // Froxel light assignment. The view frustum is split into a grid of clusters, tiled in screen
+    // space and sliced logarithmically in depth. Every point and spot light is bound by a sphere,
+    // binned into the clusters it touches and the fragment shader only loops over the lights of its
+    // own cluster. Binning runs on the CPU in LightGrid, one sphere per light against the view.
+    class LightClusters {
+      public:
+        static constexpr std::uint32_t clusterCount{ LightGrid::clusterCount };
+
+        // Attenuated radiance below this is cut off and sets the range of a light. Dim tails are
+        // traded for short light lists, most of it is hidden by the ambient term.
+        static constexpr float lightCutoff{ 1.0f / 64.0f };
+
+        using Cluster = LightGrid::Cluster;
+
+        struct Statistics {
+            std::uint32_t lightCount;
+            std::uint32_t indexCount; // Summed over every view
+            float buildTime;          // ms
+        };
+
+      public:
+        LightClusters() noexcept;
+
+        LightClusters(std::uint32_t maxLights, std::uint32_t frameCount, std::uint32_t viewCount);
+
+        LightClusters(const LightClusters& rhs) = delete;
+
+        LightClusters& operator=(const LightClusters& rhs) = delete;
+
+        LightClusters(LightClusters&& rhs) noexcept;
+
+        LightClusters& operator=(LightClusters&& rhs) noexcept;
+
+        ~LightClusters();
+
+        void Create(std::uint32_t maxLights, std::uint32_t frameCount, std::uint32_t viewCount);
+
+        void Destroy() noexcept;
+
+        // Perspective cameras only, the depth slices follow nearZ and farZ
+        void SetView(std::uint32_t viewIndex, const xmm::Matrix& view, const xmm::Matrix& projection, float nearZ, float farZ) ADH_NOEXCEPT;
+
+        // Collects every point and spot light and bins them into the clusters of every view.
+        // Returns true if a buffer had to grow and descriptors must be rewritten.
+        bool Build(Scene& scene);
+
+        void Upload(std::uint32_t frameIndex) noexcept;
+
+        VkDescriptorBufferInfo GetDataDescriptor(std::uint32_t frameIndex, std::uint32_t viewIndex) const noexcept;
+
+        VkDescriptorBufferInfo GetLightDescriptor(std::uint32_t frameIndex) const noexcept;
+
+        VkDescriptorBufferInfo GetClusterDescriptor(std::uint32_t frameIndex, std::uint32_t viewIndex) const noexcept;
+
+        VkDescriptorBufferInfo GetIndexDescriptor(std::uint32_t frameIndex, std::uint32_t viewIndex) const noexcept;
+
+        const Statistics& GetStatistics() const noexcept;
+
+        std::uint32_t GetViewCount() const noexcept;
+
+      private:
+        float GetRange(const Vector3D& color, float intensity, const float (&attenuation)[3]) const noexcept;
+
+        void CreateBuffers();
+
+        void DestroyBuffers() noexcept;
+
+        void MoveConstruct(LightClusters&& rhs) noexcept;
+
+        void Clear() noexcept;
+
+      private:
+        vk::UniformBuffer m_DataBuffer;
+        vk::UniformBuffer m_LightBuffer;
+        vk::UniformBuffer m_ClusterBuffer;
+        vk::UniformBuffer m_IndexBuffer;
+        LightGrid m_Grid;
+        Array<LightData> m_Lights;
+        Statistics m_Statistics;
+        std::uint32_t m_MaxLights;
+        std::uint32_t m_MaxIndices; // Per view
+        std::uint32_t m_FrameCount;
+    };
+} // namespace adh
@@ -0,0 +1,192 @@
+#include "LightGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace adh {
+    LightGrid::LightGrid(std::uint32_t viewCount, std::uint32_t maxIndices) {
+        Create(viewCount, maxIndices);
+    }
+
+    LightGrid::LightGrid(LightGrid&& rhs) noexcept {
+        MoveConstruct(Move(rhs));
+    }
+
+    LightGrid& LightGrid::operator=(LightGrid&& rhs) noexcept {
+        Clear();
+        MoveConstruct(Move(rhs));
+        return *this;
+    }
+
+    void LightGrid::Create(std::uint32_t viewCount, std::uint32_t maxIndices) {
+        ADH_THROW(viewCount, "Light clusters need at least one view!");
+        m_Views.Resize(viewCount);
+        for (auto& view : m_Views) {
+            view.view = xmm::Matrix{ 1.0f };
+            view.data = {};
+            view.clusters.Resize(clusterCount);
+            for (auto& cluster : view.clusters) {
+                cluster = {};
+            }
+            view.indices.Reserve(maxIndices);
+            view.isActive = false;
+        }
+    }
+
+    void LightGrid::Destroy() noexcept {
+        Clear();
+    }
+
+    void LightGrid::SetView(std::uint32_t viewIndex, const xmm::Matrix& view, const xmm::Matrix& projection, float nearZ, float farZ) ADH_NOEXCEPT {
+        ADH_THROW(viewIndex < m_Views.GetSize(), "Light cluster view out of range!");
+        ADH_THROW(nearZ > 0.0f && farZ > nearZ, "Light clusters need a perspective depth range!");
+        auto& target{ m_Views[viewIndex] };
+        target.view                = view;
+        target.projectionScale[0]  = projection[0][0];
+        target.projectionScale[1]  = projection[1][1];
+        target.data.viewProjection = projection * view;
+        target.data.gridSize[0]    = gridX;
+        target.data.gridSize[1]    = gridY;
+        target.data.gridSize[2]    = gridZ;
+
+        // slice = log(z) * scale + bias, near maps to 0 and far to gridZ
+        const float logRatio{ std::log(farZ / nearZ) };
+        target.data.depthSlicing[0] = nearZ;
+        target.data.depthSlicing[1] = farZ;
+        target.data.depthSlicing[2] = static_cast<float>(gridZ) / logRatio;
+        target.data.depthSlicing[3] = -static_cast<float>(gridZ) * std::log(nearZ) / logRatio;
+        target.isActive             = true;
+    }
+
+    std::uint32_t LightGrid::Bin(const Array<LightData>& lights) {
+        m_Bounds.Resize(lights.GetSize());
+        std::uint32_t maxIndices{};
+        for (auto& view : m_Views) {
+            Bin(view, lights);
+            view.data.gridSize[3] = static_cast<std::uint32_t>(lights.GetSize());
+            maxIndices            = std::max(maxIndices, static_cast<std::uint32_t>(view.indices.GetSize()));
+        }
+        return maxIndices;
+    }
+
+    const ClusterData& LightGrid::GetData(std::uint32_t viewIndex) const ADH_NOEXCEPT {
+        ADH_THROW(viewIndex < m_Views.GetSize(), "Light cluster view out of range!");
+        return m_Views[viewIndex].data;
+    }
+
+    const Array<LightGrid::Cluster>& LightGrid::GetClusters(std::uint32_t viewIndex) const ADH_NOEXCEPT {
+        ADH_THROW(viewIndex < m_Views.GetSize(), "Light cluster view out of range!");
+        return m_Views[viewIndex].clusters;
+    }
+
+    const Array<std::uint32_t>& LightGrid::GetIndices(std::uint32_t viewIndex) const ADH_NOEXCEPT {
+        ADH_THROW(viewIndex < m_Views.GetSize(), "Light cluster view out of range!");
+        return m_Views[viewIndex].indices;
+    }
+
+    std::uint32_t LightGrid::GetViewCount() const noexcept {
+        return static_cast<std::uint32_t>(m_Views.GetSize());
+    }
+
+    bool LightGrid::GetBounds(const View& view, const LightData& light, Bounds& bounds) const noexcept {
+        auto center{ xmm::Vector{ light.position.x, light.position.y, light.position.z, 1.0f } * view.view };
+        const auto radius{ light.position.w };
+        const auto& slicing{ view.data.depthSlicing };
+
+        const auto zMin{ center.z - radius };
+        const auto zMax{ center.z + radius };
+        if (zMax < slicing[0] || zMin > slicing[1]) {
+            return false;
+        }
+
+        auto slice{ [&slicing](float z) {
+            return static_cast<std::uint32_t>(std::clamp(std::log(z) * slicing[2] + slicing[3], 0.0f, static_cast<float>(gridZ - 1u)));
+        } };
+        bounds.min[2] = slice(std::max(zMin, slicing[0]));
+        bounds.max[2] = slice(std::min(zMax, slicing[1]));
+
+        // Spheres reaching behind the near plane may cover any tile
+        if (zMin <= slicing[0]) {
+            bounds.min[0] = bounds.min[1] = 0u;
+            bounds.max[0]                 = gridX - 1u;
+            bounds.max[1]                 = gridY - 1u;
+            return true;
+        }
+
+        // x / z over the box around the sphere peaks at its corners, a conservative screen rectangle
+        const float lower[]{ center.x - radius, center.y - radius };
+        const float upper[]{ center.x + radius, center.y + radius };
+        const std::uint32_t grid[]{ gridX, gridY };
+        for (std::uint32_t axis{}; axis != 2u; ++axis) {
+            const auto scale{ view.projectionScale[axis] };
+            const float corners[]{ scale * lower[axis] / zMin, scale * lower[axis] / zMax, scale * upper[axis] / zMin, scale * upper[axis] / zMax };
+            const auto ndcMin{ std::min({ corners[0], corners[1], corners[2], corners[3] }) };
+            const auto ndcMax{ std::max({ corners[0], corners[1], corners[2], corners[3] }) };
+            if (ndcMax < -1.0f || ndcMin > 1.0f) {
+                return false;
+            }
+
+            auto tile{ [size = grid[axis]](float ndc) {
+                return static_cast<std::uint32_t>(std::clamp((ndc * 0.5f + 0.5f) * size, 0.0f, static_cast<float>(size - 1u)));
+            } };
+            bounds.min[axis] = tile(ndcMin);
+            bounds.max[axis] = tile(ndcMax);
+        }
+        return true;
+    }
+
+    void LightGrid::Bin(View& view, const Array<LightData>& lights) noexcept {
+        for (auto& cluster : view.clusters) {
+            cluster = {};
+        }
+        view.indices.Clear();
+        if (!view.isActive) {
+            return;
+        }
+
+        auto forEachCluster{ [](const Bounds& bounds, auto&& func) {
+            for (auto z{ bounds.min[2] }; z <= bounds.max[2]; ++z) {
+                for (auto y{ bounds.min[1] }; y <= bounds.max[1]; ++y) {
+                    for (auto x{ bounds.min[0] }; x <= bounds.max[0]; ++x) {
+                        func((z * gridY + y) * gridX + x);
+                    }
+                }
+            }
+        } };
+
+        for (std::uint32_t i{}; i != lights.GetSize(); ++i) {
+            auto& bounds{ m_Bounds[i] };
+            bounds.isVisible = GetBounds(view, lights[i], bounds);
+            if (bounds.isVisible) {
+                forEachCluster(bounds, [&view](std::uint32_t cluster) { ++view.clusters[cluster].count; });
+            }
+        }
+
+        std::uint32_t offset{};
+        for (auto& cluster : view.clusters) {
+            cluster.offset = offset;
+            offset += cluster.count;
+            cluster.count = 0u;
+        }
+        view.indices.Resize(offset);
+
+        for (std::uint32_t i{}; i != lights.GetSize(); ++i) {
+            if (m_Bounds[i].isVisible) {
+                forEachCluster(m_Bounds[i], [&view, i](std::uint32_t index) {
+                    auto& cluster{ view.clusters[index] };
+                    view.indices[cluster.offset + cluster.count++] = i;
+                });
+            }
+        }
+    }
+
+    void LightGrid::MoveConstruct(LightGrid&& rhs) noexcept {
+        m_Views  = Move(rhs.m_Views);
+        m_Bounds = Move(rhs.m_Bounds);
+    }
+
+    void LightGrid::Clear() noexcept {
+        m_Views.Clear();
+        m_Bounds.Clear();
+    }
+} // namespace adh
@@ -0,0 +1,109 @@
+#pragma once
+#include <Math/Math.hpp>
+#include <Std/Array.hpp>
+
+namespace adh {
+    enum class LightType : std::uint32_t {
+        ePoint,
+        eSpot
+    };
+
+    // Matches "struct Light" in pbr_data.glsl (std430)
+    struct LightData {
+        xmm::Vector position;    // xyz = world position, w = range
+        xmm::Vector color;       // rgb = color, a = intensity
+        xmm::Vector direction;   // xyz = spot direction, w = cone size
+        xmm::Vector attenuation; // xyz = constant, linear, quadratic, w = spot smoothness
+        LightType type;
+        std::uint32_t padding[3];
+    };
+
+    // Matches "uniform ClusterData" in pbr.frag, one per view and frame
+    struct ClusterData {
+        xmm::Matrix viewProjection;
+        std::uint32_t gridSize[4]; // xyz = clusters per axis, w = light count
+        float depthSlicing[4];     // near, far, scale and bias of the logarithmic depth slices
+        std::uint32_t padding[40]; // Uniform buffer offset alignment
+    };
+
+    // The CPU half of LightClusters. Every view frustum is split into a grid of clusters, tiled in
+    // screen space and sliced logarithmically in depth, and every light is binned by its sphere
+    // into the clusters it touches.
+    class LightGrid {
+      public:
+        static constexpr std::uint32_t gridX{ 16u };
+        static constexpr std::uint32_t gridY{ 9u };
+        static constexpr std::uint32_t gridZ{ 24u };
+        static constexpr std::uint32_t clusterCount{ gridX * gridY * gridZ };
+
+        struct Cluster {
+            std::uint32_t offset; // First slot in the light index list of the view
+            std::uint32_t count;
+        };
+
+      public:
+        LightGrid() noexcept = default;
+
+        LightGrid(std::uint32_t viewCount, std::uint32_t maxIndices);
+
+        LightGrid(const LightGrid& rhs) = delete;
+
+        LightGrid& operator=(const LightGrid& rhs) = delete;
+
+        LightGrid(LightGrid&& rhs) noexcept;
+
+        LightGrid& operator=(LightGrid&& rhs) noexcept;
+
+        ~LightGrid() = default;
+
+        void Create(std::uint32_t viewCount, std::uint32_t maxIndices);
+
+        void Destroy() noexcept;
+
+        // Perspective cameras only, the depth slices follow nearZ and farZ
+        void SetView(std::uint32_t viewIndex, const xmm::Matrix& view, const xmm::Matrix& projection, float nearZ, float farZ) ADH_NOEXCEPT;
+
+        // Bins the lights into the clusters of every view, returns the longest index list of a view
+        std::uint32_t Bin(const Array<LightData>& lights);
+
+        const ClusterData& GetData(std::uint32_t viewIndex) const ADH_NOEXCEPT;
+
+        const Array<Cluster>& GetClusters(std::uint32_t viewIndex) const ADH_NOEXCEPT;
+
+        // Light indices of every cluster, Cluster::offset and count select the ones of one
+        const Array<std::uint32_t>& GetIndices(std::uint32_t viewIndex) const ADH_NOEXCEPT;
+
+        std::uint32_t GetViewCount() const noexcept;
+
+      private:
+        struct View {
+            xmm::Matrix view;
+            ClusterData data;
+            float projectionScale[2]; // Projection x and y scale, view space to NDC
+            Array<Cluster> clusters;
+            Array<std::uint32_t> indices;
+            bool isActive; // Set by SetView(), inactive views have empty clusters
+        };
+
+        // Inclusive cluster bounds of a light in a view
+        struct Bounds {
+            std::uint32_t min[3];
+            std::uint32_t max[3];
+            bool isVisible;
+        };
+
+      private:
+        bool GetBounds(const View& view, const LightData& light, Bounds& bounds) const noexcept;
+
+        // Counts, then offsets, then fills the clusters of a view
+        void Bin(View& view, const Array<LightData>& lights) noexcept;
+
+        void MoveConstruct(LightGrid&& rhs) noexcept;
+
+        void Clear() noexcept;
+
+      private:
+        Array<View> m_Views;
+        Array<Bounds> m_Bounds;
+    };
+} // namespace adh
@@ -0,0 +1,111 @@
+#include "MeshCache.hpp"
+#include <Scene/Components/Mesh.hpp>
+#include <Std/VirtualFileSystem.hpp>
+#include <Vulkan/Context.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+
+namespace adh {
+    bool MeshCache::Read(const std::string& meshPath, std::uint32_t options, MeshBufferData& data, MappedFile& cache) {
+        auto cachePath{ GetCachePath(meshPath) };
+        if (!VirtualFileSystem::Open(cachePath, cache) || cache.GetSize() < sizeof(FileHeader)) {
+            cache.Close();
+            return false;
+        }
+        FileHeader header{};
+        std::memcpy(&header, cache.GetData(), sizeof(FileHeader));
+        if (!IsValid(header, cache.GetSize(), options)) {
+            cache.Close();
+            return false;
+        }
+
+        if (!CacheFile::Validate(meshPath, cachePath, offsetof(FileHeader, source), cache)) {
+            cache.Close();
+            return false;
+        }
+
+        data.vertexCount = header.vertexCount;
+        data.isPacked    = options & packedVertices;
+        for (std::uint32_t i{}; i != header.lodCount; ++i) {
+            data.lods.EmplaceBack(header.lods[i]);
+        }
+        data.boundsMin    = Vector3D{ header.boundsMin[0], header.boundsMin[1], header.boundsMin[2] };
+        data.boundsMax    = Vector3D{ header.boundsMax[0], header.boundsMax[1], header.boundsMax[2] };
+        data.boundsCenter = Vector3D{ header.boundsCenter[0], header.boundsCenter[1], header.boundsCenter[2] };
+        data.boundsRadius = header.boundsRadius;
+        data.meshName     = meshPath.substr(meshPath.find_last_of("/") + 1u);
+        data.meshFilePath = meshPath;
+        return true;
+    }
+
+    void MeshCache::ReadCollision(MeshBufferData& data, const MappedFile& cache) {
+        FileHeader header{};
+        std::memcpy(&header, cache.GetData(), sizeof(FileHeader));
+        const auto* bytes{ static_cast<const char*>(cache.GetData()) };
+        data.vertices2.Resize(header.vertexCount);
+        data.indices.Resize(header.indexCount);
+        std::memcpy(data.vertices2.GetData(), bytes + header.positionOffset, sizeof(Vector3D) * header.vertexCount);
+        std::memcpy(data.indices.GetData(), bytes + header.indexOffset, sizeof(std::uint32_t) * header.indexCount);
+    }
+
+    void MeshCache::Upload(MeshBufferData& data, const MappedFile& cache) {
+        FileHeader header{};
+        std::memcpy(&header, cache.GetData(), sizeof(FileHeader));
+        const auto* bytes{ static_cast<const char*>(cache.GetData()) };
+        data.CreateBuffers(bytes + header.vertexOffset, header.vertexStride, bytes + header.indexOffset, header.indexCount);
+    }
+
+    void MeshCache::Save(const MeshBufferData& data, const std::string& meshPath, std::uint32_t options) noexcept {
+        try {
+            auto vertexCount{ (options & packedVertices) ? data.packedVertices.GetSize() : data.vertices.GetSize() };
+            if (vertexCount != data.vertices2.GetSize() || data.lods.IsEmpty() || data.lods.GetSize() > MeshBufferData::maxLodCount) {
+                return;
+            }
+
+            CacheFile::Source source;
+            if (!CacheFile::GetSource(meshPath, source)) {
+                return;
+            }
+
+            FileHeader header{};
+            header.magic        = magic;
+            header.version      = version;
+            header.options      = options;
+            header.vertexStride = GetVertexStride(options);
+            header.source       = source;
+            header.vertexCount  = static_cast<std::uint32_t>(vertexCount);
+            header.indexCount   = static_cast<std::uint32_t>(data.indices.GetSize());
+            header.lodCount     = static_cast<std::uint32_t>(data.lods.GetSize());
+            for (std::uint32_t i{}; i != header.lodCount; ++i) {
+                header.lods[i] = data.lods[i];
+            }
+            for (std::size_t i{}; i != 3u; ++i) {
+                header.boundsMin[i]    = data.boundsMin[i];
+                header.boundsMax[i]    = data.boundsMax[i];
+                header.boundsCenter[i] = data.boundsCenter[i];
+            }
+            header.boundsRadius   = data.boundsRadius;
+            header.vertexOffset   = Align(sizeof(FileHeader));
+            header.positionOffset = Align(header.vertexOffset + std::uint64_t{ header.vertexStride } * header.vertexCount);
+            header.indexOffset    = Align(header.positionOffset + sizeof(Vector3D) * header.vertexCount);
+
+            auto vertexData{ (options & packedVertices) ? static_cast<const void*>(data.packedVertices.GetData()) : data.vertices.GetData() };
+            CacheFile::Write(GetCachePath(meshPath), { { 0u, &header, sizeof(FileHeader) },
+                                                       { header.vertexOffset, vertexData, std::size_t{ header.vertexStride } * header.vertexCount },
+                                                       { header.positionOffset, data.vertices2.GetData(), sizeof(Vector3D) * header.vertexCount },
+                                                       { header.indexOffset, data.indices.GetData(), sizeof(std::uint32_t) * header.indexCount } });
+        } catch (const std::exception&) {
+            // Paths and streams allocate, running out only leaves the cache unwritten
+        }
+    }
+
+    std::string MeshCache::GetCachePath(const std::string& meshPath) {
+        return CacheFile::GetPath(vk::Context::Get()->GetDataDirectory(), meshPath, "MeshCache", ".adhmesh");
+    }
+
+    std::uint64_t MeshCache::Align(std::uint64_t offset) noexcept {
+        return (offset + blobAlignment - 1u) & ~static_cast<std::uint64_t>(blobAlignment - 1u);
+    }
+} // namespace adh
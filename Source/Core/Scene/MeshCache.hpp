@@ -0,0 +1,94 @@
+#pragma once
+#include <Asset/CacheFile.hpp>
+#include <Scene/Components/MeshLod.hpp>
+#include <Std/MappedFile.hpp>
+#include <Vertex.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace adh {
+    struct MeshBufferData;
+
+    // Engine-native copy of an imported mesh, written after the first import so later loads skip
+    // Assimp, LOD generation and the optimizer. The file is a header followed by the vertex,
+    // position and index blobs, each aligned to blobAlignment. It's mapped and the GPU buffers are
+    // uploaded straight from the mapped pages. Kept and reused as a CacheFile.
+    class MeshCache {
+      public:
+        static constexpr std::uint32_t magic{ 0x4D484441u }; // "ADHM"
+        static constexpr std::uint32_t version{ 1u };
+        static constexpr std::size_t blobAlignment{ 16u };
+        static constexpr std::uint32_t packedVertices{ 1u << 31u }; // Option, the vertex blob is PackedVertex
+
+      public:
+        // Maps the cache and fills everything but the GPU buffers and the CPU positions and indices,
+        // cache stays mapped for Upload(). Returns false if there is no cache for the source or it's
+        // stale. options are the import settings the cache must have been written with. Thread safe.
+        static bool Read(const std::string& meshPath, std::uint32_t options, MeshBufferData& data, MappedFile& cache);
+
+        // Copies the CPU positions and indices out of the pages mapped by Read()
+        static void ReadCollision(MeshBufferData& data, const MappedFile& cache);
+
+        // Creates the vertex and index buffers from the pages mapped by Read()
+        static void Upload(MeshBufferData& data, const MappedFile& cache);
+
+        // The CPU vertices of data must still be there, errors only leave the cache unwritten
+        static void Save(const MeshBufferData& data, const std::string& meshPath, std::uint32_t options) noexcept;
+
+        static std::string GetCachePath(const std::string& meshPath);
+
+      public:
+        // At the start of every cache, read with memcpy() so the mapping needs no alignment
+        struct FileHeader {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t options;
+            std::uint32_t vertexStride; // sizeof(Vertex) or sizeof(PackedVertex) of the writer
+            CacheFile::Source source;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+            std::uint32_t lodCount;
+            std::uint32_t padding;
+            MeshLod lods[MeshLod::maxCount];
+            float boundsMin[3];
+            float boundsMax[3];
+            float boundsCenter[3];
+            float boundsRadius;
+            std::uint64_t vertexOffset;
+            std::uint64_t positionOffset;
+            std::uint64_t indexOffset;
+        };
+
+        // The header was written with options, its blobs and LODs are in order and inside a file of
+        // fileSize bytes. Offsets are bounded by fileSize before they're added to, no sum can wrap.
+        static bool IsValid(const FileHeader& header, std::size_t fileSize, std::uint32_t options) noexcept {
+            if (header.magic != magic || header.version != version || header.options != options ||
+                header.vertexStride != GetVertexStride(options) || !header.lodCount || header.lodCount > MeshLod::maxCount) {
+                return false;
+            }
+            if (header.vertexOffset < sizeof(FileHeader) || header.vertexOffset > fileSize || header.positionOffset > fileSize ||
+                header.indexOffset > fileSize) {
+                return false;
+            }
+            if (header.positionOffset < header.vertexOffset + std::uint64_t{ header.vertexStride } * header.vertexCount ||
+                header.indexOffset < header.positionOffset + sizeof(Vector3D) * header.vertexCount ||
+                header.indexOffset + sizeof(std::uint32_t) * header.indexCount > fileSize) {
+                return false;
+            }
+            for (std::uint32_t i{}; i != header.lodCount; ++i) {
+                if (std::uint64_t{ header.lods[i].firstIndex } + header.lods[i].indexCount > header.indexCount) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static std::uint32_t GetVertexStride(std::uint32_t options) noexcept {
+            return (options & packedVertices) ? sizeof(PackedVertex) : sizeof(Vertex);
+        }
+
+      private:
+        static std::uint64_t Align(std::uint64_t offset) noexcept;
+    };
+} // namespace adh
@@ -0,0 +1,276 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace adh {
+    namespace {
+        // FIFO cache simulated with timestamps, a vertex is cached while fewer than cacheSize
+        // vertices missed after it
+        class FifoCache {
+          public:
+            explicit FifoCache(std::uint32_t vertexCount) : m_Time{ MeshOptimizer::cacheSize + 1u } {
+                m_Stamps.Resize(vertexCount, 0u);
+            }
+
+            // Returns true on a miss
+            bool Access(std::uint32_t vertex) noexcept {
+                if (m_Time - m_Stamps[vertex] > MeshOptimizer::cacheSize) {
+                    m_Stamps[vertex] = m_Time++;
+                    return true;
+                }
+                return false;
+            }
+
+            // Age of a cached vertex, more than cacheSize if it isn't cached
+            std::uint32_t GetAge(std::uint32_t vertex) const noexcept {
+                return m_Time - m_Stamps[vertex];
+            }
+
+            void Flush() noexcept {
+                m_Time += MeshOptimizer::cacheSize + 1u;
+            }
+
+          private:
+            Array<std::uint32_t> m_Stamps;
+            std::uint32_t m_Time;
+        };
+
+        struct Cluster {
+            std::uint32_t firstTriangle;
+            std::uint32_t triangleCount;
+            float sortKey;
+        };
+    } // namespace
+
+    void MeshOptimizer::OptimizeVertexCache(Array<std::uint32_t>& indices, std::size_t first, std::size_t count, std::uint32_t vertexCount) {
+        const auto triangleCount{ count / 3u };
+        if (triangleCount < 2u) {
+            return;
+        }
+
+        Array<std::uint32_t> input;
+        input.Resize(count);
+        std::memcpy(input.GetData(), indices.GetData() + first, sizeof(std::uint32_t) * count);
+
+        // Triangles around every vertex and how many of them aren't emitted yet
+        Array<std::uint32_t> offsets;
+        Array<std::uint32_t> liveCounts;
+        Array<std::uint32_t> adjacency;
+        offsets.Resize(vertexCount + 1u, 0u);
+        liveCounts.Resize(vertexCount, 0u);
+        adjacency.Resize(count);
+        for (auto index : input) {
+            ++liveCounts[index];
+        }
+        for (std::uint32_t i{}; i != vertexCount; ++i) {
+            offsets[i + 1u] = offsets[i] + liveCounts[i];
+        }
+        {
+            Array<std::uint32_t> cursors{ offsets };
+            for (std::size_t i{}; i != count; ++i) {
+                adjacency[cursors[input[i]]++] = static_cast<std::uint32_t>(i / 3u);
+            }
+        }
+
+        FifoCache cache{ vertexCount };
+        Array<std::uint8_t> isEmitted;
+        Array<std::uint32_t> deadEnds;
+        Array<std::uint32_t> candidates;
+        isEmitted.Resize(triangleCount, std::uint8_t{});
+        deadEnds.Reserve(count);
+        candidates.Resize(count);
+
+        auto* output{ indices.GetData() + first };
+        std::uint32_t cursor{};
+        auto fanning{ input[0] };
+        while (fanning != invalidIndex) {
+            // Emits every triangle left around the fanning vertex
+            std::size_t candidateCount{};
+            for (auto i{ offsets[fanning] }; i != offsets[fanning + 1u]; ++i) {
+                auto triangle{ adjacency[i] };
+                if (isEmitted[triangle]) {
+                    continue;
+                }
+                for (std::size_t j{}; j != 3u; ++j) {
+                    auto vertex{ input[triangle * 3u + j] };
+                    *output++ = vertex;
+                    deadEnds.EmplaceBack(vertex);
+                    candidates[candidateCount++] = vertex;
+                    --liveCounts[vertex];
+                    cache.Access(vertex);
+                }
+                isEmitted[triangle] = 1u;
+            }
+
+            // Fans next around the oldest candidate that stays cached for all its triangles
+            fanning = invalidIndex;
+            std::int64_t bestPriority{ -1 };
+            for (std::size_t i{}; i != candidateCount; ++i) {
+                auto vertex{ candidates[i] };
+                if (!liveCounts[vertex]) {
+                    continue;
+                }
+                std::int64_t priority{};
+                if (cache.GetAge(vertex) + 2u * liveCounts[vertex] <= cacheSize) {
+                    priority = cache.GetAge(vertex);
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    fanning      = vertex;
+                }
+            }
+
+            // Dead end, the most recently used vertex with triangles left or the next one in input order
+            while (fanning == invalidIndex && !deadEnds.IsEmpty()) {
+                auto vertex{ deadEnds[deadEnds.GetSize() - 1u] };
+                deadEnds.PopBack();
+                if (liveCounts[vertex]) {
+                    fanning = vertex;
+                }
+            }
+            while (fanning == invalidIndex && cursor != vertexCount) {
+                if (liveCounts[cursor]) {
+                    fanning = cursor;
+                }
+                ++cursor;
+            }
+        }
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(Array<std::uint32_t>& indices, std::size_t first, std::size_t count,
+                                         const Array<Vector3D>& positions, float threshold) {
+        const auto triangleCount{ static_cast<std::uint32_t>(count / 3u) };
+        if (triangleCount < 2u) {
+            return;
+        }
+
+        const auto* input{ indices.GetData() + first };
+        FifoCache cache{ static_cast<std::uint32_t>(positions.GetSize()) };
+        auto getMisses{ [&](std::uint32_t triangle) {
+            std::uint32_t misses{};
+            for (std::size_t j{}; j != 3u; ++j) {
+                misses += cache.Access(input[triangle * 3u + j]) ? 1u : 0u;
+            }
+            return misses;
+        } };
+
+        // Hard boundaries, the cache order restarts where all three vertices of a triangle miss
+        Array<std::uint32_t> hardBoundaries;
+        for (std::uint32_t i{}; i != triangleCount; ++i) {
+            if (getMisses(i) == 3u || !i) {
+                hardBoundaries.EmplaceBack(i);
+            }
+        }
+        hardBoundaries.EmplaceBack(triangleCount);
+
+        // Soft boundaries, a cluster ends once its own miss ratio is close to the one of the hard cluster
+        Array<Cluster> clusters;
+        for (std::size_t i{}; i + 1u != hardBoundaries.GetSize(); ++i) {
+            auto start{ hardBoundaries[i] };
+            auto end{ hardBoundaries[i + 1u] };
+
+            cache.Flush();
+            std::uint32_t misses{};
+            for (auto j{ start }; j != end; ++j) {
+                misses += getMisses(j);
+            }
+            auto acmr{ static_cast<float>(misses) / static_cast<float>(end - start) };
+
+            cache.Flush();
+            auto clusterStart{ start };
+            misses = 0u;
+            for (auto j{ start }; j != end; ++j) {
+                misses += getMisses(j);
+                auto size{ j + 1u - clusterStart };
+                if (j + 1u != end && static_cast<float>(misses) / static_cast<float>(size) <= threshold * acmr) {
+                    clusters.EmplaceBack(Cluster{ clusterStart, size, 0.0f });
+                    clusterStart = j + 1u;
+                    misses       = 0u;
+                    cache.Flush();
+                }
+            }
+            clusters.EmplaceBack(Cluster{ clusterStart, end - clusterStart, 0.0f });
+        }
+
+        // Clusters facing away from the mesh center are drawn first, they occlude the rest
+        auto getCentroid{ [&](std::uint32_t firstTriangle, std::uint32_t clusterTriangles, Vector3D& normal) {
+            Vector3D centroid{};
+            normal = Vector3D{};
+            auto totalArea{ 0.0f };
+            for (auto i{ firstTriangle }; i != firstTriangle + clusterTriangles; ++i) {
+                const auto& a{ positions[input[i * 3u]] };
+                const auto& b{ positions[input[i * 3u + 1u]] };
+                const auto& c{ positions[input[i * 3u + 2u]] };
+                auto triangleNormal{ Cross(b - a, c - a) };
+                auto area{ triangleNormal.Magnitude() };
+                centroid = centroid + (a + b + c) * (area / 3.0f);
+                normal   = normal + triangleNormal;
+                totalArea += area;
+            }
+            auto length{ normal.Magnitude() };
+            if (length > 0.0f) {
+                normal.Divide(length);
+            }
+            return totalArea > 0.0f ? centroid * (1.0f / totalArea) : centroid;
+        } };
+
+        Vector3D meshNormal;
+        auto meshCentroid{ getCentroid(0u, triangleCount, meshNormal) };
+        for (auto& cluster : clusters) {
+            Vector3D normal;
+            auto centroid{ getCentroid(cluster.firstTriangle, cluster.triangleCount, normal) };
+            cluster.sortKey = (centroid - meshCentroid).Dot(normal);
+        }
+        std::stable_sort(clusters.GetData(), clusters.GetData() + clusters.GetSize(), [](const Cluster& lhs, const Cluster& rhs) {
+            return lhs.sortKey > rhs.sortKey;
+        });
+
+        Array<std::uint32_t> sorted;
+        sorted.Reserve(count);
+        for (const auto& cluster : clusters) {
+            for (auto i{ cluster.firstTriangle * 3u }; i != (cluster.firstTriangle + cluster.triangleCount) * 3u; ++i) {
+                sorted.EmplaceBack(input[i]);
+            }
+        }
+        std::memcpy(indices.GetData() + first, sorted.GetData(), sizeof(std::uint32_t) * count);
+    }
+
+    std::uint32_t MeshOptimizer::OptimizeVertexFetch(Array<std::uint32_t>& indices, std::uint32_t vertexCount, Array<std::uint32_t>& remap) {
+        remap.Clear();
+        remap.Resize(vertexCount, invalidIndex);
+
+        std::uint32_t usedCount{};
+        for (auto& index : indices) {
+            if (remap[index] == invalidIndex) {
+                remap[index] = usedCount++;
+            }
+            index = remap[index];
+        }
+        return usedCount;
+    }
+
+    MeshOptimizer::Statistics MeshOptimizer::Analyze(const Array<std::uint32_t>& indices, std::size_t first, std::size_t count, std::uint32_t vertexCount) {
+        FifoCache cache{ vertexCount };
+        Array<std::uint8_t> isUsed;
+        isUsed.Resize(vertexCount, std::uint8_t{});
+
+        std::uint32_t misses{};
+        std::uint32_t usedCount{};
+        for (auto i{ first }; i != first + count; ++i) {
+            auto vertex{ indices[i] };
+            misses += cache.Access(vertex) ? 1u : 0u;
+            if (!isUsed[vertex]) {
+                isUsed[vertex] = 1u;
+                ++usedCount;
+            }
+        }
+
+        Statistics statistics{};
+        if (count >= 3u) {
+            statistics.acmr = static_cast<float>(misses) / static_cast<float>(count / 3u);
+            statistics.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+        }
+        return statistics;
+    }
+} // namespace adh
@@ -0,0 +1,58 @@
+#pragma once
+#include <Math/Math.hpp>
+#include <Std/Array.hpp>
+
+#include <cstdint>
+
+namespace adh {
+    // Index and vertex reordering run at import. The vertex cache pass is Tipsify (Sander, Nehab
+    // and Barczak), the overdraw pass splits its output into clusters and sorts them so outward
+    // facing clusters are drawn first, the fetch pass renumbers vertices in the order they are
+    // first used. None of them changes the triangles, only their order and the vertex order.
+    class MeshOptimizer {
+      public:
+        enum Pass : std::uint32_t {
+            eVertexCache = 1u << 0u,
+            eOverdraw    = 1u << 1u,
+            eVertexFetch = 1u << 2u,
+            eAllPasses   = eVertexCache | eOverdraw | eVertexFetch
+        };
+
+        // Of a simulated FIFO post-transform cache
+        struct Statistics {
+            float acmr; // Average cache miss ratio, transformed vertices per triangle (0.5 to 3)
+            float atvr; // Average transformed vertex ratio, transformed vertices per used vertex (1 is optimal)
+        };
+
+        static constexpr std::uint32_t cacheSize{ 16u };
+        static constexpr std::uint32_t invalidIndex{ ~0u };
+
+      public:
+        // Reorders the triangles of indices [first, first + count) in place
+        static void OptimizeVertexCache(Array<std::uint32_t>& indices, std::size_t first, std::size_t count, std::uint32_t vertexCount);
+
+        // Keeps the cache order inside clusters, a cluster is only split while its miss ratio stays
+        // within threshold of the unsplit one
+        static void OptimizeOverdraw(Array<std::uint32_t>& indices, std::size_t first, std::size_t count,
+                                     const Array<Vector3D>& positions, float threshold = 1.05f);
+
+        // New index of every vertex in the order of first use, unused vertices are invalidIndex.
+        // Rewrites indices, returns the number of used vertices.
+        static std::uint32_t OptimizeVertexFetch(Array<std::uint32_t>& indices, std::uint32_t vertexCount, Array<std::uint32_t>& remap);
+
+        static Statistics Analyze(const Array<std::uint32_t>& indices, std::size_t first, std::size_t count, std::uint32_t vertexCount);
+    };
+
+    // Applies a remap of OptimizeVertexFetch() to one vertex stream
+    template <typename T>
+    void RemapVertices(Array<T>& vertices, const Array<std::uint32_t>& remap, std::uint32_t usedCount) {
+        Array<T> remapped;
+        remapped.Resize(usedCount);
+        for (std::size_t i{}; i != remap.GetSize(); ++i) {
+            if (remap[i] != MeshOptimizer::invalidIndex) {
+                remapped[remap[i]] = vertices[i];
+            }
+        }
+        vertices = Move(remapped);
+    }
+} // namespace adh
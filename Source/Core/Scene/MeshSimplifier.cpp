@@ -0,0 +1,249 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace adh {
+    namespace {
+        constexpr std::uint32_t invalidIndex{ std::numeric_limits<std::uint32_t>::max() };
+
+        std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b) noexcept {
+            return a < b ? (static_cast<std::uint64_t>(a) << 32u) | b : (static_cast<std::uint64_t>(b) << 32u) | a;
+        }
+
+        // Not normalized, twice the area
+        Vector3D TriangleNormal(const Vector3D& a, const Vector3D& b, const Vector3D& c) noexcept {
+            return Cross(b - a, c - a);
+        }
+    } // namespace
+
+    MeshSimplifier::Result MeshSimplifier::Simplify(const Array<Vector3D>& positions, const Array<std::uint32_t>& indices, std::size_t targetIndexCount) {
+        Result result{ indices, 0.0f };
+        const auto vertexCount{ static_cast<std::uint32_t>(positions.GetSize()) };
+
+        Array<Quadric> quadrics;
+        quadrics.Resize(vertexCount, Quadric{});
+        for (std::size_t i{}; i < indices.GetSize(); i += 3u) {
+            auto normal{ TriangleNormal(positions[indices[i]], positions[indices[i + 1u]], positions[indices[i + 2u]]) };
+            auto length{ normal.Magnitude() };
+            if (length == 0.0f) {
+                continue;
+            }
+            normal.Divide(length);
+            auto distance{ -static_cast<double>(normal.Dot(positions[indices[i]])) };
+            for (std::size_t j{}; j != 3u; ++j) {
+                AddPlane(quadrics[indices[i + j]], normal, distance, length * 0.5);
+            }
+        }
+
+        // Edges that don't have exactly two triangles are borders or non-manifold, their vertices stay
+        Array<std::uint8_t> isLocked;
+        isLocked.Resize(vertexCount, std::uint8_t{});
+        Array<std::uint64_t> edges;
+        edges.Resize(indices.GetSize());
+        for (std::size_t i{}; i < indices.GetSize(); i += 3u) {
+            for (std::size_t j{}; j != 3u; ++j) {
+                edges[i + j] = EdgeKey(indices[i + j], indices[i + (j + 1u) % 3u]);
+            }
+        }
+        std::sort(edges.GetData(), edges.GetData() + edges.GetSize());
+        for (std::size_t i{}; i != edges.GetSize();) {
+            auto j{ i + 1u };
+            while (j != edges.GetSize() && edges[j] == edges[i]) {
+                ++j;
+            }
+            if (j - i != 2u) {
+                isLocked[static_cast<std::uint32_t>(edges[i] >> 32u)] = 1u;
+                isLocked[static_cast<std::uint32_t>(edges[i])]        = 1u;
+            }
+            i = j;
+        }
+
+        Array<std::uint32_t> remap;
+        Array<std::uint8_t> isTouched;
+        Array<std::uint32_t> adjacencyOffsets;
+        Array<std::uint32_t> adjacencyCursors;
+        Array<std::uint32_t> adjacency;
+        Array<Collapse> collapses;
+        remap.Resize(vertexCount);
+        isTouched.Resize(vertexCount);
+        adjacencyOffsets.Resize(vertexCount + 1u);
+        adjacencyCursors.Resize(vertexCount);
+        adjacency.Resize(indices.GetSize());
+        collapses.Reserve(edges.GetSize());
+
+        double maxCost{};
+        auto& current{ result.indices };
+        auto indexCount{ current.GetSize() };
+        // Every pass collapses a set of edges whose triangle fans don't overlap, then removes the
+        // triangles that became degenerate
+        while (indexCount > targetIndexCount) {
+            adjacencyOffsets.Fill(0u);
+            for (std::size_t i{}; i != indexCount; ++i) {
+                ++adjacencyOffsets[current[i] + 1u];
+            }
+            for (std::uint32_t i{}; i != vertexCount; ++i) {
+                adjacencyOffsets[i + 1u] += adjacencyOffsets[i];
+                adjacencyCursors[i] = adjacencyOffsets[i];
+            }
+            for (std::size_t i{}; i != indexCount; ++i) {
+                adjacency[adjacencyCursors[current[i]]++] = static_cast<std::uint32_t>(i / 3u);
+            }
+
+            for (std::size_t i{}; i < indexCount; i += 3u) {
+                for (std::size_t j{}; j != 3u; ++j) {
+                    edges[i + j] = EdgeKey(current[i + j], current[i + (j + 1u) % 3u]);
+                }
+            }
+            std::sort(edges.GetData(), edges.GetData() + indexCount);
+            auto edgeCount{ static_cast<std::size_t>(std::unique(edges.GetData(), edges.GetData() + indexCount) - edges.GetData()) };
+
+            // Each edge collapses towards the end that moves the other one the least
+            collapses.Clear();
+            for (std::size_t i{}; i != edgeCount; ++i) {
+                std::uint32_t vertices[]{ static_cast<std::uint32_t>(edges[i] >> 32u), static_cast<std::uint32_t>(edges[i]) };
+                Collapse collapse{ std::numeric_limits<double>::max(), invalidIndex, invalidIndex };
+                for (std::size_t j{}; j != 2u; ++j) {
+                    auto from{ vertices[j] };
+                    auto to{ vertices[1u - j] };
+                    if (isLocked[from]) {
+                        continue;
+                    }
+                    auto quadric{ quadrics[from] };
+                    Add(quadric, quadrics[to]);
+                    auto cost{ Evaluate(quadric, positions[to]) };
+                    if (cost < collapse.cost) {
+                        collapse = Collapse{ cost, from, to };
+                    }
+                }
+                if (collapse.from != invalidIndex) {
+                    collapses.EmplaceBack(collapse);
+                }
+            }
+            std::sort(collapses.GetData(), collapses.GetData() + collapses.GetSize(), [](const Collapse& lhs, const Collapse& rhs) {
+                return lhs.cost < rhs.cost;
+            });
+
+            for (std::uint32_t i{}; i != vertexCount; ++i) {
+                remap[i] = i;
+            }
+            isTouched.Fill(0u);
+
+            auto remainingCount{ indexCount };
+            auto isCollapsed{ false };
+            for (const auto& collapse : collapses) {
+                if (remainingCount <= targetIndexCount) {
+                    break;
+                }
+                if (isTouched[collapse.from] || isTouched[collapse.to]) {
+                    continue;
+                }
+
+                auto isFlipping{ false };
+                std::size_t removedCount{};
+                for (auto k{ adjacencyOffsets[collapse.from] }; k != adjacencyOffsets[collapse.from + 1u] && !isFlipping; ++k) {
+                    const auto* triangle{ &current[adjacency[k] * 3u] };
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                        removedCount += 3u;
+                        continue;
+                    }
+
+                    Vector3D moved[3];
+                    for (std::size_t j{}; j != 3u; ++j) {
+                        moved[j] = positions[triangle[j] == collapse.from ? collapse.to : triangle[j]];
+                    }
+                    auto before{ TriangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]) };
+                    auto after{ TriangleNormal(moved[0], moved[1], moved[2]) };
+                    // A triangle left without area has no orientation, later collapses could flip it
+                    // unnoticed. Degenerate triangles of the source are let through.
+                    isFlipping = before.Dot(after) <= 0.0f && before.Dot(before) > 0.0f;
+                }
+                if (isFlipping) {
+                    continue;
+                }
+
+                for (auto k{ adjacencyOffsets[collapse.from] }; k != adjacencyOffsets[collapse.from + 1u]; ++k) {
+                    const auto* triangle{ &current[adjacency[k] * 3u] };
+                    for (std::size_t j{}; j != 3u; ++j) {
+                        isTouched[triangle[j]] = 1u;
+                    }
+                }
+                remap[collapse.from] = collapse.to;
+                Add(quadrics[collapse.to], quadrics[collapse.from]);
+                maxCost = std::max(maxCost, collapse.cost);
+                remainingCount -= removedCount;
+                isCollapsed = true;
+            }
+            if (!isCollapsed) {
+                break;
+            }
+
+            std::size_t count{};
+            for (std::size_t i{}; i < indexCount; i += 3u) {
+                auto a{ remap[current[i]] };
+                auto b{ remap[current[i + 1u]] };
+                auto c{ remap[current[i + 2u]] };
+                if (a != b && b != c && a != c) {
+                    current[count++] = a;
+                    current[count++] = b;
+                    current[count++] = c;
+                }
+            }
+            indexCount = count;
+        }
+
+        // Array only grows, shrink into a copy of the right size
+        Array<std::uint32_t> simplified;
+        simplified.Resize(indexCount);
+        std::copy(current.GetData(), current.GetData() + indexCount, simplified.GetData());
+        result.indices = Move(simplified);
+        result.error   = static_cast<float>(std::sqrt(maxCost));
+        return result;
+    }
+
+    void MeshSimplifier::AddPlane(Quadric& quadric, const Vector3D& normal, double distance, double weight) noexcept {
+        const double a{ normal[0] };
+        const double b{ normal[1] };
+        const double c{ normal[2] };
+        quadric.a00 += weight * a * a;
+        quadric.a01 += weight * a * b;
+        quadric.a02 += weight * a * c;
+        quadric.a03 += weight * a * distance;
+        quadric.a11 += weight * b * b;
+        quadric.a12 += weight * b * c;
+        quadric.a13 += weight * b * distance;
+        quadric.a22 += weight * c * c;
+        quadric.a23 += weight * c * distance;
+        quadric.a33 += weight * distance * distance;
+        quadric.weight += weight;
+    }
+
+    void MeshSimplifier::Add(Quadric& lhs, const Quadric& rhs) noexcept {
+        lhs.a00 += rhs.a00;
+        lhs.a01 += rhs.a01;
+        lhs.a02 += rhs.a02;
+        lhs.a03 += rhs.a03;
+        lhs.a11 += rhs.a11;
+        lhs.a12 += rhs.a12;
+        lhs.a13 += rhs.a13;
+        lhs.a22 += rhs.a22;
+        lhs.a23 += rhs.a23;
+        lhs.a33 += rhs.a33;
+        lhs.weight += rhs.weight;
+    }
+
+    double MeshSimplifier::Evaluate(const Quadric& quadric, const Vector3D& point) noexcept {
+        if (quadric.weight == 0.0) {
+            return 0.0;
+        }
+        const double x{ point[0] };
+        const double y{ point[1] };
+        const double z{ point[2] };
+        // p^T Q p with p = (x, y, z, 1)
+        auto error{ quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z + quadric.a33 +
+                    2.0 * (quadric.a01 * x * y + quadric.a02 * x * z + quadric.a12 * y * z +
+                           quadric.a03 * x + quadric.a13 * y + quadric.a23 * z) };
+        return std::max(error, 0.0) / quadric.weight;
+    }
+} // namespace adh
@@ -0,0 +1,49 @@
+#pragma once
+#include <Math/Math.hpp>
+#include <Std/Array.hpp>
+
+#include <cstdint>
+
+namespace adh {
+    // Quadric error metric simplification (Garland and Heckbert). Edges collapse onto one of their
+    // vertices, so the simplified indices still index the vertices of the full mesh and every level
+    // shares one vertex buffer. Vertices on open borders, which include UV and normal seams after
+    // the importer joined identical vertices, never move, the silhouette and the seams stay closed.
+    // Triangles that would flip or lose their area are never produced.
+    class MeshSimplifier {
+      public:
+        struct Result {
+            Array<std::uint32_t> indices;
+            float error; // Local space distance, the largest RMS distance a collapsed vertex moved off its planes
+        };
+
+      public:
+        // Collapses the cheapest edges until at most targetIndexCount indices are left or nothing
+        // can collapse anymore
+        static Result Simplify(const Array<Vector3D>& positions, const Array<std::uint32_t>& indices, std::size_t targetIndexCount);
+
+      private:
+        // Symmetric 4x4 plane quadric, weighted by triangle area
+        struct Quadric {
+            double a00, a01, a02, a03;
+            double a11, a12, a13;
+            double a22, a23;
+            double a33;
+            double weight;
+        };
+
+        struct Collapse {
+            double cost;
+            std::uint32_t from;
+            std::uint32_t to;
+        };
+
+      private:
+        static void AddPlane(Quadric& quadric, const Vector3D& normal, double distance, double weight) noexcept;
+
+        static void Add(Quadric& lhs, const Quadric& rhs) noexcept;
+
+        // Mean squared distance of the point to the planes of the quadric
+        static double Evaluate(const Quadric& quadric, const Vector3D& point) noexcept;
+    };
+} // namespace adh
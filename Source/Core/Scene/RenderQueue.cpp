@@ -0,0 +1,445 @@
+#include "RenderQueue.hpp"
+#include "Components.hpp"
+#include "Scene.hpp"
+
+#include <Vulkan/Context.hpp>
+#include <Vulkan/DescriptorSet.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace adh {
+    static_assert(sizeof(InstanceData) == 144u, "InstanceData must match the std430 layout of Instance in pbr_data.glsl!");
+    static_assert(sizeof(CullData) == 48u, "CullData must match the std430 layout of CullData in cull.comp!");
+
+    namespace {
+        constexpr std::uint32_t maxLodCount{ MeshBufferData::maxLodCount };
+
+        // Coarsest LOD whose error, scaled like the instance, projects to at most one pixel from the
+        // closest point of its bounding sphere. Matches cull.comp.
+        std::uint32_t SelectLod(const MeshBufferData& mesh, const xmm::Matrix& model, const xmm::Vector& lodOrigin) noexcept {
+            if (lodOrigin[3] <= 0.0f || mesh.lods.GetSize() < 2u) {
+                return 0u;
+            }
+
+            const auto& c{ mesh.boundsCenter };
+            xmm::Vector offset{ model.m[3] + model.m[0] * c[0] + model.m[1] * c[1] + model.m[2] * c[2] - lodOrigin };
+            offset[3] = 0.0f;
+            auto scale{ std::max({ model.m[0].Magnitude(), model.m[1].Magnitude(), model.m[2].Magnitude() }) };
+            auto distance{ std::max(offset.Magnitude() - mesh.boundsRadius * scale, 0.0f) };
+
+            std::uint32_t lod{};
+            for (std::uint32_t i{ 1u }; i != mesh.lods.GetSize(); ++i) {
+                if (mesh.lods[i].error * scale * lodOrigin[3] <= distance) {
+                    lod = i;
+                }
+            }
+            return lod;
+        }
+
+        struct ItemOrder {
+            bool operator()(const RenderQueue::Item& lhs, const RenderQueue::Item& rhs) const noexcept {
+                if (lhs.isStatic != rhs.isStatic) {
+                    return lhs.isStatic;
+                }
+                return lhs.mesh < rhs.mesh;
+            }
+        };
+    } // namespace
+
+    RenderQueue::RenderQueue() noexcept : m_StaticBatchCount{},
+                                          m_StaticRevision{},
+                                          m_MaxInstances{},
+                                          m_FrameCount{} {
+    }
+
+    RenderQueue::RenderQueue(std::uint32_t maxInstances, std::uint32_t frameCount, std::uint32_t viewCount) : m_StaticBatchCount{},
+                                                                                                              m_StaticRevision{} {
+        Create(maxInstances, frameCount, viewCount);
+    }
+
+    RenderQueue::RenderQueue(RenderQueue&& rhs) noexcept {
+        MoveConstruct(Move(rhs));
+    }
+
+    RenderQueue& RenderQueue::operator=(RenderQueue&& rhs) noexcept {
+        Clear();
+        MoveConstruct(Move(rhs));
+        return *this;
+    }
+
+    RenderQueue::~RenderQueue() {
+        Clear();
+    }
+
+    void RenderQueue::Create(std::uint32_t maxInstances, std::uint32_t frameCount, std::uint32_t viewCount) {
+        ADH_THROW(frameCount, "Render queue needs at least one frame!");
+        ADH_THROW(viewCount, "Render queue needs at least one view!");
+        // Keep every per-frame and per-view slice 256 byte aligned (sizeof(std::uint32_t) * 64 == 256)
+        m_MaxInstances = (maxInstances + 63u) & ~63u;
+        m_FrameCount   = frameCount;
+        m_Views.Resize(viewCount);
+        m_Statistics.Resize(viewCount);
+        m_Submissions.Resize(frameCount * viewCount);
+        for (auto& statistics : m_Statistics) {
+            statistics = {};
+        }
+        m_Instances.Reserve(m_MaxInstances);
+        m_SortedInstances.Reserve(m_MaxInstances);
+        m_CullData.Reserve(m_MaxInstances);
+        m_Items.Reserve(m_MaxInstances);
+        m_StaticCasters.Reserve(m_MaxInstances);
+        CreateBuffers();
+    }
+
+    void RenderQueue::Destroy() noexcept {
+        Clear();
+    }
+
+    bool RenderQueue::Build(Scene& scene, bool isPlaying) {
+        m_Instances.Clear();
+        m_Items.Clear();
+        m_Batches.Clear();
+        m_StaticBatchCount = 0u;
+
+        auto& world{ scene.GetWorld() };
+        world.GetSystem<Transform, Mesh, Material>().ForEach([&](ecs::Entity e, Transform& transform, Mesh& mesh, Material& material) {
+            if (!mesh.toDraw || !mesh.GetDrawable() || !mesh.GetIndexCount()) {
+                return;
+            }
+
+            auto& instance{ m_Instances.EmplaceBack() };
+            if (isPlaying && world.Contains<RigidBody>(e)) {
+                instance.model = transform.GetXmmPhysics();
+            } else {
+                instance.model = transform.GetXmm();
+            }
+            instance.material = material;
+
+            instance.textureIndex = vk::TextureDescriptors::invalidID;
+            if (world.Contains<vk::Texture2D>(e)) {
+                auto [texture]        = world.Get<vk::Texture2D>(e);
+                instance.textureIndex = texture.GetDescriptorID();
+            }
+            instance.material.hasTexture = instance.textureIndex != vk::TextureDescriptors::invalidID;
+
+            auto isStatic{ true };
+            if (world.Contains<RigidBody>(e)) {
+                auto [rigidBody] = world.Get<RigidBody>(e);
+                isStatic         = rigidBody.bodyType == PhysicsBodyType::eStatic;
+            }
+
+            m_Items.EmplaceBack(Item{ mesh.GetDrawable(), static_cast<std::uint32_t>(m_Instances.GetSize() - 1u), isStatic });
+        });
+
+        m_Items.Sort<ItemOrder>();
+
+        m_SortedInstances.Resize(m_Items.GetSize());
+        m_CullData.Resize(m_Items.GetSize());
+        for (std::uint32_t i{}; i != m_Items.GetSize(); ++i) {
+            const auto& item{ m_Items[i] };
+            m_SortedInstances[i] = m_Instances[item.instanceIndex];
+
+            if (!m_Batches.IsEmpty() && m_Batches[m_Batches.GetSize() - 1u].mesh == item.mesh && m_Batches[m_Batches.GetSize() - 1u].isStatic == item.isStatic) {
+                ++m_Batches[m_Batches.GetSize() - 1u].instanceCount;
+            } else {
+                m_Batches.EmplaceBack(Batch{ item.mesh, i, 1u, item.isStatic });
+                m_StaticBatchCount += item.isStatic ? 1u : 0u;
+            }
+
+            auto& instance{ m_SortedInstances[i] };
+            if (item.mesh->isPacked) {
+                const auto& min{ item.mesh->boundsMin };
+                const auto& max{ item.mesh->boundsMax };
+                instance.positionScale  = xmm::Vector{ max[0] - min[0], max[1] - min[1], max[2] - min[2], 1.0f };
+                instance.positionOffset = xmm::Vector{ min[0], min[1], min[2], 0.0f };
+            } else {
+                instance.positionScale  = xmm::Vector{ 1.0f, 1.0f, 1.0f, 0.0f };
+                instance.positionOffset = xmm::Vector{ 0.0f, 0.0f, 0.0f, 0.0f };
+            }
+
+            const auto& lods{ item.mesh->lods };
+            auto& cull{ m_CullData[i] };
+            cull.sphere = xmm::Vector{ item.mesh->boundsCenter[0], item.mesh->boundsCenter[1], item.mesh->boundsCenter[2], item.mesh->boundsRadius };
+            for (std::uint32_t lod{}; lod != maxLodCount; ++lod) {
+                cull.lodErrors[lod] = lod < lods.GetSize() ? lods[lod].error : 0.0f;
+            }
+            cull.batch    = static_cast<std::uint32_t>(m_Batches.GetSize() - 1u);
+            cull.lodCount = static_cast<std::uint32_t>(lods.GetSize());
+        }
+
+        UpdateStaticRevision();
+
+        if (m_SortedInstances.GetSize() > m_MaxInstances) {
+            vkDeviceWaitIdle(vk::Context::Get()->GetDevice());
+            m_MaxInstances = (static_cast<std::uint32_t>(m_SortedInstances.GetSize()) * 2u + 63u) & ~63u;
+            DestroyBuffers();
+            CreateBuffers();
+            return true;
+        }
+        return false;
+    }
+
+    void RenderQueue::SetView(std::uint32_t viewIndex, const xmm::Matrix& viewProjection, const Vector3D& lodOrigin, float lodScale) ADH_NOEXCEPT {
+        ADH_THROW(viewIndex < m_Views.GetSize(), "Render queue view out of range!");
+        m_Views[viewIndex].frustum.Update(viewProjection);
+        m_Views[viewIndex].lodOrigin = xmm::Vector{ lodOrigin[0], lodOrigin[1], lodOrigin[2], lodScale };
+    }
+
+    void RenderQueue::Upload(std::uint32_t frameIndex, bool gpuCulling) noexcept {
+        auto* commands{ reinterpret_cast<VkDrawIndexedIndirectCommand*>(
+            static_cast<char*>(m_CommandBuffer.GetMappedPtr()) + GetCommandDescriptor(frameIndex).offset) };
+        auto* visible{ reinterpret_cast<std::uint32_t*>(
+            static_cast<char*>(m_VisibleBuffer.GetMappedPtr()) + GetVisibleDescriptor(frameIndex).offset) };
+
+        const auto instanceCount{ GetInstanceCount() };
+        m_VisibleCounts.Resize(m_Views.GetSize() * m_Batches.GetSize() * maxLodCount);
+
+        for (std::uint32_t view{}; view != m_Views.GetSize(); ++view) {
+            auto& submission{ m_Submissions[frameIndex * m_Views.GetSize() + view] };
+            auto& statistics{ m_Statistics[view] };
+            auto* viewCommands{ commands + GetViewOffset(view) };
+
+            // LOD 0 of a batch is always written, its index count is the full mesh
+            if (gpuCulling) {
+                statistics = {};
+                for (std::uint32_t i{}; i != submission.commandCount; ++i) {
+                    const auto& command{ viewCommands[i] };
+                    statistics.drawn += command.instanceCount;
+                    statistics.triangles += command.instanceCount * (command.indexCount / 3u);
+                    statistics.fullTriangles += command.instanceCount * (viewCommands[i - i % maxLodCount].indexCount / 3u);
+                }
+                statistics.culled = submission.instanceCount - statistics.drawn;
+            }
+
+            submission.commandCount  = static_cast<std::uint32_t>(m_Batches.GetSize()) * maxLodCount;
+            submission.instanceCount = instanceCount;
+        }
+
+        if (m_SortedInstances.IsEmpty()) {
+            if (!gpuCulling) {
+                for (auto& statistics : m_Statistics) {
+                    statistics = {};
+                }
+            }
+            return;
+        }
+
+        auto* instances{ static_cast<char*>(m_InstanceBuffer.GetMappedPtr()) + GetDescriptor(frameIndex).offset };
+        std::memcpy(instances, m_SortedInstances.GetData(), sizeof(InstanceData) * m_SortedInstances.GetSize());
+
+        auto* cullData{ static_cast<char*>(m_CullBuffer.GetMappedPtr()) + GetCullDescriptor(frameIndex).offset };
+        std::memcpy(cullData, m_CullData.GetData(), sizeof(CullData) * m_CullData.GetSize());
+
+        for (std::uint32_t view{}; view != m_Views.GetSize(); ++view) {
+            const auto& frustum{ m_Views[view].frustum };
+            const auto& lodOrigin{ m_Views[view].lodOrigin };
+            auto* viewCommands{ commands + GetViewOffset(view) };
+            Statistics statistics{};
+
+            for (std::uint32_t i{}; i != m_Batches.GetSize(); ++i) {
+                const auto& batch{ m_Batches[i] };
+                const auto& lods{ batch.mesh->lods };
+                auto* visibleCounts{ &m_VisibleCounts[(view * m_Batches.GetSize() + i) * maxLodCount] };
+                std::fill(visibleCounts, visibleCounts + maxLodCount, 0u);
+
+                if (!gpuCulling) {
+                    const auto& min{ batch.mesh->boundsMin };
+                    const auto& max{ batch.mesh->boundsMax };
+                    const xmm::Vector center{ (min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f, 1.0f };
+                    const xmm::Vector extents{ (max[0] - min[0]) * 0.5f, (max[1] - min[1]) * 0.5f, (max[2] - min[2]) * 0.5f, 0.0f };
+
+                    for (std::uint32_t j{ batch.firstInstance }; j != batch.firstInstance + batch.instanceCount; ++j) {
+                        const auto& model{ m_SortedInstances[j].model };
+                        if (frustum.Intersects(model, center, extents)) {
+                            auto lod{ SelectLod(*batch.mesh, model, lodOrigin) };
+                            visible[GetFirstInstance(view, i, lod) + visibleCounts[lod]++] = j;
+                        }
+                    }
+                }
+
+                for (std::uint32_t lod{}; lod != maxLodCount; ++lod) {
+                    auto& command{ viewCommands[i * maxLodCount + lod] };
+                    command.indexCount    = lod < lods.GetSize() ? lods[lod].indexCount : 0u;
+                    command.instanceCount = visibleCounts[lod];
+                    command.firstIndex    = lod < lods.GetSize() ? batch.mesh->GetFirstIndex(lod) : 0u;
+                    command.vertexOffset  = batch.mesh->GetVertexOffset();
+                    command.firstInstance = GetFirstInstance(view, i, lod);
+
+                    statistics.drawn += visibleCounts[lod];
+                    statistics.triangles += visibleCounts[lod] * (command.indexCount / 3u);
+                    statistics.fullTriangles += visibleCounts[lod] * (lods[0].indexCount / 3u);
+                }
+            }
+
+            if (!gpuCulling) {
+                statistics.culled   = instanceCount - statistics.drawn;
+                m_Statistics[view] = statistics;
+            }
+        }
+    }
+
+    VkDescriptorBufferInfo RenderQueue::GetDescriptor(std::uint32_t frameIndex) const noexcept {
+        auto info{ m_InstanceBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex;
+        return info;
+    }
+
+    VkDescriptorBufferInfo RenderQueue::GetCullDescriptor(std::uint32_t frameIndex) const noexcept {
+        auto info{ m_CullBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex;
+        return info;
+    }
+
+    VkDescriptorBufferInfo RenderQueue::GetCommandDescriptor(std::uint32_t frameIndex) const noexcept {
+        auto info{ m_CommandBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex;
+        return info;
+    }
+
+    VkDescriptorBufferInfo RenderQueue::GetVisibleDescriptor(std::uint32_t frameIndex) const noexcept {
+        auto info{ m_VisibleBuffer.GetDescriptor() };
+        info.offset = info.range * frameIndex;
+        return info;
+    }
+
+    VkBuffer RenderQueue::GetCommandBuffer() noexcept {
+        return m_CommandBuffer;
+    }
+
+    VkDeviceSize RenderQueue::GetCommandOffset(std::uint32_t frameIndex, std::uint32_t viewIndex, std::uint32_t batchIndex, std::uint32_t lod) const noexcept {
+        return GetCommandDescriptor(frameIndex).offset +
+               sizeof(VkDrawIndexedIndirectCommand) * (GetViewOffset(viewIndex) + batchIndex * maxLodCount + lod);
+    }
+
+    std::uint32_t RenderQueue::GetViewOffset(std::uint32_t viewIndex) const noexcept {
+        return viewIndex * m_MaxInstances * maxLodCount;
+    }
+
+    std::uint32_t RenderQueue::GetFirstInstance(std::uint32_t viewIndex, std::uint32_t batchIndex, std::uint32_t lod) const noexcept {
+        return GetViewOffset(viewIndex) + lod * m_MaxInstances + m_Batches[batchIndex].firstInstance;
+    }
+
+    const RenderQueue::View& RenderQueue::GetView(std::uint32_t viewIndex) const ADH_NOEXCEPT {
+        ADH_THROW(viewIndex < m_Views.GetSize(), "Render queue view out of range!");
+        return m_Views[viewIndex];
+    }
+
+    std::uint32_t RenderQueue::GetVisibleCount(std::uint32_t viewIndex, std::uint32_t batchIndex, std::uint32_t lod) const noexcept {
+        return m_VisibleCounts[(viewIndex * m_Batches.GetSize() + batchIndex) * maxLodCount + lod];
+    }
+
+    const Array<RenderQueue::Statistics>& RenderQueue::GetStatistics() const noexcept {
+        return m_Statistics;
+    }
+
+    std::uint32_t RenderQueue::GetViewCount() const noexcept {
+        return static_cast<std::uint32_t>(m_Views.GetSize());
+    }
+
+    const Array<RenderQueue::Batch>& RenderQueue::GetBatches() const noexcept {
+        return m_Batches;
+    }
+
+    std::uint32_t RenderQueue::GetInstanceCount() const noexcept {
+        return static_cast<std::uint32_t>(m_SortedInstances.GetSize());
+    }
+
+    std::uint32_t RenderQueue::GetStaticBatchCount() const noexcept {
+        return m_StaticBatchCount;
+    }
+
+    std::uint64_t RenderQueue::GetStaticRevision() const noexcept {
+        return m_StaticRevision;
+    }
+
+    void RenderQueue::UpdateStaticRevision() noexcept {
+        // Static items are sorted first, compare them against the last build
+        std::uint32_t staticCount{};
+        while (staticCount != m_Items.GetSize() && m_Items[staticCount].isStatic) {
+            ++staticCount;
+        }
+
+        auto isChanged{ staticCount != m_StaticCasters.GetSize() };
+        for (std::uint32_t i{}; i != staticCount && !isChanged; ++i) {
+            const auto& caster{ m_StaticCasters[i] };
+            isChanged = caster.mesh != m_Items[i].mesh ||
+                        std::memcmp(&caster.model, &m_SortedInstances[i].model, sizeof(xmm::Matrix));
+        }
+        if (!isChanged) {
+            return;
+        }
+
+        m_StaticCasters.Resize(staticCount);
+        for (std::uint32_t i{}; i != staticCount; ++i) {
+            m_StaticCasters[i] = StaticCaster{ m_SortedInstances[i].model, m_Items[i].mesh };
+        }
+        ++m_StaticRevision;
+    }
+
+    void RenderQueue::CreateBuffers() {
+        const auto viewCount{ static_cast<std::uint32_t>(m_Views.GetSize()) };
+        // The new command buffers hold nothing to read statistics back from
+        for (auto& submission : m_Submissions) {
+            submission = {};
+        }
+
+        m_InstanceBuffer.Create(nullptr, sizeof(InstanceData) * m_MaxInstances, m_FrameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        m_CullBuffer.Create(nullptr, sizeof(CullData) * m_MaxInstances, m_FrameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        // One command per batch and LOD, every LOD has room for every instance
+        m_CommandBuffer.Create(nullptr, sizeof(VkDrawIndexedIndirectCommand) * m_MaxInstances * maxLodCount * viewCount, m_FrameCount,
+                               VkBufferUsageFlagBits(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT));
+        m_VisibleBuffer.Create(nullptr, sizeof(std::uint32_t) * m_MaxInstances * maxLodCount * viewCount, m_FrameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    void RenderQueue::DestroyBuffers() noexcept {
+        m_InstanceBuffer.Destroy();
+        m_CullBuffer.Destroy();
+        m_CommandBuffer.Destroy();
+        m_VisibleBuffer.Destroy();
+    }
+
+    void RenderQueue::MoveConstruct(RenderQueue&& rhs) noexcept {
+        m_InstanceBuffer   = Move(rhs.m_InstanceBuffer);
+        m_CullBuffer       = Move(rhs.m_CullBuffer);
+        m_CommandBuffer    = Move(rhs.m_CommandBuffer);
+        m_VisibleBuffer    = Move(rhs.m_VisibleBuffer);
+        m_Instances        = Move(rhs.m_Instances);
+        m_SortedInstances  = Move(rhs.m_SortedInstances);
+        m_CullData         = Move(rhs.m_CullData);
+        m_Views            = Move(rhs.m_Views);
+        m_Statistics       = Move(rhs.m_Statistics);
+        m_Submissions      = Move(rhs.m_Submissions);
+        m_VisibleCounts    = Move(rhs.m_VisibleCounts);
+        m_Items            = Move(rhs.m_Items);
+        m_Batches          = Move(rhs.m_Batches);
+        m_StaticCasters    = Move(rhs.m_StaticCasters);
+        m_StaticBatchCount = rhs.m_StaticBatchCount;
+        m_StaticRevision   = rhs.m_StaticRevision;
+        m_MaxInstances     = rhs.m_MaxInstances;
+        m_FrameCount       = rhs.m_FrameCount;
+
+        rhs.m_StaticBatchCount = 0u;
+        rhs.m_StaticRevision   = 0u;
+        rhs.m_MaxInstances     = 0u;
+        rhs.m_FrameCount       = 0u;
+    }
+
+    void RenderQueue::Clear() noexcept {
+        DestroyBuffers();
+        m_Instances.Clear();
+        m_SortedInstances.Clear();
+        m_CullData.Clear();
+        m_Views.Clear();
+        m_Statistics.Clear();
+        m_Submissions.Clear();
+        m_VisibleCounts.Clear();
+        m_Items.Clear();
+        m_Batches.Clear();
+        m_StaticCasters.Clear();
+        m_StaticBatchCount = 0u;
+        m_StaticRevision   = 0u;
+        m_MaxInstances     = 0u;
+        m_FrameCount       = 0u;
+    }
+} // namespace adh
@@ -0,0 +1,178 @@
+#pragma once
+#include <Math/Math.hpp>
+#include <Std/Array.hpp>
+#include <Vulkan/UniformBuffer.hpp>
+
+#include "Components/Material.hpp"
+#include "Components/Mesh.hpp"
+
+#include <vulkan/vulkan.h>
+
+namespace adh {
+    class Scene;
+
+    // Matches "struct Instance" in pbr_data.glsl (std430)
+    struct InstanceData {
+        xmm::Matrix model;
+        Material material;
+        std::uint32_t textureIndex; // Slot in the bindless texture table
+        std::uint32_t padding[3];
+        xmm::Vector positionScale;  // Packed positions are scaled by xyz, w is 1 if the normals are octahedral
+        xmm::Vector positionOffset; // and offset by xyz, float positions have scale 1 and offset 0
+    };
+
+    // Matches "struct CullData" in cull.comp (std430)
+    struct CullData {
+        xmm::Vector sphere;    // xyz = local center, w = local radius
+        xmm::Vector lodErrors; // MeshLod::error per LOD
+        std::uint32_t batch;
+        std::uint32_t lodCount;
+        std::uint32_t padding[2];
+    };
+
+    class RenderQueue {
+      public:
+        struct Item {
+            MeshBufferData* mesh;
+            std::uint32_t instanceIndex;
+            bool isStatic;
+        };
+
+        struct Batch {
+            MeshBufferData* mesh;
+            std::uint32_t firstInstance;
+            std::uint32_t instanceCount;
+            bool isStatic; // No rigid body or a static one, never moves while playing
+        };
+
+        struct View {
+            xmm::Frustum frustum;
+            xmm::Vector lodOrigin; // xyz = camera position, w = pixels per unit at distance one
+        };
+
+        struct Statistics {
+            std::uint32_t drawn;
+            std::uint32_t culled;
+            std::uint32_t triangles;
+            std::uint32_t fullTriangles; // Had every instance drawn LOD 0
+        };
+
+      public:
+        RenderQueue() noexcept;
+
+        RenderQueue(std::uint32_t maxInstances, std::uint32_t frameCount, std::uint32_t viewCount);
+
+        RenderQueue(const RenderQueue& rhs) = delete;
+
+        RenderQueue& operator=(const RenderQueue& rhs) = delete;
+
+        RenderQueue(RenderQueue&& rhs) noexcept;
+
+        RenderQueue& operator=(RenderQueue&& rhs) noexcept;
+
+        ~RenderQueue();
+
+        void Create(std::uint32_t maxInstances, std::uint32_t frameCount, std::uint32_t viewCount);
+
+        void Destroy() noexcept;
+
+        // Collects every drawable entity, sorts by mesh and merges equal meshes into instanced batches.
+        // Textures are indexed per instance from the bindless table, so they never split a batch.
+        // Static batches come first, caches of static geometry draw [0, GetStaticBatchCount()).
+        // Returns true if the instance buffer had to grow and descriptors must be rewritten.
+        bool Build(Scene& scene, bool isPlaying);
+
+        // A view is a camera the queue is culled against. Instances pick the coarsest LOD whose error
+        // projects to at most one pixel, lodScale is the pixels per unit at distance one. Views
+        // without a scale, like the shadow cascades that are cached, always draw LOD 0.
+        void SetView(std::uint32_t viewIndex, const xmm::Matrix& viewProjection, const Vector3D& lodOrigin = {}, float lodScale = 0.0f) ADH_NOEXCEPT;
+
+        // Writes instances, cull data and one indirect command per batch, LOD and view.
+        // With gpuCulling the instance counts start at zero and cull.comp fills them,
+        // otherwise every view is culled and its LODs picked here.
+        void Upload(std::uint32_t frameIndex, bool gpuCulling) noexcept;
+
+        VkDescriptorBufferInfo GetDescriptor(std::uint32_t frameIndex) const noexcept;
+
+        VkDescriptorBufferInfo GetCullDescriptor(std::uint32_t frameIndex) const noexcept;
+
+        VkDescriptorBufferInfo GetCommandDescriptor(std::uint32_t frameIndex) const noexcept;
+
+        VkDescriptorBufferInfo GetVisibleDescriptor(std::uint32_t frameIndex) const noexcept;
+
+        VkBuffer GetCommandBuffer() noexcept;
+
+        // Byte offset of the indirect command of a batch LOD inside the command buffer
+        VkDeviceSize GetCommandOffset(std::uint32_t frameIndex, std::uint32_t viewIndex, std::uint32_t batchIndex, std::uint32_t lod) const noexcept;
+
+        // First slot of a view inside the visible index list and the indirect commands of a frame.
+        // Commands are ordered by batch and LOD, visible indices by LOD and batch.
+        std::uint32_t GetViewOffset(std::uint32_t viewIndex) const noexcept;
+
+        // First visible index slot of a batch LOD
+        std::uint32_t GetFirstInstance(std::uint32_t viewIndex, std::uint32_t batchIndex, std::uint32_t lod) const noexcept;
+
+        const View& GetView(std::uint32_t viewIndex) const ADH_NOEXCEPT;
+
+        // Instances of a batch left to draw a LOD after CPU culling
+        std::uint32_t GetVisibleCount(std::uint32_t viewIndex, std::uint32_t batchIndex, std::uint32_t lod) const noexcept;
+
+        // Drawn/culled instances and triangles per view. With GPU culling these are read back from
+        // the indirect commands of the last frame that used the same frame slot.
+        const Array<Statistics>& GetStatistics() const noexcept;
+
+        std::uint32_t GetViewCount() const noexcept;
+
+        // Batches grouped by mesh, shared by every view
+        const Array<Batch>& GetBatches() const noexcept;
+
+        std::uint32_t GetStaticBatchCount() const noexcept;
+
+        // Changes whenever a static instance is added, removed or moved
+        std::uint64_t GetStaticRevision() const noexcept;
+
+        std::uint32_t GetInstanceCount() const noexcept;
+
+      private:
+        struct Submission {
+            std::uint32_t commandCount;
+            std::uint32_t instanceCount;
+        };
+
+        struct StaticCaster {
+            xmm::Matrix model;
+            MeshBufferData* mesh;
+        };
+
+      private:
+        void UpdateStaticRevision() noexcept;
+
+        void CreateBuffers();
+
+        void DestroyBuffers() noexcept;
+
+        void MoveConstruct(RenderQueue&& rhs) noexcept;
+
+        void Clear() noexcept;
+
+      private:
+        vk::UniformBuffer m_InstanceBuffer;
+        vk::UniformBuffer m_CullBuffer;
+        vk::UniformBuffer m_CommandBuffer;
+        vk::UniformBuffer m_VisibleBuffer;
+        Array<InstanceData> m_Instances;
+        Array<InstanceData> m_SortedInstances;
+        Array<CullData> m_CullData;
+        Array<View> m_Views;
+        Array<Statistics> m_Statistics;
+        Array<Submission> m_Submissions;
+        Array<std::uint32_t> m_VisibleCounts;
+        Array<Item> m_Items;
+        Array<Batch> m_Batches;
+        Array<StaticCaster> m_StaticCasters;
+        std::uint32_t m_StaticBatchCount;
+        std::uint64_t m_StaticRevision;
+        std::uint32_t m_MaxInstances;
+        std::uint32_t m_FrameCount;
+    };
+} // namespace adh
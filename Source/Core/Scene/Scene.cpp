@@ -96,4 +96,8 @@ namespace adh {
     void Scene::LoadFromFile(const char* filePath) {
         m_Serializer.DeserializeFromFile(filePath);
     }
+
+    void Scene::LoadFromFileAsync(const char* filePath, std::function<void()> onLoaded) {
+        m_Serializer.DeserializeFromFileAsync(filePath, Move(onLoaded));
+    }
 } // namespace adh
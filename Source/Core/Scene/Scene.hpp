@@ -43,6 +43,9 @@ namespace adh {
 
         void LoadFromFile(const char* filePath);
 
+        // The current scene keeps running until the new one is parsed, onLoaded runs right after
+        void LoadFromFileAsync(const char* filePath, std::function<void()> onLoaded = {});
+
       private:
         std::string m_Tag;
         PhysicsWorld m_PhysicsWorld;
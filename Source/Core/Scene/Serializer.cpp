@@ -6,7 +6,9 @@
 #include <Scripting/Script.hpp>
 #include <Scripting/ScriptHandler.hpp>
 
+#include <Asset/AssetManager.hpp>
 #include <Std/File.hpp>
+#include <Std/VirtualFileSystem.hpp>
 #include <Vulkan/Context.hpp>
 
 #include <Vulkan/Context.hpp>
@@ -21,6 +23,15 @@ namespace adh {
         out << YAML::EndMap;
     }
 
+    // YAML::LoadFile() reading through the VirtualFileSystem
+    static YAML::Node LoadFile(const std::string& filePath) {
+        MappedFile file;
+        if (!VirtualFileSystem::Open(filePath, file)) {
+            throw YAML::BadFile(filePath);
+        }
+        return YAML::Load(std::string{ static_cast<const char*>(file.GetData()), file.GetSize() });
+    }
+
     Serializer::Serializer(Scene* scene)
         : m_Scene{ scene } {
     }
@@ -158,7 +169,7 @@ namespace adh {
     void Serializer::DeserializeFromFile(const char* filePath) {
         YAML::Node node;
         try {
-            node = YAML::LoadFile(filePath);
+            node = LoadFile(filePath);
         } catch (const std::exception& e) {
             ADH_THROW(false, "Bad scene file!");
             return;
@@ -166,6 +177,26 @@ namespace adh {
         Deserialize(&node);
     }
 
+    void Serializer::DeserializeFromFileAsync(const char* filePath, std::function<void()> onLoaded) {
+        std::string file{ filePath };
+        auto node{ MakeShared<YAML::Node>() };
+        AssetManager::Get()->Submit(
+            file.substr(file.find_last_of("/") + 1u),
+            [file, node]() {
+                *node = LoadFile(file);
+                return true;
+            },
+            [this, node, onLoaded = Move(onLoaded)](bool isDecoded) {
+                if (!isDecoded) {
+                    return;
+                }
+                Deserialize(node.Get());
+                if (onLoaded) {
+                    onLoaded();
+                }
+            });
+    }
+
     void Serializer::Deserialize(void* pNode) {
         YAML::Node& node = *(YAML::Node*)(pNode);
         auto scene       = node["Scene"];
@@ -199,7 +230,13 @@ namespace adh {
                 if (mesh) {
                     auto [m]             = world.Add<Mesh>(e, Mesh{});
                     std::string filePath = vk::Context::Get()->GetDataDirectory() + "Assets/Models/" + mesh["name"].as<std::string>();
-                    m.Load(filePath);
+                    // Mesh colliders are cooked from the triangles right below
+                    auto colliderShape{ i["RigidBody"] ? PhysicsColliderShape(i["RigidBody"]["collider shape"].as<int>()) : PhysicsColliderShape::eInvalid };
+                    if (colliderShape == PhysicsColliderShape::eMesh || colliderShape == PhysicsColliderShape::eConvexMesh) {
+                        m.Load(filePath);
+                    } else {
+                        m.LoadAsync(filePath);
+                    }
                     m.toDraw = mesh["draw"].as<bool>();
                 }
 
@@ -231,8 +268,8 @@ namespace adh {
                 auto texture2d = i["Texture2D"];
                 if (texture2d) {
                     std::string filePath = vk::Context::Get()->GetDataDirectory() + "Assets/Textures/" + texture2d["name"].as<std::string>();
-                    auto [t]             = world.Add<vk::Texture2D>(e, vk::Texture2D{});
-                    t.Create(filePath.data(), VK_IMAGE_USAGE_SAMPLED_BIT, VK_FILTER_LINEAR, true);
+                    world.Add<vk::Texture2D>(e, vk::Texture2D{});
+                    AssetManager::Get()->LoadTexture(world, e, filePath);
                 }
 
                 auto rigidbody = i["RigidBody"];
@@ -1,5 +1,6 @@
 #pragma once
 #include <Std/UniquePtr.hpp>
+#include <functional>
 #include <string>
 
 // TODO: efficient load-save from play
@@ -18,6 +19,9 @@ namespace adh {
 
         void DeserializeFromFile(const char* filePath);
 
+        // The file is parsed on an AssetManager worker, the scene is replaced once it's parsed
+        void DeserializeFromFileAsync(const char* filePath, std::function<void()> onLoaded);
+
       private:
         void Deserialize(void* pNode);
 
@@ -0,0 +1,113 @@
+#include "VertexPacker.hpp"
+#include <Utility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace adh {
+    VertexPacker::Format VertexPacker::GetFormat() noexcept {
+        // Read once, the pipelines and every mesh must agree on it
+        static const auto format{ [] {
+            auto value{ std::getenv("ADH_VERTEX_FORMAT") };
+            return value && !std::strcmp(value, "packed") ? Format::ePacked : Format::eFloat;
+        }() };
+        return format;
+    }
+
+    std::uint32_t VertexPacker::GetStride(Format format) noexcept {
+        return format == Format::ePacked ? sizeof(PackedVertex) : sizeof(Vertex);
+    }
+
+    void VertexPacker::AddAttributes(vk::VertexLayout& vertexLayout, Format format) noexcept {
+        vertexLayout.AddBinding(0, GetStride(format), VK_VERTEX_INPUT_RATE_VERTEX);
+        if (format == Format::ePacked) {
+            vertexLayout.AddAttribute(0, 0, VK_FORMAT_R16G16B16A16_UNORM, ADH_OFFSET(PackedVertex, position));
+            vertexLayout.AddAttribute(1, 0, VK_FORMAT_R16G16_SNORM, ADH_OFFSET(PackedVertex, normals));
+            vertexLayout.AddAttribute(2, 0, VK_FORMAT_R16G16_SFLOAT, ADH_OFFSET(PackedVertex, textureCoords));
+        } else {
+            vertexLayout.AddAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, position));
+            vertexLayout.AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, normals));
+            vertexLayout.AddAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, ADH_OFFSET(Vertex, textureCoords));
+        }
+    }
+
+    void VertexPacker::Pack(const Array<Vertex>& vertices, const Vector3D& boundsMin, const Vector3D& boundsMax, Array<PackedVertex>& packed) {
+        // A flat axis has no extent, every vertex sits at its minimum
+        float scale[3];
+        for (std::size_t i{}; i != 3u; ++i) {
+            auto extent{ boundsMax[i] - boundsMin[i] };
+            scale[i] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+        }
+
+        packed.Resize(vertices.GetSize());
+        for (std::size_t i{}; i != vertices.GetSize(); ++i) {
+            const auto& vertex{ vertices[i] };
+            auto& result{ packed[i] };
+            for (std::size_t j{}; j != 3u; ++j) {
+                auto position{ std::clamp((vertex.position[j] - boundsMin[j]) * scale[j], 0.0f, 65535.0f) };
+                result.position[j] = static_cast<std::uint16_t>(std::lround(position));
+            }
+            result.position[3] = 0u;
+            EncodeOctahedral(vertex.normals, result.normals);
+            result.textureCoords[0] = ToHalf(vertex.textureCoords[0]);
+            result.textureCoords[1] = ToHalf(vertex.textureCoords[1]);
+        }
+    }
+
+    std::uint16_t VertexPacker::ToHalf(float value) noexcept {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        auto sign{ (bits >> 16u) & 0x8000u };
+        auto magnitude{ bits & 0x7FFFFFFFu };
+
+        if (magnitude >= 0x7F800000u) {
+            // Infinity stays infinity, NaN stays NaN
+            return static_cast<std::uint16_t>(sign | (magnitude > 0x7F800000u ? 0x7E00u : 0x7C00u));
+        }
+        if (magnitude >= 0x477FF000u) {
+            // 65520 and above round past the largest half
+            return static_cast<std::uint16_t>(sign | 0x7C00u);
+        }
+        if (magnitude < 0x38800000u) {
+            // Below the smallest normal half, counted in steps of 2^-24
+            float absolute;
+            std::memcpy(&absolute, &magnitude, sizeof(absolute));
+            return static_cast<std::uint16_t>(sign | static_cast<std::uint32_t>(std::nearbyint(absolute * 16777216.0f)));
+        }
+        // The exponent is rebiased from 127 to 15 and the mantissa rounded to 10 bits, a carry
+        // moves into the exponent
+        auto half{ magnitude - 0x38000000u };
+        half += 0x0FFFu + ((half >> 13u) & 1u);
+        return static_cast<std::uint16_t>(sign | (half >> 13u));
+    }
+
+    void VertexPacker::EncodeOctahedral(const Vector3D& normal, std::int16_t (&encoded)[2]) noexcept {
+        // Projected onto the octahedron |x| + |y| + |z| = 1, the lower half is folded over the
+        // diagonals of the upper one
+        auto length{ std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]) };
+        auto x{ length > 0.0f ? normal[0] / length : 0.0f };
+        auto y{ length > 0.0f ? normal[1] / length : 0.0f };
+        if (normal[2] < 0.0f) {
+            auto foldedX{ (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f) };
+            auto foldedY{ (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f) };
+            x = foldedX;
+            y = foldedY;
+        }
+        encoded[0] = static_cast<std::int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767.0f));
+        encoded[1] = static_cast<std::int16_t>(std::lround(std::clamp(y, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    Vector3D VertexPacker::DecodeOctahedral(const std::int16_t (&encoded)[2]) noexcept {
+        // SNORM, -32768 clamps to -1 like the vertex fetch does
+        auto x{ std::max(encoded[0] / 32767.0f, -1.0f) };
+        auto y{ std::max(encoded[1] / 32767.0f, -1.0f) };
+        auto z{ 1.0f - std::abs(x) - std::abs(y) };
+        auto t{ std::max(-z, 0.0f) };
+        x += x >= 0.0f ? -t : t;
+        y += y >= 0.0f ? -t : t;
+        auto length{ std::sqrt(x * x + y * y + z * z) };
+        return Vector3D{ x / length, y / length, z / length };
+    }
+} // namespace adh
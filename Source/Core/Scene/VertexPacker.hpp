@@ -0,0 +1,39 @@
+#pragma once
+#include <Std/Array.hpp>
+#include <Vertex.hpp>
+#include <Vulkan/VertexLayout.hpp>
+
+#include <cstdint>
+
+namespace adh {
+    // Compact vertex layout, ADH_VERTEX_FORMAT=packed turns it on. Positions are 16 bit UNORM
+    // inside the mesh bounds, normals are octahedral 16 bit SNORM and texture coordinates are half
+    // floats. The vertex fetch converts them to floats, the vertex shaders scale the positions back
+    // with the bounds of the instance and decode the normals.
+    class VertexPacker {
+      public:
+        enum class Format : std::uint32_t {
+            eFloat,
+            ePacked
+        };
+
+      public:
+        static Format GetFormat() noexcept;
+
+        static std::uint32_t GetStride(Format format) noexcept;
+
+        // Binding 0, the position is location 0, the normal 1 and the texture coordinates 2
+        static void AddAttributes(vk::VertexLayout& vertexLayout, Format format) noexcept;
+
+        // Quantizes the vertices inside [boundsMin, boundsMax]
+        static void Pack(const Array<Vertex>& vertices, const Vector3D& boundsMin, const Vector3D& boundsMax, Array<PackedVertex>& packed);
+
+        // Round to nearest even, out of range values become infinity
+        static std::uint16_t ToHalf(float value) noexcept;
+
+        static void EncodeOctahedral(const Vector3D& normal, std::int16_t (&encoded)[2]) noexcept;
+
+        // Same as UnpackNormal() of the shaders, the result is normalized
+        static Vector3D DecodeOctahedral(const std::int16_t (&encoded)[2]) noexcept;
+    };
+} // namespace adh
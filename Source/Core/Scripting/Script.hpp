@@ -18,6 +18,7 @@
 #include <Std/Function.hpp>
 #include <Std/UniquePtr.hpp>
 #include <Std/Utility.hpp>
+#include <Std/VirtualFileSystem.hpp>
 #include <Utility.hpp>
 
 #include <Math/Math.hpp>
@@ -381,6 +382,17 @@ namespace adh {
             inline static std::unordered_map<void*, bool> toDestroy;
         };
 
+        // luaL_loadfile() reading through the VirtualFileSystem, errors are pushed the same way
+        inline int LoadFile(lua_State* state, const std::string& filePath) {
+            MappedFile file;
+            if (!VirtualFileSystem::Open(filePath, file)) {
+                lua_pushfstring(state, "cannot open %s", filePath.data());
+                return LUA_ERRFILE;
+            }
+            auto chunkName{ "@" + filePath };
+            return luaL_loadbuffer(state, static_cast<const char*>(file.GetData()), file.GetSize(), chunkName.data());
+        }
+
         class Script {
           public:
             Script() = default;
@@ -416,6 +428,22 @@ namespace adh {
                 }
             }
 
+            // Loads the changed file into the environment of the script, Run() defines the new
+            // functions while the fields keep their values. A file that doesn't compile keeps the old chunk.
+            bool Reload() {
+                if (LoadFile(m_State, filePath) != LUA_OK) {
+                    std::string message = lua_tostring(m_State, -1);
+                    errorText           = "File: " + fileName + " - " + message.substr(message.find_last_of(':') + 1) + "\n ";
+                    Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eError, errorText.data());
+                    lua_pop(m_State, 1);
+                    return false;
+                }
+                lua_getfield(m_State, LUA_REGISTRYINDEX, m_Id.data());
+                lua_setupvalue(m_State, -2, 1);
+                lua_setglobal(m_State, m_Id.data());
+                return true;
+            }
+
             void Bind() noexcept {
                 lua_getfield(m_State, LUA_REGISTRYINDEX, m_Id.data());
             }
@@ -679,7 +707,7 @@ namespace adh {
           private:
             Script CreateScript(const std::string& script, std::uint64_t id) {
                 auto uniqueScript{ CreateUniqueScript(script, id) };
-                luaL_loadfile(m_State, script.data());
+                LoadFile(m_State, script);
                 lua_newtable(m_State);
                 lua_newtable(m_State);
                 lua_getglobal(m_State, "_G");
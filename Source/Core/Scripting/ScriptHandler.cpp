@@ -5,6 +5,7 @@
 #include <Scene/Scene.hpp>
 #include <Scripting/Script.hpp>
 
+#include <Asset/AssetManager.hpp>
 #include <Audio/Audio.hpp>
 
 #include <Event/Event.hpp>
@@ -92,8 +93,8 @@ namespace adh {
         } else if (!std::strcmp(name, "Texture2D")) {
             auto file = lua_tostring(L, 3);
             if (!scene->GetWorld().Contains<vk::Texture2D>(entity)) {
-                auto [texture2d]{ scene->GetWorld().Add<vk::Texture2D>(entity, vk::Texture2D{}) };
-                texture2d.Create((vk::Context::Get()->GetDataDirectory() + "Assets/Textures/" + file).data(), VK_IMAGE_USAGE_SAMPLED_BIT, VK_FILTER_LINEAR, true);
+                scene->GetWorld().Add<vk::Texture2D>(entity, vk::Texture2D{});
+                AssetManager::Get()->LoadTexture(scene->GetWorld(), entity, vk::Context::Get()->GetDataDirectory() + "Assets/Textures/" + file);
             }
         } else if (!std::strcmp(name, "RigidBody")) {
             if (!scene->GetWorld().Contains<RigidBody>(entity)) {
@@ -125,6 +126,8 @@ namespace adh {
                         if ((colliderShape == PhysicsColliderShape::eMesh || colliderShape == PhysicsColliderShape::eConvexMesh) &&
                             scene->GetWorld().Contains<Mesh>(entity)) {
                             auto [mesh]{ scene->GetWorld().Get<Mesh>(entity) };
+                            // Collider is cooked from the triangles, a streamed mesh must be in first
+                            AssetManager::Get()->Wait([&mesh]() { return !mesh.Get() || mesh.IsReady(); });
                             meshPtr = &mesh;
                         }
                         auto staticType = lua_tostring(L, 4);
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace adh {
+    // FNV-1a, 64 bit. Stable across runs and platforms, so it is stored in the caches and the pak
+    // index. Not meant for untrusted keys.
+    inline std::uint64_t Fnv1a(const void* data, std::size_t size) noexcept {
+        auto bytes{ static_cast<const unsigned char*>(data) };
+        std::uint64_t hash{ 14695981039346656037ull };
+        for (std::size_t i{}; i != size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    inline std::uint64_t Fnv1a(std::string_view string) noexcept {
+        return Fnv1a(string.data(), string.size());
+    }
+} // namespace adh
@@ -0,0 +1,156 @@
+#pragma once
+#include "Utility.hpp"
+#include <Utility.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(ADH_WINDOWS)
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace adh {
+    // Read-only view of a whole file, pages are read by the OS on first access and shared with its
+    // file cache. Nothing is copied until the caller reads the data. A file inside a mounted pak is
+    // either a view into the mapped pak or, if it's compressed, a buffer it was decompressed into.
+    class MappedFile {
+      public:
+        MappedFile() noexcept : m_Data{},
+                                m_Size{},
+                                m_Storage{ Storage::eMapped } {
+        }
+
+        MappedFile(const char* filePath) noexcept : MappedFile() {
+            Open(filePath);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& rhs) noexcept {
+            MoveConstruct(Move(rhs));
+        }
+
+        MappedFile& operator=(MappedFile&& rhs) noexcept {
+            Close();
+            MoveConstruct(Move(rhs));
+            return *this;
+        }
+
+        ~MappedFile() {
+            Close();
+        }
+
+        // Returns false if the file doesn't exist, is empty or can't be mapped
+        bool Open(const char* filePath) noexcept {
+            Close();
+#if defined(ADH_WINDOWS)
+            auto file{ CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            if (file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+            LARGE_INTEGER size{};
+            if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+                if (auto mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) }) {
+                    m_Data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    m_Size = m_Data ? static_cast<std::size_t>(size.QuadPart) : 0u;
+                    CloseHandle(mapping);
+                }
+            }
+            CloseHandle(file);
+#else
+            auto file{ open(filePath, O_RDONLY) };
+            if (file == -1) {
+                return false;
+            }
+            struct stat status {};
+            if (!fstat(file, &status) && status.st_size > 0) {
+                auto data{ mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0) };
+                if (data != MAP_FAILED) {
+                    m_Data = data;
+                    m_Size = static_cast<std::size_t>(status.st_size);
+                }
+            }
+            // The mapping keeps its own reference to the file
+            close(file);
+#endif
+            return m_Data != nullptr;
+        }
+
+        // Memory the caller keeps alive while this is open
+        void OpenView(const void* data, std::size_t size) noexcept {
+            Close();
+            m_Data    = size ? data : nullptr;
+            m_Size    = m_Data ? size : 0u;
+            m_Storage = Storage::eView;
+        }
+
+        // Owned memory of size bytes for the caller to fill, null if it can't be allocated
+        std::uint8_t* OpenBuffer(std::size_t size) noexcept {
+            Close();
+            auto data{ size ? new (std::nothrow) std::uint8_t[size] : nullptr };
+            m_Data    = data;
+            m_Size    = data ? size : 0u;
+            m_Storage = Storage::eBuffer;
+            return data;
+        }
+
+        void Close() noexcept {
+            if (m_Data) {
+                if (m_Storage == Storage::eBuffer) {
+                    delete[] static_cast<const std::uint8_t*>(m_Data);
+                } else if (m_Storage == Storage::eMapped) {
+#if defined(ADH_WINDOWS)
+                    UnmapViewOfFile(m_Data);
+#else
+                    munmap(const_cast<void*>(m_Data), m_Size);
+#endif
+                }
+            }
+            m_Data    = nullptr;
+            m_Size    = 0u;
+            m_Storage = Storage::eMapped;
+        }
+
+        bool IsOpen() const noexcept {
+            return m_Data != nullptr;
+        }
+
+        const void* GetData() const noexcept {
+            return m_Data;
+        }
+
+        std::size_t GetSize() const noexcept {
+            return m_Size;
+        }
+
+      private:
+        enum class Storage : std::uint8_t {
+            eMapped,
+            eView,
+            eBuffer
+        };
+
+      private:
+        void MoveConstruct(MappedFile&& rhs) noexcept {
+            m_Data    = rhs.m_Data;
+            m_Size    = rhs.m_Size;
+            m_Storage = rhs.m_Storage;
+
+            rhs.m_Data    = nullptr;
+            rhs.m_Size    = 0u;
+            rhs.m_Storage = Storage::eMapped;
+        }
+
+      private:
+        const void* m_Data;
+        std::size_t m_Size;
+        Storage m_Storage;
+    };
+} // namespace adh
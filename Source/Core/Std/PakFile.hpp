@@ -0,0 +1,221 @@
+#pragma once
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include "Utility.hpp"
+#include <Utility.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace adh {
+    // Archive of the files under the data directory, mapped once so opening a packed file costs a
+    // binary search instead of a trip to the file system. The header is followed by the blobs,
+    // each aligned like the caches inside them expect, then the index sorted by the hash of the
+    // relative path and the paths themselves. A blob is stored as is unless LZ4 made it smaller,
+    // stored blobs are read in place from the mapped pages. PakBuilder writes the archive.
+    class PakFile {
+      public:
+        static constexpr std::uint32_t magic{ 0x50484441u }; // "ADHP"
+        static constexpr std::uint32_t version{ 1u };
+        static constexpr std::size_t blobAlignment{ 16u };
+
+        enum class Compression : std::uint32_t {
+            eNone,
+            eLZ4 // Block format
+        };
+
+        struct Header {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t entryCount;
+            std::uint32_t padding;
+            std::uint64_t indexOffset; // Entries
+            std::uint64_t nameOffset;  // Paths, not terminated
+            std::uint64_t nameSize;
+        };
+
+        struct Entry {
+            std::uint64_t hash; // Fnv1a() of the path
+            std::uint64_t offset;
+            std::uint64_t size; // Stored
+            std::uint64_t originalSize;
+            std::int64_t time; // Last write time of the packed file, ticks of the file clock
+            std::uint32_t nameOffset;
+            std::uint32_t nameSize;
+            Compression compression;
+            std::uint32_t padding;
+        };
+
+      public:
+        PakFile() noexcept : m_Entries{},
+                             m_Names{},
+                             m_EntryCount{} {
+        }
+
+        PakFile(const PakFile&) = delete;
+        PakFile& operator=(const PakFile&) = delete;
+
+        // Returns false if the file isn't a pak of this version or its index is out of bounds
+        bool Open(const char* filePath) noexcept {
+            Close();
+            if (!m_File.Open(filePath) || m_File.GetSize() < sizeof(Header)) {
+                Close();
+                return false;
+            }
+            Header header;
+            std::memcpy(&header, m_File.GetData(), sizeof(Header));
+            auto size{ static_cast<std::uint64_t>(m_File.GetSize()) };
+            // Compared against what is left after each offset, a sum could wrap around
+            if (header.magic != magic || header.version != version || header.indexOffset % alignof(Entry) ||
+                header.indexOffset > size || header.entryCount > (size - header.indexOffset) / sizeof(Entry) ||
+                header.nameOffset > size || header.nameSize > size - header.nameOffset) {
+                Close();
+                return false;
+            }
+
+            const auto* data{ static_cast<const char*>(m_File.GetData()) };
+            m_Entries    = reinterpret_cast<const Entry*>(data + header.indexOffset);
+            m_Names      = data + header.nameOffset;
+            m_EntryCount = header.entryCount;
+            for (std::uint32_t i{}; i != m_EntryCount; ++i) {
+                const auto& entry{ m_Entries[i] };
+                if (entry.offset > size || entry.size > size - entry.offset || entry.nameOffset > header.nameSize ||
+                    entry.nameSize > header.nameSize - entry.nameOffset ||
+                    (entry.compression != Compression::eNone && entry.compression != Compression::eLZ4) ||
+                    (entry.compression == Compression::eNone && entry.size != entry.originalSize)) {
+                    Close();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void Close() noexcept {
+            m_File.Close();
+            m_Entries    = nullptr;
+            m_Names      = nullptr;
+            m_EntryCount = 0u;
+        }
+
+        bool IsOpen() const noexcept {
+            return m_File.IsOpen();
+        }
+
+        // path is relative to the directory the pak was built from, separated by '/'
+        const Entry* Find(std::string_view path) const noexcept {
+            auto hash{ Fnv1a(path) };
+            auto it{ std::lower_bound(m_Entries, m_Entries + m_EntryCount, hash, [](const Entry& entry, std::uint64_t value) {
+                return entry.hash < value;
+            }) };
+            for (; it != m_Entries + m_EntryCount && it->hash == hash; ++it) {
+                if (GetPath(*it) == path) {
+                    return it;
+                }
+            }
+            return nullptr;
+        }
+
+        // Stored blobs are viewed in place and stay valid while the pak is open, compressed ones
+        // are decompressed into a buffer the file owns. False for empty files like MappedFile::Open().
+        // Thread safe.
+        bool Read(const Entry& entry, MappedFile& file) const noexcept {
+            const auto* blob{ static_cast<const std::uint8_t*>(m_File.GetData()) + entry.offset };
+            if (entry.compression == Compression::eNone) {
+                file.OpenView(blob, static_cast<std::size_t>(entry.size));
+                return file.IsOpen();
+            }
+            auto* target{ file.OpenBuffer(static_cast<std::size_t>(entry.originalSize)) };
+            if (!target || !Decompress(blob, static_cast<std::size_t>(entry.size), target, static_cast<std::size_t>(entry.originalSize))) {
+                file.Close();
+                return false;
+            }
+            return true;
+        }
+
+        std::string_view GetPath(const Entry& entry) const noexcept {
+            return { m_Names + entry.nameOffset, entry.nameSize };
+        }
+
+        const Entry* begin() const noexcept {
+            return m_Entries;
+        }
+
+        const Entry* end() const noexcept {
+            return m_Entries + m_EntryCount;
+        }
+
+        std::uint32_t GetEntryCount() const noexcept {
+            return m_EntryCount;
+        }
+
+        std::size_t GetSize() const noexcept {
+            return m_File.GetSize();
+        }
+
+        // LZ4 block, false unless the block is well formed and decodes to exactly targetSize bytes
+        static bool Decompress(const std::uint8_t* source, std::size_t sourceSize, std::uint8_t* target, std::size_t targetSize) noexcept {
+            const auto* sourceEnd{ source + sourceSize };
+            auto* targetBegin{ target };
+            auto* targetEnd{ target + targetSize };
+            while (source != sourceEnd) {
+                auto token{ *source++ };
+                std::size_t literalSize{ static_cast<std::size_t>(token >> 4u) };
+                if (literalSize == 15u && !ReadLength(source, sourceEnd, literalSize)) {
+                    return false;
+                }
+                if (literalSize > static_cast<std::size_t>(sourceEnd - source) || literalSize > static_cast<std::size_t>(targetEnd - target)) {
+                    return false;
+                }
+                std::memcpy(target, source, literalSize);
+                source += literalSize;
+                target += literalSize;
+                // The last sequence has no match
+                if (source == sourceEnd) {
+                    break;
+                }
+
+                if (sourceEnd - source < 2) {
+                    return false;
+                }
+                std::size_t offset{ source[0] | static_cast<std::size_t>(source[1]) << 8u };
+                source += 2;
+                std::size_t matchSize{ static_cast<std::size_t>(token & 15u) };
+                if (matchSize == 15u && !ReadLength(source, sourceEnd, matchSize)) {
+                    return false;
+                }
+                matchSize += 4u;
+                if (!offset || offset > static_cast<std::size_t>(target - targetBegin) || matchSize > static_cast<std::size_t>(targetEnd - target)) {
+                    return false;
+                }
+                // Byte by byte, the match may overlap what it writes
+                const auto* match{ target - offset };
+                for (std::size_t i{}; i != matchSize; ++i) {
+                    *target++ = *match++;
+                }
+            }
+            return target == targetEnd;
+        }
+
+      private:
+        static bool ReadLength(const std::uint8_t*& source, const std::uint8_t* sourceEnd, std::size_t& length) noexcept {
+            std::uint8_t byte;
+            do {
+                if (source == sourceEnd) {
+                    return false;
+                }
+                byte = *source++;
+                length += byte;
+            } while (byte == 255u);
+            return true;
+        }
+
+      private:
+        MappedFile m_File;
+        const Entry* m_Entries;
+        const char* m_Names;
+        std::uint32_t m_EntryCount;
+    };
+} // namespace adh
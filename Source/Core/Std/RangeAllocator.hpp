@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace adh {
+    // Hands out ranges of [0, capacity) first fit. Free blocks are kept sorted by their start and
+    // a freed range is merged with the blocks right before and after it.
+    class RangeAllocator {
+      public:
+        struct Block {
+            std::uint32_t head;
+            std::uint32_t tail; // One past the end
+        };
+
+      public:
+        void Create(std::uint32_t capacity) {
+            m_FreeBlocks.clear();
+            if (capacity) {
+                m_FreeBlocks.push_back({ 0u, capacity });
+            }
+        }
+
+        void Destroy() noexcept {
+            m_FreeBlocks.clear();
+        }
+
+        // False if no free block holds count elements
+        bool Allocate(std::uint32_t count, std::uint32_t& first) {
+            for (std::size_t i{}; i != m_FreeBlocks.size(); ++i) {
+                auto& block{ m_FreeBlocks[i] };
+                if (block.tail - block.head < count) {
+                    continue;
+                }
+                first = block.head;
+                block.head += count;
+                if (block.head == block.tail) {
+                    m_FreeBlocks.erase(m_FreeBlocks.begin() + i);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void Free(std::uint32_t first, std::uint32_t count) {
+            std::size_t i{};
+            while (i != m_FreeBlocks.size() && m_FreeBlocks[i].head < first) {
+                ++i;
+            }
+            Block freed{ first, first + count };
+            if (i != m_FreeBlocks.size() && m_FreeBlocks[i].head == freed.tail) {
+                freed.tail = m_FreeBlocks[i].tail;
+                m_FreeBlocks.erase(m_FreeBlocks.begin() + i);
+            }
+            if (i && m_FreeBlocks[i - 1u].tail == freed.head) {
+                m_FreeBlocks[i - 1u].tail = freed.tail;
+            } else {
+                m_FreeBlocks.insert(m_FreeBlocks.begin() + i, freed);
+            }
+        }
+
+        const std::vector<Block>& GetFreeBlocks() const noexcept {
+            return m_FreeBlocks;
+        }
+
+      private:
+        std::vector<Block> m_FreeBlocks;
+    };
+} // namespace adh
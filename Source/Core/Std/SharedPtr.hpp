@@ -238,9 +238,10 @@ namespace adh {
                         (*this)(m_Data);
                         delete m_ControlBlock;
                     }
-                    m_Data         = nullptr;
-                    m_ControlBlock = nullptr;
                 }
+                // Released either way, a second Clear() or the destructor mustn't count it again
+                m_Data         = nullptr;
+                m_ControlBlock = nullptr;
             }
         }
 
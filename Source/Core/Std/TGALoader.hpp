@@ -1,9 +1,21 @@
 #pragma once
-#include "File.hpp"
+#include "MappedFile.hpp"
 #include "Utility.hpp"
+#include "VirtualFileSystem.hpp"
 #include <Utility.hpp>
 
-#include <iostream>
+#if defined(__arm__) || defined(__aarch64__)
+#    include <sse2neon/sse2neon.h>
+#elif defined(ADH_WINDOWS)
+#    include <intrin.h>
+#else
+#    include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace adh {
 #pragma pack(push, 1)
@@ -25,135 +37,245 @@ namespace adh {
     };
 #pragma pack(pop)
 
+    // Decodes 8 bit grey, 24 bit BGR and 32 bit BGRA TGAs, plain or run length encoded, into RGBA8
+    // while it reads them. The file is mapped and the rows are decoded straight into the caller's
+    // memory, usually a staging buffer, so nothing is copied in between. Large images can be read
+    // in bands of rows into a small buffer. Rows come out bottom first like the flipped stbi decode,
+    // pixels left to right whatever order the image descriptor stores them in.
     class TGALoader {
       public:
-        TGALoader(const char* filePath) {
-            TGAHeader header;
-
-            // Read header data
-            File file{ filePath, File::Mode::ReadBinary };
-            file.Read(header, sizeof(TGAHeader));
+        TGALoader() noexcept = default;
 
-            m_Width  = header.width;
-            m_Height = header.height;
+        TGALoader(const char* filePath) noexcept {
+            Open(filePath);
+        }
 
-            // Select rgb or rgba
-            switch (header.bitsPerPixel) {
-            case 32:
-                m_Offset = 4u;
-                break;
+        TGALoader(const TGALoader& rhs) = delete;
 
-            case 24:
-                m_Offset = 3u;
-                break;
+        TGALoader& operator=(const TGALoader& rhs) = delete;
 
-            default:
-                ADH_THROW(header.bitsPerPixel == 32 || header.bitsPerPixel == 24, "Not a 32 or 24 bit TGA");
-                break;
+        // Reads the header, returns false if the file isn't a TGA this decodes
+        bool Open(const char* filePath) noexcept {
+            Close();
+            if (!VirtualFileSystem::Open(filePath, m_File) || m_File.GetSize() < sizeof(TGAHeader)) {
+                Close();
+                return false;
             }
+            TGAHeader header;
+            std::memcpy(&header, m_File.GetData(), sizeof(TGAHeader));
 
-            // Calculate size of image
-            m_Size = static_cast<std::size_t>(m_Width * m_Height * m_Offset);
+            auto imageType{ static_cast<std::uint8_t>(header.imageType) };
+            auto bitsPerPixel{ static_cast<std::uint8_t>(header.bitsPerPixel) };
+            auto isGrey{ imageType == 3u || imageType == 11u };
+            auto isColor{ imageType == 2u || imageType == 10u };
+            if (header.colorMapType || !(isGrey && bitsPerPixel == 8u) && !(isColor && (bitsPerPixel == 24u || bitsPerPixel == 32u))) {
+                Close();
+                return false;
+            }
 
-            // Read image data
-            m_Data = { static_cast<unsigned char*>(operator new(m_Size)) };
-            file.Read(m_Data, m_Size);
+            m_Width         = static_cast<std::uint16_t>(header.width);
+            m_Height        = static_cast<std::uint16_t>(header.height);
+            m_BytesPerPixel = bitsPerPixel / 8u;
+            m_IsRunLength   = imageType >= 9u;
+            m_IsTopDown     = header.imageDescriptor & 0x20;
+            m_IsRightToLeft = header.imageDescriptor & 0x10;
+            m_Read          = static_cast<const std::uint8_t*>(m_File.GetData()) + sizeof(TGAHeader) + static_cast<std::uint8_t>(header.IDLenght);
+            m_End           = static_cast<const std::uint8_t*>(m_File.GetData()) + m_File.GetSize();
+            if (!m_Width || !m_Height || m_Read > m_End ||
+                (!m_IsRunLength && static_cast<std::size_t>(m_End - m_Read) < std::size_t{ m_BytesPerPixel } * m_Width * m_Height)) {
+                Close();
+                return false;
+            }
+            return true;
         }
 
-        TGALoader(const TGALoader& rhs) {
-            InitCopy(rhs);
+        void Close() noexcept {
+            m_File.Close();
+            m_Read          = nullptr;
+            m_End           = nullptr;
+            m_Width         = 0u;
+            m_Height        = 0u;
+            m_Row           = 0u;
+            m_BytesPerPixel = 0u;
+            m_PacketLeft    = 0u;
+            m_IsRunLength   = false;
+            m_IsRun         = false;
+            m_IsTopDown     = false;
+            m_IsRightToLeft = false;
         }
 
-        TGALoader& operator=(const TGALoader& rhs) {
-            Clear();
-            InitCopy(rhs);
-
-            return *this;
+        bool IsOpen() const noexcept {
+            return m_Read;
         }
 
-        TGALoader(TGALoader&& rhs) noexcept {
-            InitMove(Move(rhs));
+        std::uint32_t GetWidth() const noexcept {
+            return m_Width;
         }
 
-        TGALoader& operator=(TGALoader&& rhs) noexcept {
-            Clear();
-            InitMove(Move(rhs));
+        std::uint32_t GetHeight() const noexcept {
+            return m_Height;
+        }
 
-            return *this;
+        // Of the whole image in RGBA8
+        std::size_t GetSize() const noexcept {
+            return std::size_t{ 4u } * m_Width * m_Height;
         }
 
-        ~TGALoader() {
-            Clear();
+        std::uint32_t GetRowsLeft() const noexcept {
+            return m_Height - m_Row;
         }
 
-        auto GetData() const noexcept {
-            return m_Data;
+        // The encoded file
+        const void* GetFileData() const noexcept {
+            return m_File.GetData();
         }
 
-        auto GetSize() const noexcept {
-            return m_Size;
+        std::size_t GetFileSize() const noexcept {
+            return m_File.GetSize();
         }
 
-        auto GetWidth() const noexcept {
-            return m_Width;
+        // Decodes the next rowCount rows into destination, bottom first. firstRow is the row of the
+        // image, counted from the bottom, that the first row of destination is. Returns false if the
+        // file ends early.
+        bool ReadRows(std::uint8_t* destination, std::uint32_t rowCount, std::uint32_t& firstRow) noexcept {
+            rowCount = std::min(rowCount, GetRowsLeft());
+            std::size_t rowSize{ std::size_t{ 4u } * m_Width };
+            if (m_IsTopDown) {
+                // The file starts at the top, the band is filled from its last row up
+                firstRow = m_Height - m_Row - rowCount;
+                for (std::uint32_t i{ rowCount }; i--;) {
+                    if (!ReadRow(destination + rowSize * i)) {
+                        return false;
+                    }
+                }
+            } else {
+                firstRow = m_Row;
+                for (std::uint32_t i{}; i != rowCount; ++i) {
+                    if (!ReadRow(destination + rowSize * i)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
         }
 
-        auto GetHeight() const noexcept {
-            return m_Height;
+        // The whole image, pixels must hold GetSize() bytes
+        bool Read(std::uint8_t* pixels) noexcept {
+            std::uint32_t firstRow;
+            return !m_Row && ReadRows(pixels, m_Height, firstRow);
         }
 
-        void InvertRedBlue() noexcept {
-            for (std::size_t y{}; y != m_Height; ++y) {
-                for (std::size_t x{}; x != m_Width; ++x) {
-                    const auto index{ (y * m_Width + x) * m_Offset };
-                    const auto temp{ m_Data[index] };
-                    m_Data[index]     = m_Data[index + 2];
-                    m_Data[index + 2] = temp;
+      private:
+        bool ReadRow(std::uint8_t* destination) noexcept {
+            ++m_Row;
+            if (!m_IsRunLength) {
+                if (static_cast<std::size_t>(m_End - m_Read) < std::size_t{ m_BytesPerPixel } * m_Width) {
+                    return false;
                 }
+                Convert(m_Read, GetPixel(destination, 0u), m_Width, m_IsRightToLeft);
+                m_Read += std::size_t{ m_BytesPerPixel } * m_Width;
+                return true;
             }
-        }
 
-        void Clear() noexcept {
-            if (m_Data) {
-                operator delete(m_Data);
-                m_Data   = nullptr;
-                m_Width  = 0u;
-                m_Height = 0u;
-                m_Size   = 0u;
-                m_Offset = 0u;
+            // Packets may run on into the next row, their state is kept between rows
+            std::uint32_t x{};
+            while (x != m_Width) {
+                if (!m_PacketLeft) {
+                    if (m_Read == m_End) {
+                        return false;
+                    }
+                    auto packet{ *m_Read++ };
+                    m_PacketLeft = (packet & 0x7Fu) + 1u;
+                    m_IsRun      = packet & 0x80u;
+                    if (m_IsRun) {
+                        if (static_cast<std::size_t>(m_End - m_Read) < m_BytesPerPixel) {
+                            return false;
+                        }
+                        Convert(m_Read, m_RunPixel, 1u, false);
+                        m_Read += m_BytesPerPixel;
+                    }
+                }
+                auto count{ std::min(m_PacketLeft, m_Width - x) };
+                if (m_IsRun) {
+                    for (std::uint32_t i{}; i != count; ++i) {
+                        std::memcpy(GetPixel(destination, x + i), m_RunPixel, 4u);
+                    }
+                } else {
+                    if (static_cast<std::size_t>(m_End - m_Read) < std::size_t{ m_BytesPerPixel } * count) {
+                        return false;
+                    }
+                    Convert(m_Read, GetPixel(destination, x), count, m_IsRightToLeft);
+                    m_Read += std::size_t{ m_BytesPerPixel } * count;
+                }
+                x += count;
+                m_PacketLeft -= count;
             }
+            return true;
         }
 
-      private:
-        void InitCopy(const TGALoader& rhs) {
-            m_Data = static_cast<unsigned char*>(operator new(rhs.m_Size));
-            std::memcpy(m_Data, rhs.m_Data, rhs.m_Size);
-
-            m_Width  = rhs.m_Width;
-            m_Height = rhs.m_Height;
-            m_Offset = rhs.m_Offset;
-            m_Size   = rhs.m_Size;
+        // Where the x-th pixel of a row in file order goes
+        std::uint8_t* GetPixel(std::uint8_t* row, std::uint32_t x) const noexcept {
+            return row + std::size_t{ 4u } * (m_IsRightToLeft ? m_Width - 1u - x : x);
         }
 
-        void InitMove(TGALoader&& rhs) {
-            m_Data   = rhs.m_Data;
-            m_Width  = rhs.m_Width;
-            m_Height = rhs.m_Height;
-            m_Offset = rhs.m_Offset;
-            m_Size   = rhs.m_Size;
-
-            rhs.m_Data   = nullptr;
-            rhs.m_Width  = 0u;
-            rhs.m_Height = 0u;
-            rhs.m_Offset = 0u;
-            rhs.m_Size   = 0u;
+        // Whole pixels are written at once, destination is often write combined memory. Reversed
+        // pixels go from destination down, for rows stored right to left.
+        void Convert(const std::uint8_t* source, std::uint8_t* destination, std::uint32_t count, bool isReversed) const noexcept {
+            std::ptrdiff_t step{ isReversed ? -4 : 4 };
+            std::uint32_t i{};
+            switch (m_BytesPerPixel) {
+            case 4u: {
+                // BGRA to RGBA four pixels at a time, green and alpha stay, red and blue swap
+                auto greenAlpha{ _mm_set1_epi32(static_cast<int>(0xFF00FF00u)) };
+                auto lowByte{ _mm_set1_epi32(0x000000FF) };
+                for (; i + 4u <= count; i += 4u) {
+                    auto p{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4u)) };
+                    auto red{ _mm_and_si128(_mm_srli_epi32(p, 16), lowByte) };
+                    auto blue{ _mm_slli_epi32(_mm_and_si128(p, lowByte), 16) };
+                    auto rgba{ _mm_or_si128(_mm_and_si128(p, greenAlpha), _mm_or_si128(red, blue)) };
+                    if (isReversed) {
+                        rgba = _mm_shuffle_epi32(rgba, _MM_SHUFFLE(0, 1, 2, 3));
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + step * (isReversed ? i + 3u : i)), rgba);
+                }
+                for (; i != count; ++i) {
+                    auto s{ source + i * 4u };
+                    std::uint32_t pixel{ s[2] | (s[1] << 8u) | (s[0] << 16u) | (static_cast<std::uint32_t>(s[3]) << 24u) };
+                    std::memcpy(destination + step * i, &pixel, 4u);
+                }
+                break;
+            }
+
+            case 3u:
+                for (; i != count; ++i) {
+                    auto s{ source + i * 3u };
+                    std::uint32_t pixel{ s[2] | (s[1] << 8u) | (s[0] << 16u) | 0xFF000000u };
+                    std::memcpy(destination + step * i, &pixel, 4u);
+                }
+                break;
+
+            default:
+                for (; i != count; ++i) {
+                    std::uint32_t pixel{ source[i] * 0x010101u | 0xFF000000u };
+                    std::memcpy(destination + step * i, &pixel, 4u);
+                }
+                break;
+            }
         }
 
       private:
-        unsigned char* m_Data{};
-        std::size_t m_Width{};
-        std::size_t m_Height{};
-        std::size_t m_Offset{};
-        std::size_t m_Size{};
+        MappedFile m_File;
+        const std::uint8_t* m_Read{}; // Next encoded byte
+        const std::uint8_t* m_End{};
+        std::uint32_t m_Width{};
+        std::uint32_t m_Height{};
+        std::uint32_t m_Row{}; // Rows read, in file order
+        std::uint32_t m_BytesPerPixel{};
+        std::uint32_t m_PacketLeft{}; // Pixels of the run length packet not written yet
+        std::uint8_t m_RunPixel[4]{};
+        bool m_IsRunLength{};
+        bool m_IsRun{};
+        bool m_IsTopDown{};
+        bool m_IsRightToLeft{};
     };
 } // namespace adh
@@ -0,0 +1,144 @@
+#pragma once
+#include "Utility.hpp"
+#include <Utility.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace adh {
+    class ThreadPool {
+      public:
+        // Every task receives the index of the worker thread running it
+        using Task           = std::function<void(std::uint32_t)>;
+        using ThreadCallback = std::function<void(std::uint32_t)>;
+
+      public:
+        ThreadPool() noexcept = default;
+
+        ThreadPool(std::uint32_t threadCount, ThreadCallback onStart = {}, ThreadCallback onExit = {}) {
+            Create(threadCount, Move(onStart), Move(onExit));
+        }
+
+        ThreadPool(const ThreadPool& rhs) = delete;
+
+        ThreadPool& operator=(const ThreadPool& rhs) = delete;
+
+        ThreadPool(ThreadPool&& rhs) = delete;
+
+        ThreadPool& operator=(ThreadPool&& rhs) = delete;
+
+        ~ThreadPool() {
+            Clear();
+        }
+
+        // onStart/onExit run on each worker thread, e.g. to create thread local resources
+        void Create(std::uint32_t threadCount, ThreadCallback onStart = {}, ThreadCallback onExit = {}) {
+            Clear();
+            m_Stop = false;
+            m_Threads.reserve(threadCount);
+            for (std::uint32_t i{}; i != threadCount; ++i) {
+                m_Threads.emplace_back([this, i, onStart, onExit]() {
+                    if (onStart) {
+                        onStart(i);
+                    }
+                    Work(i);
+                    if (onExit) {
+                        onExit(i);
+                    }
+                });
+            }
+        }
+
+        void Destroy() noexcept {
+            Clear();
+        }
+
+        template <typename Func>
+        void Submit(Func&& task) {
+            {
+                std::lock_guard lock{ m_Mutex };
+                m_Tasks.emplace(Forward<Func>(task));
+                ++m_Pending;
+            }
+            m_TaskCondition.notify_one();
+        }
+
+        // Blocks until every submitted task has finished
+        void Wait() {
+            std::unique_lock lock{ m_Mutex };
+            m_DoneCondition.wait(lock, [this]() { return !m_Pending; });
+        }
+
+        std::uint32_t GetThreadCount() const noexcept {
+            return static_cast<std::uint32_t>(m_Threads.size());
+        }
+
+        // Leaves one core for the calling thread
+        static std::uint32_t GetDefaultThreadCount() noexcept {
+            return std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+        }
+
+      private:
+        void Work(std::uint32_t threadIndex) {
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock lock{ m_Mutex };
+                    m_TaskCondition.wait(lock, [this]() { return m_Stop || !m_Tasks.empty(); });
+                    if (m_Stop && m_Tasks.empty()) {
+                        return;
+                    }
+                    task = Move(m_Tasks.front());
+                    m_Tasks.pop();
+                }
+
+                // A throwing task would terminate the worker and leave Wait() blocked, callers that
+                // need the error catch it themselves
+                try {
+                    task(threadIndex);
+                } catch (const std::exception& e) {
+                    ADH_LOG("Thread pool: task failed, " << e.what());
+                } catch (...) {
+                    ADH_LOG("Thread pool: task failed");
+                }
+
+                {
+                    std::lock_guard lock{ m_Mutex };
+                    if (!--m_Pending) {
+                        m_DoneCondition.notify_all();
+                    }
+                }
+            }
+        }
+
+        void Clear() noexcept {
+            {
+                std::lock_guard lock{ m_Mutex };
+                m_Stop = true;
+            }
+            m_TaskCondition.notify_all();
+            for (auto& thread : m_Threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+            m_Threads.clear();
+        }
+
+      private:
+        std::vector<std::thread> m_Threads;
+        std::queue<Task> m_Tasks;
+        std::mutex m_Mutex;
+        std::condition_variable m_TaskCondition;
+        std::condition_variable m_DoneCondition;
+        std::uint32_t m_Pending{};
+        bool m_Stop{};
+    };
+} // namespace adh
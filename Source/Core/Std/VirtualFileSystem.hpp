@@ -0,0 +1,85 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "PakFile.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace adh {
+    // Where the loaders open files. While a pak is mounted, paths under the directory it was built
+    // from are looked up in it first and everything else is read from the disk as before.
+    // Mount() and Unmount() are called on the main thread while nothing is loading, the rest is
+    // thread safe.
+    class VirtualFileSystem {
+      public:
+        // rootDirectory ends with a '/' like Context::GetDataDirectory()
+        static bool Mount(const std::string& pakPath, const std::string& rootDirectory) noexcept {
+            Unmount();
+            if (!s_Pak.Open(pakPath.data())) {
+                return false;
+            }
+            s_RootDirectory = rootDirectory;
+            return true;
+        }
+
+        // Files opened from the pak must be closed first
+        static void Unmount() noexcept {
+            s_Pak.Close();
+            s_RootDirectory.clear();
+        }
+
+        static bool IsMounted() noexcept {
+            return s_Pak.IsOpen();
+        }
+
+        static bool Open(const std::string& filePath, MappedFile& file) noexcept {
+            if (auto entry{ Find(filePath) }) {
+                return s_Pak.Read(*entry, file);
+            }
+            return file.Open(filePath.data());
+        }
+
+        static bool Open(const char* filePath, MappedFile& file) noexcept {
+            return Open(std::string{ filePath }, file);
+        }
+
+        // Size and last write time, ticks of the file clock like the caches store them
+        static bool GetStatus(const std::string& filePath, std::uint64_t& size, std::int64_t& time) noexcept {
+            if (auto entry{ Find(filePath) }) {
+                size = entry->originalSize;
+                time = entry->time;
+                return true;
+            }
+            std::error_code error;
+            size = static_cast<std::uint64_t>(std::filesystem::file_size(filePath, error));
+            if (error) {
+                return false;
+            }
+            time = static_cast<std::int64_t>(std::filesystem::last_write_time(filePath, error).time_since_epoch().count());
+            return !error;
+        }
+
+        static bool IsPacked(const std::string& filePath) noexcept {
+            return Find(filePath) != nullptr;
+        }
+
+        static const PakFile& GetPak() noexcept {
+            return s_Pak;
+        }
+
+      private:
+        static const PakFile::Entry* Find(const std::string& filePath) noexcept {
+            if (!s_Pak.IsOpen() || filePath.compare(0u, s_RootDirectory.size(), s_RootDirectory)) {
+                return nullptr;
+            }
+            return s_Pak.Find(std::string_view{ filePath }.substr(s_RootDirectory.size()));
+        }
+
+      private:
+        inline static PakFile s_Pak;
+        inline static std::string s_RootDirectory;
+    };
+} // namespace adh
@@ -49,9 +49,11 @@ namespace adh {
     }
 
     void Editor::CreateFramebuffers(vk::Swapchain& swapchain) {
-        m_Images.Resize(swapchain.GetImageViewCount() * 2);
-        m_Framebuffers.Resize(swapchain.GetImageViewCount() * 2);
-        for (std::uint32_t i{}; i != swapchain.GetImageViewCount() * 2; ++i) {
+        // Both viewports are drawn into by every frame in flight, one image each
+        m_FrameCount = vk::FrameContext::maxFramesInFlight;
+        m_Images.Resize(m_FrameCount * 2);
+        m_Framebuffers.Resize(m_FrameCount * 2);
+        for (std::uint32_t i{}; i != m_FrameCount * 2; ++i) {
             m_Images[i].Create(
                 { swapchain.GetExtent().width, swapchain.GetExtent().height, 1u },
                 VK_FORMAT_B8G8R8A8_UNORM,
@@ -84,7 +86,6 @@ namespace adh {
             //           "Failed to create frame buffers!");
         }
         m_RenderPass.UpdateRenderArea({ {}, swapchain.GetExtent() });
-        m_SwapchainImageCount = swapchain.GetImageViewCount();
     }
 
     void Editor::InitOverlay(vk::Swapchain& swapchain, Scene& scene, vk::Sampler& sampler, float aspecRatioWidth, float aspecRatioHeight) {
@@ -95,18 +96,18 @@ namespace adh {
             aspecRatioHeight,
             m_RenderPass,
             vk::Context::Get()->GetQueue(vk::DeviceQueues::Family::eGraphics).queue,
-            swapchain.GetImageViewCount(),
+            m_FrameCount,
             &scene);
         {
             Array<VkImageView> views;
-            for (std::size_t i{}; i != m_SwapchainImageCount; ++i) {
+            for (std::size_t i{}; i != m_FrameCount; ++i) {
                 views.EmplaceBack(m_Images[i].GetImageView());
             }
             m_Overlay.AddTexture("Scene Viewport", views.GetData(), sampler);
         }
         {
             Array<VkImageView> views;
-            for (std::size_t i{ m_SwapchainImageCount }; i != m_SwapchainImageCount * 2; ++i) {
+            for (std::size_t i{ m_FrameCount }; i != m_FrameCount * 2; ++i) {
                 views.EmplaceBack(m_Images[i].GetImageView());
             }
             m_Overlay.AddTexture("Game Viewport", views.GetData(), sampler);
@@ -117,14 +118,14 @@ namespace adh {
         m_Overlay.SetUpDisplaySize(static_cast<float>(extent.width), static_cast<float>(extent.height));
         {
             Array<VkImageView> views;
-            for (std::size_t i{}; i != m_SwapchainImageCount; ++i) {
+            for (std::size_t i{}; i != m_FrameCount; ++i) {
                 views.EmplaceBack(m_Images[i].GetImageView());
             }
             m_Overlay.UpdateTexture("Scene Viewport", views.GetData(), sampler);
         }
         {
             Array<VkImageView> views;
-            for (std::size_t i{ m_SwapchainImageCount }; i != m_SwapchainImageCount * 2; ++i) {
+            for (std::size_t i{ m_FrameCount }; i != m_FrameCount * 2; ++i) {
                 views.EmplaceBack(m_Images[i].GetImageView());
             }
             m_Overlay.UpdateTexture("Game Viewport", views.GetData(), sampler);
@@ -135,8 +136,13 @@ namespace adh {
         m_Overlay.OnUpdate(scene, deltaTime, drawEditor);
     }
 
-    void Editor::Draw(VkCommandBuffer cmd, std::uint32_t imageIndex, bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, float* floats[], Vector3D& sunPosition) {
-        m_Overlay.Draw(cmd, imageIndex, maximizeOnPlay, play, pause, fpsLimit, floats, sunPosition);
+    void Editor::Draw(VkCommandBuffer cmd, std::uint32_t frameIndex, bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, vk::FrameSettings* frameSettings,
+                      float* floats[], Vector3D& sunPosition, bool* gpuCulling, const RenderQueue& renderQueue, const vk::GpuProfiler& profiler) {
+        m_Overlay.Draw(cmd, frameIndex, maximizeOnPlay, play, pause, fpsLimit, frameSettings, floats, sunPosition, gpuCulling, renderQueue, profiler);
+    }
+
+    void Editor::UploadThumbnails(VkCommandBuffer cmd, vk::FrameContext& frameContext) {
+        m_Overlay.UploadThumbnails(cmd, frameContext);
     }
 
     bool Editor::GetKeyDown(std::uint64_t keycode) noexcept {
@@ -156,7 +162,7 @@ namespace adh {
     }
 
     void Editor::Recreate(vk::Swapchain& swapchain) {
-        for (std::uint32_t i{}; i != swapchain.GetImageViewCount() * 2; ++i) {
+        for (std::uint32_t i{}; i != m_Images.GetSize(); ++i) {
             m_Images[i].Destroy();
             m_Framebuffers[i].Destroy();
             // vkDestroyFramebuffer(vk::Context::Get()->GetDevice(), m_Framebuffers[i], nullptr);
@@ -165,8 +171,16 @@ namespace adh {
         m_RenderPass.UpdateRenderArea({ {}, swapchain.GetExtent() });
     }
 
-    void Editor::BeginRenderPass(VkCommandBuffer cmd, std::uint32_t imageIndex, std::uint32_t viewportIndex) {
-        m_RenderPass.Begin(cmd, m_Framebuffers[imageIndex + (m_SwapchainImageCount * viewportIndex)]);
+    void Editor::BeginRenderPass(VkCommandBuffer cmd, std::uint32_t frameIndex, std::uint32_t viewportIndex, VkSubpassContents contents) {
+        m_RenderPass.Begin(cmd, GetFramebuffer(frameIndex, viewportIndex), contents);
+    }
+
+    VkRenderPass Editor::GetRenderPass() noexcept {
+        return m_RenderPass;
+    }
+
+    VkFramebuffer Editor::GetFramebuffer(std::uint32_t frameIndex, std::uint32_t viewportIndex) noexcept {
+        return m_Framebuffers[frameIndex + (m_FrameCount * viewportIndex)];
     }
 
     void Editor::BindGraphicsPipeline(VkCommandBuffer cmd, std::uint32_t index) {
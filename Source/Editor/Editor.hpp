@@ -3,6 +3,7 @@
 #include <Std/Array.hpp>
 #include <Std/StaticArray.hpp>
 #include <Vulkan/Attachments.hpp>
+#include <Vulkan/FrameContext.hpp>
 #include <Vulkan/Framebuffer.hpp>
 #include <Vulkan/GraphicsPipeline.hpp>
 #include <Vulkan/Image.hpp>
@@ -16,6 +17,8 @@
 #include "UIOverlay/UIOverlay.hpp"
 
 namespace adh {
+    class RenderQueue;
+
     class Editor {
       public:
         Editor() noexcept = default;
@@ -56,7 +59,10 @@ namespace adh {
 
         void OnUpdate(Scene* scene, float deltaTime, bool drawEditor);
 
-        void Draw(VkCommandBuffer cmd, std::uint32_t imageIndex, bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, float* floats[], Vector3D& sunPosition);
+        void Draw(VkCommandBuffer cmd, std::uint32_t frameIndex, bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, vk::FrameSettings* frameSettings,
+                  float* floats[], Vector3D& sunPosition, bool* gpuCulling, const RenderQueue& renderQueue, const vk::GpuProfiler& profiler);
+
+        void UploadThumbnails(VkCommandBuffer cmd, vk::FrameContext& frameContext);
 
         void Recreate(vk::Swapchain& swapchain);
 
@@ -68,7 +74,11 @@ namespace adh {
 
         float GetSelectedAspectRatioHeight() const noexcept;
 
-        void BeginRenderPass(VkCommandBuffer cmd, std::uint32_t imageIndex, std::uint32_t viewportIndex);
+        void BeginRenderPass(VkCommandBuffer cmd, std::uint32_t frameIndex, std::uint32_t viewportIndex, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
+        VkRenderPass GetRenderPass() noexcept;
+
+        VkFramebuffer GetFramebuffer(std::uint32_t frameIndex, std::uint32_t viewportIndex) noexcept;
 
         void BindGraphicsPipeline(VkCommandBuffer cmd, std::uint32_t index = 0u);
 
@@ -88,6 +98,6 @@ namespace adh {
         vk::RenderPass m_RenderPass;
         Array<vk::GraphicsPipeline> m_GraphicsPipelines;
         UIOverlay m_Overlay;
-        std::uint32_t m_SwapchainImageCount;
+        std::uint32_t m_FrameCount; // Viewport images per viewport
     };
 } // namespace adh
@@ -4,6 +4,8 @@
 
 #include <Scene/Scene.hpp>
 
+#include <algorithm>
+
 #if defined(ADH_WINDOWS)
 #    include <Windows.h>
 #endif
@@ -13,11 +15,20 @@ namespace adh {
         Create(assetPath);
     }
 
+    AssetPanel::~AssetPanel() {
+        Event::DestroyListener(m_Listener);
+    }
+
     void AssetPanel::Create(const char* assetPath) {
         currentDirectory = dataDirectory = assetPath;
+        m_ListedDirectory.clear();
+        if (m_Listener == null_listener) {
+            m_Listener = Event::CreateListener();
+            Event::AddListener<FileEvent>(m_Listener, &AssetPanel::OnFileEvent, this);
+        }
     }
 
-    void AssetPanel::Draw(Scene* scene, void* folderIconID, void* itemIconID) noexcept {
+    void AssetPanel::Draw(Scene* scene, void* folderIconID, void* itemIconID, void* thumbnailsID) noexcept {
         if (isOpen) {
             if (!ImGui::Begin("Assets", &isOpen)) {
                 ImGui::End();
@@ -29,90 +40,134 @@ namespace adh {
                         currentDirectory = currentDirectory.parent_path();
                     }
                 }
+                if (m_ListedDirectory != currentDirectory.string()) {
+                    Refresh();
+                }
 
                 float padding{ 8.0f };
                 float thumbnailSize{ 64.0f };
                 float cellSize{ thumbnailSize + padding };
                 float panelWidth{ ImGui::GetContentRegionAvail().x };
                 auto columnCount{ static_cast<std::int32_t>(std::max(panelWidth / cellSize, 1.0f)) };
+                auto rowCount{ static_cast<std::int32_t>((m_Entries.size() + columnCount - 1u) / columnCount) };
 
                 ImGui::Columns(columnCount, nullptr, false);
 
-                for (auto&& directoryEntry : std::filesystem::directory_iterator(currentDirectory)) {
-                    std::string dir = directoryEntry.path().string();
-                    auto pos        = dir.find_last_of('/');
-                    auto str        = dir.substr(pos + 1);
-                    if (str[0] != '.') {
-                        ImGui::PushID(directoryEntry.path().string().data());
-                        const auto& path{ directoryEntry.path() };
-                        auto relativePath{ std::filesystem::relative(path, currentDirectory) };
-                        auto filenameString{ relativePath.filename().string() };
-
-                        if (directoryEntry.is_directory()) {
-                            ImGui::ImageButton(folderIconID, { thumbnailSize, thumbnailSize }, ImVec2(0, 1), ImVec2(1, 0));
-                        }
+                // Every cell is one line of text high, the clipper skips the rows out of view
+                ImGuiListClipper clipper;
+                clipper.Begin(rowCount);
+                while (clipper.Step()) {
+                    for (auto row{ clipper.DisplayStart }; row < clipper.DisplayEnd; ++row) {
+                        for (std::int32_t column{}; column != columnCount; ++column) {
+                            auto index{ static_cast<std::size_t>(row) * columnCount + column };
+                            if (index >= m_Entries.size()) {
+                                break;
+                            }
+                            const auto& entry{ m_Entries[index] };
+                            ImGui::PushID(entry.path.data());
+
+                            AssetThumbnails::Rect rect;
+                            if (entry.isDirectory) {
+                                ImGui::ImageButton(folderIconID, { thumbnailSize, thumbnailSize }, ImVec2(0, 1), ImVec2(1, 0));
+                            } else if (thumbnails.Find(entry.path, rect)) {
+                                ImGui::ImageButton(thumbnailsID, { thumbnailSize, thumbnailSize }, ImVec2(rect.u0, rect.v0), ImVec2(rect.u1, rect.v1));
+                            } else {
+                                ImGui::ImageButton(itemIconID, { thumbnailSize, thumbnailSize }, ImVec2(0, 1), ImVec2(1, 0));
+                            }
 
-                        else {
-                            ImGui::ImageButton(itemIconID, { thumbnailSize, thumbnailSize }, ImVec2(0, 1), ImVec2(1, 0));
+                            if (!entry.isDirectory) {
+                                if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
+                                    ImGui::SetDragDropPayload("DND_DEMO_CELL", entry.path.data(), entry.path.size() + 1);
+                                    ImGui::EndDragDropSource();
+                                }
+                            }
 
-                            if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
-                                ImGui::SetDragDropPayload("DND_DEMO_CELL", directoryEntry.path().string().data(), directoryEntry.path().string().size() + 1);
-                                ImGui::EndDragDropSource();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::SetTooltip("%s", entry.name.data());
                             }
-                        }
 
-                        if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
-                            if (directoryEntry.is_directory()) {
-                                currentDirectory /= path.filename();
-                            } else {
+                            if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                                if (entry.isDirectory) {
+                                    currentDirectory /= entry.name;
+                                } else {
 #if defined(ADH_APPLE)
-                                std::string t = "open " + directoryEntry.path().string();
-                                system(t.data());
+                                    std::string t = "open " + entry.path;
+                                    system(t.data());
 #elif defined(ADH_LINUX)
-                                std::string t = "vim " + directoryEntry.path().string();
-                                system(t.data());
+                                    std::string t = "vim " + entry.path;
+                                    system(t.data());
 #elif defined(ADH_WINDOWS)
-                                std::string t = "start " + directoryEntry.path().string();
-                                for (int i{}; i != t.size(); ++i) {
-                                    if (t[i] == '/') {
-                                        t[i] = '\\';
+                                    std::string t = "start " + entry.path;
+                                    for (int i{}; i != t.size(); ++i) {
+                                        if (t[i] == '/') {
+                                            t[i] = '\\';
+                                        }
                                     }
-                                }
-                                system(t.data());
+                                    system(t.data());
 #endif
+                                }
                             }
-                        }
 
-                        if (ImGui::BeginPopupContextItem(directoryEntry.path().string().data())) {
-                            if (ImGui::MenuItem("Open")) {
-                                Event::Dispatch<StatusEvent>(StatusEvent::Type::eStop);
-                                scene->LoadFromFile(directoryEntry.path().string().data());
-                            }
+                            if (ImGui::BeginPopupContextItem(entry.path.data())) {
+                                if (ImGui::MenuItem("Open")) {
+                                    Event::Dispatch<StatusEvent>(StatusEvent::Type::eStop);
+                                    scene->LoadFromFile(entry.path.data());
+                                }
 
-                            if (ImGui::MenuItem("Delete")) {
+                                if (ImGui::MenuItem("Delete")) {
 #if defined(ADH_APPLE)
-                                std::string del = "rm " + directoryEntry.path().string();
-                                system(del.data());
+                                    std::string del = "rm " + entry.path;
+                                    system(del.data());
 #elif defined(ADH_LINUX)
-                                std::string del = "rm " + directoryEntry.path().string();
-                                system(del.data());
+                                    std::string del = "rm " + entry.path;
+                                    system(del.data());
 #elif defined(ADH_WINDOWS)
-                                DeleteFileA(directoryEntry.path().string().data());
+                                    DeleteFileA(entry.path.data());
 #endif
-                            }
+                                    // Listed again next frame, also where no watcher reports it
+                                    thumbnails.Invalidate(entry.path);
+                                    m_ListedDirectory.clear();
+                                }
 
-                            ImGui::EndPopup();
-                        }
+                                ImGui::EndPopup();
+                            }
 
-                        ImGui::TextWrapped(filenameString.data());
+                            ImGui::TextUnformatted(entry.name.data());
 
-                        ImGui::NextColumn();
-                        ImGui::PopID();
+                            ImGui::NextColumn();
+                            ImGui::PopID();
+                        }
                     }
                 }
 
+                ImGui::Columns(1);
                 ImGui::End();
             }
         }
     }
+
+    void AssetPanel::OnFileEvent(FileEvent* event) {
+        std::string filePath{ event->filePath };
+        thumbnails.Invalidate(filePath);
+        // Files of other directories are listed when the panel moves there
+        if (filePath.substr(0u, filePath.find_last_of('/')) == m_ListedDirectory) {
+            m_ListedDirectory.clear();
+        }
+    }
+
+    void AssetPanel::Refresh() {
+        m_ListedDirectory = currentDirectory.string();
+        m_Entries.clear();
+        std::error_code error;
+        for (const auto& directoryEntry : std::filesystem::directory_iterator(currentDirectory, error)) {
+            auto name{ directoryEntry.path().filename().string() };
+            if (name.empty() || name[0] == '.') {
+                continue;
+            }
+            m_Entries.push_back({ m_ListedDirectory + "/" + name, Move(name), directoryEntry.is_directory(error) });
+        }
+        std::sort(m_Entries.begin(), m_Entries.end(), [](const Entry& lhs, const Entry& rhs) {
+            return lhs.isDirectory != rhs.isDirectory ? lhs.isDirectory : lhs.name < rhs.name;
+        });
+    }
 } // namespace adh
@@ -1,8 +1,16 @@
 #pragma once
+#include "AssetThumbnails.hpp"
+#include <Event/Event.hpp>
+
 #include <filesystem>
+#include <string>
+#include <vector>
 
 namespace adh {
     class Scene;
+
+    // Lists the current directory once and keeps the listing until the FileWatcher reports a
+    // change in it, only the rows in view are drawn. Textures and meshes show their thumbnail.
     class AssetPanel {
         using FilePath = std::filesystem::path;
 
@@ -11,13 +19,38 @@ namespace adh {
 
         AssetPanel(const char* assetPath);
 
+        AssetPanel(const AssetPanel& rhs) = delete;
+
+        AssetPanel& operator=(const AssetPanel& rhs) = delete;
+
+        ~AssetPanel();
+
         void Create(const char* assetPath);
 
-        void Draw(Scene* scene, void* folderIconID, void* itemIconID) noexcept;
+        void Draw(Scene* scene, void* folderIconID, void* itemIconID, void* thumbnailsID) noexcept;
+
+        void OnFileEvent(FileEvent* event);
 
       public:
         FilePath dataDirectory;
         FilePath currentDirectory;
+        AssetThumbnails thumbnails;
         bool isOpen{ true };
+
+      private:
+        struct Entry {
+            std::string path;
+            std::string name;
+            bool isDirectory;
+        };
+
+      private:
+        // Directories first, both by name. Hidden files are skipped.
+        void Refresh();
+
+      private:
+        std::vector<Entry> m_Entries;
+        std::string m_ListedDirectory; // Of m_Entries, cleared when a change in it is reported
+        EventListener m_Listener{ null_listener };
     };
 } // namespace adh
@@ -0,0 +1,371 @@
+#include "AssetThumbnails.hpp"
+#include <Scene/Components/Mesh.hpp>
+#include <Vulkan/StagingBuffer.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+
+namespace adh {
+    namespace {
+        std::string GetExtension(const std::string& filePath) {
+            auto dot{ filePath.find_last_of('.') };
+            if (dot == std::string::npos || filePath.find('/', dot) != std::string::npos) {
+                return {};
+            }
+            auto extension{ filePath.substr(dot) };
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension;
+        }
+    } // namespace
+
+    AssetThumbnails::AssetThumbnails() noexcept : m_IsStopping{},
+                                                  m_Frame{},
+                                                  m_RequestCount{} {
+    }
+
+    AssetThumbnails::~AssetThumbnails() {
+        Clear();
+    }
+
+    void AssetThumbnails::Create(const vk::Sampler& sampler) {
+        Clear();
+        // Transparent until the first thumbnails are copied in
+        Array<std::uint8_t> pixels;
+        pixels.Resize(std::size_t{ 4u } * atlasSize * atlasSize);
+        std::memset(pixels.GetData(), 0, pixels.GetSize());
+        m_Atlas.Create(pixels.GetData(), pixels.GetSize(), { atlasSize, atlasSize }, VK_IMAGE_USAGE_SAMPLED_BIT, &sampler);
+
+        m_FreeCells.reserve(cellCount);
+        for (std::uint32_t i{ cellCount }; i != 0u; --i) {
+            m_FreeCells.emplace_back(i - 1u);
+        }
+        m_IsStopping = false;
+        m_ThreadPool.Create(1u);
+    }
+
+    void AssetThumbnails::Destroy() noexcept {
+        Clear();
+    }
+
+    bool AssetThumbnails::Find(const std::string& filePath, Rect& rect) {
+        auto it{ m_Entries.find(filePath) };
+        if (it == m_Entries.end()) {
+            if (!IsTexture(filePath) && !IsMesh(filePath)) {
+                return false;
+            }
+            auto request{ ++m_RequestCount };
+            m_Entries.emplace(filePath, Entry{ request, m_Frame, cellCount, State::eRendering });
+            m_ThreadPool.Submit([this, filePath, request](std::uint32_t) {
+                if (m_IsStopping) {
+                    return;
+                }
+                Result result{ filePath, request, {}, false };
+                try {
+                    result.isRendered = Render(filePath, result.pixels);
+                } catch (const std::exception&) {
+                    result.isRendered = false;
+                }
+                std::lock_guard lock{ m_Mutex };
+                m_Results.emplace_back(Move(result));
+            });
+            return false;
+        }
+
+        auto& entry{ it->second };
+        if (entry.state != State::eReady) {
+            return false;
+        }
+        entry.lastUse = m_Frame;
+        constexpr auto columns{ atlasSize / cellSize };
+        constexpr auto size{ static_cast<float>(cellSize) / static_cast<float>(atlasSize) };
+        auto u{ static_cast<float>(entry.cell % columns) * size };
+        auto v{ static_cast<float>(entry.cell / columns) * size };
+        rect = { u, v + size, u + size, v };
+        return true;
+    }
+
+    void AssetThumbnails::Invalidate(const std::string& filePath) {
+        auto it{ m_Entries.find(filePath) };
+        if (it == m_Entries.end()) {
+            return;
+        }
+        // Copies into the cell are ordered after the frames that still draw it
+        if (it->second.cell != cellCount) {
+            m_FreeCells.emplace_back(it->second.cell);
+        }
+        m_Entries.erase(it);
+    }
+
+    void AssetThumbnails::Upload(VkCommandBuffer commandBuffer, vk::FrameContext& frameContext) {
+        ++m_Frame;
+        {
+            std::lock_guard lock{ m_Mutex };
+            for (auto& result : m_Results) {
+                m_Waiting.emplace_back(Move(result));
+            }
+            m_Results.clear();
+        }
+        if (m_Waiting.empty() || !vk::StagingBuffer::IsCreated()) {
+            return;
+        }
+
+        constexpr VkDeviceSize cellBytes{ VkDeviceSize{ 4u } * cellSize * cellSize };
+        vk::StagingBuffer::Region region{};
+        if (!vk::StagingBuffer::Get()->Allocate(cellBytes * maxUploads, region)) {
+            return;
+        }
+
+        constexpr auto columns{ atlasSize / cellSize };
+        std::uint32_t uploadCount{};
+        std::size_t i{};
+        for (; i != m_Waiting.size() && uploadCount != maxUploads; ++i) {
+            auto& result{ m_Waiting[i] };
+            auto it{ m_Entries.find(result.filePath) };
+            if (it == m_Entries.end() || it->second.request != result.request) {
+                continue;
+            }
+            auto& entry{ it->second };
+            if (!result.isRendered) {
+                entry.state = State::eFailed;
+                continue;
+            }
+            if (!AllocateCell(entry.cell)) {
+                break;
+            }
+            auto offset{ cellBytes * uploadCount++ };
+            std::memcpy(static_cast<char*>(region.data) + offset, result.pixels.GetData(), static_cast<std::size_t>(cellBytes));
+            VkOffset2D cellOffset{ static_cast<std::int32_t>(entry.cell % columns * cellSize), static_cast<std::int32_t>(entry.cell / columns * cellSize) };
+            m_Atlas.CopyRegion(commandBuffer, *vk::StagingBuffer::Get(), region.offset + offset, cellOffset, { cellSize, cellSize });
+            entry.state = State::eReady;
+        }
+        m_Waiting.erase(m_Waiting.begin(), m_Waiting.begin() + static_cast<std::ptrdiff_t>(i));
+
+        if (!uploadCount) {
+            vk::StagingBuffer::Get()->Free(region);
+            return;
+        }
+        frameContext.Defer([region]() mutable {
+            vk::StagingBuffer::Get()->Free(region);
+        });
+    }
+
+    VkImageView AssetThumbnails::GetImageView() noexcept {
+        return m_Atlas;
+    }
+
+    bool AssetThumbnails::IsTexture(const std::string& filePath) noexcept {
+        auto extension{ GetExtension(filePath) };
+        return extension == ".tga" || extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp";
+    }
+
+    bool AssetThumbnails::IsMesh(const std::string& filePath) noexcept {
+        auto extension{ GetExtension(filePath) };
+        return extension == ".obj" || extension == ".fbx" || extension == ".gltf" || extension == ".glb" || extension == ".dae";
+    }
+
+    bool AssetThumbnails::Render(const std::string& filePath, Array<std::uint8_t>& pixels) {
+        pixels.Resize(std::size_t{ 4u } * cellSize * cellSize);
+        std::memset(pixels.GetData(), 0, pixels.GetSize());
+        return IsTexture(filePath) ? RenderTexture(filePath, pixels) : RenderMesh(filePath, pixels);
+    }
+
+    bool AssetThumbnails::RenderTexture(const std::string& filePath, Array<std::uint8_t>& pixels) {
+        Array<std::uint8_t> image;
+        VkExtent2D extent;
+        if (!vk::Texture2D::Decode(filePath.data(), image, extent) || !extent.width || !extent.height) {
+            return false;
+        }
+
+        // Box filtered, every source texel lands in exactly one thumbnail texel
+        auto scale{ static_cast<float>(cellSize) / static_cast<float>(std::max(extent.width, extent.height)) };
+        auto width{ std::clamp(static_cast<std::uint32_t>(std::lround(extent.width * scale)), 1u, cellSize) };
+        auto height{ std::clamp(static_cast<std::uint32_t>(std::lround(extent.height * scale)), 1u, cellSize) };
+        auto left{ (cellSize - width) / 2u };
+        auto bottom{ (cellSize - height) / 2u };
+        for (std::uint32_t y{}; y != height; ++y) {
+            auto y0{ std::uint64_t{ y } * extent.height / height };
+            auto y1{ std::max(std::uint64_t{ y + 1u } * extent.height / height, y0 + 1u) };
+            for (std::uint32_t x{}; x != width; ++x) {
+                auto x0{ std::uint64_t{ x } * extent.width / width };
+                auto x1{ std::max(std::uint64_t{ x + 1u } * extent.width / width, x0 + 1u) };
+                std::uint64_t sum[4]{};
+                for (auto sy{ y0 }; sy != y1; ++sy) {
+                    const auto* texel{ image.GetData() + (sy * extent.width + x0) * 4u };
+                    for (auto sx{ x0 }; sx != x1; ++sx, texel += 4) {
+                        sum[0] += texel[0];
+                        sum[1] += texel[1];
+                        sum[2] += texel[2];
+                        sum[3] += texel[3];
+                    }
+                }
+                auto count{ (y1 - y0) * (x1 - x0) };
+                auto* target{ pixels.GetData() + (std::size_t{ bottom + y } * cellSize + left + x) * 4u };
+                for (std::uint32_t c{}; c != 4u; ++c) {
+                    target[c] = static_cast<std::uint8_t>(sum[c] / count);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool AssetThumbnails::RenderMesh(const std::string& filePath, Array<std::uint8_t>& pixels) {
+        Array<Vector3D> positions;
+        Array<std::uint32_t> indices;
+        std::uint32_t indexCount{};
+        if (!Mesh::ReadTriangles(filePath, positions, indices, indexCount) || positions.IsEmpty() || indexCount < 3u) {
+            return false;
+        }
+
+        // Rasterized at twice the size and averaged down for smooth edges
+        constexpr std::uint32_t size{ cellSize * 2u };
+        constexpr float yaw{ 0.785f };    // Radians around the up axis
+        constexpr float pitch{ 0.524f };  // Radians looking down
+        constexpr float lightX{ -0.41f }; // Toward the light, in view space
+        constexpr float lightY{ 0.57f };
+        constexpr float lightZ{ -0.71f };
+
+        Vector3D min{ positions[0] };
+        Vector3D max{ positions[0] };
+        for (const auto& position : positions) {
+            min = Vector3D{ std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z) };
+            max = Vector3D{ std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z) };
+        }
+        Vector3D center{ (min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f };
+
+        // View space, x to the right, y up and z away from the viewer
+        Array<Vector3D> view;
+        view.Resize(positions.GetSize());
+        float radius{};
+        auto cosYaw{ std::cos(yaw) };
+        auto sinYaw{ std::sin(yaw) };
+        auto cosPitch{ std::cos(pitch) };
+        auto sinPitch{ std::sin(pitch) };
+        for (std::size_t i{}; i != positions.GetSize(); ++i) {
+            auto x{ positions[i].x - center.x };
+            auto y{ positions[i].y - center.y };
+            auto z{ positions[i].z - center.z };
+            radius = std::max(radius, std::sqrt(x * x + y * y + z * z));
+            auto x1{ cosYaw * x + sinYaw * z };
+            auto z1{ -sinYaw * x + cosYaw * z };
+            view[i] = Vector3D{ x1, cosPitch * y - sinPitch * z1, sinPitch * y + cosPitch * z1 };
+        }
+        if (radius <= 0.0f) {
+            return false;
+        }
+        auto scale{ size * 0.48f / radius };
+        for (auto& vertex : view) {
+            vertex.x = size * 0.5f + vertex.x * scale;
+            vertex.y = size * 0.5f + vertex.y * scale;
+        }
+
+        Array<float> depth;
+        depth.Resize(std::size_t{ size } * size, std::numeric_limits<float>::max());
+        Array<std::uint8_t> shade;
+        shade.Resize(std::size_t{ size } * size, std::uint8_t{});
+        for (std::uint32_t i{}; i + 2u < indexCount; i += 3u) {
+            if (indices[i] >= view.GetSize() || indices[i + 1u] >= view.GetSize() || indices[i + 2u] >= view.GetSize()) {
+                return false;
+            }
+            const auto& a{ view[indices[i]] };
+            const auto& b{ view[indices[i + 1u]] };
+            const auto& c{ view[indices[i + 2u]] };
+
+            // Both sides are lit, meshes may be open or wound either way
+            auto ux{ b.x - a.x }, uy{ b.y - a.y }, uz{ (b.z - a.z) * scale };
+            auto vx{ c.x - a.x }, vy{ c.y - a.y }, vz{ (c.z - a.z) * scale };
+            auto nx{ uy * vz - uz * vy }, ny{ uz * vx - ux * vz }, nz{ ux * vy - uy * vx };
+            auto length{ std::sqrt(nx * nx + ny * ny + nz * nz) };
+            if (length <= 0.0f) {
+                continue;
+            }
+            auto light{ std::abs(nx * lightX + ny * lightY + nz * lightZ) / length };
+            auto intensity{ static_cast<std::uint8_t>(std::clamp(60.0f + 195.0f * light, 1.0f, 255.0f)) };
+
+            auto area{ ux * vy - uy * vx };
+            if (std::abs(area) < 1e-6f) {
+                continue;
+            }
+            auto x0{ static_cast<std::int32_t>(std::max(std::floor(std::min({ a.x, b.x, c.x })), 0.0f)) };
+            auto x1{ static_cast<std::int32_t>(std::min(std::ceil(std::max({ a.x, b.x, c.x })), size - 1.0f)) };
+            auto y0{ static_cast<std::int32_t>(std::max(std::floor(std::min({ a.y, b.y, c.y })), 0.0f)) };
+            auto y1{ static_cast<std::int32_t>(std::min(std::ceil(std::max({ a.y, b.y, c.y })), size - 1.0f)) };
+            for (auto y{ y0 }; y <= y1; ++y) {
+                for (auto x{ x0 }; x <= x1; ++x) {
+                    auto px{ x + 0.5f };
+                    auto py{ y + 0.5f };
+                    auto w1{ ((px - a.x) * vy - (py - a.y) * vx) / area };
+                    auto w2{ ((py - a.y) * ux - (px - a.x) * uy) / area };
+                    auto w0{ 1.0f - w1 - w2 };
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                        continue;
+                    }
+                    auto z{ w0 * a.z + w1 * b.z + w2 * c.z };
+                    auto index{ std::size_t(y) * size + std::size_t(x) };
+                    if (z < depth[index]) {
+                        depth[index] = z;
+                        shade[index] = intensity;
+                    }
+                }
+            }
+        }
+
+        for (std::uint32_t y{}; y != cellSize; ++y) {
+            for (std::uint32_t x{}; x != cellSize; ++x) {
+                std::uint32_t sum{};
+                std::uint32_t coverage{};
+                for (std::uint32_t s{}; s != 4u; ++s) {
+                    auto value{ shade[std::size_t(y * 2u + s / 2u) * size + x * 2u + s % 2u] };
+                    sum += value;
+                    coverage += value != 0u;
+                }
+                if (!coverage) {
+                    continue;
+                }
+                auto value{ static_cast<std::uint8_t>(sum / coverage) };
+                auto* target{ pixels.GetData() + (std::size_t{ y } * cellSize + x) * 4u };
+                target[0] = value;
+                target[1] = value;
+                target[2] = static_cast<std::uint8_t>(std::min(value + 16u, 255u));
+                target[3] = static_cast<std::uint8_t>(coverage * 255u / 4u);
+            }
+        }
+        return true;
+    }
+
+    bool AssetThumbnails::AllocateCell(std::uint32_t& cell) {
+        if (!m_FreeCells.empty()) {
+            cell = m_FreeCells.back();
+            m_FreeCells.pop_back();
+            return true;
+        }
+        auto oldest{ m_Entries.end() };
+        for (auto it{ m_Entries.begin() }; it != m_Entries.end(); ++it) {
+            const auto& entry{ it->second };
+            if (entry.state == State::eReady && entry.lastUse + 1u < m_Frame && (oldest == m_Entries.end() || entry.lastUse < oldest->second.lastUse)) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_Entries.end()) {
+            return false;
+        }
+        // Rendered again once it's drawn again
+        cell = oldest->second.cell;
+        m_Entries.erase(oldest);
+        return true;
+    }
+
+    void AssetThumbnails::Clear() noexcept {
+        // Queued renders are skipped, the one running finishes first
+        m_IsStopping = true;
+        m_ThreadPool.Destroy();
+        m_Atlas.Destroy();
+        m_Entries.clear();
+        m_FreeCells.clear();
+        m_Results.clear();
+        m_Waiting.clear();
+    }
+} // namespace adh
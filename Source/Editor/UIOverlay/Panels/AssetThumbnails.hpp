@@ -0,0 +1,112 @@
+#pragma once
+#include <Std/Array.hpp>
+#include <Std/ThreadPool.hpp>
+#include <Vulkan/FrameContext.hpp>
+#include <Vulkan/Sampler.hpp>
+#include <Vulkan/Texture2D.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace adh {
+    // Thumbnails of the textures and meshes the AssetPanel shows, packed into one atlas so the
+    // panel draws all of them under a single texture ID. A worker scales textures down and
+    // rasterizes meshes on the CPU, Upload() copies the finished ones into the atlas before the
+    // passes of the frame. Once the atlas is full the cell drawn least recently is reused.
+    class AssetThumbnails {
+      public:
+        static constexpr std::uint32_t cellSize{ 64u };                                  // Pixels
+        static constexpr std::uint32_t atlasSize{ 1024u };                               // Pixels
+        static constexpr std::uint32_t cellCount{ (atlasSize / cellSize) * (atlasSize / cellSize) };
+        static constexpr std::uint32_t maxUploads{ 16u }; // Per frame
+
+        // Of the atlas, flipped the way the panel draws its icons
+        struct Rect {
+            float u0;
+            float v0;
+            float u1;
+            float v1;
+        };
+
+      public:
+        AssetThumbnails() noexcept;
+
+        AssetThumbnails(const AssetThumbnails& rhs) = delete;
+
+        AssetThumbnails& operator=(const AssetThumbnails& rhs) = delete;
+
+        ~AssetThumbnails();
+
+        void Create(const vk::Sampler& sampler);
+
+        void Destroy() noexcept;
+
+        // Once per drawn file. Returns false while the thumbnail is rendered or if the file is
+        // neither a texture nor a mesh, the panel draws its icon then.
+        bool Find(const std::string& filePath, Rect& rect);
+
+        // The file changed or was removed, it's rendered again the next time it's drawn
+        void Invalidate(const std::string& filePath);
+
+        // Outside of a render pass, the staging memory is freed once the frame is complete
+        void Upload(VkCommandBuffer commandBuffer, vk::FrameContext& frameContext);
+
+        VkImageView GetImageView() noexcept;
+
+        static bool IsTexture(const std::string& filePath) noexcept;
+
+        static bool IsMesh(const std::string& filePath) noexcept;
+
+      private:
+        enum class State : char {
+            eRendering,
+            eReady,
+            eFailed
+        };
+
+        struct Entry {
+            std::uint64_t request; // Results of an older request are dropped
+            std::uint64_t lastUse; // Frame
+            std::uint32_t cell;
+            State state;
+        };
+
+        struct Result {
+            std::string filePath;
+            std::uint64_t request;
+            Array<std::uint8_t> pixels; // RGBA8, cellSize by cellSize
+            bool isRendered;
+        };
+
+      private:
+        // On the worker, false if the file can't be read
+        static bool Render(const std::string& filePath, Array<std::uint8_t>& pixels);
+
+        // Scaled down into the middle of the cell, the aspect ratio is kept
+        static bool RenderTexture(const std::string& filePath, Array<std::uint8_t>& pixels);
+
+        // Lit from the top left, seen from above at an angle and fitted to the cell by its bounds
+        static bool RenderMesh(const std::string& filePath, Array<std::uint8_t>& pixels);
+
+        // A free cell or the one drawn least recently, false if every cell was drawn this frame
+        bool AllocateCell(std::uint32_t& cell);
+
+        void Clear() noexcept;
+
+      private:
+        vk::Texture2D m_Atlas;
+        ThreadPool m_ThreadPool;
+        std::unordered_map<std::string, Entry> m_Entries;
+        std::vector<std::uint32_t> m_FreeCells;
+        std::vector<Result> m_Results; // Guarded by m_Mutex, in the order they were rendered
+        std::vector<Result> m_Waiting; // Rendered, not uploaded yet
+        std::mutex m_Mutex;
+        std::atomic<bool> m_IsStopping;
+        std::uint64_t m_Frame;
+        std::uint64_t m_RequestCount;
+    };
+} // namespace adh
@@ -1,5 +1,6 @@
 #include "InspectorPanel.hpp"
 #include "../IconFontCppHeaders/IconFontAwesome5.hpp"
+#include <Asset/AssetManager.hpp>
 #include <ImGui/imgui.h>
 #include <ImGui/imgui_internal.h>
 #include <Math/Math.hpp>
@@ -311,7 +312,7 @@ namespace adh {
             currentScene);
 
         DrawComponent<vk::Texture2D>(
-            "Texture2D", entity, [](auto& component) {
+            "Texture2D", entity, [this, entity](auto& component) {
                 std::string buffer;
                 buffer.resize(256);
 
@@ -349,8 +350,7 @@ namespace adh {
 
                             auto type{ buffer.substr(pos + 1) };
                             if (type == "tga") {
-                                component.Destroy();
-                                component.Create(buffer.data(), VK_IMAGE_USAGE_SAMPLED_BIT, VK_FILTER_LINEAR, true);
+                                AssetManager::Get()->LoadTexture(currentScene->GetWorld(), entity, buffer);
                                 linearFilter = true;
                                 component.UpdateSampler(linearFilter);
                             }
@@ -512,11 +512,8 @@ namespace adh {
 
             if (ImGui::MenuItem("Texture2D")) {
                 if (!currentScene->GetWorld().Contains<vk::Texture2D>(entity)) {
-                    auto [texture2d]{ currentScene->GetWorld().Add<vk::Texture2D>(entity, vk::Texture2D{}) };
-                    texture2d.Create((vk::Context::Get()->GetDataDirectory() + "Assets/Textures/default_texture.tga").data(),
-                                     VK_IMAGE_USAGE_SAMPLED_BIT,
-                                     VK_FILTER_LINEAR,
-                                     true);
+                    currentScene->GetWorld().Add<vk::Texture2D>(entity, vk::Texture2D{});
+                    AssetManager::Get()->LoadTexture(currentScene->GetWorld(), entity, vk::Context::Get()->GetDataDirectory() + "Assets/Textures/default_texture.tga");
                 }
             }
 
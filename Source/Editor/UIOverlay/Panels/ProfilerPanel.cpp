@@ -0,0 +1,108 @@
+#include "ProfilerPanel.hpp"
+#include <Asset/AssetRegistry.hpp>
+#include <ImGui/imgui.h>
+#include <Vulkan/Context.hpp>
+#include <Vulkan/GpuProfiler.hpp>
+
+#include <algorithm>
+
+namespace adh {
+    void ProfilerPanel::Draw(const vk::GpuProfiler& profiler) {
+        if (isOpen) {
+            if (!ImGui::Begin("Profiler", &isOpen)) {
+                ImGui::End();
+            } else {
+                const auto& assets{ AssetRegistry::Get()->GetStatistics() };
+                ImGui::Text("Assets %u resident, %.1f MB, %llu hits, %llu misses, %llu duplicates, %llu evictions",
+                            assets.assetCount,
+                            static_cast<double>(assets.residentBytes) / (1024.0 * 1024.0),
+                            static_cast<unsigned long long>(assets.hits),
+                            static_cast<unsigned long long>(assets.misses),
+                            static_cast<unsigned long long>(assets.duplicates),
+                            static_cast<unsigned long long>(assets.evictions));
+
+                if (!profiler.IsSupported()) {
+                    ImGui::Text("GPU timestamps aren't supported");
+                    ImGui::End();
+                    return;
+                }
+
+                const auto& frame{ profiler.GetFrame() };
+                ImGui::Text("GPU frame %.3f ms (max %.3f ms), averaged over %u frames", frame.time, frame.maxTime, vk::GpuProfiler::historySize);
+                ImGui::InputFloat("Budget (ms)", &budget, 0.0f, 0.0f, "%.2f");
+                budget = std::max(budget, 0.1f);
+
+                if (ImGui::SmallButton("Dump CSV")) {
+                    auto path{ vk::Context::Get()->GetDataDirectory() + "gpu_profile.csv" };
+                    csvStatus = profiler.WriteCSV(path) ? "Written to " + path : "Failed to write " + path;
+                }
+                if (!csvStatus.empty()) {
+                    ImGui::SameLine();
+                    ImGui::TextUnformatted(csvStatus.data());
+                }
+
+                auto hasStatistics{ profiler.HasStatistics() };
+                if (ImGui::BeginTable("Scopes", hasStatistics ? 6 : 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+                    ImGui::TableSetupColumn("Scope");
+                    ImGui::TableSetupColumn("GPU ms");
+                    ImGui::TableSetupColumn("Budget");
+                    if (hasStatistics) {
+                        ImGui::TableSetupColumn("Vertices");
+                        ImGui::TableSetupColumn("Fragments");
+                        ImGui::TableSetupColumn("Compute");
+                    }
+                    ImGui::TableHeadersRow();
+
+                    for (const auto& result : profiler.GetResults()) {
+                        if (!result.isActive) {
+                            continue;
+                        }
+
+                        // Nested scopes, e.g. the bloom levels, are indented below their pass
+                        ImGui::TableNextColumn();
+                        auto indent{ result.depth * ImGui::GetStyle().IndentSpacing };
+                        if (indent) {
+                            ImGui::Indent(indent);
+                        }
+                        ImGui::TextUnformatted(result.name.data());
+                        if (indent) {
+                            ImGui::Unindent(indent);
+                        }
+
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f (%.3f)", result.time, result.maxTime);
+
+                        // Past the budget on its own is red
+                        ImGui::TableNextColumn();
+                        auto fraction{ result.time / budget };
+                        if (fraction > 1.0f) {
+                            ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.9f, 0.2f, 0.2f, 1.0f));
+                        }
+                        ImGui::ProgressBar(std::min(fraction, 1.0f), ImVec2(-1.0f, 0.0f));
+                        if (fraction > 1.0f) {
+                            ImGui::PopStyleColor();
+                        }
+
+                        if (hasStatistics) {
+                            if (result.hasStatistics) {
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.0f", result.statistics[vk::GpuProfiler::eVertexInvocations]);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.0f", result.statistics[vk::GpuProfiler::eFragmentInvocations]);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.0f", result.statistics[vk::GpuProfiler::eComputeInvocations]);
+                            } else {
+                                ImGui::TableNextColumn();
+                                ImGui::TableNextColumn();
+                                ImGui::TableNextColumn();
+                            }
+                        }
+                    }
+                    ImGui::EndTable();
+                }
+
+                ImGui::End();
+            }
+        }
+    }
+} // namespace adh
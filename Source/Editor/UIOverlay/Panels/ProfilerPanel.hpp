@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+
+namespace adh {
+    namespace vk {
+        class GpuProfiler;
+    }
+
+    class ProfilerPanel {
+      public:
+        void Draw(const vk::GpuProfiler& profiler);
+
+      public:
+        bool isOpen{ true };
+
+      private:
+        std::string csvStatus;
+        float budget{ 1000.0f / 60.0f }; // ms, scopes are drawn as a fraction of it
+    };
+} // namespace adh
@@ -1,4 +1,5 @@
 #include "SceneHierarchyPanel.hpp"
+#include <Asset/AssetManager.hpp>
 #include <ImGui/imgui.h>
 #include <Scene/Components.hpp>
 #include <Vulkan/Context.hpp>
@@ -135,8 +136,8 @@ namespace adh {
             if (world.Contains<vk::Texture2D>(entity)) {
                 auto [texture2d]     = world.Get<vk::Texture2D>(entity);
                 std::string filePath = vk::Context::Get()->GetDataDirectory() + "Assets/Textures/" + texture2d.mFileName;
-                auto [t]             = world.Add<vk::Texture2D>(e, vk::Texture2D{});
-                t.Create(filePath.data(), VK_IMAGE_USAGE_SAMPLED_BIT, VK_FILTER_LINEAR, true);
+                world.Add<vk::Texture2D>(e, vk::Texture2D{});
+                AssetManager::Get()->LoadTexture(world, e, filePath);
             }
         }
     }
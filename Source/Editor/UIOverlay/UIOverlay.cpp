@@ -6,6 +6,7 @@
 #include <ImGuizmo/ImGuizmo.h>
 #include <Input/Keycodes.hpp>
 #include <Scene/Components.hpp>
+#include <Scene/RenderQueue.hpp>
 #include <Scripting/ScriptHandler.hpp>
 #include <Vulkan/Context.hpp>
 
@@ -20,7 +21,10 @@ namespace adh {
 
     UIOverlay::~UIOverlay() {
         Event::DestroyListener(m_EventListener);
-        ImGui::DestroyContext();
+        // Headless runs never create the editor
+        if (ImGui::GetCurrentContext()) {
+            ImGui::DestroyContext();
+        }
     }
 
     void UIOverlay::Create(float width, float height, float aspectRatioWidth, float aspectRatioHeight, const vk::RenderPass& renderPass,
@@ -73,6 +77,9 @@ namespace adh {
             &m_Sampler);
 
         AddTexture("Item Icon", m_ItemTexture, m_Sampler);
+
+        assetPanel.thumbnails.Create(m_Sampler);
+        AddTexture("Asset Thumbnails", assetPanel.thumbnails.GetImageView(), m_Sampler);
     }
 
     void UIOverlay::AddTexture(const std::string& name, VkImageView imageView, const vk::Sampler& sampler) {
@@ -119,10 +126,15 @@ namespace adh {
         return m_ViewportAspectRatioHeight;
     }
 
-    void UIOverlay::Draw(VkCommandBuffer commandBuffer, std::uint32_t imageIndex,
-                         bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, float* floats[], Vector3D& sunPosition) noexcept {
-        NewFrame(maximizeOnPlay, play, pause, fpsLimit, floats, sunPosition);
-        m_ImGui.Draw(commandBuffer, imageIndex);
+    void UIOverlay::Draw(VkCommandBuffer commandBuffer, std::uint32_t frameIndex,
+                         bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, vk::FrameSettings* frameSettings, float* floats[], Vector3D& sunPosition,
+                         bool* gpuCulling, const RenderQueue& renderQueue, const vk::GpuProfiler& profiler) noexcept {
+        NewFrame(maximizeOnPlay, play, pause, fpsLimit, frameSettings, floats, sunPosition, gpuCulling, renderQueue, profiler);
+        m_ImGui.Draw(commandBuffer, frameIndex);
+    }
+
+    void UIOverlay::UploadThumbnails(VkCommandBuffer commandBuffer, vk::FrameContext& frameContext) {
+        assetPanel.thumbnails.Upload(commandBuffer, frameContext);
     }
 
     void UIOverlay::SetUpDisplaySize(float width, float height) const noexcept {
@@ -256,6 +268,10 @@ namespace adh {
                         consolePanel.isOpen = true;
                     }
 
+                    if (ImGui::MenuItem("Profiler")) {
+                        profilerPanel.isOpen = true;
+                    }
+
                     ImGui::EndMenu();
                 }
 
@@ -364,7 +380,8 @@ namespace adh {
         }
     }
 
-    void UIOverlay::NewFrame(bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, float* floats[], Vector3D& sunPosition) noexcept {
+    void UIOverlay::NewFrame(bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, vk::FrameSettings* frameSettings, float* floats[], Vector3D& sunPosition,
+                             bool* gpuCulling, const RenderQueue& renderQueue, const vk::GpuProfiler& profiler) noexcept {
         ImGui::NewFrame();
         ImGuizmo::BeginFrame();
         BeginDockSpace();
@@ -372,8 +389,9 @@ namespace adh {
 
         gamePanel.Draw(m_TextureIDs["Game Viewport"], m_ViewportAspectRatio);
         scenePanel.Draw(m_CurrentScene, m_SelectedEntity, guizmoMode, m_TextureIDs["Scene Viewport"], m_ViewportAspectRatio);
-        assetPanel.Draw(m_CurrentScene, m_TextureIDs["Folder Icon"], m_TextureIDs["Item Icon"]);
+        assetPanel.Draw(m_CurrentScene, m_TextureIDs["Folder Icon"], m_TextureIDs["Item Icon"], m_TextureIDs["Asset Thumbnails"]);
         consolePanel.Draw();
+        profilerPanel.Draw(profiler);
         inspectorPanel.Draw(m_CurrentScene, m_SelectedEntity);
         sceneHierarchyPanel.Draw(m_CurrentScene, m_SelectedEntity);
 
@@ -386,6 +404,30 @@ namespace adh {
 
                 ImGui::Checkbox("Editor fps limit", fpsLimit);
 
+                // Applied by recreating the swapchain, unsupported modes fall back to FIFO
+                const char* presentModeNames[]{ "FIFO", "Mailbox", "Immediate" };
+                constexpr VkPresentModeKHR presentModes[]{ VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+                int presentMode{};
+                for (int i{}; i != std::size(presentModes); ++i) {
+                    if (presentModes[i] == frameSettings->presentMode) {
+                        presentMode = i;
+                    }
+                }
+                if (ImGui::Combo("Present mode", &presentMode, presentModeNames, std::size(presentModeNames))) {
+                    frameSettings->presentMode = presentModes[presentMode];
+                }
+                int framesInFlight{ static_cast<int>(frameSettings->framesInFlight) };
+                if (ImGui::SliderInt("Frames in flight", &framesInFlight, 1, vk::FrameContext::maxFramesInFlight)) {
+                    frameSettings->framesInFlight = static_cast<std::uint32_t>(framesInFlight);
+                }
+
+                ImGui::Checkbox("GPU culling", gpuCulling);
+                const auto& statistics{ renderQueue.GetStatistics() };
+                for (std::uint32_t i{}; i != statistics.GetSize(); ++i) {
+                    ImGui::Text("View %u: %u drawn, %u culled, %u triangles (%u without LODs)", i, statistics[i].drawn, statistics[i].culled,
+                                statistics[i].triangles, statistics[i].fullTriangles);
+                }
+
                 ImGui::SliderFloat("Inteisty", floats[0], 0.0, 20.0);
                 ImGui::SliderFloat("Threshold", floats[1], 0.0, 20.0);
                 ImGui::SliderFloat("Blur Scale", floats[2], 0.0, 5.0);
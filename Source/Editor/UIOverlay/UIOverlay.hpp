@@ -11,12 +11,16 @@
 #include "Panels/ConsolePanel.hpp"
 #include "Panels/GamePanel.hpp"
 #include "Panels/InspectorPanel.hpp"
+#include "Panels/ProfilerPanel.hpp"
 #include "Panels/SceneHierarchyPanel.hpp"
 #include "Panels/ScenePanel.hpp"
 
 #include "../Api/Vulkan/VulkanImGui.hpp"
+#include <Vulkan/FrameContext.hpp>
 
 namespace adh {
+    class RenderQueue;
+
     class UIOverlay {
       public:
         using TextureIdMap = std::unordered_map<std::string, void*>;
@@ -51,8 +55,12 @@ namespace adh {
 
         void OnUpdate(Scene* scene, float delta, bool drawEditor);
 
-        void Draw(VkCommandBuffer commandBuffer, std::uint32_t imageIndex,
-                  bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, float* floats[], Vector3D& sunPosition) noexcept;
+        void Draw(VkCommandBuffer commandBuffer, std::uint32_t frameIndex,
+                  bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, vk::FrameSettings* frameSettings, float* floats[], Vector3D& sunPosition,
+                  bool* gpuCulling, const RenderQueue& renderQueue, const vk::GpuProfiler& profiler) noexcept;
+
+        // Outside of a render pass
+        void UploadThumbnails(VkCommandBuffer commandBuffer, vk::FrameContext& frameContext);
 
         void SetUpDisplaySize(float width, float height) const noexcept;
 
@@ -71,7 +79,8 @@ namespace adh {
 
         void MenuBar(bool* drawEditor, bool* play, bool* pause);
 
-        void NewFrame(bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, float* floats[], Vector3D& sunPosition) noexcept;
+        void NewFrame(bool* maximizeOnPlay, bool* play, bool* pause, bool* fpsLimit, vk::FrameSettings* frameSettings, float* floats[], Vector3D& sunPosition,
+                      bool* gpuCulling, const RenderQueue& renderQueue, const vk::GpuProfiler& profiler) noexcept;
 
         void SetUpConfigFlags() const noexcept;
 
@@ -117,6 +126,7 @@ namespace adh {
         InspectorPanel inspectorPanel;
         SceneHierarchyPanel sceneHierarchyPanel;
         ConsolePanel consolePanel;
+        ProfilerPanel profilerPanel;
 
         float m_ScreenAspectWidth;
         float m_ScreenAspectHeight;
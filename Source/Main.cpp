@@ -1,3 +1,8 @@
+#include <Asset/AssetManager.hpp>
+#include <Asset/AssetRegistry.hpp>
+#include <Asset/FileWatcher.hpp>
+#include <Asset/PakBuilder.hpp>
+#include <Asset/TextureCache.hpp>
 #include <Audio/Audio.hpp>
 #include <Editor/Editor.hpp>
 #include <Entity/Entity.hpp>
@@ -5,25 +10,39 @@
 #include <Input/Input.hpp>
 #include <Math/Math.hpp>
 #include <Scene/Components.hpp>
+#include <Scene/LightClusters.hpp>
+#include <Scene/RenderQueue.hpp>
 #include <Scene/Scene.hpp>
+#include <Scene/VertexPacker.hpp>
+#include <Std/Hash.hpp>
+#include <Std/Random.hpp>
 #include <Std/StaticArray.hpp>
 #include <Std/Stopwatch.hpp>
+#include <Std/ThreadPool.hpp>
+#include <Std/UniquePtr.hpp>
+#include <Std/VirtualFileSystem.hpp>
 #include <Utility.hpp>
 #include <Vulkan/Attachments.hpp>
 #include <Vulkan/CommandBuffer.hpp>
 #include <Vulkan/CommandPool.hpp>
+#include <Vulkan/ComputePipeline.hpp>
 #include <Vulkan/Context.hpp>
 #include <Vulkan/DescriptorSet.hpp>
+#include <Vulkan/FrameContext.hpp>
 #include <Vulkan/Framebuffer.hpp>
+#include <Vulkan/GeometryBuffer.hpp>
+#include <Vulkan/GpuProfiler.hpp>
 #include <Vulkan/GraphicsPipeline.hpp>
 #include <Vulkan/ImageView.hpp>
 #include <Vulkan/IndexBuffer.hpp>
 #include <Vulkan/Memory.hpp>
 #include <Vulkan/PipelineLayout.hpp>
+#include <Vulkan/RenderGraph.hpp>
 #include <Vulkan/RenderPass.hpp>
 #include <Vulkan/Sampler.hpp>
 #include <Vulkan/Scissor.hpp>
 #include <Vulkan/Shader.hpp>
+#include <Vulkan/StagingBuffer.hpp>
 #include <Vulkan/Subpass.hpp>
 #include <Vulkan/Swapchain.hpp>
 #include <Vulkan/Texture2D.hpp>
@@ -34,6 +53,13 @@
 #include <Vulkan/Viewport.hpp>
 #include <Window.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <fstream>
 
 #if defined(ADH_IOS)
@@ -54,7 +80,10 @@ struct PBR_UBO {
 } viewProjection;
 PBR_UBO editorViewProjection;
 
-xmm::Matrix lightSpace{ 1.0f };
+constexpr std::uint32_t shadowCascadeCount{ 4u };
+
+// Cascade matrices with the bias applied, pbr.vert picks the cascade per fragment
+xmm::Matrix lightSpace[shadowCascadeCount];
 
 const xmm::Matrix lightSpaceBias{
     0.5f, 0.0f, 0.0f, 0.0f,
@@ -113,11 +142,121 @@ struct AspectRatio {
     }
 };
 
-struct ShadowMap2D {
-    struct Debug {
-        void Create(RenderPass& renderPass, VkDescriptorImageInfo& info) {
+// Compiles pipelines on worker threads during startup. The jobs are kept after Wait(), Reload()
+// compiles the pipelines of a changed shader again, so pipeline layouts and render passes must
+// outlive the compiler as well.
+struct PipelineCompiler {
+    using CompileFunc = std::function<void(const Shader&, const VertexLayout&)>;
+
+    struct Job {
+        UniquePtr<Shader> shader;
+        VertexLayout vertexLayout;
+        CompileFunc compile;
+        std::exception_ptr error;
+    };
+
+    void Create() {
+        threadPool.Create(ThreadPool::GetDefaultThreadCount());
+        stopwatch.Reset();
+    }
+
+    void Compile(UniquePtr<Shader>&& shader, VertexLayout&& vertexLayout, CompileFunc compile) {
+        // Jobs are heap allocated, the worker only sees its own job while the array grows
+        auto job{ jobs.EmplaceBack(MakeUnique<Job>()).Get() };
+        job->shader       = Move(shader);
+        job->vertexLayout = Move(vertexLayout);
+        job->compile      = Move(compile);
+        threadPool.Submit([job](std::uint32_t) {
+            try {
+                job->compile(*job->shader, job->vertexLayout);
+            } catch (...) {
+                job->error = std::current_exception();
+            }
+        });
+    }
+
+    // Blocks until every pipeline is compiled, reports the time against the state of the pipeline cache
+    void Wait() {
+        threadPool.Wait();
+        for (auto& job : jobs) {
+            if (job->error) {
+                std::rethrow_exception(job->error);
+            }
+        }
+        ADH_LOG("Pipelines: " << jobs.GetSize() << " compiled in " << stopwatch.GetTime() * 1000.0f << " ms ("
+                              << (Context::Get()->GetPipelineCache().IsWarm() ? "warm" : "cold") << " pipeline cache)");
+        threadPool.Destroy();
+    }
+
+    // On the main thread while the device is idle, shaderFile is a stage like "pbr.frag". Returns
+    // the number of pipelines compiled again, a shader that fails keeps its old pipeline.
+    std::uint32_t Reload(const std::string& shaderFile) {
+        std::uint32_t count{};
+        for (auto& job : jobs) {
+            const auto& files{ job->shader->GetFiles() };
+            if (std::find(files.begin(), files.end(), shaderFile) == files.end()) {
+                continue;
+            }
+            try {
+                job->shader->Reload();
+                job->compile(*job->shader, job->vertexLayout);
+                ++count;
+            } catch (const std::exception& e) {
+                std::string s{ "[" + shaderFile + "] " + e.what() };
+                Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eError, s.data());
+            }
+        }
+        return count;
+    }
+
+    Array<UniquePtr<Job>> jobs;
+    Stopwatch<> stopwatch;
+    ThreadPool threadPool;
+};
+
+// Binds copy i of a uniform buffer created with one copy per frame to copy i of the descriptor set
+inline void UpdateFrameDescriptors(DescriptorSet& descSet, const UniformBuffer& buffer, std::uint32_t setIndex, std::uint32_t binding) {
+    Array<VkDescriptorBufferInfo> infos;
+    infos.Resize(descSet.m_SwapChainImageViews);
+    for (std::uint32_t i{}; i != descSet.m_SwapChainImageViews; ++i) {
+        infos[i] = buffer.GetDescriptor(i);
+    }
+    descSet.Update(
+        infos.GetData(),
+        setIndex,                         // descriptor index
+        binding,                          // binding
+        0u,                               // array element
+        1u,                               // array count
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
+    );
+}
+
+// Directional light shadows split along the camera frustum, one layer of the shadow map per cascade.
+// Near cascades are redrawn every frame with every caster. Far cascades only draw static casters and
+// are snapped to a coarse grid, they are redrawn when a static caster, the light or the grid cell changes.
+struct CascadedShadowMap {
+    static constexpr std::uint32_t cascadeCount{ shadowCascadeCount };
+    static constexpr std::uint32_t firstCachedCascade{ 2u };
+    // Far cascades move in steps of this many texels and cover one step more than their split
+    static constexpr float cachedSnapTexels{ 256.0f };
+    // Casters this far in front of a cascade toward the light still shadow it
+    static constexpr float casterDistance{ 100.0f };
+    static constexpr float maxShadowDistance{ 100.0f };
+    // Blend between uniform (0) and logarithmic (1) split distances
+    static constexpr float splitLambda{ 0.75f };
+
+    static_assert(sizeof(xmm::Matrix) * cascadeCount == 256u, "Cascade buffer copies must stay 256 byte aligned!");
+
+    // Last state a cached cascade was drawn with
+    struct Cache {
+        xmm::Matrix lightSpace;
+        std::uint64_t staticRevision;
+        bool isValid;
+    };
 
-            Shader shader("draw_shadowmap.vert", "draw_shadowmap.frag");
+    struct Debug {
+        void Create(PipelineCompiler& compiler, RenderPass& renderPass, VkDescriptorImageInfo& info) {
+            auto shader{ MakeUnique<Shader>("draw_shadowmap.vert", "draw_shadowmap.frag") };
 
             VertexLayout vertexLayout;
             vertexLayout.Create();
@@ -127,9 +266,11 @@ struct ShadowMap2D {
 
             pipelineLayout.Create();
 
-            graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, renderPass,
-                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                    VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+            compiler.Compile(Move(shader), Move(vertexLayout), [this, &renderPass](const Shader& shader, const VertexLayout& vertexLayout) {
+                graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, renderPass,
+                                        VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                                        VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+            });
 
             descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3);
             descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
@@ -150,341 +291,177 @@ struct ShadowMap2D {
         GraphicsPipeline graphicsPipeline;
     };
 
-    void Create(RenderPass& renderPass, Sampler& sampler) {
-        Attachment attachment;
-        attachment.AddDescription(
-            tools::GetSupportedDepthFormat(Context::Get()->GetPhysicalDevice()),
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            Attachment::Type::eDepth);
-
-        Subpass subpass;
-        subpass.AddDescription(VK_PIPELINE_BIND_POINT_GRAPHICS, attachment);
-        subpass.AddDependencies(
-            VK_SUBPASS_EXTERNAL,
-            0u,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-            VK_ACCESS_SHADER_READ_BIT,
-            VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT)
-        );
-
-        subpass.AddDependencies(
-            0u,
-            VK_SUBPASS_EXTERNAL,
-            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT),
-            VK_ACCESS_SHADER_READ_BIT);
-
-        VkRect2D renderArea{
-            { 0u, 0u },
-            m_Extent
-        };
-
-        Array<VkClearValue> clearValues;
-        clearValues.Resize(1);
-        clearValues[0].depthStencil = {
-            1.0f, // float    depth
-            0u    // uint32_t stencil
-        };
-
-        m_RenderPass.Create(attachment, subpass, renderArea, Move(clearValues));
-        m_RenderPass.UpdateRenderArea({ {}, m_Extent });
-
-        Shader shader("shadowmap.vert", "shadowmap.frag");
+    void Create(PipelineCompiler& compiler, RenderPass& renderPass, const RenderGraph& renderGraph, Sampler& sampler) {
+        auto shader{ MakeUnique<Shader>("shadowmap.vert", "shadowmap.frag") };
 
         VertexLayout vertexLayout;
-        vertexLayout.AddBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX);
-        vertexLayout.AddAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, position));
-        vertexLayout.AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, normals));
-        vertexLayout.AddAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, ADH_OFFSET(Vertex, textureCoords));
+        VertexPacker::AddAttributes(vertexLayout, VertexPacker::GetFormat());
         vertexLayout.Create();
 
         pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+        pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+        pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
         pipelineLayout.CreateSet();
 
-        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, sizeof(xmm::Matrix), 0);
+        // Cascade index
+        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, sizeof(std::uint32_t), 0);
+
         pipelineLayout.Create();
 
-        graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, m_RenderPass,
-                                VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        compiler.Compile(Move(shader), Move(vertexLayout), [this, &shadowPass = renderGraph.GetRenderPass(pass)](const Shader& shader, const VertexLayout& vertexLayout) {
+            graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, shadowPass,
+                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                                    VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        });
 
-        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3);
+        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, FrameContext::maxFramesInFlight);
         descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1);
+        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2);
         descriptorSet.Create(pipelineLayout.GetSetLayout());
 
-        lightSpaceBuffer.Create(&lightSpace, sizeof(lightSpace), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-        descriptorSet.Update(
-            lightSpaceBuffer.GetDescriptor(),
-            0u,                               // descriptor index
-            0u,                               // binding
-            0u,                               // array element
-            1u,                               // array count
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-        );
+        // Near cascades follow the camera every frame, frames in flight keep their own copy
+        lightSpaceBuffer.Create(lightSpace, sizeof(lightSpace), descriptorSet.m_SwapChainImageViews, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        UpdateFrameDescriptors(descriptorSet, lightSpaceBuffer, 0u, 0u);
 
-        lightSpaceBuffer.Update();
+        // The shadow map has a fixed extent, resizing the graph keeps the image and the descriptor
+        descriptor = renderGraph.GetDescriptor(image, sampler);
 
-        m_Image.Create(
-            { m_Extent.width, m_Extent.height, 1u },
-            tools::GetSupportedDepthFormat(Context::Get()->GetPhysicalDevice()),
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_TYPE_2D,
-            (VkImageCreateFlagBits)0,
-            1,
-            1,
-            VK_SAMPLE_COUNT_1_BIT,
-            VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT),
-            VK_IMAGE_ASPECT_DEPTH_BIT,
-            VK_IMAGE_VIEW_TYPE_2D,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_SHARING_MODE_EXCLUSIVE);
-
-        VkImageView viewAttachments[]{
-            m_Image.GetImageView()
-        };
-
-        descriptor.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-        descriptor.sampler     = sampler;
-        descriptor.imageView   = m_Image.GetImageView();
-
-        m_Framebuffer.Create(m_RenderPass, std::size(viewAttachments), viewAttachments, m_Extent, 1u);
-
-        debug.Create(renderPass, descriptor);
+        debug.Create(compiler, renderPass, descriptor);
     }
 
-    void Recreate(VkExtent2D extent) {
-        m_Extent = extent;
-        auto device{ Context::Get()->GetDevice() };
-        vkDeviceWaitIdle(device);
-
-        m_Framebuffer.Destroy();
-
-        m_Image.Destroy();
-
-        m_Image.Create(
-            { m_Extent.width, m_Extent.height, 1u },
-            tools::GetSupportedDepthFormat(Context::Get()->GetPhysicalDevice()),
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_TYPE_2D,
-            (VkImageCreateFlagBits)0,
-            1,
-            1,
-            VK_SAMPLE_COUNT_1_BIT,
-            VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT),
-            VK_IMAGE_ASPECT_DEPTH_BIT,
-            VK_IMAGE_VIEW_TYPE_2D,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_SHARING_MODE_EXCLUSIVE);
-
-        m_RenderPass.UpdateRenderArea({ {}, m_Extent });
-
-        VkImageView viewAttachments[]{
-            m_Image.GetImageView()
-        };
+    // Fits every cascade to its split of the camera frustum and marks the cascades that must be drawn
+    void Update(const Camera3D& camera, const Vector3D& lightPosition, std::uint64_t staticRevision) noexcept {
+        const Vector3D forward{ Normalize(camera.focusPosition - camera.eyePosition) };
+        const Vector3D right{ Normalize(Cross(camera.upVector, forward)) };
+        const Vector3D up{ Cross(forward, right) };
+        const float tanY{ std::tan(ToRadians(camera.fieldOfView) * 0.5f) };
+        const float tanX{ tanY * camera.aspectRatio };
+
+        // Same basis as xmm::LookAtLH() from the origin, light space x is -lightRight
+        const Vector3D lightForward{ Normalize(Vector3D{ -lightPosition.x, -lightPosition.y, -lightPosition.z }) };
+        const Vector3D lightUpVector{ std::abs(lightForward.y) > 0.99f ? Vector3D{ 0.0f, 0.0f, 1.0f } : Vector3D{ 0.0f, 1.0f, 0.0f } };
+        const Vector3D lightRight{ Normalize(Cross(lightForward, lightUpVector)) };
+        const Vector3D lightUp{ Cross(lightRight, lightForward) };
+        const xmm::Matrix lightView{ xmm::LookAtLH({ 0.0f, 0.0f, 0.0f }, lightForward, lightUpVector) };
+
+        const float nearZ{ camera.nearZ };
+        const float farZ{ std::min(camera.farZ, maxShadowDistance) };
+        float splitNear{ nearZ };
+        for (std::uint32_t cascade{}; cascade != cascadeCount; ++cascade) {
+            const float ratio{ static_cast<float>(cascade + 1u) / cascadeCount };
+            const float splitFar{ splitLambda * nearZ * std::pow(farZ / nearZ, ratio) + (1.0f - splitLambda) * (nearZ + (farZ - nearZ) * ratio) };
+
+            // Bounding sphere of the split, its radius only depends on the projection so it doesn't
+            // change while the camera moves or turns
+            Vector3D corners[8];
+            Vector3D center{ 0.0f, 0.0f, 0.0f };
+            for (std::uint32_t i{}; i != 8u; ++i) {
+                const float depth{ i & 4u ? splitFar : splitNear };
+                const float x{ i & 1u ? tanX * depth : -tanX * depth };
+                const float y{ i & 2u ? tanY * depth : -tanY * depth };
+                corners[i] = camera.eyePosition + forward * depth + right * x + up * y;
+                center += corners[i];
+            }
+            center /= 8.0f;
+            float radius{};
+            for (const auto& corner : corners) {
+                radius = std::max(radius, Magnitude(corner - center));
+            }
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            // Snapping to whole texels keeps the near cascades from shimmering, far cascades snap
+            // to a coarse grid and only move after the camera crossed a cell
+            const auto isCached{ cascade >= firstCachedCascade };
+            float step{ 2.0f * radius / m_Extent.width };
+            if (isCached) {
+                step *= cachedSnapTexels;
+                radius += step;
+            }
+            const float x{ std::floor(-Dot(lightRight, center) / step) * step };
+            const float y{ std::floor(Dot(lightUp, center) / step) * step };
+            const float z{ std::floor(Dot(lightForward, center) / step) * step };
+
+            auto matrix{ xmm::OrthographicLH(x - radius, x + radius, y - radius, y + radius, z - radius - casterDistance, z + radius) * lightView };
+
+            auto& cache{ caches[cascade] };
+            isDrawn[cascade] = !isCached || !cache.isValid || cache.staticRevision != staticRevision ||
+                               std::memcmp(&cache.lightSpace, &matrix, sizeof(xmm::Matrix));
+            if (isCached) {
+                cache.lightSpace     = matrix;
+                cache.staticRevision = staticRevision;
+                cache.isValid        = true;
+            }
 
-        m_Framebuffer.Create(m_RenderPass, std::size(viewAttachments), viewAttachments, m_Extent, 1u);
+            lightSpace[cascade] = matrix;
+            splitNear           = splitFar;
+        }
     }
 
-    RenderPass m_RenderPass;
+    // Declared in AdHoc::InitializeRenderGraph()
+    RenderGraph::Handle image;
+    RenderGraph::Handle pass;
     VkExtent2D m_Extent;
-    vk::Image m_Image;
-    Framebuffer m_Framebuffer;
 
-    xmm::Matrix lightSpace{ 1.0f };
+    xmm::Matrix lightSpace[cascadeCount];
     UniformBuffer lightSpaceBuffer;
+    Cache caches[cascadeCount]{};
+    bool isDrawn[cascadeCount]{};
 
     PipelineLayout pipelineLayout;
     DescriptorSet descriptorSet;
     GraphicsPipeline graphicsPipeline;
 
-    Viewport viewport;
-    Scissor scissor;
-
     VkDescriptorImageInfo descriptor;
 
     Debug debug;
 };
 
 struct HDRBuffer {
-    void Create(const adh::Window& window, Swapchain& swapchain, const Sampler& sampler) {
-        Attachment attachment;
-        attachment.AddDescription(
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            Attachment::Type::eColor);
-
-        attachment.AddDescription(
-            tools::GetSupportedDepthFormat(Context::Get()->GetPhysicalDevice()),
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            Attachment::Type::eDepth);
-
-        Subpass subpass;
-        subpass.AddDescription(VK_PIPELINE_BIND_POINT_GRAPHICS, attachment);
-        subpass.AddDependencies(
-            VK_SUBPASS_EXTERNAL,
-            0u,
-            VkPipelineStageFlagBits(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT),
-            VkPipelineStageFlagBits(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT),
-            VK_ACCESS_NONE_KHR,
-            VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT));
-
-        subpass.AddDependencies(
-            0u,
-            VK_SUBPASS_EXTERNAL,
-            VkPipelineStageFlagBits(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT),
-            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-            VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT),
-            VK_ACCESS_NONE_KHR);
-
-        VkRect2D renderArea{
-            { 0u, 0u },
-            { (uint32_t)window.GetWindowWidth(), (uint32_t)window.GetWindowHeight() }
-        };
-
-        Array<VkClearValue> clearValues;
-        clearValues.Resize(2);
-        clearValues[0].color        = { 0.0f, 0.0f, 0.0f, 1.0f };
-        clearValues[1].depthStencil = {
-            1.0f, // float    depth
-            0u    // uint32_t stencil
-        };
-
-        m_RenderPass.Create(attachment, subpass, renderArea, Move(clearValues));
-        m_RenderPass.UpdateRenderArea({ {}, swapchain.GetExtent() });
-
-        Shader shader("pbr.vert", "pbr.frag");
+    void Create(PipelineCompiler& compiler, const RenderGraph& renderGraph) {
+        auto shader{ MakeUnique<Shader>("pbr.vert", "pbr.frag") };
 
         VertexLayout vertexLayout;
-        vertexLayout.AddBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX);
-        vertexLayout.AddAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, position));
-        vertexLayout.AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, normals));
-        vertexLayout.AddAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, ADH_OFFSET(Vertex, textureCoords));
+        VertexPacker::AddAttributes(vertexLayout, VertexPacker::GetFormat());
         vertexLayout.Create();
 
         pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
         pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+        pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
         pipelineLayout.CreateSet();
 
         pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
         pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
         pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
         pipelineLayout.CreateSet();
 
-        pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-        pipelineLayout.CreateSet();
-
-        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, sizeof(xmm::Matrix), 0);
-        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(Material), 64);
+        pipelineLayout.AddSetLayout(TextureDescriptors::GetSetLayout());
 
         pipelineLayout.Create();
 
-        graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, m_RenderPass,
-                                VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
-
-        m_Image.Create(
-            { swapchain.GetExtent().width, swapchain.GetExtent().height, 1u },
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_TYPE_2D,
-            VkImageCreateFlagBits(0),
-            1,
-            1u,
-            VK_SAMPLE_COUNT_1_BIT,
-            VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT),
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_IMAGE_VIEW_TYPE_2D,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_SHARING_MODE_EXCLUSIVE);
-
-        vk::TransferImageLayout(
-            m_Image,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_IMAGE_ASPECT_COLOR_BIT);
-
-        VkImageView viewAttachments[]{
-            m_Image.GetImageView(),
-            swapchain.GetDepthBuffer().GetImageView()
-        };
-
-        m_Framebuffer.Create(m_RenderPass, std::size(viewAttachments), viewAttachments, swapchain.GetExtent(), 1u);
-
-        descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        descriptor.sampler     = sampler;
-        descriptor.imageView   = m_Image.GetImageView();
-    }
-
-    void Recreate(Swapchain& swapchain) {
-        m_Image.Destroy();
-
-        m_Framebuffer.Destroy();
-
-        m_Image.Create(
-            { swapchain.GetExtent().width, swapchain.GetExtent().height, 1u },
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_TYPE_2D,
-            VkImageCreateFlagBits(0),
-            1,
-            1u,
-            VK_SAMPLE_COUNT_1_BIT,
-            VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT),
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_IMAGE_VIEW_TYPE_2D,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_SHARING_MODE_EXCLUSIVE);
-
-        vk::TransferImageLayout(
-            m_Image,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_IMAGE_ASPECT_COLOR_BIT);
-
-        VkImageView viewAttachments[]{
-            m_Image.GetImageView(),
-            swapchain.GetDepthBuffer().GetImageView()
-        };
-
-        m_Framebuffer.Create(m_RenderPass, std::size(viewAttachments), viewAttachments, swapchain.GetExtent(), 1u);
-
-        descriptor.imageView = m_Image.GetImageView();
-        m_RenderPass.UpdateRenderArea({ {}, swapchain.GetExtent() });
+        compiler.Compile(Move(shader), Move(vertexLayout), [this, &scenePass = renderGraph.GetRenderPass(pass)](const Shader& shader, const VertexLayout& vertexLayout) {
+            graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, scenePass,
+                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                                    VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        });
     }
 
-    vk::Image m_Image;
-    Framebuffer m_Framebuffer;
-    RenderPass m_RenderPass;
+    // Declared in AdHoc::InitializeRenderGraph()
+    RenderGraph::Handle color;
+    RenderGraph::Handle depth;
+    RenderGraph::Handle pass;
 
     PipelineLayout pipelineLayout;
     GraphicsPipeline graphicsPipeline;
-
-    VkDescriptorImageInfo descriptor;
 };
 
 struct HDRDraw {
-    void Create(RenderPass& renderPass, VkDescriptorImageInfo& info, VkDescriptorImageInfo& info2) {
-        Shader shader("hdr.vert", "hdr.frag");
+    void Create(PipelineCompiler& compiler, RenderPass& renderPass, VkDescriptorImageInfo& info, VkDescriptorImageInfo& info2) {
+        auto shader{ MakeUnique<Shader>("hdr.vert", "hdr.frag") };
 
         VertexLayout vertexLayout;
         vertexLayout.Create();
@@ -497,11 +474,13 @@ struct HDRDraw {
 
         pipelineLayout.Create();
 
-        graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, renderPass,
-                                VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        compiler.Compile(Move(shader), Move(vertexLayout), [this, &renderPass](const Shader& shader, const VertexLayout& vertexLayout) {
+            graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, renderPass,
+                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                                    VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        });
 
-        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3);
+        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, FrameContext::maxFramesInFlight);
         descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2);
         descriptorSet.Create(pipelineLayout.GetSetLayout());
 
@@ -546,588 +525,434 @@ struct HDRDraw {
     PipelineLayout pipelineLayout;
     GraphicsPipeline graphicsPipeline;
 
+    RenderGraph::Handle pass;
+
     float intensity[2]{
         1.0f,
         1.0f
     };
 };
 
-struct GaussianBlur {
-    void Create(const adh::Window& window, Swapchain& swapchain, const Sampler& sampler, VkDescriptorImageInfo imageInfo) {
-        auto e = swapchain.GetExtent();
-        e.width /= 2;
-        e.height /= 2;
+struct Bloom {
+    struct Downsample {
+        float threshold;
+        std::int32_t isPrefilter;
+    };
 
-        brightColor.extent = e;
+    struct Upsample {
+        float radius;
+        float weight;
+    };
 
-        e.width /= 2;
-        e.height /= 2;
-        extents.EmplaceBack(e);
-        while (e.width > 20 && e.height > 20) {
-            e.width /= 2;
-            e.height /= 2;
-            extents.EmplaceBack(e);
+    // Declares the bloom as one compute pass over a half resolution mip chain and returns the image,
+    // mip 0 holds the result. The level count is fixed by the initial extent.
+    RenderGraph::Handle AddPass(RenderGraph& renderGraph, GpuProfiler& profiler, RenderGraph::Handle hdrColor, VkExtent2D extent) {
+        // Halves down to 16 pixels, every level costs one downsample and one upsample dispatch
+        std::uint32_t mipLevels{ 1u };
+        for (auto width{ extent.width / 2u }, height{ extent.height / 2u }; width > 16u && height > 16u && mipLevels != maxMipLevels; width /= 2u, height /= 2u) {
+            ++mipLevels;
         }
+        mipLevels = std::max(mipLevels, 2u);
 
-        uboUniformBuffer.Create(&ubo, sizeof(ubo), swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-
-        Attachment attachment;
-        attachment.AddDescription(
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_SAMPLE_COUNT_1_BIT,
-            VK_ATTACHMENT_LOAD_OP_CLEAR,
-            VK_ATTACHMENT_STORE_OP_STORE,
-            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            Attachment::Type::eColor);
-
-        Subpass subpass;
-        subpass.AddDescription(VK_PIPELINE_BIND_POINT_GRAPHICS, attachment);
-        subpass.AddDependencies(
-            VK_SUBPASS_EXTERNAL,
-            0u,
-            VkPipelineStageFlagBits(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT),
-            VkPipelineStageFlagBits(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT),
-            VK_ACCESS_NONE_KHR,
-            VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT));
-
-        subpass.AddDependencies(
-            0u,
-            VK_SUBPASS_EXTERNAL,
-            VkPipelineStageFlagBits(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT),
-            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-            VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT),
-            VK_ACCESS_NONE_KHR);
-
-        VkRect2D renderArea{
-            { 0u, 0u },
-            { (uint32_t)window.GetWindowWidth(), (uint32_t)window.GetWindowHeight() }
-        };
-
-        Array<VkClearValue> clearValues;
-        clearValues.Resize(1);
-        clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
-
-        mRenderPass.Create(attachment, subpass, renderArea, Move(clearValues));
-
-        // Bright color pass
-        {
-            Shader shader("brightColor.vert", "brightColor.frag");
-            VertexLayout vertexLayout;
-            vertexLayout.Create();
-
-            brightColor.pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-            brightColor.pipelineLayout.CreateSet();
-
-            brightColor.pipelineLayout.AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(float), 0);
-
-            brightColor.pipelineLayout.Create();
-
-            brightColor.graphicsPipeline.Create(shader, vertexLayout, brightColor.pipelineLayout, mRenderPass,
-                                                VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                                VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
-
-            brightColor.mImages.Create(
-                { brightColor.extent.width, brightColor.extent.height, 1u },
-                VK_FORMAT_R32G32B32A32_SFLOAT,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_TYPE_2D,
-                VkImageCreateFlagBits(0),
-                1,
-                1u,
-                VK_SAMPLE_COUNT_1_BIT,
-                VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT),
-                VK_IMAGE_ASPECT_COLOR_BIT,
-                VK_IMAGE_VIEW_TYPE_2D,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                VK_SHARING_MODE_EXCLUSIVE);
-
-            vk::TransferImageLayout(
-                brightColor.mImages,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_IMAGE_ASPECT_COLOR_BIT);
-
-            VkImageView viewAttachments[]{
-                brightColor.mImages.GetImageView()
-            };
-
-            brightColor.mFramebuffers.Create(mRenderPass, std::size(viewAttachments), viewAttachments, brightColor.extent, 1u);
-
-            brightColor.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            brightColor.imageInfo.sampler     = sampler;
-            brightColor.imageInfo.imageView   = brightColor.mImages.GetImageView();
-
-            brightColor.descriptorSets.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, brightColor.pipelineLayout, swapchain.GetImageViewCount());
-            brightColor.descriptorSets.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
-            brightColor.descriptorSets.Create(brightColor.pipelineLayout.GetSetLayout());
-
-            brightColor.descriptorSets.Update(
-                imageInfo,
-                0u,                                       // descriptor index
-                1u,                                       // binding
-                0u,                                       // array element
-                1u,                                       // array count
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-            );
+        // Every dispatch is a profiler scope nested in the pass
+        for (std::uint32_t mip{}; mip != maxMipLevels; ++mip) {
+            downsampleNames[mip] = "Downsample " + std::to_string(mip);
+            upsampleNames[mip]   = "Upsample " + std::to_string(mip);
         }
 
-        // Blur passes
-        {
-            int blurPasses = extents.GetSize() * 2;
+        image = renderGraph.CreateImage("Bloom", { VK_FORMAT_R16G16B16A16_SFLOAT, {}, 0.5f, true, mipLevels });
+        pass  = renderGraph.AddComputePass("Bloom", [this, &renderGraph, &profiler](VkCommandBuffer cmd, std::uint32_t frameIndex) {
+            Dispatch(cmd, frameIndex, renderGraph, profiler);
+        });
+        renderGraph.Read(pass, hdrColor);
+        renderGraph.Write(pass, image);
 
-            Shader shader("gaussianBlur.vert", "gaussianBlur.frag");
+        return image;
+    }
 
-            VertexLayout vertexLayout;
-            vertexLayout.Create();
+    void Create(PipelineCompiler& compiler, const RenderGraph& renderGraph, std::uint32_t imageCount, const Sampler& sampler, RenderGraph::Handle hdrColor) {
+        auto downsampleShader{ MakeUnique<Shader>("bloomDownsample.comp") };
+        auto upsampleShader{ MakeUnique<Shader>("bloomUpsample.comp") };
 
-            pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-            pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-            pipelineLayout.CreateSet();
+        // Both shaders sample binding 0 and write binding 1, the push constants are two 32 bit values
+        pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineLayout.CreateSet();
 
-            pipelineLayout.AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(int) * 3, 0);
+        static_assert(sizeof(Downsample) == sizeof(Upsample));
+        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(Downsample), 0);
 
-            pipelineLayout.Create();
+        pipelineLayout.Create();
 
-            graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, mRenderPass,
-                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                    VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        compiler.Compile(Move(downsampleShader), {}, [this](const Shader& shader, const VertexLayout&) {
+            downsamplePipeline.Create(pipelineLayout, shader.Get(), localSize, 1u, localSize, 1u, 1u, 1u);
+        });
+        compiler.Compile(Move(upsampleShader), {}, [this](const Shader& shader, const VertexLayout&) {
+            upsamplePipeline.Create(pipelineLayout, shader.Get(), localSize, 1u, localSize, 1u, 1u, 1u);
+        });
 
-            mImages.Resize(blurPasses);
-            mFramebuffers.Resize(blurPasses);
-            descriptorImageInfos.Resize(blurPasses);
-
-            int count = 0;
-            for (int i{}; i != mImages.GetSize(); ++i) {
-                mImages[i].Create(
-                    { extents[count].width, extents[count].height, 1u },
-                    VK_FORMAT_R32G32B32A32_SFLOAT,
-                    VK_IMAGE_TILING_OPTIMAL,
-                    VK_IMAGE_TYPE_2D,
-                    VkImageCreateFlagBits(0),
-                    1,
-                    1u,
-                    VK_SAMPLE_COUNT_1_BIT,
-                    VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT),
-                    VK_IMAGE_ASPECT_COLOR_BIT,
-                    VK_IMAGE_VIEW_TYPE_2D,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    VK_SHARING_MODE_EXCLUSIVE);
-
-                vk::TransferImageLayout(
-                    mImages[i],
-                    VK_IMAGE_LAYOUT_UNDEFINED,
-                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                    VK_IMAGE_ASPECT_COLOR_BIT);
-
-                VkImageView viewAttachments[]{
-                    mImages[i].GetImageView()
-                };
-
-                mFramebuffers[i].Create(mRenderPass, std::size(viewAttachments), viewAttachments, extents[count], 1u);
-
-                descriptorImageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                descriptorImageInfos[i].sampler     = sampler;
-                descriptorImageInfos[i].imageView   = mImages[i].GetImageView();
-
-                if (i % 2) {
-                    count++;
-                }
+        // One set per dispatch, the levels are bound through their own views
+        auto createSets = [&](Array<DescriptorSet>& sets, std::uint32_t count) {
+            sets.Resize(count);
+            for (auto& set : sets) {
+                set.Initialize(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, imageCount);
+                set.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
+                set.AddPool(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1);
+                set.Create(pipelineLayout.GetSetLayout());
             }
+        };
+        auto mipLevels{ renderGraph.GetMipLevels(image) };
+        createSets(downsampleSets, mipLevels);
+        createSets(upsampleSets, mipLevels - 1u);
 
-            descriptorSets.Resize(blurPasses);
-            for (int i{}; i != blurPasses; ++i) {
-                descriptorSets[i].Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, swapchain.GetImageViewCount());
-                descriptorSets[i].AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1);
-                descriptorSets[i].AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
-                descriptorSets[i].Create(pipelineLayout.GetSetLayout());
-            }
+        UpdateDescriptors(renderGraph, sampler, hdrColor);
+    }
 
-            descriptorSets[0].Update(
-                uboUniformBuffer.GetDescriptor(),
-                0u,                               // descriptor index
-                0u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
-            descriptorSets[0].Update(
-                brightColor.imageInfo,
+    // Graph images are recreated on resize, the views of every level have to be written again
+    void UpdateDescriptors(const RenderGraph& renderGraph, const Sampler& sampler, RenderGraph::Handle hdrColor) {
+        auto update = [&](DescriptorSet& set, VkDescriptorImageInfo source, std::uint32_t mip) {
+            VkDescriptorImageInfo destination{ VK_NULL_HANDLE, renderGraph.GetMipView(image, mip), VK_IMAGE_LAYOUT_GENERAL };
+            set.Update(
+                source,
                 0u,                                       // descriptor index
-                1u,                                       // binding
+                0u,                                       // binding
                 0u,                                       // array element
                 1u,                                       // array count
                 VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
             );
+            set.Update(
+                destination,
+                0u,                              // descriptor index
+                1u,                              // binding
+                0u,                              // array element
+                1u,                              // array count
+                VK_DESCRIPTOR_TYPE_STORAGE_IMAGE // type
+            );
+        };
 
-            for (int i{ 1 }; i != descriptorSets.GetSize(); ++i) {
-                descriptorSets[i].Update(
-                    uboUniformBuffer.GetDescriptor(),
-                    0u,                               // descriptor index
-                    0u,                               // binding
-                    0u,                               // array element
-                    1u,                               // array count
-                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-                );
-                descriptorSets[i].Update(
-                    descriptorImageInfos[i - 1],
-                    0u,                                       // descriptor index
-                    1u,                                       // binding
-                    0u,                                       // array element
-                    1u,                                       // array count
-                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-                );
-            }
+        // The pass keeps the whole chain in the general layout while it runs
+        auto mipSource = [&](std::uint32_t mip) {
+            return VkDescriptorImageInfo{ sampler, renderGraph.GetMipView(image, mip), VK_IMAGE_LAYOUT_GENERAL };
+        };
+
+        auto mipLevels{ GetMipLevels(renderGraph) };
+        for (std::uint32_t mip{}; mip != mipLevels; ++mip) {
+            update(downsampleSets[mip], mip ? mipSource(mip - 1u) : renderGraph.GetDescriptor(hdrColor, sampler), mip);
         }
-        // Recompose
-        {
-            int recomposePasses = extents.GetSize();
+        for (std::uint32_t mip{}; mip != mipLevels - 1u; ++mip) {
+            update(upsampleSets[mip], mipSource(mip + 1u), mip);
+        }
+    }
 
-            Shader shader("bloomRecompose.vert", "bloomRecompose.frag");
+    // Downsamples the bright parts of the HDR color through the chain, then walks back up and adds
+    // every blurred level onto the one above it
+    void Dispatch(VkCommandBuffer cmd, std::uint32_t frameIndex, const RenderGraph& renderGraph, GpuProfiler& profiler) {
+        auto mipLevels{ GetMipLevels(renderGraph) };
+        auto extent{ renderGraph.GetExtent(image) };
 
-            VertexLayout vertexLayout;
-            vertexLayout.Create();
+        auto dispatch = [&](ComputePipeline& pipeline, DescriptorSet& set, std::uint32_t mip, const void* pushConstants) {
+            set.Bind(cmd, frameIndex);
+            vkCmdPushConstants(
+                cmd,
+                pipelineLayout,
+                VK_SHADER_STAGE_COMPUTE_BIT,
+                0u,
+                sizeof(Downsample), pushConstants);
 
-            recompose.pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-            recompose.pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-            recompose.pipelineLayout.CreateSet();
-
-            recompose.pipelineLayout.AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(int) * 2, 0);
-
-            recompose.pipelineLayout.Create();
-
-            recompose.graphicsPipeline.Create(shader, vertexLayout, recompose.pipelineLayout, mRenderPass,
-                                              VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                              VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
-
-            int s = recomposePasses - 1;
-            recompose.flickerImages.Resize(s);
-            recompose.flickerFramebuffers.Resize(s);
-            recompose.flickerImageInfo.Resize(s);
-
-            for (int i{}; i != s; ++i) {
-                recompose.flickerImages[i].Create(
-                    { extents[extents.GetSize() - 2 - i].width, extents[extents.GetSize() - 2 - i].height, 1u },
-                    VK_FORMAT_R32G32B32A32_SFLOAT,
-                    VK_IMAGE_TILING_OPTIMAL,
-                    VK_IMAGE_TYPE_2D,
-                    VkImageCreateFlagBits(0),
-                    1,
-                    1u,
-                    VK_SAMPLE_COUNT_1_BIT,
-                    VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT),
-                    VK_IMAGE_ASPECT_COLOR_BIT,
-                    VK_IMAGE_VIEW_TYPE_2D,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    VK_SHARING_MODE_EXCLUSIVE);
-
-                vk::TransferImageLayout(
-                    recompose.flickerImages[i],
-                    VK_IMAGE_LAYOUT_UNDEFINED,
-                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                    VK_IMAGE_ASPECT_COLOR_BIT);
-
-                VkImageView viewAttachments[]{
-                    recompose.flickerImages[i].GetImageView()
-                };
-
-                recompose.flickerFramebuffers[i].Create(mRenderPass, std::size(viewAttachments), viewAttachments, extents[extents.GetSize() - 2 - i], 1u);
-
-                recompose.flickerImageInfo[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                recompose.flickerImageInfo[i].sampler     = sampler;
-                recompose.flickerImageInfo[i].imageView   = recompose.flickerImages[i].GetImageView();
-            }
+            auto width{ std::max(extent.width >> mip, 1u) };
+            auto height{ std::max(extent.height >> mip, 1u) };
+            pipeline.Dispatch(cmd, (width + localSize - 1u) / localSize, (height + localSize - 1u) / localSize);
+        };
 
-            recompose.mImages.Create(
-                { brightColor.extent.width, brightColor.extent.height, 1u },
-                VK_FORMAT_R32G32B32A32_SFLOAT,
-                VK_IMAGE_TILING_OPTIMAL,
-                VK_IMAGE_TYPE_2D,
-                VkImageCreateFlagBits(0),
-                1,
-                1u,
-                VK_SAMPLE_COUNT_1_BIT,
-                VkImageUsageFlagBits(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT),
+        // The next dispatch samples the level this one wrote
+        auto barrier = [&](std::uint32_t mip) {
+            ImageBarrier(
+                cmd,
+                VK_ACCESS_SHADER_WRITE_BIT,
+                VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_IMAGE_LAYOUT_GENERAL,
+                VK_IMAGE_LAYOUT_GENERAL,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                renderGraph.GetImage(image),
                 VK_IMAGE_ASPECT_COLOR_BIT,
-                VK_IMAGE_VIEW_TYPE_2D,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                VK_SHARING_MODE_EXCLUSIVE);
-
-            vk::TransferImageLayout(
-                recompose.mImages,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_IMAGE_ASPECT_COLOR_BIT);
-
-            VkImageView viewAttachments[]{
-                recompose.mImages.GetImageView()
-            };
-
-            recompose.mFramebuffers.Create(mRenderPass, std::size(viewAttachments), viewAttachments, brightColor.extent, 1u);
-
-            recompose.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            recompose.imageInfo.sampler     = sampler;
-            recompose.imageInfo.imageView   = recompose.mImages.GetImageView();
-
-            recompose.descriptorSets.Resize(recomposePasses);
-            for (int i{}; i != recomposePasses; ++i) {
-                recompose.descriptorSets[i].Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, recompose.pipelineLayout, swapchain.GetImageViewCount());
-                recompose.descriptorSets[i].AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2);
-                recompose.descriptorSets[i].Create(recompose.pipelineLayout.GetSetLayout());
-            }
+                mip);
+        };
 
-            recompose.descriptorSets[0].Update(
-                descriptorImageInfos[descriptorImageInfos.GetSize() - 3],
-                0u,                                       // descriptor index
-                1u,                                       // binding
-                0u,                                       // array element
-                1u,                                       // array count
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-            );
-            recompose.descriptorSets[0].Update(
-                descriptorImageInfos[descriptorImageInfos.GetSize() - 1],
-                0u,                                       // descriptor index
-                2u,                                       // binding
-                0u,                                       // array element
-                1u,                                       // array count
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-            );
+        downsamplePipeline.Bind(cmd);
+        for (std::uint32_t mip{}; mip != mipLevels; ++mip) {
+            Downsample downsample{ threshold, !mip };
+            profiler.BeginScope(cmd, downsampleNames[mip].c_str());
+            dispatch(downsamplePipeline, downsampleSets[mip], mip, &downsample);
+            profiler.EndScope(cmd);
+            barrier(mip);
+        }
 
-            int count = descriptorImageInfos.GetSize() - 2;
-            for (int i{ 1 }; i != recompose.descriptorSets.GetSize() - 1; ++i) {
-                recompose.descriptorSets[i].Update(
-                    descriptorImageInfos[count - 1 - (2 * i)],
-                    0u,                                       // descriptor index
-                    1u,                                       // binding
-                    0u,                                       // array element
-                    1u,                                       // array count
-                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-                );
-                recompose.descriptorSets[i].Update(
-                    recompose.flickerImageInfo[i - 1],
-                    0u,                                       // descriptor index
-                    2u,                                       // binding
-                    0u,                                       // array element
-                    1u,                                       // array count
-                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-                );
+        upsamplePipeline.Bind(cmd);
+        Upsample upsample{ radius, weight };
+        for (auto mip{ mipLevels - 1u }; mip-- != 0u;) {
+            profiler.BeginScope(cmd, upsampleNames[mip].c_str());
+            dispatch(upsamplePipeline, upsampleSets[mip], mip, &upsample);
+            profiler.EndScope(cmd);
+            if (mip) {
+                barrier(mip);
             }
-
-            recompose.descriptorSets[recompose.descriptorSets.GetSize() - 1].Update(
-                brightColor.imageInfo,
-                0u,                                       // descriptor index
-                1u,                                       // binding
-                0u,                                       // array element
-                1u,                                       // array count
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-            );
-            recompose.descriptorSets[recompose.descriptorSets.GetSize() - 1].Update(
-                recompose.flickerImageInfo[s - 1],
-                0u,                                       // descriptor index
-                2u,                                       // binding
-                0u,                                       // array element
-                1u,                                       // array count
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-            );
         }
-
-        finalPassdescriptor = recompose.imageInfo;
     }
 
-    void Recreate(Swapchain& swapchain, VkDescriptorImageInfo info) {
-        brightColor.descriptorSets.Update(
-            info,
-            0u,                                       // descriptor index
-            1u,                                       // binding
-            0u,                                       // array element
-            1u,                                       // array count
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-        );
+    // Levels that exist at the current extent, never more than the sets created for the initial one
+    std::uint32_t GetMipLevels(const RenderGraph& renderGraph) const {
+        return std::min(renderGraph.GetMipLevels(image), static_cast<std::uint32_t>(downsampleSets.GetSize()));
     }
 
-    void Draw(VkCommandBuffer cmd, std::uint32_t imageIndex, Viewport& viewport, Scissor& scissor) {
-        // Bright color
-        {
-            viewport.Update(brightColor.extent, false);
-            viewport.Set(cmd);
-
-            scissor.Update(brightColor.extent);
-            scissor.Set(cmd);
+    static constexpr std::uint32_t localSize{ 8u };
+    static constexpr std::uint32_t maxMipLevels{ 8u };
 
-            mRenderPass.UpdateRenderArea({ {}, brightColor.extent });
-            mRenderPass.Begin(cmd, brightColor.mFramebuffers);
-            brightColor.graphicsPipeline.Bind(cmd);
-            brightColor.descriptorSets.Bind(cmd, imageIndex);
+    RenderGraph::Handle image;
+    RenderGraph::Handle pass;
 
-            vkCmdPushConstants(
-                cmd,
-                brightColor.pipelineLayout,
-                VK_SHADER_STAGE_FRAGMENT_BIT,
-                0u,
-                sizeof(float), &brightColor.threshold);
-
-            vkCmdDraw(cmd, 3, 1, 0, 0);
-            mRenderPass.End(cmd);
-        }
-
-        // Blur
-        {
-            uboUniformBuffer.Update(imageIndex);
-            int count      = 0;
-            horizontalBlur = 1;
-            for (int i{}; i != mFramebuffers.GetSize(); ++i) {
-                viewport.Update(extents[count], false);
-                viewport.Set(cmd);
-                scissor.Update(extents[count]);
-                scissor.Set(cmd);
-
-                mRenderPass.UpdateRenderArea({ {}, extents[count] });
-                mRenderPass.Begin(cmd, mFramebuffers[i]);
-                graphicsPipeline.Bind(cmd);
-                descriptorSets[i].Bind(cmd, imageIndex);
-
-                horizontalBlur = horizontalBlur == 1 ? 0 : 1;
-                if (!horizontalBlur) {
-                    if (!i) {
-                        int p[3]{ horizontalBlur, (int)brightColor.extent.width, (int)brightColor.extent.height };
-                        vkCmdPushConstants(
-                            cmd,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_FRAGMENT_BIT,
-                            0u,
-                            sizeof(int) * 3, p);
-                    } else {
-                        int p[3]{ horizontalBlur, (int)extents[count - 1].width, (int)extents[count - 1].height };
-                        vkCmdPushConstants(
-                            cmd,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_FRAGMENT_BIT,
-                            0u,
-                            sizeof(int) * 3, p);
-                    }
-                } else {
-                    int p[3]{ horizontalBlur, (int)extents[count].width, (int)extents[count].height };
-                    vkCmdPushConstants(
-                        cmd,
-                        pipelineLayout,
-                        VK_SHADER_STAGE_FRAGMENT_BIT,
-                        0u,
-                        sizeof(int) * 3, p);
-                }
+    PipelineLayout pipelineLayout;
+    ComputePipeline downsamplePipeline;
+    ComputePipeline upsamplePipeline;
+    Array<DescriptorSet> downsampleSets;
+    Array<DescriptorSet> upsampleSets;
+    std::string downsampleNames[maxMipLevels];
+    std::string upsampleNames[maxMipLevels];
+
+    float threshold{ 1.0f };
+    float radius{ 1.0f }; // Tent filter offset in texels of the smaller level
+    float weight{ 1.0f }; // Scales every upsampled level before it is added
+};
 
-                vkCmdDraw(cmd, 3, 1, 0, 0);
-                mRenderPass.End(cmd);
+struct FrustumCulling {
+    struct PushConstants {
+        xmm::Vector planes[xmm::Frustum::eCount];
+        xmm::Vector lodOrigin;
+        std::uint32_t instanceCount;
+        std::uint32_t viewOffset;
+    };
 
-                if (i % 2) {
-                    count++;
-                }
-            }
+    void Create(PipelineCompiler& compiler, std::uint32_t imageCount) {
+        // Indirect commands start at view * maxInstances + batch offset, without this feature firstInstance must be 0
+        auto features{ tools::GetPhysicalDeviceFeatures(Context::Get()->GetPhysicalDevice()) };
+        isSupported = features.drawIndirectFirstInstance;
+        // Batches of shared meshes whose commands are drawn by one indirect draw, zero draws them one by one
+        if (features.multiDrawIndirect) {
+            auto maxDrawCount{ tools::GetPhysicalDeviceProperties(Context::Get()->GetPhysicalDevice()).limits.maxDrawIndirectCount };
+            maxMergedBatches = maxDrawCount / MeshBufferData::maxLodCount;
         }
 
-        // Recompose
-        {
-            int size        = descriptorImageInfos.GetSize() - 4;
-            int extentIndex = extents.GetSize() - 2;
-            for (int i{}; i != recompose.descriptorSets.GetSize() - 1; ++i) {
-                viewport.Update(extents[extentIndex], false);
-                viewport.Set(cmd);
-                scissor.Update(extents[extentIndex]);
-                scissor.Set(cmd);
+        auto shader{ MakeUnique<Shader>("cull.comp") };
 
-                mRenderPass.UpdateRenderArea({ {}, extents[extentIndex] });
-                extentIndex--;
+        pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineLayout.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        pipelineLayout.CreateSet();
 
-                mRenderPass.Begin(cmd, recompose.flickerFramebuffers[i]);
-                size -= 2;
+        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(PushConstants), 0);
 
-                recompose.graphicsPipeline.Bind(cmd);
+        pipelineLayout.Create();
 
-                recompose.descriptorSets[i].Bind(cmd, imageIndex);
+        compiler.Compile(Move(shader), {}, [this](const Shader& shader, const VertexLayout&) {
+            computePipeline.Create(pipelineLayout, shader.Get(), localSize, 1u, 1u, 1u, 1u, 1u);
+        });
 
-                int p[2]{ (int)extents[extentIndex + 1].width, (int)extents[extentIndex + 1].height };
+        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, imageCount);
+        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4);
+        descriptorSet.Create(pipelineLayout.GetSetLayout());
+    }
 
-                vkCmdPushConstants(
-                    cmd,
-                    recompose.pipelineLayout,
-                    VK_SHADER_STAGE_FRAGMENT_BIT,
-                    0u,
-                    sizeof(int) * 2, p);
+    void Update(const RenderQueue& renderQueue) {
+        Array<VkDescriptorBufferInfo> infos;
+        infos.Resize(descriptorSet.m_SwapChainImageViews);
 
-                vkCmdDraw(cmd, 3, 1, 0, 0);
-                mRenderPass.End(cmd);
+        auto update = [&](std::uint32_t binding, auto&& getDescriptor) {
+            for (std::uint32_t i{}; i != descriptorSet.m_SwapChainImageViews; ++i) {
+                infos[i] = getDescriptor(i);
             }
+            descriptorSet.Update(
+                infos.GetData(),
+                0u,                               // descriptor index
+                binding,                          // binding
+                0u,                               // array element
+                1u,                               // array count
+                VK_DESCRIPTOR_TYPE_STORAGE_BUFFER // type
+            );
+        };
 
-            viewport.Update(brightColor.extent, false);
-            viewport.Set(cmd);
-            scissor.Update(brightColor.extent);
-            scissor.Set(cmd);
+        update(0u, [&](std::uint32_t i) { return renderQueue.GetDescriptor(i); });
+        update(1u, [&](std::uint32_t i) { return renderQueue.GetCullDescriptor(i); });
+        update(2u, [&](std::uint32_t i) { return renderQueue.GetCommandDescriptor(i); });
+        update(3u, [&](std::uint32_t i) { return renderQueue.GetVisibleDescriptor(i); });
+    }
 
-            mRenderPass.UpdateRenderArea({ {}, brightColor.extent });
+    // One dispatch per view, every invocation tests one instance and appends it to its batch LOD
+    void Dispatch(VkCommandBuffer cmd, std::uint32_t frameIndex, const RenderQueue& renderQueue) {
+        if (!IsActive() || !renderQueue.GetInstanceCount()) {
+            return;
+        }
 
-            mRenderPass.Begin(cmd, recompose.mFramebuffers);
+        computePipeline.Bind(cmd);
+        descriptorSet.Bind(cmd, frameIndex);
 
-            recompose.graphicsPipeline.Bind(cmd);
+        PushConstants pushConstants{};
+        pushConstants.instanceCount = renderQueue.GetInstanceCount();
+        for (std::uint32_t view{}; view != renderQueue.GetViewCount(); ++view) {
+            const auto& queueView{ renderQueue.GetView(view) };
+            for (std::size_t i{}; i != xmm::Frustum::eCount; ++i) {
+                pushConstants.planes[i] = queueView.frustum[i];
+            }
+            pushConstants.lodOrigin  = queueView.lodOrigin;
+            pushConstants.viewOffset = renderQueue.GetViewOffset(view);
 
-            recompose.descriptorSets[recompose.descriptorSets.GetSize() - 1].Bind(cmd, imageIndex);
+            vkCmdPushConstants(
+                cmd,
+                pipelineLayout,
+                VK_SHADER_STAGE_COMPUTE_BIT,
+                0u,
+                sizeof(PushConstants), &pushConstants);
 
-            vkCmdDraw(cmd, 3, 1, 0, 0);
-            mRenderPass.End(cmd);
+            computePipeline.Dispatch(cmd, (pushConstants.instanceCount + localSize - 1u) / localSize);
         }
-    }
 
-    Array<Image> mImages;
-    Array<Framebuffer> mFramebuffers;
+        auto commands{ renderQueue.GetCommandDescriptor(frameIndex) };
+        BufferBarrier(
+            cmd,
+            VK_ACCESS_SHADER_WRITE_BIT,
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            commands.buffer,
+            commands.offset,
+            commands.range);
+
+        auto visible{ renderQueue.GetVisibleDescriptor(frameIndex) };
+        BufferBarrier(
+            cmd,
+            VK_ACCESS_SHADER_WRITE_BIT,
+            VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            visible.buffer,
+            visible.offset,
+            visible.range);
+    }
 
-    Array<DescriptorSet> descriptorSets;
-    Array<VkDescriptorImageInfo> descriptorImageInfos;
+    // Otherwise the render queue culls on the CPU
+    bool IsActive() const noexcept {
+        return isSupported && isEnabled;
+    }
 
-    VkDescriptorImageInfo finalPassdescriptor;
+    static constexpr std::uint32_t localSize{ 64u };
 
     PipelineLayout pipelineLayout;
-    GraphicsPipeline graphicsPipeline;
-
-    RenderPass mRenderPass;
+    DescriptorSet descriptorSet;
+    ComputePipeline computePipeline;
+    std::uint32_t maxMergedBatches{};
+    bool isSupported{};
+    bool isEnabled{ true };
+};
 
-    struct UBO {
-        float blurScale{ 0.25f };
-        float blurStrength{ 0.25f };
+// Records render pass contents into secondary command buffers on worker threads.
+// Command pools must only be used by the thread that created them, so every worker owns one.
+struct ParallelRecorder {
+    struct Worker {
+        UniquePtr<CommandPool> commandPool;
+        CommandBuffer commandBuffers;
+        std::uint32_t nextBuffer{};
     };
 
-    int horizontalBlur = 1;
-    UBO ubo;
-    UniformBuffer uboUniformBuffer;
-
-    Array<VkExtent2D> extents;
+    void Create(std::uint32_t frameCount) {
+        auto threadCount{ ThreadPool::GetDefaultThreadCount() };
+        // Worst case every task of a frame runs on the same worker
+        buffersPerFrame = maxPassesPerFrame * threadCount;
+        workers.Resize(threadCount);
+
+        threadPool.Create(
+            threadCount,
+            [this, frameCount](std::uint32_t threadIndex) {
+                auto& worker{ workers[threadIndex] };
+                worker.commandPool = MakeUnique<CommandPool>();
+                worker.commandBuffers.Create(VK_COMMAND_BUFFER_LEVEL_SECONDARY, frameCount * buffersPerFrame, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, DeviceQueues::Family::eGraphics);
+            },
+            [this](std::uint32_t threadIndex) {
+                auto& worker{ workers[threadIndex] };
+                worker.commandBuffers.Destroy();
+                worker.commandPool.Delete();
+            });
+    }
 
-    struct BrightColor {
-        VkExtent2D extent;
-        Image mImages;
-        Framebuffer mFramebuffers;
+    // Secondaries of a frame are reused once its fence has been waited on
+    void BeginFrame(std::uint32_t frame) noexcept {
+        frameIndex = frame;
+        for (auto& worker : workers) {
+            worker.nextBuffer = 0u;
+        }
+    }
 
-        DescriptorSet descriptorSets;
-        VkDescriptorImageInfo imageInfo;
+    // Splits [0, itemCount) into at most one range per worker and records every range into its own secondary.
+    // The secondaries are written to commandBuffers in range order, valid after Wait().
+    template <typename Func>
+    void Record(Array<VkCommandBuffer>& commandBuffers, const VkCommandBufferInheritanceInfo& inheritanceInfo, std::uint32_t itemCount, Func record) {
+        std::uint32_t taskCount{ std::min(threadPool.GetThreadCount(), (itemCount + minItemsPerTask - 1u) / minItemsPerTask) };
+        commandBuffers.Resize(taskCount);
+
+        for (std::uint32_t task{}; task != taskCount; ++task) {
+            std::uint32_t first{ itemCount * task / taskCount };
+            std::uint32_t last{ itemCount * (task + 1u) / taskCount };
+            threadPool.Submit([this, &commandBuffers, inheritanceInfo, record, task, first, last](std::uint32_t threadIndex) {
+                auto& worker{ workers[threadIndex] };
+                ADH_THROW(worker.nextBuffer != buffersPerFrame, "Ran out of secondary command buffers!");
+
+                auto index{ frameIndex * buffersPerFrame + worker.nextBuffer++ };
+                auto cmd{ worker.commandBuffers.Begin(index, inheritanceInfo) };
+                record(cmd, first, last);
+                worker.commandBuffers.End(index);
+
+                commandBuffers[task] = cmd;
+            });
+        }
+    }
 
-        PipelineLayout pipelineLayout;
-        GraphicsPipeline graphicsPipeline;
+    void Wait() {
+        threadPool.Wait();
+    }
 
-        float threshold = 1.0f;
-    } brightColor;
+    // Every shadow cascade + HDR or both editor viewports
+    static constexpr std::uint32_t maxPassesPerFrame{ CascadedShadowMap::cascadeCount + 2u };
+    // Below this a range is not worth a secondary of its own, small scenes record one per pass
+    static constexpr std::uint32_t minItemsPerTask{ 64u };
 
-    struct Recompose {
-        PipelineLayout pipelineLayout;
-        Array<DescriptorSet> descriptorSets;
-        GraphicsPipeline graphicsPipeline;
+    Array<Worker> workers;
+    std::uint32_t buffersPerFrame{};
+    std::uint32_t frameIndex{};
+    // Declared last so the workers are joined before their command pools go away
+    ThreadPool threadPool;
+};
 
-        Image mImages;
-        Framebuffer mFramebuffers;
-        VkDescriptorImageInfo imageInfo;
+// Executes the secondaries of a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+inline void ExecuteCommands(VkCommandBuffer cmd, const Array<VkCommandBuffer>& commandBuffers) {
+    if (!commandBuffers.IsEmpty()) {
+        vkCmdExecuteCommands(cmd, static_cast<std::uint32_t>(commandBuffers.GetSize()), commandBuffers.GetData());
+    }
+}
 
-        Array<Image> flickerImages;
-        Array<Framebuffer> flickerFramebuffers;
-        Array<VkDescriptorImageInfo> flickerImageInfo;
-    } recompose;
+// Read from the environment at startup, see AdHoc::GetHeadlessSettings()
+struct HeadlessSettings {
+    bool isEnabled{ false };
+    std::string scene;
+    std::uint32_t frames{ 600u };
+    float deltaTime{ 1.0f / 60.0f };
+    VkExtent2D extent{ 1280u, 720u };
+    bool hash{ false };
+    std::string csvPath;
 };
 
 struct CollisionPair {
@@ -1141,7 +966,6 @@ class AdHoc {
     adh::Window window;
     Context context;
     Swapchain swapchain;
-    std::uint32_t swapchanImageCount{ 2 };
 
     Sampler sampler;
     Scene scene;
@@ -1156,11 +980,12 @@ class AdHoc {
     VkQueue graphicsQueue;
     GraphicsPipeline graphicsPipeline;
     CommandPool commandPool;
-    CommandBuffer commandBuffer;
-    Array<VkFence> fence1;
-    Array<VkFence> fence2;
-    Array<VkSemaphore> presentSempahore;
-    Array<VkSemaphore> renderSemaphore;
+    FrameContext frameContext;
+    GpuProfiler gpuProfiler;
+    // Picked in the editor, applied before the next frame begins
+    FrameSettings frameSettings;
+    FrameSettings appliedFrameSettings;
+    HeadlessSettings headless;
     Input input;
     UniformBuffer viewProjectionBuffer;
     UniformBuffer editorViewProjectionBuffer;
@@ -1168,8 +993,8 @@ class AdHoc {
     UniformBuffer fragDataBuffer;
     UniformBuffer lightBuffer;
 
-    std::uint32_t currentFrame{};
-    std::uint32_t imageIndex{};
+    std::uint32_t currentFrame{}; // Frame slot, indexes every per-frame copy
+    std::uint32_t imageIndex{};   // Swapchain image, only indexes swapchainFramebuffers
     bool renderingReady = false;
     Material material;
     DirectionalLight directionalLight;
@@ -1194,10 +1019,16 @@ class AdHoc {
     bool clearFramebuffers     = true;
     int clearFramebuffersCount = 0;
 
-    ShadowMap2D shadowMap;
+    CascadedShadowMap shadowMap;
     HDRBuffer hdrBuffer;
     HDRDraw hdrDraw;
-    GaussianBlur gaussianBlur;
+    Bloom bloom;
+
+    RenderGraph renderGraph;
+    RenderGraph::Handle backbuffer;
+    RenderGraph::Handle editorViewports[2];
+    RenderGraph::Handle viewportPasses[2];
+    RenderGraph::Handle editorPass;
 
     float* floats[7];
 
@@ -1205,20 +1036,54 @@ class AdHoc {
     float floatShadowPCF = 2;
 
     AudioDevice audioDevice;
+    StagingBuffer stagingBuffer;
+    GeometryBuffer geometryBuffer;
+    AssetRegistry assetRegistry;
+    AssetManager assets;
+    FileWatcher fileWatcher;
+    PipelineCompiler pipelineCompiler;
+
+
+    RenderQueue renderQueue;
+    FrustumCulling frustumCulling;
+    LightClusters lightClusters;
+
+    ParallelRecorder parallelRecorder;
+    Array<VkCommandBuffer> shadowCommands[CascadedShadowMap::cascadeCount];
+    Array<VkCommandBuffer> sceneCommands[2];
+
+    // Render queue views, culled by cull.comp
+    enum View : std::uint32_t {
+        eShadowView, // One per cascade
+        eSceneView = eShadowView + CascadedShadowMap::cascadeCount,
+        eRuntimeView,
+        eViewCount
+    };
 
-    Texture2D testTexture;
+    // Light cluster views, editorDescriptorSet draws with the scene camera, the other sets with the runtime camera
+    enum LightView : std::uint32_t {
+        eSceneLights,
+        eRuntimeLights,
+        eLightViewCount
+    };
+
+    // ADH_LIGHT_BENCHMARK spawns CreateLightBenchmark() and logs the cluster build time
+    bool isLightBenchmark{ false };
+    std::uint32_t lightBenchmarkFrame{};
 
   public:
     ~AdHoc() {
         auto device{ Context::Get()->GetDevice() };
         vkDeviceWaitIdle(device);
-        for (int i{}; i != swapchain.GetImageViewCount(); ++i) {
-            vkDestroySemaphore(device, presentSempahore[i], nullptr);
-            vkDestroySemaphore(device, renderSemaphore[i], nullptr);
-            vkDestroyFence(device, fence1[i], nullptr);
-        }
+        frameContext.Destroy();
+        gpuProfiler.Destroy();
+        fileWatcher.Destroy();
+        assets.Destroy();
         Mesh::Clear(); // TODO: temp
-        testTexture.Destroy();
+        assetRegistry.Destroy();
+        VirtualFileSystem::Unmount();
+        geometryBuffer.Destroy();
+        stagingBuffer.Destroy();
         Texture2D::CleanUpDefaultSamplers();
         TextureDescriptors::CleanUp();
     }
@@ -1331,67 +1196,98 @@ class AdHoc {
         event->isHandled = true;
     }
 
-    void UpdateTexture(const Texture2D& t) {
-        // TODO: Texture!!
-        descriptorSet.Update(
-            t.GetDescriptor(),
-            2u,                                       // descriptor index
-            0u,                                       // binding
-            0u,                                       // array element
-            1u,                                       // array count
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-        );
-        // TODO: Texture!!
-        editorDescriptorSet.Update(
-            t.GetDescriptor(),
-            2u,                                       // descriptor index
-            0u,                                       // binding
-            0u,                                       // array element
-            1u,                                       // array count
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-        );
-        // TODO: Texture!!
-        editorDescriptorSet2.Update(
-            t.GetDescriptor(),
-            2u,                                       // descriptor index
-            0u,                                       // binding
-            0u,                                       // array element
-            1u,                                       // array count
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER // type
-        );
+    // Changed assets are reloaded in place, removed ones stay resident until they're unused
+    void OnFileEvent(FileEvent* event) {
+        event->isHandled = true;
+        if (event->type == FileEvent::Type::eRemoved) {
+            return;
+        }
+        std::string filePath{ event->filePath };
+        auto fileName{ filePath.substr(filePath.find_last_of('/') + 1u) };
+        auto dot{ fileName.find_last_of('.') };
+        auto extension{ dot == std::string::npos ? std::string{} : fileName.substr(dot) };
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == ".spv") {
+            // The old pipelines may still be drawing
+            frameContext.WaitIdle();
+            auto count{ pipelineCompiler.Reload(fileName.substr(0u, fileName.size() - extension.size())) };
+            std::string s{ "[" + fileName + "] Reloaded " + std::to_string(count) + " pipelines" };
+            Event::Dispatch<EditorLogEvent>(EditorLogEvent::Type::eLog, s.data());
+        } else if (extension == ".obj" || extension == ".fbx" || extension == ".gltf" || extension == ".glb" || extension == ".dae") {
+            Mesh::Reload(filePath);
+        } else if (extension == ".tga" || extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp") {
+            assets.ReloadTexture(scene.GetWorld(), filePath);
+        } else if (extension == ".lua" && g_IsPlaying && g_AreScriptsReady) {
+            // Scripts that aren't running load the file when the scene plays
+            scene.GetWorld().GetSystem<lua::Script>().ForEach([&](ecs::Entity ent, lua::Script& script) {
+                if (script.filePath == filePath && script.Reload()) {
+                    ScriptHandler::currentEntity = static_cast<std::uint64_t>(ent);
+                    script.Run();
+                }
+            });
+        }
     }
 
     void Initialize(const char* path) {
-        window.Create(name, 1200, 800, true, false);
-        context.Create(window, "AdHoc", path);
-        swapchain.Create(swapchanImageCount, VK_FORMAT_B8G8R8A8_UNORM, VK_PRESENT_MODE_FIFO_KHR);
+        Stopwatch<> startup;
+        headless      = GetHeadlessSettings();
+        frameSettings = GetFrameSettings();
+        if (headless.isEnabled) {
+            context.Create("AdHoc", path);
+        } else {
+            window.Create(name, 1200, 800, true, false);
+            context.Create(window, "AdHoc", path);
+        }
+        // Before anything is loaded, shaders included
+        MountPak();
+
+        auto& compiler{ pipelineCompiler };
+        compiler.Create();
+        if (headless.isEnabled) {
+            swapchain.CreateOffscreen(GetSwapchainImageCount(), VK_FORMAT_B8G8R8A8_UNORM, headless.extent);
+        } else {
+            swapchain.Create(GetSwapchainImageCount(), VK_FORMAT_B8G8R8A8_UNORM, frameSettings.presentMode);
+        }
         InitializeRenderPass();
 
         sampler.Create(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_MIPMAP_MODE_LINEAR, VK_COMPARE_OP_NEVER, VK_FALSE, VK_TRUE);
 
         TextureDescriptors::Initialize(2, 0);
         Texture2D::InitializeDefaultSamplers();
-
-        shadowMap.lightSpace = xmm::PerspectiveLH(ToRadians(140.0f), 1.0f, 1.0f, 1000.0f) * xmm::LookAtLH(sunPosition, { 0, 0, 0 }, { 0, 1, 0 });
-        shadowMap.m_Extent   = { 2048 * 2, 2048 * 2 };
+        stagingBuffer.Create();
+        geometryBuffer.Create(VertexPacker::GetStride(VertexPacker::GetFormat()));
+        assetRegistry.Create(FrameContext::maxFramesInFlight);
+        // Half the cores decode, the rest is left to the render threads
+        assets.Create(std::max(ThreadPool::GetDefaultThreadCount() / 2u, 1u));
+
+        // Per cascade, the cascades are fitted to the camera in Draw()
+        shadowMap.m_Extent = { 2048, 2048 };
         // shadowMap.m_Extent = { 1024, 1024 };
-        shadowMap.Create(renderPass, sampler);
-        lightSpace = lightSpaceBias * shadowMap.lightSpace;
+        InitializeRenderGraph();
+        shadowMap.Create(compiler, renderPass, renderGraph, sampler);
 
         // TODO: Textures
 
-        InitializePipeline();
+        InitializePipeline(compiler);
         InitializeDescriptorSets();
         InitializeEditorDescriptorSets();
-        commandBuffer.Create(VK_COMMAND_BUFFER_LEVEL_PRIMARY, swapchain.GetImageViewCount(), VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, DeviceQueues::Family::eGraphics);
+        // Per-frame copies are sized for the most frames in flight, the frame count can change at runtime
+        renderQueue.Create(1024u, FrameContext::maxFramesInFlight, eViewCount);
+        frustumCulling.Create(compiler, FrameContext::maxFramesInFlight);
+        UpdateInstanceDescriptors();
+        lightClusters.Create(1024u, FrameContext::maxFramesInFlight, eLightViewCount);
+        UpdateLightDescriptors();
+        parallelRecorder.Create(FrameContext::maxFramesInFlight);
         InitializeFramebuffers();
-        InitializeSyncData();
+        frameContext.Create(frameSettings.framesInFlight, swapchain.GetImageViewCount());
+        appliedFrameSettings = frameSettings;
+        gpuProfiler.Create(FrameContext::maxFramesInFlight, 64u);
 
         InitializeScripting();
-        CreateEditor();
-
-        testTexture.Create((Context::Get()->GetDataDirectory() + "Assets/Textures/" + "default_texture.tga").data(), VK_IMAGE_USAGE_SAMPLED_BIT, &sampler);
-        UpdateTexture(testTexture);
+        if (!headless.isEnabled) {
+            CreateEditor();
+        }
 
         auto runtimeCamera = scene.GetWorld().CreateEntity();
         scene.GetWorld().Add<Tag>(runtimeCamera, "Runtime Camera");
@@ -1405,30 +1301,76 @@ class AdHoc {
         c1.isSceneCamera = true;
         c1.eyePosition   = Vector3D{ -7.0f, 8.0f, -14.0f };
 
+        if (std::getenv("ADH_LIGHT_BENCHMARK")) {
+            isLightBenchmark = true;
+            CreateLightBenchmark(1000u);
+        }
+
+        if (std::getenv("ADH_MESH_BENCHMARK")) {
+            Mesh::Benchmark(Context::Get()->GetDataDirectory() + "Assets/Models/");
+        }
+
+        if (std::getenv("ADH_TEXTURE_BENCHMARK")) {
+            TextureCache::Benchmark(Context::Get()->GetDataDirectory() + "Assets/Textures/");
+        }
+
         EventListener eventListener = Event::CreateListener();
         Event::AddListener<WindowEvent>(eventListener, &AdHoc::OnResize, this);
         Event::AddListener<StatusEvent>(eventListener, &AdHoc::OnStatusEvent, this);
         Event::AddListener<CollisionEvent>(eventListener, &AdHoc::OnCollisionEvent, this);
+        Event::AddListener<FileEvent>(eventListener, &AdHoc::OnFileEvent, this);
+        if (!headless.isEnabled) {
+            // Assets and compiled shaders are reloaded while the editor runs
+            auto dataDirectory{ Context::Get()->GetDataDirectory() };
+            if (VirtualFileSystem::IsMounted()) {
+                ADH_LOG("File watcher: a pak is mounted, assets are not reloaded");
+            } else if (!fileWatcher.Create({ dataDirectory + "Assets/", dataDirectory + "Resources/Shaders/" })) {
+                ADH_LOG("File watcher: not supported, assets are not reloaded");
+            }
+        }
         input.Initialize();
 
-        hdrBuffer.Create(window, swapchain, sampler);
-        gaussianBlur.Create(window, swapchain, sampler, hdrBuffer.descriptor);
-        hdrDraw.Create(renderPass, hdrBuffer.descriptor, gaussianBlur.finalPassdescriptor);
+        hdrBuffer.Create(compiler, renderGraph);
+        bloom.Create(compiler, renderGraph, FrameContext::maxFramesInFlight, sampler, hdrBuffer.color);
+        auto hdrDescriptor{ renderGraph.GetDescriptor(hdrBuffer.color, sampler) };
+        auto bloomDescriptor{ renderGraph.GetDescriptor(bloom.image, sampler) };
+        hdrDraw.Create(compiler, renderPass, hdrDescriptor, bloomDescriptor);
 
         floats[0] = &hdrDraw.intensity[0];
-        floats[1] = &gaussianBlur.brightColor.threshold;
-        floats[2] = &gaussianBlur.ubo.blurScale;
-        floats[3] = &gaussianBlur.ubo.blurStrength;
+        floats[1] = &bloom.threshold;
+        floats[2] = &bloom.weight;
+        floats[3] = &bloom.radius;
         floats[4] = &directionalLight.intensity;
         floats[5] = &hdrDraw.intensity[1];
         floats[6] = &floatShadowPCF;
 
         audioDevice.Create();
 
+        compiler.Wait();
+        ADH_LOG("Startup: " << startup.GetTime() * 1000.0f << " ms" << (VirtualFileSystem::IsMounted() ? " (packed)" : " (loose files)"));
+
+        // Plays the scene the way the editor's play button does, drawn from its runtime camera
+        if (headless.isEnabled) {
+            scene.LoadFromFile((Context::Get()->GetDataDirectory() + "Assets/Scenes/" + headless.scene).data());
+            // Measured frames draw the real assets, not the placeholders
+            assets.Wait();
+            scene.GetState().ClearStack();
+            scene.ResetPhysicsWorld();
+            ReadyScript();
+            g_AreScriptsReady = true;
+            g_IsPlaying       = true;
+            g_DrawEditor      = false;
+        }
+
         renderingReady = true;
     }
 
     void Run() {
+        if (headless.isEnabled) {
+            RunHeadless();
+            return;
+        }
+
         auto start            = std::chrono::steady_clock::now();
         const float maxFPS    = 60.0;
         const float maxPeriod = 1.0 / maxFPS;
@@ -1466,12 +1408,10 @@ class AdHoc {
                 //     collisionCallbacks.clear();
                 // }
 
-                if (g_IsPlaying && !g_IsPaused) {
-                    scene.GetPhysics().StepSimulation(deltaTime);
-                    scene.GetWorld().GetSystem<Transform, RigidBody>().ForEach([&](Transform& transform, RigidBody& rigidBody) {
-                        rigidBody.OnUpdate(transform);
-                    });
-                }
+                Simulate(deltaTime);
+                fileWatcher.Update();
+                assets.Update();
+                assetRegistry.Update();
 
                 if (g_IsPlaying && g_MaximizeOnPlay) {
                     g_DrawEditor = false;
@@ -1483,6 +1423,12 @@ class AdHoc {
                     g_MaximizeOnPlay = false;
                 }
 
+                // Present mode and frames in flight picked in the editor take effect between two frames
+                if (frameSettings.presentMode != appliedFrameSettings.presentMode ||
+                    frameSettings.framesInFlight != appliedFrameSettings.framesInFlight) {
+                    swapchain.isValid = false;
+                }
+
                 if (swapchain.isValid) {
                     Draw();
                 } else if (!swapchain.isValid && !window.IsMinimized()) {
@@ -1490,29 +1436,134 @@ class AdHoc {
                     RecreateEditor();
                 }
 
-                if (ScriptHandler::loadSceneFilename) {
-                    scene.LoadFromFile((Context::Get()->GetDataDirectory() + "Assets/Scenes/" + ScriptHandler::loadSceneFilename).data());
-                    ScriptHandler::loadSceneFilename = nullptr;
-                    scene.GetState().ClearStack();
-                    scene.ResetPhysicsWorld();
-                    ReadyScript();
-                }
-
-                if (!ScriptHandler::scriptComponentEvent.IsEmpty()) {
-                    for (auto&& i : ScriptHandler::scriptComponentEvent) {
-                        i();
-                    }
-                    ScriptHandler::scriptComponentEvent.Clear();
-                }
+                ProcessScriptRequests();
                 start = end;
             }
         }
     }
 
+    // Runs the scene for a fixed number of frames with a fixed delta time and logs the frame times.
+    // The first frames compile pipelines and fill caches, they aren't part of the statistics.
+    void RunHeadless() {
+        constexpr std::uint32_t warmupFrames{ 10u };
+
+        Array<float> frameTimes;
+        frameTimes.Reserve(headless.frames);
+
+        ScriptHandler::deltaTime = headless.deltaTime;
+        Stopwatch<> timer;
+        for (std::uint32_t frame{}; frame != headless.frames; ++frame) {
+            UpdateCameras();
+            UpdateScripts(headless.deltaTime);
+            Simulate(headless.deltaTime);
+            assets.Update();
+            assetRegistry.Update();
+            Draw();
+            ProcessScriptRequests();
+
+            auto time{ timer.Lap() * 1000.0f };
+            if (frame >= warmupFrames) {
+                frameTimes.EmplaceBack(time);
+            }
+        }
+        frameContext.WaitIdle();
+
+        ADH_LOG("Headless: " << headless.scene << ", " << headless.frames << " frames, " << headless.extent.width << "x" << headless.extent.height);
+        if (!frameTimes.IsEmpty()) {
+            frameTimes.Sort();
+            auto percentile{ [&frameTimes](float p) {
+                return frameTimes[static_cast<std::size_t>(p * static_cast<float>(frameTimes.GetSize() - 1u))];
+            } };
+            float total{};
+            for (auto time : frameTimes) {
+                total += time;
+            }
+            ADH_LOG("CPU ms: avg " << total / static_cast<float>(frameTimes.GetSize()) << " min " << frameTimes[0] << " max " << frameTimes[frameTimes.GetSize() - 1u]
+                                   << " p50 " << percentile(0.5f) << " p95 " << percentile(0.95f) << " p99 " << percentile(0.99f));
+        }
+        const auto& statistics{ renderQueue.GetStatistics()[eRuntimeView] };
+        ADH_LOG("Triangles: " << statistics.triangles << " (" << statistics.fullTriangles << " without LODs)");
+        const auto& assetStatistics{ assetRegistry.GetStatistics() };
+        ADH_LOG("Assets: " << assetStatistics.assetCount << " resident, " << (assetStatistics.residentBytes >> 20u) << " MB, "
+                           << assetStatistics.hits << " hits, " << assetStatistics.misses << " misses, "
+                           << assetStatistics.duplicates << " duplicates, " << assetStatistics.evictions << " evictions");
+        ADH_LOG("Geometry buffer: " << (geometryBuffer.GetUsedSize() >> 20u) << " of " << (geometryBuffer.GetSize() >> 20u) << " MB used");
+        if (gpuProfiler.IsSupported()) {
+            ADH_LOG("GPU ms: avg " << gpuProfiler.GetFrame().time << " max " << gpuProfiler.GetFrame().maxTime);
+        }
+        if (headless.hash) {
+            ADH_LOG("Image hash: " << std::hex << HashImage(swapchain.GetImages()[imageIndex]) << std::dec);
+        }
+        if (!headless.csvPath.empty() && !gpuProfiler.WriteCSV(headless.csvPath)) {
+            ADH_LOG("Failed to write " << headless.csvPath);
+        }
+    }
+
+    void Simulate(float deltaTime) {
+        if (g_IsPlaying && !g_IsPaused) {
+            scene.GetPhysics().StepSimulation(deltaTime);
+            scene.GetWorld().GetSystem<Transform, RigidBody>().ForEach([&](Transform& transform, RigidBody& rigidBody) {
+                rigidBody.OnUpdate(transform);
+            });
+        }
+    }
+
+    // Scene loads and component changes requested by scripts run between two frames
+    void ProcessScriptRequests() {
+        if (ScriptHandler::loadSceneFilename) {
+            // The current scene keeps playing until the new one is parsed
+            scene.LoadFromFileAsync((Context::Get()->GetDataDirectory() + "Assets/Scenes/" + ScriptHandler::loadSceneFilename).data(), [this]() {
+                scene.GetState().ClearStack();
+                scene.ResetPhysicsWorld();
+                ReadyScript();
+            });
+            ScriptHandler::loadSceneFilename = nullptr;
+        }
+
+        if (!ScriptHandler::scriptComponentEvent.IsEmpty()) {
+            for (auto&& i : ScriptHandler::scriptComponentEvent) {
+                i();
+            }
+            ScriptHandler::scriptComponentEvent.Clear();
+        }
+    }
+
+    // FNV-1a of the pixels, the image was last written by the composite pass. Needs an idle device.
+    std::uint64_t HashImage(VkImage image) {
+        auto extent{ swapchain.GetExtent() };
+        VkDeviceSize size{ static_cast<VkDeviceSize>(extent.width) * extent.height * 4u };
+        UniformBuffer readback(nullptr, size, 1u, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+        CommandBuffer commandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1u, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, DeviceQueues::Family::eGraphics);
+        commandBuffer.Begin();
+        // Earlier submissions finished, their attachment writes still have to be made visible to the copy
+        auto attachmentBarrier{ initializers::MemoryBarrier(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT) };
+        vkCmdPipelineBarrier(commandBuffer[0], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1u, &attachmentBarrier, 0u, nullptr, 0u, nullptr);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u };
+        region.imageExtent      = { extent.width, extent.height, 1u };
+        vkCmdCopyImageToBuffer(commandBuffer[0], image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback, 1u, &region);
+
+        auto hostBarrier{ initializers::MemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT) };
+        vkCmdPipelineBarrier(commandBuffer[0], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1u, &hostBarrier, 0u, nullptr, 0u, nullptr);
+        commandBuffer.End();
+
+        VkCommandBuffer cmd{ commandBuffer[0] };
+        auto submitInfo{ initializers::SubmitInfo(1u, &cmd) };
+        auto queue{ Context::Get()->GetQueue(DeviceQueues::Family::eGraphics).queue };
+        ADH_THROW(vkQueueSubmit(queue, 1u, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS, "Failed to submit to queue!");
+        vkQueueWaitIdle(queue);
+        commandBuffer.Free();
+
+        return Fnv1a(readback.GetMappedPtr(), static_cast<std::size_t>(size));
+    }
+
+    // Only computes the matrices, Draw() writes them to the copies of the frame once its fence was waited on
     void UpdateCameras() {
         scene.GetWorld().GetSystem<Camera2D>().ForEach([&](Camera2D& camera) {
-            auto width    = editor.GetSelectedAspectRatioWidth();
-            auto height   = editor.GetSelectedAspectRatioHeight();
+            auto width    = GetAspectRatioWidth();
+            auto height   = GetAspectRatioHeight();
             camera.left   = -(width / 2.0f);
             camera.right  = width / 2.0f;
             camera.bottom = -(height / 2.0f);
@@ -1520,23 +1571,18 @@ class AdHoc {
 
             if (camera.isRuntimeCamera) {
                 viewProjection.viewProj = camera.GetXmmProjection() * camera.GetXmmView();
-                viewProjectionBuffer.Update(imageIndex);
                 editorViewProjection2.viewProj = camera.GetXmmProjection() * camera.GetXmmView();
-                editorViewProjectionBuffer2.Update(imageIndex);
             }
             if (camera.isSceneCamera) {
                 editorViewProjection.viewProj = camera.GetXmmProjection() * camera.GetXmmView();
-                editorViewProjectionBuffer.Update(imageIndex);
             }
         });
         scene.GetWorld().GetSystem<Camera3D>().ForEach([&](Camera3D& camera) {
-            camera.aspectRatio = editor.GetSelectedAspectRatio();
+            camera.aspectRatio = GetAspectRatioWidth() / GetAspectRatioHeight();
             if (camera.isRuntimeCamera) {
                 viewProjection.viewProj = camera.GetXmmProjection() * camera.GetXmmView();
-                viewProjectionBuffer.Update(imageIndex);
 
                 editorViewProjection2.viewProj = camera.GetXmmProjection() * camera.GetXmmView();
-                editorViewProjectionBuffer2.Update(imageIndex);
             }
             if (camera.isSceneCamera) {
                 // TODO: camera control
@@ -1544,7 +1590,6 @@ class AdHoc {
                 }
 
                 editorViewProjection.viewProj = camera.GetXmmProjection() * camera.GetXmmView();
-                editorViewProjectionBuffer.Update(imageIndex);
             }
         });
     }
@@ -1630,266 +1675,285 @@ class AdHoc {
         }
     }
 
-    void Draw() {
-        auto device               = Context::Get()->GetDevice();
-        constexpr auto maxTimeout = std::numeric_limits<std::uint64_t>::max();
-
-        ADH_THROW(vkWaitForFences(device, 1u, &fence1[currentFrame], VK_TRUE, maxTimeout) == VK_SUCCESS,
-                  "Failed to wait for fences!");
+    // Instances at "binding", visible instance indices at "binding + 1"
+    void UpdateInstanceDescriptors(DescriptorSet& descSet, std::uint32_t setIndex, std::uint32_t binding) {
+        Array<VkDescriptorBufferInfo> infos;
+        infos.Resize(descSet.m_SwapChainImageViews);
+        for (std::uint32_t i{}; i != descSet.m_SwapChainImageViews; ++i) {
+            infos[i] = renderQueue.GetDescriptor(i);
+        }
+        descSet.Update(
+            infos.GetData(),
+            setIndex,                         // descriptor index
+            binding,                          // binding
+            0u,                               // array element
+            1u,                               // array count
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER // type
+        );
 
-        auto acquireNextImage{ vkAcquireNextImageKHR(device, swapchain, maxTimeout, presentSempahore[currentFrame], nullptr, &imageIndex) };
-        if (acquireNextImage == VK_ERROR_OUT_OF_DATE_KHR) {
-            swapchain.isValid = false;
+        for (std::uint32_t i{}; i != descSet.m_SwapChainImageViews; ++i) {
+            infos[i] = renderQueue.GetVisibleDescriptor(i);
         }
+        descSet.Update(
+            infos.GetData(),
+            setIndex,                         // descriptor index
+            binding + 1u,                     // binding
+            0u,                               // array element
+            1u,                               // array count
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER // type
+        );
+    }
 
-        auto cmd = commandBuffer.Begin(currentFrame);
+    void UpdateInstanceDescriptors() {
+        UpdateInstanceDescriptors(shadowMap.descriptorSet, 0u, 1u);
+        UpdateInstanceDescriptors(descriptorSet, 0u, 2u);
+        UpdateInstanceDescriptors(editorDescriptorSet, 0u, 2u);
+        UpdateInstanceDescriptors(editorDescriptorSet2, 0u, 2u);
+        frustumCulling.Update(renderQueue);
+    }
 
-        fragmentUbo.shadowPCF = (int)floatShadowPCF;
-        fragDataBuffer.Update(imageIndex);
+    // ClusterData at "binding", lights, clusters and light indices at the following bindings
+    void UpdateLightDescriptors(DescriptorSet& descSet, std::uint32_t setIndex, std::uint32_t binding, std::uint32_t view) {
+        Array<VkDescriptorBufferInfo> infos;
+        infos.Resize(descSet.m_SwapChainImageViews);
+        auto update{ [&](std::uint32_t offset, VkDescriptorType type, auto&& getDescriptor) {
+            for (std::uint32_t i{}; i != descSet.m_SwapChainImageViews; ++i) {
+                infos[i] = getDescriptor(i);
+            }
+            descSet.Update(
+                infos.GetData(),
+                setIndex,         // descriptor index
+                binding + offset, // binding
+                0u,               // array element
+                1u,               // array count
+                type              // type
+            );
+        } };
+        update(0u, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, [&](std::uint32_t i) { return lightClusters.GetDataDescriptor(i, view); });
+        update(1u, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, [&](std::uint32_t i) { return lightClusters.GetLightDescriptor(i); });
+        update(2u, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, [&](std::uint32_t i) { return lightClusters.GetClusterDescriptor(i, view); });
+        update(3u, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, [&](std::uint32_t i) { return lightClusters.GetIndexDescriptor(i, view); });
+    }
 
-        // TODO: problem with fullscreen
-        if (g_DrawEditor) {
-            directionalLight.direction = sunPosition;
-            lightBuffer.Update(imageIndex);
+    void UpdateLightDescriptors() {
+        UpdateLightDescriptors(descriptorSet, 1u, 3u, eRuntimeLights);
+        UpdateLightDescriptors(editorDescriptorSet, 1u, 3u, eSceneLights);
+        UpdateLightDescriptors(editorDescriptorSet2, 1u, 3u, eRuntimeLights);
+    }
+
+    void UpdateLightClusters() {
+        scene.GetWorld().GetSystem<Camera3D>().ForEach([&](Camera3D& camera) {
+            if (camera.isRuntimeCamera) {
+                lightClusters.SetView(eRuntimeLights, camera.GetXmmView(), camera.GetXmmProjection(), camera.nearZ, camera.farZ);
+            }
+            if (camera.isSceneCamera) {
+                lightClusters.SetView(eSceneLights, camera.GetXmmView(), camera.GetXmmProjection(), camera.nearZ, camera.farZ);
+            }
+        });
 
-            shadowMap.lightSpace = xmm::PerspectiveLH(ToRadians(140.0f), 1.0f, 1.0f, 1000.0f) * xmm::LookAtLH(sunPosition, { 0, 0, 0 }, { 0, 1, 0 });
-            shadowMap.lightSpaceBuffer.Update(imageIndex);
+        if (lightClusters.Build(scene)) {
+            UpdateLightDescriptors();
+        }
+        lightClusters.Upload(currentFrame);
 
-            lightSpace = lightSpaceBias * shadowMap.lightSpace;
-            lightSpaceBuffer.Update(imageIndex);
+        if (isLightBenchmark && !(lightBenchmarkFrame++ % 300u)) {
+            const auto& statistics{ lightClusters.GetStatistics() };
+            ADH_LOG("Light clusters: " << statistics.lightCount << " lights, " << statistics.indexCount << " indices, built in "
+                                       << statistics.buildTime << " ms");
         }
+    }
 
-        // Draw shadowmap
-        {
-            shadowMap.m_RenderPass.Begin(cmd, shadowMap.m_Framebuffer);
-            shadowMap.graphicsPipeline.Bind(cmd);
-            shadowMap.descriptorSet.Bind(cmd, imageIndex);
-            shadowMap.viewport.Update(shadowMap.m_Extent, false);
-            shadowMap.viewport.Set(cmd);
-            shadowMap.scissor.Update(shadowMap.m_Extent);
-            shadowMap.scissor.Set(cmd);
-
-            float depthBiasConstant = 1.25f;
-            float depthBiasSlope    = 1.75f;
-            vkCmdSetDepthBias(cmd, depthBiasConstant, 0.0f, depthBiasSlope);
-
-            scene.GetWorld().GetSystem<Transform, Mesh, Material>().ForEach([&](ecs::Entity e, Transform& transform, Mesh& mesh, Material& material) {
-                if (mesh.toDraw) {
-                    // TODO: temp
-                    xmm::Matrix transformMatrix;
-                    if (!g_IsPlaying) {
-                        transformMatrix = transform.GetXmm();
-                    } else if (g_IsPlaying && scene.GetWorld().Contains<RigidBody>(e)) {
-                        transformMatrix = transform.GetXmmPhysics();
-                    } else {
-                        transformMatrix = transform.GetXmm();
-                    }
-                    vkCmdPushConstants(
-                        cmd,
-                        shadowMap.pipelineLayout,
-                        VK_SHADER_STAGE_VERTEX_BIT,
-                        0u,
-                        sizeof(transformMatrix), &transformMatrix);
-
-                    if (mesh.GetIndexCount() > 0) {
-                        mesh.Bind(cmd);
-                        vkCmdDrawIndexed(cmd, mesh.GetIndexCount(), 1u, 0u, 0, 0u);
-                    }
-                }
-            });
+    // A floor under a grid of point lights with short ranges, most clusters only see a few of them
+    void CreateLightBenchmark(std::uint32_t lightCount) {
+        constexpr float spacing{ 2.0f };
+        const auto side{ static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<float>(lightCount)))) };
+        const auto extent{ side * spacing };
+
+        auto& world{ scene.GetWorld() };
+        auto [tag, transform, mesh, material] = world.Add<Tag, Transform, Mesh, Material>(
+            world.CreateEntity(),
+            std::string("Light Benchmark Floor"),
+            Transform{ Vector3D{ 0.0f, -1.0f, 0.0f }, Vector3D{}, Vector3D{ extent * 0.5f, 0.1f, extent * 0.5f } },
+            Mesh{},
+            Material{});
+        mesh.Load(Context::Get()->GetDataDirectory() + "Assets/Models/cube.obj");
+
+        for (std::uint32_t i{}; i != lightCount; ++i) {
+            PointLight light{};
+            light.intensity = 1.0f;
+            light.position  = Vector3D{ ((i % side) + 0.5f) * spacing - extent * 0.5f, -0.5f, ((i / side) + 0.5f) * spacing - extent * 0.5f };
+            light.color     = Vector3D{ Random::Real(0.2f, 1.0f), Random::Real(0.2f, 1.0f), Random::Real(0.2f, 1.0f) };
+            SetLightAttenuation(&light, AttenuationStrength::e1);
+
+            world.Add<Tag, PointLight>(world.CreateEntity(), std::string("Point Light ") + std::to_string(i), light);
+        }
+    }
 
-            shadowMap.m_RenderPass.End(cmd);
+    // One draw per LOD of the mesh, LODs no instance picked draw nothing
+    void DrawBatch(VkCommandBuffer cmd, std::uint32_t view, std::uint32_t batchIndex, const RenderQueue::Batch& batch) {
+        const auto& lods{ batch.mesh->lods };
+        for (std::uint32_t lod{}; lod != lods.GetSize(); ++lod) {
+            if (frustumCulling.isSupported) {
+                vkCmdDrawIndexedIndirect(cmd, renderQueue.GetCommandBuffer(), renderQueue.GetCommandOffset(currentFrame, view, batchIndex, lod),
+                                         1u, sizeof(VkDrawIndexedIndirectCommand));
+            } else if (auto visibleCount{ renderQueue.GetVisibleCount(view, batchIndex, lod) }; visibleCount) {
+                vkCmdDrawIndexed(cmd, lods[lod].indexCount, visibleCount, batch.mesh->GetFirstIndex(lod), batch.mesh->GetVertexOffset(),
+                                 renderQueue.GetFirstInstance(view, batchIndex, lod));
+            }
         }
+    }
 
-        // End shadowmap
-        if (!g_DrawEditor) {
-            // Draw hdr texture
-            {
-                hdrBuffer.m_RenderPass.Begin(cmd, hdrBuffer.m_Framebuffer);
-                hdrBuffer.graphicsPipeline.Bind(cmd);
-                // descriptorSet.Bind(cmd, imageIndex);
-
-                viewport.Update(swapchain.GetExtent(), false);
-                viewport.Set(cmd);
-
-                scissor.Update(swapchain.GetExtent());
-                scissor.Set(cmd);
-
-                float depthBiasConstant = 1.25f;
-                float depthBiasSlope    = 1.75f;
-                vkCmdSetDepthBias(cmd, 0, 0.0f, 0);
-                // vkCmdSetDepthBias(cmd, depthBiasConstant, 0.0f, depthBiasSlope);
-
-                scene.GetWorld().GetSystem<Transform, Mesh, Material>().ForEach([&](ecs::Entity e, Transform& transform, Mesh& mesh, Material& material) {
-                    if (mesh.toDraw) {
-                        xmm::Matrix transformMatrix;
-                        if (!g_IsPlaying) {
-                            transformMatrix = transform.GetXmm();
-                        } else if (g_IsPlaying && scene.GetWorld().Contains<RigidBody>(e)) {
-                            transformMatrix = transform.GetXmmPhysics();
-                        } else {
-                            transformMatrix = transform.GetXmm();
-                        }
-                        vkCmdPushConstants(
-                            cmd,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_VERTEX_BIT,
-                            0u,
-                            sizeof(transformMatrix), &transformMatrix);
-
-                        // FIXME: Do not update if same texture
-                        if (scene.GetWorld().Contains<Texture2D>(e)) {
-                            auto [t] = scene.GetWorld().Get<Texture2D>(e);
-                            // UpdateTexture(t);
-                            DescriptorSet* descSet = &descriptorSet;
-
-                            auto count{ descSet->m_DescriptorSets.GetSize() / descSet->m_SwapChainImageViews };
-                            VkDescriptorSet* sets{ static_cast<VkDescriptorSet*>(ADH_STACK_ALLOC(count * sizeof(VkDescriptorSet))) };
-                            ADH_THROW(sets, "Failed to allocate memory for descriptor sets!");
-
-                            for (std::uint32_t i{}; i != count - 1; ++i) {
-                                sets[i] = descSet->GetSet(i, imageIndex);
-                            }
-                            sets[count - 1] = TextureDescriptors::GetDescriptor(t.GetDescriptorID());
-                            vkCmdBindDescriptorSets(cmd,
-                                                    descSet->m_BindPoint,
-                                                    descSet->m_PipelineLayout,
-                                                    0u,
-                                                    count,
-                                                    sets,
-                                                    0u,
-                                                    nullptr);
-
-                            material.hasTexture = 1;
-                        } else {
-                            descriptorSet.Bind(cmd, imageIndex);
-                            material.hasTexture = 0;
-                        }
+    // Draws the batches [first, last). Meshes in the GeometryBuffer are bound once, with
+    // multiDrawIndirect a run of them is a single draw over their consecutive indirect commands.
+    // Meshes with buffers of their own are bound and drawn one by one.
+    void DrawMeshes(VkCommandBuffer cmd, std::uint32_t view, std::uint32_t first, std::uint32_t last) {
+        const auto& batches{ renderQueue.GetBatches() };
+        const MeshBufferData* boundMesh{};
+        bool isSharedBound{};
+        for (std::uint32_t batchIndex{ first }; batchIndex != last;) {
+            const auto& batch{ batches[batchIndex] };
+            if (batch.mesh->IsShared() ? !isSharedBound : batch.mesh != boundMesh) {
+                batch.mesh->Bind(cmd);
+                boundMesh     = batch.mesh;
+                isSharedBound = batch.mesh->IsShared();
+            }
+            if (!batch.mesh->IsShared() || !frustumCulling.isSupported || !frustumCulling.maxMergedBatches) {
+                DrawBatch(cmd, view, batchIndex, batch);
+                ++batchIndex;
+                continue;
+            }
 
-                        vkCmdPushConstants(
-                            cmd,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_FRAGMENT_BIT,
-                            64u,
-                            sizeof(material), &material);
+            auto runEnd{ batchIndex + 1u };
+            while (runEnd != last && runEnd - batchIndex != frustumCulling.maxMergedBatches && batches[runEnd].mesh->IsShared()) {
+                ++runEnd;
+            }
+            vkCmdDrawIndexedIndirect(cmd, renderQueue.GetCommandBuffer(), renderQueue.GetCommandOffset(currentFrame, view, batchIndex, 0u),
+                                     (runEnd - batchIndex) * MeshBufferData::maxLodCount, sizeof(VkDrawIndexedIndirectCommand));
+            batchIndex = runEnd;
+        }
+    }
 
-                        if (mesh.GetIndexCount() > 0) {
-                            mesh.Bind(cmd);
-                            vkCmdDrawIndexed(cmd, mesh.GetIndexCount(), 1u, 0u, 0, 0u);
-                        }
-                    }
-                });
+    // Draws the render queue batches [first, last). The bindless texture table (set 2) is bound once,
+    // instances pick their texture by index in the fragment shader.
+    // Called from the recorder workers, so it must not touch anything but the command buffer.
+    void DrawBatches(VkCommandBuffer cmd, DescriptorSet& descSet, std::uint32_t view, std::uint32_t first, std::uint32_t last) {
+        descSet.Bind(cmd, currentFrame);
+        VkDescriptorSet textureSet{ TextureDescriptors::GetDescriptor() };
+        vkCmdBindDescriptorSets(cmd, descSet.m_BindPoint, descSet.m_PipelineLayout, 2u, 1u, &textureSet, 0u, nullptr);
 
-                hdrBuffer.m_RenderPass.End(cmd);
-            }
-            // End  hdr texture
+        DrawMeshes(cmd, view, first, last);
+    }
 
-            // Gaussian blur
-            {
-                vkCmdSetDepthBias(cmd, 0, 0, 0);
+    // Secondaries don't inherit dynamic state from the primary
+    static void SetDynamicState(VkCommandBuffer cmd, VkExtent2D extent, float depthBiasConstant, float depthBiasSlope) {
+        Viewport viewport{ extent, false };
+        viewport.Set(cmd);
+        Scissor scissor{ extent };
+        scissor.Set(cmd);
+        vkCmdSetDepthBias(cmd, depthBiasConstant, 0.0f, depthBiasSlope);
+    }
+
+    // Records the shadow map and scene passes on the worker threads, per pass and per batch range
+    void RecordScenePasses() {
+        parallelRecorder.BeginFrame(currentFrame);
 
-                gaussianBlur.Draw(cmd, imageIndex, viewport, scissor);
+        // Cached cascades only hold the static batches, which are sorted first
+        auto shadowExtent{ renderGraph.GetExtent(shadowMap.image) };
+        for (std::uint32_t cascade{}; cascade != CascadedShadowMap::cascadeCount; ++cascade) {
+            if (!shadowMap.isDrawn[cascade]) {
+                continue;
             }
-            // Gaussian blur
-        }
-        if (g_DrawEditor) {
-            for (std::uint32_t i{}; i != 2u; ++i) {
-                editor.BeginRenderPass(cmd, imageIndex, i);
-                editor.BindGraphicsPipeline(cmd);
-
-                viewport.Update(swapchain.GetExtent(), false);
-                viewport.Set(cmd);
-                scissor.Update(swapchain.GetExtent());
-                scissor.Set(cmd);
-
-                // if (!i) {
-                //     editorDescriptorSet.Bind(cmd, imageIndex);
-                // } else {
-                //     editorDescriptorSet2.Bind(cmd, imageIndex);
-                // }
 
-                float depthBiasConstant = 1.25f;
-                float depthBiasSlope    = 1.75f;
-                vkCmdSetDepthBias(cmd, 0, 0.0f, 0);
-                // vkCmdSetDepthBias(cmd, depthBiasConstant, 0.0f, depthBiasSlope);
-
-                scene.GetWorld().GetSystem<Transform, Mesh, Material>().ForEach([&](ecs::Entity e, Transform& transform, Mesh& mesh, Material& material) {
-                    if (mesh.toDraw) {
-                        // TODO: temp
-                        xmm::Matrix transformMatrix;
-                        if (!g_IsPlaying) {
-                            transformMatrix = transform.GetXmm();
-                        } else if (g_IsPlaying && scene.GetWorld().Contains<RigidBody>(e)) {
-                            transformMatrix = transform.GetXmmPhysics();
-                        } else {
-                            transformMatrix = transform.GetXmm();
-                        }
-                        vkCmdPushConstants(
-                            cmd,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_VERTEX_BIT,
-                            0u,
-                            sizeof(transformMatrix), &transformMatrix);
-
-                        // FIXME: Do not update if same texture
-                        if (scene.GetWorld().Contains<Texture2D>(e)) {
-                            auto [t] = scene.GetWorld().Get<Texture2D>(e);
-                            // UpdateTexture(t);
-                            DescriptorSet* descSet;
-                            if (!i) {
-                                descSet = &editorDescriptorSet;
-                            } else {
-                                descSet = &editorDescriptorSet2;
-                            }
+            auto shadowInheritance{ initializers::CommandBufferInheritanceInfo(renderGraph.GetRenderPass(shadowMap.pass), 0u, renderGraph.GetFramebuffer(shadowMap.pass, cascade)) };
+            shadowInheritance.pipelineStatistics = gpuProfiler.GetInheritedStatistics();
+            auto casterCount{ cascade < CascadedShadowMap::firstCachedCascade ? renderQueue.GetBatches().GetSize() : renderQueue.GetStaticBatchCount() };
+            parallelRecorder.Record(shadowCommands[cascade], shadowInheritance, static_cast<std::uint32_t>(casterCount),
+                                    [this, shadowExtent, cascade](VkCommandBuffer cmd, std::uint32_t first, std::uint32_t last) {
+                                        shadowMap.graphicsPipeline.Bind(cmd);
+                                        shadowMap.descriptorSet.Bind(cmd, currentFrame);
+                                        SetDynamicState(cmd, shadowExtent, 1.25f, 1.75f);
+                                        vkCmdPushConstants(cmd, shadowMap.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0u, sizeof(cascade), &cascade);
+                                        DrawMeshes(cmd, eShadowView + cascade, first, last);
+                                    });
+        }
 
-                            auto count{ descSet->m_DescriptorSets.GetSize() / descSet->m_SwapChainImageViews };
-                            VkDescriptorSet* sets{ static_cast<VkDescriptorSet*>(ADH_STACK_ALLOC(count * sizeof(VkDescriptorSet))) };
-                            ADH_THROW(sets, "Failed to allocate memory for descriptor sets!");
+        // Only the scene passes the graph didn't cull are recorded
+        auto batchCount{ static_cast<std::uint32_t>(renderQueue.GetBatches().GetSize()) };
+        auto extent{ swapchain.GetExtent() };
+        if (renderGraph.IsActive(hdrBuffer.pass)) {
+            auto hdrInheritance{ initializers::CommandBufferInheritanceInfo(renderGraph.GetRenderPass(hdrBuffer.pass), 0u, renderGraph.GetFramebuffer(hdrBuffer.pass)) };
+            hdrInheritance.pipelineStatistics = gpuProfiler.GetInheritedStatistics();
+            auto hdrExtent{ renderGraph.GetExtent(hdrBuffer.color) };
+            parallelRecorder.Record(sceneCommands[0], hdrInheritance, batchCount,
+                                    [this, hdrExtent](VkCommandBuffer cmd, std::uint32_t first, std::uint32_t last) {
+                                        hdrBuffer.graphicsPipeline.Bind(cmd);
+                                        SetDynamicState(cmd, hdrExtent, 0.0f, 0.0f);
+                                        DrawBatches(cmd, descriptorSet, eRuntimeView, first, last);
+                                    });
+        }
+        for (std::uint32_t i{}; i != 2u; ++i) {
+            if (renderGraph.IsActive(viewportPasses[i])) {
+                auto editorInheritance{ initializers::CommandBufferInheritanceInfo(editor.GetRenderPass(), 0u, editor.GetFramebuffer(currentFrame, i)) };
+                editorInheritance.pipelineStatistics = gpuProfiler.GetInheritedStatistics();
+                parallelRecorder.Record(sceneCommands[i], editorInheritance, batchCount,
+                                        [this, extent, i](VkCommandBuffer cmd, std::uint32_t first, std::uint32_t last) {
+                                            editor.BindGraphicsPipeline(cmd);
+                                            SetDynamicState(cmd, extent, 0.0f, 0.0f);
+                                            DrawBatches(cmd, !i ? editorDescriptorSet : editorDescriptorSet2, !i ? eSceneView : eRuntimeView, first, last);
+                                        });
+            }
+        }
 
-                            for (std::uint32_t i{}; i != count - 1; ++i) {
-                                sets[i] = descSet->GetSet(i, imageIndex);
-                            }
-                            sets[count - 1] = TextureDescriptors::GetDescriptor(t.GetDescriptorID());
-                            vkCmdBindDescriptorSets(cmd,
-                                                    descSet->m_BindPoint,
-                                                    descSet->m_PipelineLayout,
-                                                    0u,
-                                                    count,
-                                                    sets,
-                                                    0u,
-                                                    nullptr);
-
-                            material.hasTexture = 1;
-                        } else {
-                            // UpdateTexture(testTexture);
-                            if (!i) {
-                                editorDescriptorSet.Bind(cmd, imageIndex);
-                            } else {
-                                editorDescriptorSet2.Bind(cmd, imageIndex);
-                            }
+        parallelRecorder.Wait();
+    }
 
-                            material.hasTexture = 0;
-                        }
+    // Cascades that are still cached are skipped, their layers keep the last frame that drew them
+    void DrawShadowCascades(VkCommandBuffer cmd) {
+        for (std::uint32_t cascade{}; cascade != CascadedShadowMap::cascadeCount; ++cascade) {
+            if (shadowMap.isDrawn[cascade]) {
+                renderGraph.BeginLayer(cmd, shadowMap.pass, cascade);
+                ExecuteCommands(cmd, shadowCommands[cascade]);
+                renderGraph.EndLayer(cmd, shadowMap.pass);
+            }
+        }
+    }
 
-                        vkCmdPushConstants(
-                            cmd,
-                            pipelineLayout,
-                            VK_SHADER_STAGE_FRAGMENT_BIT,
-                            64u,
-                            sizeof(material), &material);
+    // LODs are picked against the height of the backbuffer, the editor viewports are never larger
+    void SetCameraViews() {
+        renderQueue.SetView(eSceneView, editorViewProjection.viewProj);
+        renderQueue.SetView(eRuntimeView, viewProjection.viewProj);
 
-                        if (mesh.GetIndexCount() > 0) {
-                            mesh.Bind(cmd);
-                            vkCmdDrawIndexed(cmd, mesh.GetIndexCount(), 1u, 0u, 0, 0u);
-                        }
-                    }
-                });
+        auto height{ static_cast<float>(swapchain.GetExtent().height) };
+        scene.GetWorld().GetSystem<Camera3D>().ForEach([&](Camera3D& camera) {
+            auto lodScale{ height / (2.0f * std::tan(ToRadians(camera.fieldOfView) * 0.5f)) };
+            if (camera.isRuntimeCamera) {
+                renderQueue.SetView(eRuntimeView, viewProjection.viewProj, camera.eyePosition, lodScale);
+            }
+            if (camera.isSceneCamera) {
+                renderQueue.SetView(eSceneView, editorViewProjection.viewProj, camera.eyePosition, lodScale);
+            }
+        });
+    }
 
-                editor.EndRenderPass(cmd);
+    // Cascades follow the camera the frame is drawn from, the editor fits them to the scene camera
+    void UpdateShadowCascades() {
+        scene.GetWorld().GetSystem<Camera3D>().ForEach([&](Camera3D& camera) {
+            if (g_DrawEditor ? camera.isSceneCamera : camera.isRuntimeCamera) {
+                shadowMap.Update(camera, sunPosition, renderQueue.GetStaticRevision());
             }
+        });
+        shadowMap.lightSpaceBuffer.Update(currentFrame);
+
+        for (std::uint32_t cascade{}; cascade != CascadedShadowMap::cascadeCount; ++cascade) {
+            lightSpace[cascade] = lightSpaceBias * shadowMap.lightSpace[cascade];
+            renderQueue.SetView(eShadowView + cascade, shadowMap.lightSpace[cascade]);
         }
+        lightSpaceBuffer.Update(currentFrame);
+    }
 
-        g_AspectRatio.CalculateViewport(swapchain.GetExtent(), editor.GetSelectedAspectRatioWidth(), editor.GetSelectedAspectRatioHeight());
+    // Both passes that write the backbuffer share the swapchain render pass
+    void BeginBackbuffer(VkCommandBuffer cmd) {
+        g_AspectRatio.CalculateViewport(swapchain.GetExtent(), GetAspectRatioWidth(), GetAspectRatioHeight());
 
         if (g_DrawEditor == true) {
             clearFramebuffers = true;
@@ -1907,145 +1971,242 @@ class AdHoc {
         }
 
         renderPass.Begin(cmd, swapchainFramebuffers[imageIndex]);
+    }
 
-        if (!g_DrawEditor) {
-            // TODO: editor viewport to see shadowmap
-            // Draw shadowmap
-            // shadowMap.debug.graphicsPipeline.Bind(cmd);
-            // shadowMap.debug.descriptorSet.Bind(cmd, imageIndex);
-
-            // viewport.Update(g_AspectRatio.GetViewport());
-            // viewport.Set(cmd);
-
-            // scissor.Update(g_AspectRatio.GetRect());
-            // scissor.Set(cmd);
-
-            // float depthBiasConstant = 1.25f;
-            // float depthBiasSlope    = 1.75f;
-            // vkCmdSetDepthBias(cmd, depthBiasConstant, 0.0f, depthBiasSlope);
-
-            // vkCmdDraw(cmd, 3, 1, 0, 0);
-
-            // viewport.Update(g_AspectRatio.GetViewport());
-            // viewport.Set(cmd);
-
-            // scissor.Update(g_AspectRatio.GetRect());
-            // scissor.Set(cmd);
-
-            // vkCmdSetDepthBias(cmd, 0.0f, 0.0f, 0.0f);
-
-            // graphicsPipeline.Bind(cmd);
-            // descriptorSet.Bind(cmd, imageIndex);
-
-            // scene.GetWorld().GetSystem<Transform, Mesh, Material>().ForEach([&](ecs::Entity e, Transform& transform, Mesh& mesh, Material& material) {
-            //     if (mesh.toDraw) {
-            //         // TODO: temp
-            //         xmm::Matrix transformMatrix;
-            //         if (!g_IsPlaying) {
-            //             transformMatrix = transform.GetXmm();
-            //         } else if (g_IsPlaying && scene.GetWorld().Contains<RigidBody>(e)) {
-            //             transformMatrix = transform.GetXmmPhysics();
-            //         } else {
-            //             transformMatrix = transform.GetXmm();
-            //         }
-            //         vkCmdPushConstants(
-            //             cmd,
-            //             pipelineLayout,
-            //             VK_SHADER_STAGE_VERTEX_BIT,
-            //             0u,
-            //             sizeof(transformMatrix), &transformMatrix);
-
-            //         vkCmdPushConstants(
-            //             cmd,
-            //             pipelineLayout,
-            //             VK_SHADER_STAGE_FRAGMENT_BIT,
-            //             64u,
-            //             sizeof(material), &material);
-
-            //         if (mesh.GetIndexCount() > 0) {
-            //             mesh.Bind(cmd);
-            //             vkCmdDrawIndexed(cmd, mesh.GetIndexCount(), 1u, 0u, 0, 0u);
-            //         }
-            //     }
-            // });
+    void DrawComposite(VkCommandBuffer cmd, std::uint32_t frameIndex) {
+        BeginBackbuffer(cmd);
 
-            viewport.Update(g_AspectRatio.GetViewport());
-            viewport.Set(cmd);
+        // TODO: editor viewport to see shadowmap
+        // Draw shadowmap
+        // shadowMap.debug.graphicsPipeline.Bind(cmd);
+        // shadowMap.debug.descriptorSet.Bind(cmd, imageIndex);
+
+        // viewport.Update(g_AspectRatio.GetViewport());
+        // viewport.Set(cmd);
+
+        // scissor.Update(g_AspectRatio.GetRect());
+        // scissor.Set(cmd);
+
+        // float depthBiasConstant = 1.25f;
+        // float depthBiasSlope    = 1.75f;
+        // vkCmdSetDepthBias(cmd, depthBiasConstant, 0.0f, depthBiasSlope);
+
+        // vkCmdDraw(cmd, 3, 1, 0, 0);
+
+        // viewport.Update(g_AspectRatio.GetViewport());
+        // viewport.Set(cmd);
+
+        // scissor.Update(g_AspectRatio.GetRect());
+        // scissor.Set(cmd);
+
+        // vkCmdSetDepthBias(cmd, 0.0f, 0.0f, 0.0f);
+
+        // graphicsPipeline.Bind(cmd);
+        // descriptorSet.Bind(cmd, imageIndex);
+
+        // scene.GetWorld().GetSystem<Transform, Mesh, Material>().ForEach([&](ecs::Entity e, Transform& transform, Mesh& mesh, Material& material) {
+        //     if (mesh.toDraw) {
+        //         // TODO: temp
+        //         xmm::Matrix transformMatrix;
+        //         if (!g_IsPlaying) {
+        //             transformMatrix = transform.GetXmm();
+        //         } else if (g_IsPlaying && scene.GetWorld().Contains<RigidBody>(e)) {
+        //             transformMatrix = transform.GetXmmPhysics();
+        //         } else {
+        //             transformMatrix = transform.GetXmm();
+        //         }
+        //         vkCmdPushConstants(
+        //             cmd,
+        //             pipelineLayout,
+        //             VK_SHADER_STAGE_VERTEX_BIT,
+        //             0u,
+        //             sizeof(transformMatrix), &transformMatrix);
+
+        //         vkCmdPushConstants(
+        //             cmd,
+        //             pipelineLayout,
+        //             VK_SHADER_STAGE_FRAGMENT_BIT,
+        //             64u,
+        //             sizeof(material), &material);
+
+        //         if (mesh.GetIndexCount() > 0) {
+        //             mesh.Bind(cmd);
+        //             vkCmdDrawIndexed(cmd, mesh.GetIndexCount(), 1u, 0u, 0, 0u);
+        //         }
+        //     }
+        // });
+
+        viewport.Update(g_AspectRatio.GetViewport());
+        viewport.Set(cmd);
+
+        scissor.Update(g_AspectRatio.GetRect());
+        scissor.Set(cmd);
+
+        float depthBiasConstant = 0;
+        float depthBiasSlope    = 0;
+        vkCmdSetDepthBias(cmd, 0, 0.0f, 0);
+
+        hdrDraw.graphicsPipeline.Bind(cmd);
+        hdrDraw.descriptorSet.Bind(cmd, frameIndex);
+
+        vkCmdPushConstants(
+            cmd,
+            hdrDraw.pipelineLayout,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            0u,
+            sizeof(float) * 2, hdrDraw.intensity);
 
-            scissor.Update(g_AspectRatio.GetRect());
-            scissor.Set(cmd);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
 
-            float depthBiasConstant = 0;
-            float depthBiasSlope    = 0;
-            vkCmdSetDepthBias(cmd, 0, 0.0f, 0);
+        renderPass.End(cmd);
+    }
 
-            hdrDraw.graphicsPipeline.Bind(cmd);
-            hdrDraw.descriptorSet.Bind(cmd, imageIndex);
+    void DrawEditor(VkCommandBuffer cmd, std::uint32_t frameIndex) {
+        BeginBackbuffer(cmd);
+        editor.Draw(cmd, frameIndex, &g_MaximizeOnPlay, &g_IsPlaying, &g_IsPaused, &g_EditorFpsLimit, &frameSettings, floats, sunPosition,
+                    &frustumCulling.isEnabled, renderQueue, gpuProfiler);
+        renderPass.End(cmd);
+    }
 
-            vkCmdPushConstants(
-                cmd,
-                hdrDraw.pipelineLayout,
-                VK_SHADER_STAGE_FRAGMENT_BIT,
-                0u,
-                sizeof(float) * 2, hdrDraw.intensity);
+    void Draw() {
+        if (!frameContext.Begin(swapchain)) {
+            swapchain.isValid = false;
+            return;
+        }
+        currentFrame = frameContext.GetIndex();
+        imageIndex   = frameContext.GetImageIndex();
+        auto cmd{ frameContext.GetCommandBuffer() };
 
-            vkCmdDraw(cmd, 3, 1, 0, 0);
+        // The fence of the frame was waited on, its copies are no longer read by the GPU and the
+        // profiler reads the queries the frame wrote last time
+        gpuProfiler.BeginFrame(cmd, currentFrame);
+        viewProjectionBuffer.Update(currentFrame);
+        editorViewProjectionBuffer.Update(currentFrame);
+        editorViewProjectionBuffer2.Update(currentFrame);
 
-        } else {
-            editor.Draw(cmd, currentFrame, &g_MaximizeOnPlay, &g_IsPlaying, &g_IsPaused, &g_EditorFpsLimit, floats, sunPosition);
+        fragmentUbo.shadowPCF = (int)floatShadowPCF;
+        fragDataBuffer.Update(currentFrame);
+
+        // TODO: problem with fullscreen
+        if (g_DrawEditor) {
+            directionalLight.direction = sunPosition;
+            lightBuffer.Update(currentFrame);
         }
 
-        renderPass.End(cmd);
+        if (renderQueue.Build(scene, g_IsPlaying)) {
+            UpdateInstanceDescriptors();
+        }
+        UpdateShadowCascades();
+        SetCameraViews();
+        renderQueue.Upload(currentFrame, frustumCulling.IsActive());
+        UpdateLightClusters();
+        gpuProfiler.BeginScope(cmd, "Culling");
+        frustumCulling.Dispatch(cmd, currentFrame, renderQueue);
+        gpuProfiler.EndScope(cmd);
+
+        // Copies the thumbnails finished since the last frame into the atlas the overlay samples
+        if (!headless.isEnabled) {
+            editor.UploadThumbnails(cmd, frameContext);
+        }
+
+        // The runtime view composites the bloom into the backbuffer, the editor only draws its viewports
+        renderGraph.SetEnabled(hdrDraw.pass, !g_DrawEditor);
+        renderGraph.SetEnabled(editorPass, g_DrawEditor);
 
-        commandBuffer.End(currentFrame);
+        RecordScenePasses();
 
-        if (fence2[imageIndex] != VK_NULL_HANDLE) {
-            vkWaitForFences(device, 1, &fence2[imageIndex], VK_TRUE, maxTimeout);
+        renderGraph.Execute(cmd, currentFrame, &gpuProfiler);
+        gpuProfiler.EndFrame(cmd);
+
+        if (!frameContext.End(swapchain)) {
+            swapchain.isValid = false;
         }
-        fence2[imageIndex] = fence1[currentFrame];
+    }
 
-        {
-            VkPipelineStageFlags waitStages[]{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-            VkSemaphore waitSemaphores[]{ presentSempahore[currentFrame] };
-            VkSemaphore signalSemaphores[]{ renderSemaphore[currentFrame] };
-            VkCommandBuffer commandBuffers[]{ cmd };
-            VkSubmitInfo submitInfo{};
-            submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.commandBufferCount   = std::size(commandBuffers);
-            submitInfo.pCommandBuffers      = commandBuffers;
-            submitInfo.waitSemaphoreCount   = std::size(waitSemaphores);
-            submitInfo.pWaitSemaphores      = waitSemaphores;
-            submitInfo.pWaitDstStageMask    = waitStages;
-            submitInfo.signalSemaphoreCount = std::size(signalSemaphores);
-            submitInfo.pSignalSemaphores    = signalSemaphores;
-
-            vkResetFences(device, 1, &fence1[currentFrame]);
-            ADH_THROW(vkQueueSubmit(Context::Get()->GetQueue(DeviceQueues::Family::eGraphics).queue, 1u, &submitInfo, fence1[currentFrame]) == VK_SUCCESS,
-                      "Failed to submit to queue!");
+    // ADH_PAK_BUILD packs the files the runtime loads into a pak of that name in the data directory,
+    // ADH_PAK mounts one so they're read from it instead of the loose files. ADH_PAK_BENCHMARK then
+    // reads every packed file both ways, the Startup line compares whole startups.
+    static void MountPak() {
+        auto dataDirectory{ Context::Get()->GetDataDirectory() };
+        if (auto pakName{ std::getenv("ADH_PAK_BUILD") }) {
+            Stopwatch<> stopwatch;
+            PakBuilder::Statistics statistics;
+            if (PakBuilder::Build(dataDirectory, { "Assets", "Resources/Shaders", "Resources/TextureCache", "Resources/MeshCache" },
+                                  dataDirectory + pakName, statistics)) {
+                ADH_LOG("Pak: " << pakName << " built in " << stopwatch.GetTime() * 1000.0f << " ms, " << statistics.fileCount << " files ("
+                                << statistics.compressedCount << " compressed), " << (statistics.originalSize >> 10u) << " KB packed into "
+                                << (statistics.packedSize >> 10u) << " KB");
+            } else {
+                ADH_LOG("Pak: failed to build " << pakName);
+            }
+        }
+        if (auto pakName{ std::getenv("ADH_PAK") }) {
+            if (!VirtualFileSystem::Mount(dataDirectory + pakName, dataDirectory)) {
+                ADH_LOG("Pak: failed to mount " << pakName << ", loose files are read");
+            } else if (std::getenv("ADH_PAK_BENCHMARK")) {
+                PakBuilder::Benchmark(dataDirectory);
+            }
         }
+    }
 
-        {
-            VkSwapchainKHR swapchains[]{ swapchain };
-            VkSemaphore waitSemaphores[]{ renderSemaphore[currentFrame] };
-            VkPresentInfoKHR presentInfo{};
-            presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            presentInfo.waitSemaphoreCount = std::size(waitSemaphores);
-            presentInfo.pWaitSemaphores    = waitSemaphores;
-            presentInfo.swapchainCount     = std::size(swapchains);
-            presentInfo.pSwapchains        = swapchains;
-            presentInfo.pImageIndices      = &imageIndex;
-
-            auto presentQueue{ vkQueuePresentKHR(Context::Get()->GetQueue(DeviceQueues::Family::ePrensent).queue, &presentInfo) };
-            if (presentQueue == VK_ERROR_OUT_OF_DATE_KHR || presentQueue == VK_SUBOPTIMAL_KHR) {
-                swapchain.isValid = false;
+    // ADH_PRESENT_MODE (fifo, mailbox or immediate) and ADH_FRAMES_IN_FLIGHT (1 to 3) override the defaults
+    static FrameSettings GetFrameSettings() {
+        FrameSettings settings;
+        if (auto presentMode{ std::getenv("ADH_PRESENT_MODE") }) {
+            if (!std::strcmp(presentMode, "mailbox")) {
+                settings.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            } else if (!std::strcmp(presentMode, "immediate")) {
+                settings.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
             }
         }
+        if (auto framesInFlight{ std::getenv("ADH_FRAMES_IN_FLIGHT") }) {
+            settings.framesInFlight = static_cast<std::uint32_t>(std::clamp(std::atoi(framesInFlight), 1, static_cast<int>(FrameContext::maxFramesInFlight)));
+        }
+        return settings;
+    }
 
-        currentFrame = ++currentFrame % swapchain.GetImageViewCount();
-        if (currentFrame % swapchain.GetImageViewCount()) {
-            Allocator::Flush();
-            TextureDescriptors::Flush();
+    // ADH_HEADLESS names a scene in Data/Assets/Scenes and runs it without a window. ADH_HEADLESS_FRAMES,
+    // ADH_HEADLESS_DELTA (seconds) and ADH_HEADLESS_SIZE (WxH) override the defaults, ADH_HEADLESS_HASH
+    // logs a hash of the last image and ADH_HEADLESS_CSV writes the GPU profiler results to a file.
+    static HeadlessSettings GetHeadlessSettings() {
+        HeadlessSettings settings;
+        if (auto scene{ std::getenv("ADH_HEADLESS") }) {
+            settings.isEnabled = true;
+            settings.scene     = scene;
+        }
+        if (auto frames{ std::getenv("ADH_HEADLESS_FRAMES") }) {
+            settings.frames = static_cast<std::uint32_t>(std::max(std::atoi(frames), 1));
+        }
+        if (auto deltaTime{ std::getenv("ADH_HEADLESS_DELTA") }) {
+            settings.deltaTime = static_cast<float>(std::atof(deltaTime));
+        }
+        if (auto size{ std::getenv("ADH_HEADLESS_SIZE") }) {
+            unsigned width{}, height{};
+            if (std::sscanf(size, "%ux%u", &width, &height) == 2 && width && height) {
+                settings.extent = { width, height };
+            }
+        }
+        if (std::getenv("ADH_HEADLESS_HASH")) {
+            settings.hash = true;
         }
+        if (auto csvPath{ std::getenv("ADH_HEADLESS_CSV") }) {
+            settings.csvPath = csvPath;
+        }
+        return settings;
+    }
+
+    // One image more than frames in flight, acquiring doesn't wait for the image on screen
+    std::uint32_t GetSwapchainImageCount() const noexcept {
+        return frameSettings.framesInFlight + 1u;
+    }
+
+    // Picked in the editor, headless runs keep the aspect ratio of their images
+    float GetAspectRatioWidth() const noexcept {
+        return headless.isEnabled ? static_cast<float>(headless.extent.width) : editor.GetSelectedAspectRatioWidth();
+    }
+
+    float GetAspectRatioHeight() const noexcept {
+        return headless.isEnabled ? static_cast<float>(headless.extent.height) : editor.GetSelectedAspectRatioHeight();
     }
 
     void
@@ -2058,7 +2219,8 @@ class AdHoc {
             VK_ATTACHMENT_STORE_OP_STORE,
             VK_ATTACHMENT_LOAD_OP_DONT_CARE,
             VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            // Offscreen images are read back instead of presented
+            swapchain.IsOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
             VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             Attachment::Type::eColor);
 
@@ -2091,10 +2253,7 @@ class AdHoc {
             VkAccessFlagBits(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT),
             VK_ACCESS_NONE_KHR);
 
-        VkRect2D renderArea{
-            { 0u, 0u },
-            { (uint32_t)window.GetWindowWidth(), (uint32_t)window.GetWindowHeight() }
-        };
+        VkRect2D renderArea{ { 0u, 0u }, swapchain.GetExtent() };
 
         Array<VkClearValue> clearValues;
         clearValues.Resize(2);
@@ -2108,36 +2267,98 @@ class AdHoc {
         renderPass.UpdateRenderArea({ {}, swapchain.GetExtent() });
     }
 
-    void InitializePipeline() {
-        Shader shader("pbr.vert", "pbr.frag");
+    // Declares every pass of the frame. The swapchain image and the editor viewports are imported,
+    // the editor and swapchain render passes keep synchronizing them.
+    void InitializeRenderGraph() {
+        backbuffer         = renderGraph.ImportImage("Backbuffer");
+        editorViewports[0] = renderGraph.ImportImage("Scene Viewport");
+        editorViewports[1] = renderGraph.ImportImage("Runtime Viewport");
+
+        auto depthFormat{ tools::GetSupportedDepthFormat(Context::Get()->GetPhysicalDevice()) };
+
+        VkClearValue depthClear{};
+        depthClear.depthStencil = { 1.0f, 0 };
+
+        VkClearValue colorClear{};
+        colorClear.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        // Persistent, cached cascades keep their layer over many frames
+        shadowMap.image = renderGraph.CreateImage("Shadow Map", { depthFormat, shadowMap.m_Extent, 1.0f, false, 1u, CascadedShadowMap::cascadeCount });
+        shadowMap.pass  = renderGraph.AddPass(
+            "Shadow Map", [this](VkCommandBuffer cmd, std::uint32_t) { DrawShadowCascades(cmd); },
+            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        renderGraph.Write(shadowMap.pass, shadowMap.image, depthClear);
+
+        hdrBuffer.color = renderGraph.CreateImage("HDR Color", { VK_FORMAT_R32G32B32A32_SFLOAT, {}, 1.0f, true });
+        hdrBuffer.depth = renderGraph.CreateImage("Scene Depth", { depthFormat, {}, 1.0f, true });
+        hdrBuffer.pass  = renderGraph.AddPass(
+            "Scene", [this](VkCommandBuffer cmd, std::uint32_t) { ExecuteCommands(cmd, sceneCommands[0]); },
+            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        renderGraph.Read(hdrBuffer.pass, shadowMap.image);
+        renderGraph.Write(hdrBuffer.pass, hdrBuffer.color, colorClear);
+        renderGraph.Write(hdrBuffer.pass, hdrBuffer.depth, depthClear);
+
+        bloom.AddPass(renderGraph, gpuProfiler, hdrBuffer.color, swapchain.GetExtent());
+
+        hdrDraw.pass = renderGraph.AddPass("Composite", [this](VkCommandBuffer cmd, std::uint32_t frameIndex) {
+            DrawComposite(cmd, frameIndex);
+        });
+        renderGraph.Read(hdrDraw.pass, hdrBuffer.color);
+        renderGraph.Read(hdrDraw.pass, bloom.image);
+        renderGraph.Write(hdrDraw.pass, backbuffer);
+
+        for (std::uint32_t i{}; i != 2u; ++i) {
+            viewportPasses[i] = renderGraph.AddPass(i ? "Runtime Viewport" : "Scene Viewport", [this, i](VkCommandBuffer cmd, std::uint32_t frameIndex) {
+                editor.BeginRenderPass(cmd, frameIndex, i, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                ExecuteCommands(cmd, sceneCommands[i]);
+                editor.EndRenderPass(cmd);
+            });
+            renderGraph.Read(viewportPasses[i], shadowMap.image);
+            renderGraph.Write(viewportPasses[i], editorViewports[i]);
+        }
+
+        editorPass = renderGraph.AddPass("Editor", [this](VkCommandBuffer cmd, std::uint32_t frameIndex) {
+            DrawEditor(cmd, frameIndex);
+        });
+        renderGraph.Read(editorPass, editorViewports[0]);
+        renderGraph.Read(editorPass, editorViewports[1]);
+        renderGraph.Write(editorPass, backbuffer);
+
+        renderGraph.SetOutput(backbuffer);
+        renderGraph.Compile(swapchain.GetExtent());
+    }
+
+    void InitializePipeline(PipelineCompiler& compiler) {
+        auto shader{ MakeUnique<Shader>("pbr.vert", "pbr.frag") };
 
         VertexLayout vertexLayout;
-        vertexLayout.AddBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX);
-        vertexLayout.AddAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, position));
-        vertexLayout.AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, normals));
-        vertexLayout.AddAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, ADH_OFFSET(Vertex, textureCoords));
+        VertexPacker::AddAttributes(vertexLayout, VertexPacker::GetFormat());
         vertexLayout.Create();
 
         pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
         pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
+        pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT);
         pipelineLayout.CreateSet();
 
         pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
         pipelineLayout.AddBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
         pipelineLayout.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+        pipelineLayout.AddBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
         pipelineLayout.CreateSet();
 
-        pipelineLayout.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
-        pipelineLayout.CreateSet();
-
-        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_VERTEX_BIT, sizeof(xmm::Matrix), 0);
-        pipelineLayout.AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(Material), 64);
+        pipelineLayout.AddSetLayout(TextureDescriptors::GetSetLayout());
 
         pipelineLayout.Create();
 
-        graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, renderPass,
-                                VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
-                                VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        compiler.Compile(Move(shader), Move(vertexLayout), [this](const Shader& shader, const VertexLayout& vertexLayout) {
+            graphicsPipeline.Create(shader, vertexLayout, pipelineLayout, renderPass,
+                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                                    VK_SAMPLE_COUNT_1_BIT, VK_FALSE, 0.0f, VK_TRUE);
+        });
     }
 
     void InitializeDescriptorSets() {
@@ -2148,50 +2369,23 @@ class AdHoc {
         directionalLight.color     = { 1.0f, 1.0f, 1.0f };
         directionalLight.intensity = 10.0f;
 
-        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, swapchain.GetImageViewCount());
-        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4);
-        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2);
-        descriptorSet.Create(pipelineLayout.GetSetLayout());
+        descriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, FrameContext::maxFramesInFlight);
+        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 5);
+        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
+        descriptorSet.AddPool(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5);
+        descriptorSet.Create(pipelineLayout.GetSetLayout(), 2u); // Set 2 is the bindless texture table
 
-        viewProjectionBuffer.Create(&viewProjection, sizeof(viewProjection), swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-        descriptorSet.Update(
-            viewProjectionBuffer.GetDescriptor(),
-            0u,                               // descriptor index
-            0u,                               // binding
-            0u,                               // array element
-            1u,                               // array count
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-        );
+        viewProjectionBuffer.Create(&viewProjection, sizeof(viewProjection), FrameContext::maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        UpdateFrameDescriptors(descriptorSet, viewProjectionBuffer, 0u, 0u);
 
-        lightSpaceBuffer.Create(&lightSpace, sizeof(lightSpace), swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-        descriptorSet.Update(
-            lightSpaceBuffer.GetDescriptor(),
-            0u,                               // descriptor index
-            1u,                               // binding
-            0u,                               // array element
-            1u,                               // array count
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-        );
+        lightSpaceBuffer.Create(lightSpace, sizeof(lightSpace), FrameContext::maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        UpdateFrameDescriptors(descriptorSet, lightSpaceBuffer, 0u, 1u);
 
-        fragDataBuffer.Create(&fragmentUbo, sizeof(fragmentUbo), swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-        descriptorSet.Update(
-            fragDataBuffer.GetDescriptor(),
-            1u,                               // descriptor index
-            0u,                               // binding
-            0u,                               // array element
-            1u,                               // array count
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-        );
+        fragDataBuffer.Create(&fragmentUbo, sizeof(fragmentUbo), FrameContext::maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        UpdateFrameDescriptors(descriptorSet, fragDataBuffer, 1u, 0u);
 
-        lightBuffer.Create(&directionalLight, sizeof(directionalLight), swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-        descriptorSet.Update(
-            lightBuffer.GetDescriptor(),
-            1u,                               // descriptor index
-            1u,                               // binding
-            0u,                               // array element
-            1u,                               // array count
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-        );
+        lightBuffer.Create(&directionalLight, sizeof(directionalLight), FrameContext::maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        UpdateFrameDescriptors(descriptorSet, lightBuffer, 1u, 1u);
 
         descriptorSet.Update(
             shadowMap.descriptor,
@@ -2220,48 +2414,21 @@ class AdHoc {
         directionalLight.color     = { 1.0f, 1.0f, 1.0f };
         directionalLight.intensity = 10.0f;
         {
-            editorDescriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, swapchain.GetImageViewCount());
-            editorDescriptorSet.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4);
-            editorDescriptorSet.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2);
-            editorDescriptorSet.Create(pipelineLayout.GetSetLayout());
+            editorDescriptorSet.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, FrameContext::maxFramesInFlight);
+            editorDescriptorSet.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 5);
+            editorDescriptorSet.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
+            editorDescriptorSet.AddPool(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5);
+            editorDescriptorSet.Create(pipelineLayout.GetSetLayout(), 2u); // Set 2 is the bindless texture table
 
             editorViewProjectionBuffer.Create(&editorViewProjection, sizeof(editorViewProjection),
-                                              swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-            editorDescriptorSet.Update(
-                editorViewProjectionBuffer.GetDescriptor(),
-                0u,                               // descriptor index
-                0u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+                                              FrameContext::maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+            UpdateFrameDescriptors(editorDescriptorSet, editorViewProjectionBuffer, 0u, 0u);
 
-            editorDescriptorSet.Update(
-                lightSpaceBuffer.GetDescriptor(),
-                0u,                               // descriptor index
-                1u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+            UpdateFrameDescriptors(editorDescriptorSet, lightSpaceBuffer, 0u, 1u);
 
-            editorDescriptorSet.Update(
-                fragDataBuffer.GetDescriptor(),
-                1u,                               // descriptor index
-                0u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+            UpdateFrameDescriptors(editorDescriptorSet, fragDataBuffer, 1u, 0u);
 
-            editorDescriptorSet.Update(
-                lightBuffer.GetDescriptor(),
-                1u,                               // descriptor index
-                1u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+            UpdateFrameDescriptors(editorDescriptorSet, lightBuffer, 1u, 1u);
 
             editorDescriptorSet.Update(
                 shadowMap.descriptor,
@@ -2282,48 +2449,21 @@ class AdHoc {
             // );
         }
         {
-            editorDescriptorSet2.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, swapchain.GetImageViewCount());
-            editorDescriptorSet2.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4);
-            editorDescriptorSet2.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2);
-            editorDescriptorSet2.Create(pipelineLayout.GetSetLayout());
+            editorDescriptorSet2.Initialize(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, FrameContext::maxFramesInFlight);
+            editorDescriptorSet2.AddPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 5);
+            editorDescriptorSet2.AddPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1);
+            editorDescriptorSet2.AddPool(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5);
+            editorDescriptorSet2.Create(pipelineLayout.GetSetLayout(), 2u); // Set 2 is the bindless texture table
 
             editorViewProjectionBuffer2.Create(&editorViewProjection2, sizeof(editorViewProjection2),
-                                               swapchain.GetImageViewCount(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-            editorDescriptorSet2.Update(
-                editorViewProjectionBuffer2.GetDescriptor(),
-                0u,                               // descriptor index
-                0u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+                                               FrameContext::maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+            UpdateFrameDescriptors(editorDescriptorSet2, editorViewProjectionBuffer2, 0u, 0u);
 
-            editorDescriptorSet2.Update(
-                lightSpaceBuffer.GetDescriptor(),
-                0u,                               // descriptor index
-                1u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+            UpdateFrameDescriptors(editorDescriptorSet2, lightSpaceBuffer, 0u, 1u);
 
-            editorDescriptorSet2.Update(
-                fragDataBuffer.GetDescriptor(),
-                1u,                               // descriptor index
-                0u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+            UpdateFrameDescriptors(editorDescriptorSet2, fragDataBuffer, 1u, 0u);
 
-            editorDescriptorSet2.Update(
-                lightBuffer.GetDescriptor(),
-                1u,                               // descriptor index
-                1u,                               // binding
-                0u,                               // array element
-                1u,                               // array count
-                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER // type
-            );
+            UpdateFrameDescriptors(editorDescriptorSet2, lightBuffer, 1u, 1u);
 
             editorDescriptorSet2.Update(
                 shadowMap.descriptor,
@@ -2356,23 +2496,6 @@ class AdHoc {
         }
     }
 
-    void InitializeSyncData() {
-        auto info{ initializers::FenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT) };
-        fence2.Resize(swapchain.GetImageViewCount());
-        for (int i{}; i != swapchain.GetImageViewCount(); ++i) {
-            ADH_THROW(vkCreateFence(Context::Get()->GetDevice(), &info, nullptr, &fence1.EmplaceBack()) == VK_SUCCESS,
-                      "Failed to create fence!");
-        }
-
-        auto info2{ initializers::SemaphoreCreateInfo() };
-        for (std::size_t i{}; i != swapchain.GetImageViewCount(); ++i) {
-            ADH_THROW(vkCreateSemaphore(Context::Get()->GetDevice(), &info2, nullptr, &presentSempahore.EmplaceBack()) == VK_SUCCESS,
-                      "Failed to create semaphore!");
-            ADH_THROW(vkCreateSemaphore(Context::Get()->GetDevice(), &info2, nullptr, &renderSemaphore.EmplaceBack()) == VK_SUCCESS,
-                      "Failed to create semaphore!");
-        }
-    }
-
     void InitializeScripting() {
         ScriptHandler::input = &input;
         ScriptHandler::scene = &scene;
@@ -2469,10 +2592,7 @@ class AdHoc {
         editor.CreateRenderPass(attachment, subpass, renderArea, Move(clearValues));
 
         VertexLayout vertexLayout;
-        vertexLayout.AddBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX);
-        vertexLayout.AddAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, position));
-        vertexLayout.AddAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, ADH_OFFSET(Vertex, normals));
-        vertexLayout.AddAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, ADH_OFFSET(Vertex, textureCoords));
+        VertexPacker::AddAttributes(vertexLayout, VertexPacker::GetFormat());
         vertexLayout.Create();
 
         Shader shader("pbr.vert", "editor_pbr.frag");
@@ -2499,12 +2619,22 @@ class AdHoc {
     }
 
     void RecreateSwapchain() {
+        frameContext.WaitIdle();
         swapchain.Destroy();
         swapchainFramebuffers.Clear();
 
-        swapchain.Create(swapchanImageCount, VK_FORMAT_B8G8R8A8_UNORM, VK_PRESENT_MODE_FIFO_KHR);
+        swapchain.Create(GetSwapchainImageCount(), VK_FORMAT_B8G8R8A8_UNORM, frameSettings.presentMode);
         InitializeFramebuffers();
 
+        // Per-frame copies already exist for every frame count, only the sync objects change
+        if (frameSettings.framesInFlight != frameContext.GetFrameCount()) {
+            frameContext.Destroy();
+            frameContext.Create(frameSettings.framesInFlight, swapchain.GetImageViewCount());
+        } else {
+            frameContext.Resize(swapchain.GetImageViewCount());
+        }
+        appliedFrameSettings = frameSettings;
+
         renderPass.UpdateRenderArea({ {}, swapchain.GetExtent() });
 
         clearFramebuffers      = true;
@@ -2512,12 +2642,11 @@ class AdHoc {
 
         // hdrDraw.Update(hdrBuffer.descriptor);
 
-        currentFrame = 0;
-        imageIndex   = 0;
-
-        hdrBuffer.Recreate(swapchain);
-        gaussianBlur.Recreate(swapchain, hdrBuffer.descriptor);
-        hdrDraw.Update(hdrBuffer.descriptor, gaussianBlur.finalPassdescriptor);
+        renderGraph.Resize(swapchain.GetExtent());
+        bloom.UpdateDescriptors(renderGraph, sampler, hdrBuffer.color);
+        auto hdrDescriptor{ renderGraph.GetDescriptor(hdrBuffer.color, sampler) };
+        auto bloomDescriptor{ renderGraph.GetDescriptor(bloom.image, sampler) };
+        hdrDraw.Update(hdrDescriptor, bloomDescriptor);
 
         // hdrDraw.Update(gaussianBlur.finalPassdescriptor);
         // hdrDraw.Create(renderPass, gaussianBlur.brightColor.imageInfo[1]);
@@ -10,7 +10,8 @@
 #include <array>
 
 namespace adh {
-    Window::Window() noexcept : m_Connection{},
+    Window::Window() noexcept : m_Display{},
+                                m_Connection{},
                                 m_Screen{},
                                 m_Window{},
                                 m_Name{},
@@ -263,7 +264,12 @@ namespace adh {
     }
 
     void Window::Clear() noexcept {
-        xcb_destroy_window(m_Connection, m_Window);
-        XCloseDisplay(m_Display);
+        // Headless runs never create the window
+        if (m_Display) {
+            xcb_destroy_window(m_Connection, m_Window);
+            XCloseDisplay(m_Display);
+            m_Display    = nullptr;
+            m_Connection = nullptr;
+        }
     }
 } // namespace adh
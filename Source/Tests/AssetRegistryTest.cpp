@@ -0,0 +1,186 @@
+#include "Test.hpp"
+#include <Asset/AssetRegistry.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+
+using namespace adh;
+
+namespace {
+    constexpr std::uint32_t frameCount{ 3u };
+
+    struct Texture {
+        int id;
+    };
+
+    struct Sound {
+        int id;
+    };
+
+    template <typename T>
+    SharedPtr<T> Insert(AssetRegistry& registry, const std::string& path, std::uint64_t hash, std::size_t size, int id) {
+        return registry.Insert<T>(path, hash, size, [id]() { return MakeShared<T>(T{ id }); });
+    }
+
+    // Past the frames an unused asset is kept for
+    void Advance(AssetRegistry& registry, std::uint32_t count = frameCount + 1u) {
+        for (std::uint32_t i{}; i != count; ++i) {
+            registry.Update();
+        }
+    }
+
+    void TestFindCountsHitsAndMisses() {
+        AssetRegistry registry;
+        registry.Create(frameCount, 1000u);
+        ADH_CHECK(!registry.Find<Texture>("a.png"));
+        auto texture{ Insert<Texture>(registry, "a.png", 1u, 10u, 1) };
+        auto found{ registry.Find<Texture>("a.png") };
+        ADH_CHECK(found && found.Get() == texture.Get());
+
+        // Same path, other type
+        ADH_CHECK(!registry.Find<Sound>("a.png"));
+
+        const auto& statistics{ registry.GetStatistics() };
+        ADH_CHECK(statistics.hits == 1u);
+        ADH_CHECK(statistics.misses == 2u);
+        ADH_CHECK(statistics.assetCount == 1u);
+        ADH_CHECK(statistics.residentBytes == 10u);
+    }
+
+    void TestEqualContentsAreShared() {
+        AssetRegistry registry;
+        registry.Create(frameCount, 1000u);
+        auto first{ Insert<Texture>(registry, "a.png", 42u, 10u, 1) };
+        bool isCreated{};
+        auto copy{ registry.Insert<Texture>("copy/a.png", 42u, 10u, [&isCreated]() {
+            isCreated = true;
+            return MakeShared<Texture>(Texture{ 2 });
+        }) };
+        ADH_CHECK(!isCreated);
+        ADH_CHECK(copy.Get() == first.Get());
+        ADH_CHECK(registry.Find<Texture>("copy/a.png").Get() == first.Get());
+
+        // Zero is no hash, nothing is compared
+        auto other{ Insert<Texture>(registry, "b.png", 0u, 10u, 3) };
+        auto another{ Insert<Texture>(registry, "c.png", 0u, 10u, 4) };
+        ADH_CHECK(other.Get() != another.Get());
+
+        // Found by path again, a hit rather than a duplicate
+        ADH_CHECK(Insert<Texture>(registry, "copy/a.png", 42u, 10u, 5).Get() == first.Get());
+
+        const auto& statistics{ registry.GetStatistics() };
+        ADH_CHECK(statistics.duplicates == 1u);
+        ADH_CHECK(statistics.hits == 2u);
+        ADH_CHECK(statistics.assetCount == 3u);
+        ADH_CHECK(statistics.residentBytes == 30u);
+    }
+
+    void TestOtherSizeOrTypeIsNotShared() {
+        AssetRegistry registry;
+        registry.Create(frameCount, 1000u);
+        auto first{ Insert<Texture>(registry, "a.png", 42u, 10u, 1) };
+
+        // A colliding hash with another size is other contents
+        auto larger{ Insert<Texture>(registry, "b.png", 42u, 20u, 2) };
+        ADH_CHECK(larger.Get() != first.Get());
+        ADH_CHECK(larger->id == 2);
+
+        // Another type with the same hash and size is its own asset
+        auto sound{ Insert<Sound>(registry, "a.wav", 42u, 10u, 3) };
+        ADH_CHECK(sound->id == 3);
+
+        // Both stay reachable by contents
+        ADH_CHECK(Insert<Texture>(registry, "copy/b.png", 42u, 20u, 4).Get() == larger.Get());
+        ADH_CHECK(Insert<Sound>(registry, "copy/a.wav", 42u, 10u, 5).Get() == sound.Get());
+
+        const auto& statistics{ registry.GetStatistics() };
+        ADH_CHECK(statistics.duplicates == 2u);
+        ADH_CHECK(statistics.assetCount == 3u);
+        ADH_CHECK(statistics.residentBytes == 40u);
+    }
+
+    void TestLeastRecentlyUsedIsEvicted() {
+        AssetRegistry registry;
+        registry.Create(frameCount, 100u);
+        auto a{ Insert<Texture>(registry, "a.png", 1u, 40u, 1) };
+        auto b{ Insert<Texture>(registry, "b.png", 2u, 40u, 2) };
+        auto c{ Insert<Texture>(registry, "c.png", 3u, 40u, 3) };
+        a.Delete();
+        b.Delete();
+        c.Delete();
+
+        // a is used again after the others, b is the oldest
+        Advance(registry, 1u);
+        registry.Find<Texture>("a.png");
+        registry.Find<Texture>("c.png");
+        Advance(registry, 1u);
+        registry.Find<Texture>("a.png");
+
+        Advance(registry);
+        ADH_CHECK(!registry.Find<Texture>("b.png"));
+        ADH_CHECK(registry.Find<Texture>("a.png"));
+        ADH_CHECK(registry.Find<Texture>("c.png"));
+
+        // Only as much as the budget needs
+        const auto& statistics{ registry.GetStatistics() };
+        ADH_CHECK(statistics.evictions == 1u);
+        ADH_CHECK(statistics.residentBytes == 80u);
+        ADH_CHECK(statistics.assetCount == 2u);
+    }
+
+    void TestUsedAssetsAreKept() {
+        AssetRegistry registry;
+        registry.Create(frameCount, 50u);
+        auto a{ Insert<Texture>(registry, "a.png", 1u, 40u, 1) };
+        auto b{ Insert<Sound>(registry, "b.wav", 2u, 40u, 2) };
+        Advance(registry, 10u);
+        ADH_CHECK(registry.GetStatistics().assetCount == 2u);
+        ADH_CHECK(registry.GetStatistics().evictions == 0u);
+
+        // Kept while a frame in flight may still read it
+        b.Delete();
+        Advance(registry, frameCount);
+        ADH_CHECK(registry.GetStatistics().assetCount == 2u);
+        Advance(registry, 1u);
+        ADH_CHECK(registry.GetStatistics().assetCount == 1u);
+        ADH_CHECK(registry.Find<Texture>("a.png").Get() == a.Get());
+        ADH_CHECK(!registry.Find<Sound>("b.wav"));
+    }
+
+    void TestSetSizeAndRemove() {
+        AssetRegistry registry;
+        registry.Create(frameCount, 1000u);
+        auto a{ Insert<Texture>(registry, "a.png", 1u, 0u, 1) };
+        auto b{ Insert<Texture>(registry, "b.png", 2u, 10u, 2) };
+        auto c{ Insert<Sound>(registry, "c.wav", 3u, 10u, 3) };
+        registry.SetSize("a.png", 25u);
+        ADH_CHECK(registry.GetStatistics().residentBytes == 45u);
+
+        // Not removed while the path refers to another asset
+        registry.Remove<Texture>("a.png", b.Get());
+        ADH_CHECK(registry.Find<Texture>("a.png"));
+        registry.Remove<Texture>("a.png", a.Get());
+        ADH_CHECK(!registry.Find<Texture>("a.png"));
+        ADH_CHECK(a->id == 1);
+
+        registry.Clear<Texture>();
+        ADH_CHECK(!registry.Find<Texture>("b.png"));
+        ADH_CHECK(registry.Find<Sound>("c.wav"));
+        ADH_CHECK(registry.GetStatistics().assetCount == 1u);
+        ADH_CHECK(registry.GetStatistics().residentBytes == 10u);
+    }
+} // namespace
+
+int main() {
+#if !defined(_WIN32)
+    // The budgets are the tests'
+    unsetenv("ADH_ASSET_BUDGET_MB");
+#endif
+    TestFindCountsHitsAndMisses();
+    TestEqualContentsAreShared();
+    TestOtherSizeOrTypeIsNotShared();
+    TestLeastRecentlyUsedIsEvicted();
+    TestUsedAssetsAreKept();
+    TestSetSizeAndRemove();
+    return test::GetResult();
+}
@@ -0,0 +1,248 @@
+#include "Test.hpp"
+#include <Asset/BlockCompressor.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace adh;
+
+namespace {
+    using Pixels = std::vector<std::uint8_t>;
+
+    struct Error {
+        double rms;
+        int max;
+    };
+
+    void From565(std::uint16_t value, int* color) {
+        int r{ value >> 11 };
+        int g{ (value >> 5) & 63 };
+        int b{ value & 31 };
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Reference BC1 colour block decoder, writes rgb of the 16 pixels and returns false for a
+    // three colour block that uses the transparent entry. BC3 colour blocks always have four.
+    bool DecodeColor(const std::uint8_t* block, std::uint8_t* pixels, bool isBC3) {
+        std::uint16_t c0, c1;
+        std::uint32_t indices;
+        std::memcpy(&c0, block, 2u);
+        std::memcpy(&c1, block + 2u, 2u);
+        std::memcpy(&indices, block + 4u, 4u);
+        int palette[4][3];
+        From565(c0, palette[0]);
+        From565(c1, palette[1]);
+        auto isFourColor{ isBC3 || c0 > c1 };
+        for (int c{}; c != 3; ++c) {
+            if (isFourColor) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        bool isOpaque{ true };
+        for (std::uint32_t i{}; i != 16u; ++i) {
+            auto index{ (indices >> (i * 2u)) & 3u };
+            isOpaque = isOpaque && (isFourColor || index != 3u);
+            for (int c{}; c != 3; ++c) {
+                pixels[i * 4u + c] = static_cast<std::uint8_t>(palette[index][c]);
+            }
+        }
+        return isOpaque;
+    }
+
+    // Reference BC4 block decoder into one channel of the 16 pixels
+    void DecodeChannel(const std::uint8_t* block, std::uint8_t* pixels, std::uint32_t channel) {
+        int a0{ block[0] };
+        int a1{ block[1] };
+        std::uint64_t indices{};
+        std::memcpy(&indices, block + 2u, 6u);
+        int palette[8]{ a0, a1 };
+        for (int i{ 1 }; i != 7; ++i) {
+            palette[i + 1] = a0 > a1 ? ((7 - i) * a0 + i * a1) / 7 : i < 5 ? ((5 - i) * a0 + i * a1) / 5 : (i == 5 ? 0 : 255);
+        }
+        for (std::uint32_t i{}; i != 16u; ++i) {
+            pixels[i * 4u + channel] = static_cast<std::uint8_t>(palette[(indices >> (i * 3u)) & 7u]);
+        }
+    }
+
+    // Decodes width x height pixels, false if a BC1 block uses the transparent entry
+    bool Decode(BlockCompressor::Format format, const std::uint8_t* blocks, std::uint32_t width, std::uint32_t height, Pixels& pixels) {
+        pixels.assign(std::size_t{ 4u } * width * height, 255u);
+        bool isOpaque{ true };
+        for (std::uint32_t y{}; y < height; y += 4u) {
+            for (std::uint32_t x{}; x < width; x += 4u) {
+                std::uint8_t block[64];
+                std::memset(block, 255, sizeof(block));
+                if (format == BlockCompressor::Format::eBC3) {
+                    DecodeChannel(blocks, block, 3u);
+                    isOpaque = DecodeColor(blocks + 8u, block, true) && isOpaque;
+                } else {
+                    isOpaque = DecodeColor(blocks, block, false) && isOpaque;
+                }
+                blocks += BlockCompressor::GetBlockSize(format);
+                for (std::uint32_t row{}; row != 4u && y + row < height; ++row) {
+                    for (std::uint32_t column{}; column != 4u && x + column < width; ++column) {
+                        std::memcpy(&pixels[(std::size_t{ y + row } * width + x + column) * 4u], block + (row * 4u + column) * 4u, 4u);
+                    }
+                }
+            }
+        }
+        return isOpaque;
+    }
+
+    Error GetError(const Pixels& expected, const Pixels& actual, std::uint32_t channelCount) {
+        double sum{};
+        int max{};
+        std::size_t count{};
+        for (std::size_t i{}; i != expected.size(); ++i) {
+            if (i % 4u >= channelCount) {
+                continue;
+            }
+            auto d{ std::abs(expected[i] - actual[i]) };
+            sum += d * d;
+            max = std::max(max, d);
+            ++count;
+        }
+        return { std::sqrt(sum / static_cast<double>(count)), max };
+    }
+
+    Pixels RoundTrip(BlockCompressor::Format format, const Pixels& pixels, std::uint32_t width, std::uint32_t height, bool& isOpaque) {
+        std::vector<std::uint8_t> blocks(BlockCompressor::GetSize(format, width, height));
+        BlockCompressor::Compress(format, pixels.data(), width, height, blocks.data());
+        Pixels result;
+        isOpaque = Decode(format, blocks.data(), width, height, result);
+        return result;
+    }
+
+    // Smooth colour ramps, what most texture blocks look like
+    Pixels MakeGradient(std::uint32_t width, std::uint32_t height) {
+        Pixels pixels(std::size_t{ 4u } * width * height);
+        for (std::uint32_t y{}; y != height; ++y) {
+            for (std::uint32_t x{}; x != width; ++x) {
+                auto pixel{ &pixels[(std::size_t{ y } * width + x) * 4u] };
+                pixel[0] = static_cast<std::uint8_t>(x * 255u / (width - 1u));
+                pixel[1] = static_cast<std::uint8_t>(y * 255u / (height - 1u));
+                pixel[2] = static_cast<std::uint8_t>(128u + 64.0 * std::sin((x + y) * 0.1));
+                pixel[3] = static_cast<std::uint8_t>((x + y) * 255u / (width + height - 2u));
+            }
+        }
+        return pixels;
+    }
+
+    void TestGetSize() {
+        ADH_CHECK(BlockCompressor::GetSize(BlockCompressor::Format::eBC1, 4u, 4u) == 8u);
+        ADH_CHECK(BlockCompressor::GetSize(BlockCompressor::Format::eBC3, 4u, 4u) == 16u);
+        // Partial blocks at the edges are whole blocks
+        ADH_CHECK(BlockCompressor::GetSize(BlockCompressor::Format::eBC1, 5u, 3u) == 16u);
+        ADH_CHECK(BlockCompressor::GetSize(BlockCompressor::Format::eBC3, 1u, 1u) == 16u);
+        ADH_CHECK(BlockCompressor::GetSize(BlockCompressor::Format::eBC7, 64u, 64u) == 4096u);
+    }
+
+    void TestFlatColor() {
+        // Only the 565 rounding is lost, and no BC1 block may use the transparent entry
+        for (auto format : { BlockCompressor::Format::eBC1, BlockCompressor::Format::eBC3 }) {
+            Pixels pixels(4u * 8u * 8u);
+            for (std::size_t i{}; i != pixels.size(); i += 4u) {
+                pixels[i]      = 200u;
+                pixels[i + 1u] = 13u;
+                pixels[i + 2u] = 97u;
+                pixels[i + 3u] = 255u;
+            }
+            bool isOpaque;
+            auto result{ RoundTrip(format, pixels, 8u, 8u, isOpaque) };
+            ADH_CHECK(isOpaque);
+            ADH_CHECK(GetError(pixels, result, 3u).max <= 4);
+            ADH_CHECK(GetError(pixels, result, 4u).max <= 4);
+        }
+    }
+
+    void TestGradientErrorBound() {
+        auto pixels{ MakeGradient(64u, 64u) };
+        bool isOpaque;
+        auto bc1{ GetError(pixels, RoundTrip(BlockCompressor::Format::eBC1, pixels, 64u, 64u, isOpaque), 3u) };
+        ADH_CHECK(isOpaque);
+        ADH_CHECK(bc1.rms < 5.0);
+        ADH_CHECK(bc1.max <= 16);
+
+        auto bc3Pixels{ RoundTrip(BlockCompressor::Format::eBC3, pixels, 64u, 64u, isOpaque) };
+        auto bc3{ GetError(pixels, bc3Pixels, 3u) };
+        ADH_CHECK(isOpaque);
+        ADH_CHECK(bc3.rms < 5.0);
+        ADH_CHECK(bc3.max <= 16);
+
+        // Eight alpha levels between exact ends
+        Pixels alpha(pixels.size());
+        Pixels bc3Alpha(pixels.size());
+        for (std::size_t i{ 3u }; i < pixels.size(); i += 4u) {
+            alpha[i]    = pixels[i];
+            bc3Alpha[i] = bc3Pixels[i];
+        }
+        auto alphaError{ GetError(alpha, bc3Alpha, 4u) };
+        ADH_CHECK(alphaError.rms < 1.0);
+        ADH_CHECK(alphaError.max <= 3);
+    }
+
+    void TestNoiseErrorBound() {
+        // Worst case for two endpoints, still well under the 74 of guessing the middle grey
+        std::mt19937 random{ 7u };
+        Pixels pixels(4u * 32u * 32u);
+        for (auto& value : pixels) {
+            value = static_cast<std::uint8_t>(random());
+        }
+        bool isOpaque;
+        auto bc3{ GetError(pixels, RoundTrip(BlockCompressor::Format::eBC3, pixels, 32u, 32u, isOpaque), 3u) };
+        ADH_CHECK(isOpaque);
+        ADH_CHECK(bc3.rms < 65.0);
+    }
+
+    void TestCutoutAlphaIsExact() {
+        // Both alpha ends are kept exact, a cutout stays a cutout
+        Pixels pixels(4u * 8u * 8u);
+        for (std::uint32_t i{}; i != 64u; ++i) {
+            pixels[i * 4u]      = static_cast<std::uint8_t>(i * 4u);
+            pixels[i * 4u + 1u] = 100u;
+            pixels[i * 4u + 2u] = 50u;
+            pixels[i * 4u + 3u] = ((i / 8u + i) & 1u) ? 255u : 0u;
+        }
+        bool isOpaque;
+        auto result{ RoundTrip(BlockCompressor::Format::eBC3, pixels, 8u, 8u, isOpaque) };
+        for (std::uint32_t i{}; i != 64u; ++i) {
+            ADH_CHECK(result[i * 4u + 3u] == pixels[i * 4u + 3u]);
+        }
+    }
+
+    void TestPartialBlocks() {
+        // 5x3 reads past neither edge and the pixels inside the image keep the full size bound
+        auto gradient{ MakeGradient(64u, 64u) };
+        Pixels pixels;
+        for (std::uint32_t y{}; y != 3u; ++y) {
+            pixels.insert(pixels.end(), gradient.begin() + y * 64u * 4u, gradient.begin() + (y * 64u + 5u) * 4u);
+        }
+        for (auto format : { BlockCompressor::Format::eBC1, BlockCompressor::Format::eBC3 }) {
+            bool isOpaque;
+            auto result{ RoundTrip(format, pixels, 5u, 3u, isOpaque) };
+            ADH_CHECK(isOpaque);
+            ADH_CHECK(GetError(pixels, result, 3u).max <= 16);
+        }
+    }
+} // namespace
+
+int main() {
+    TestGetSize();
+    TestFlatColor();
+    TestGradientErrorBound();
+    TestNoiseErrorBound();
+    TestCutoutAlphaIsExact();
+    TestPartialBlocks();
+    return test::GetResult();
+}
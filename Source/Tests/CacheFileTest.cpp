@@ -0,0 +1,138 @@
+#include "Test.hpp"
+#include <Asset/CacheFile.hpp>
+#include <Std/VirtualFileSystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace adh;
+
+namespace {
+    using Bytes = std::vector<std::uint8_t>;
+
+    // Source at offset 8, after a made up magic
+    struct Header {
+        std::uint64_t magic;
+        CacheFile::Source source;
+    };
+
+    constexpr std::uint64_t magic{ 0x1234u };
+
+    void WriteFile(const std::string& path, const std::string& text) {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file << text;
+    }
+
+    Bytes ReadFile(const std::string& path) {
+        std::ifstream file{ path, std::ios::binary };
+        return Bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    void Touch(const std::string& path) {
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds{ 10 });
+    }
+
+    bool Cook(const std::string& sourcePath, const std::string& cachePath, const Bytes& payload) {
+        Header header{ magic };
+        return CacheFile::GetSource(sourcePath, header.source) &&
+               CacheFile::Write(cachePath, { { 0u, &header, sizeof(Header) }, { 64u, payload.data(), payload.size() } });
+    }
+
+    bool Validate(const std::string& sourcePath, const std::string& cachePath) {
+        MappedFile cache;
+        return VirtualFileSystem::Open(cachePath, cache) && CacheFile::Validate(sourcePath, cachePath, offsetof(Header, source), cache);
+    }
+
+    void TestGetPath() {
+        auto path{ CacheFile::GetPath("Data/", "Data/Models/Rock.obj", "MeshCache", ".adhmesh") };
+        ADH_CHECK(path.starts_with("Data/Resources/MeshCache/Rock.obj."));
+        ADH_CHECK(path.ends_with(".adhmesh"));
+        // Keyed on the path below the data directory, not only the file name
+        ADH_CHECK(path != CacheFile::GetPath("Data/", "Data/Props/Rock.obj", "MeshCache", ".adhmesh"));
+        ADH_CHECK(path == CacheFile::GetPath("Data/", "Data/Models/Rock.obj", "MeshCache", ".adhmesh"));
+    }
+
+    void TestWriteLayout(const std::string& directory) {
+        auto sourcePath{ directory + "/Source.txt" };
+        auto cachePath{ directory + "/Cache/Source.bin" };
+        WriteFile(sourcePath, "source");
+        Bytes payload{ 1u, 2u, 3u };
+        ADH_CHECK(Cook(sourcePath, cachePath, payload));
+
+        // Header, zeros up to the payload offset and the payload, no temp file left behind
+        auto bytes{ ReadFile(cachePath) };
+        ADH_CHECK(bytes.size() == 67u);
+        Header header;
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+        ADH_CHECK(header.magic == magic);
+        ADH_CHECK(header.source.size == 6u);
+        ADH_CHECK(header.source.hash == CacheFile::HashFile(sourcePath));
+        ADH_CHECK(std::all_of(bytes.begin() + sizeof(Header), bytes.begin() + 64, [](auto byte) { return !byte; }));
+        ADH_CHECK(Bytes(bytes.begin() + 64, bytes.end()) == payload);
+        ADH_CHECK(std::distance(std::filesystem::directory_iterator{ directory + "/Cache" }, {}) == 1);
+    }
+
+    void TestValidate(const std::string& directory) {
+        auto sourcePath{ directory + "/Source.txt" };
+        auto cachePath{ directory + "/Source.bin" };
+        WriteFile(sourcePath, "source");
+        Bytes payload{ 7u, 8u };
+        ADH_CHECK(Cook(sourcePath, cachePath, payload));
+        ADH_CHECK(Validate(sourcePath, cachePath));
+
+        // Only the time moved on, the cache is kept and written again with the new time
+        Touch(sourcePath);
+        MappedFile cache;
+        ADH_CHECK(VirtualFileSystem::Open(cachePath, cache));
+        ADH_CHECK(CacheFile::Validate(sourcePath, cachePath, offsetof(Header, source), cache));
+        ADH_CHECK(cache.GetSize() == 66u);
+        ADH_CHECK(!std::memcmp(static_cast<const char*>(cache.GetData()) + 64, payload.data(), payload.size()));
+        cache.Close();
+        CacheFile::Source source;
+        ADH_CHECK(CacheFile::GetSource(sourcePath, source));
+        Header header;
+        std::memcpy(&header, ReadFile(cachePath).data(), sizeof(Header));
+        ADH_CHECK(header.source.time == source.time);
+        ADH_CHECK(std::distance(std::filesystem::directory_iterator{ directory }, {}) == 2);
+
+        // Same size, other contents
+        WriteFile(sourcePath, "SOURCE");
+        Touch(sourcePath);
+        ADH_CHECK(!Validate(sourcePath, cachePath));
+
+        // Other size
+        ADH_CHECK(Cook(sourcePath, cachePath, payload));
+        WriteFile(sourcePath, "source!");
+        ADH_CHECK(!Validate(sourcePath, cachePath));
+
+        // Missing source, truncated cache
+        ADH_CHECK(Cook(sourcePath, cachePath, payload));
+        std::filesystem::remove(sourcePath);
+        ADH_CHECK(!Validate(sourcePath, cachePath));
+        WriteFile(sourcePath, "source!");
+        WriteFile(cachePath, "short");
+        ADH_CHECK(!Validate(sourcePath, cachePath));
+    }
+} // namespace
+
+int main() {
+    auto directory{ (std::filesystem::temp_directory_path() / "AdHocCacheFileTest").string() };
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory + "/Layout");
+    std::filesystem::create_directories(directory + "/Validate");
+
+    TestGetPath();
+    TestWriteLayout(directory + "/Layout");
+    TestValidate(directory + "/Validate");
+
+    std::filesystem::remove_all(directory);
+    return test::GetResult();
+}
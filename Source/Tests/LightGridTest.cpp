@@ -0,0 +1,190 @@
+#include "Test.hpp"
+#include <Scene/LightGrid.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace adh;
+
+namespace {
+    constexpr float nearZ{ 0.5f };
+    constexpr float farZ{ 100.0f };
+
+    struct Camera {
+        Vector3D eye;
+        Vector3D focus;
+    };
+
+    // Straight down +z, and one turned away from every axis
+    const Camera cameras[]{
+        { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+        { { 4.0f, -2.0f, 7.0f }, { -3.0f, 1.0f, -5.0f } },
+    };
+
+    struct Cell {
+        std::uint32_t x;
+        std::uint32_t y;
+        std::uint32_t z;
+    };
+
+    std::uint32_t GetIndex(const Cell& cell) {
+        return (cell.z * LightGrid::gridY + cell.y) * LightGrid::gridX + cell.x;
+    }
+
+    // The cluster pbr.frag looks a world position up in, false if it's off screen or out of the depth range
+    bool GetShaderCell(const ClusterData& data, const Vector3D& position, Cell& cell) {
+        auto clip{ xmm::Vector{ position[0], position[1], position[2], 1.0f } * data.viewProjection };
+        if (clip.w <= data.depthSlicing[0] || clip.w >= data.depthSlicing[1]) {
+            return false;
+        }
+        const float ndc[]{ clip.x / clip.w, clip.y / clip.w };
+        if (std::abs(ndc[0]) > 1.0f || std::abs(ndc[1]) > 1.0f) {
+            return false;
+        }
+        auto tile{ [](float ndc, std::uint32_t size) {
+            return static_cast<std::uint32_t>(std::clamp((ndc * 0.5f + 0.5f) * size, 0.0f, static_cast<float>(size - 1u)));
+        } };
+        cell.x = tile(ndc[0], LightGrid::gridX);
+        cell.y = tile(ndc[1], LightGrid::gridY);
+        cell.z = static_cast<std::uint32_t>(std::clamp(std::log(clip.w) * data.depthSlicing[2] + data.depthSlicing[3], 0.0f,
+                                                       static_cast<float>(LightGrid::gridZ - 1u)));
+        return true;
+    }
+
+    bool Contains(const LightGrid& grid, std::uint32_t clusterIndex, std::uint32_t light) {
+        const auto& cluster{ grid.GetClusters(0u)[clusterIndex] };
+        const auto& indices{ grid.GetIndices(0u) };
+        for (std::uint32_t i{}; i != cluster.count; ++i) {
+            if (indices[cluster.offset + i] == light) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // First and last depth slice holding any light, false if every cluster is empty
+    bool GetSliceRange(const LightGrid& grid, std::uint32_t& first, std::uint32_t& last) {
+        first = LightGrid::gridZ;
+        last  = 0u;
+        for (std::uint32_t i{}; i != LightGrid::clusterCount; ++i) {
+            if (grid.GetClusters(0u)[i].count) {
+                auto slice{ i / (LightGrid::gridX * LightGrid::gridY) };
+                first = std::min(first, slice);
+                last  = std::max(last, slice);
+            }
+        }
+        return first != LightGrid::gridZ;
+    }
+
+    // Bins one light at distance along the view direction of the camera
+    LightGrid BinLight(const Camera& camera, float distance, float radius, Vector3D& center) {
+        LightGrid grid{ 1u, 64u };
+        grid.SetView(0u, xmm::LookAtLH(camera.eye, camera.focus, Vector3D{ 0.0f, 1.0f, 0.0f }),
+                     xmm::PerspectiveLH(1.0f, 16.0f / 9.0f, nearZ, farZ), nearZ, farZ);
+        center = camera.eye + Normalize(camera.focus - camera.eye) * distance;
+        Array<LightData> lights;
+        auto& light{ lights.EmplaceBack() };
+        light          = {};
+        light.position = xmm::Vector{ center[0], center[1], center[2], radius };
+        grid.Bin(lights);
+        return grid;
+    }
+
+    // Every point of the sphere the shader can look up finds the light in its cluster
+    void CheckCoverage(const LightGrid& grid, const Vector3D& center, float radius) {
+        std::mt19937 random{ 5u };
+        std::uniform_real_distribution<float> offset{ -1.0f, 1.0f };
+        std::uint32_t tested{};
+        for (std::uint32_t i{}; i != 2000u; ++i) {
+            Vector3D direction{ offset(random), offset(random), offset(random) };
+            if (Magnitude(direction) > 1.0f) {
+                continue;
+            }
+            Cell cell;
+            if (GetShaderCell(grid.GetData(0u), center + direction * (radius * 0.999f), cell)) {
+                ++tested;
+                ADH_CHECK(Contains(grid, GetIndex(cell), 0u));
+            }
+        }
+        ADH_CHECK(tested > 100u);
+    }
+
+    void TestNearSlice() {
+        for (const auto& camera : cameras) {
+            Vector3D center;
+            auto grid{ BinLight(camera, nearZ + 0.05f, 0.02f, center) };
+            std::uint32_t first, last;
+            ADH_CHECK(GetSliceRange(grid, first, last));
+            ADH_CHECK(first == 0u && last == 0u);
+            ADH_CHECK(Contains(grid, GetIndex({ LightGrid::gridX / 2u, LightGrid::gridY / 2u, 0u }), 0u));
+            // A small light covers a few tiles, not the whole screen
+            ADH_CHECK(grid.GetIndices(0u).GetSize() < LightGrid::gridX * LightGrid::gridY / 4u);
+            ADH_CHECK(grid.GetData(0u).gridSize[3] == 1u);
+            CheckCoverage(grid, center, 0.02f);
+        }
+    }
+
+    void TestFarSlice() {
+        for (const auto& camera : cameras) {
+            Vector3D center;
+            auto grid{ BinLight(camera, farZ - 1.0f, 0.5f, center) };
+            std::uint32_t first, last;
+            ADH_CHECK(GetSliceRange(grid, first, last));
+            ADH_CHECK(first == LightGrid::gridZ - 1u && last == LightGrid::gridZ - 1u);
+            ADH_CHECK(Contains(grid, GetIndex({ LightGrid::gridX / 2u, LightGrid::gridY / 2u, LightGrid::gridZ - 1u }), 0u));
+            CheckCoverage(grid, center, 0.5f);
+        }
+    }
+
+    void TestAcrossThePlanes() {
+        for (const auto& camera : cameras) {
+            // Reaching behind the near plane, every tile of the first slice
+            Vector3D center;
+            auto grid{ BinLight(camera, nearZ, 0.1f, center) };
+            for (std::uint32_t y{}; y != LightGrid::gridY; ++y) {
+                for (std::uint32_t x{}; x != LightGrid::gridX; ++x) {
+                    ADH_CHECK(Contains(grid, GetIndex({ x, y, 0u }), 0u));
+                }
+            }
+            CheckCoverage(grid, center, 0.1f);
+
+            // Reaching past the far plane, clamped into the last slice
+            grid = BinLight(camera, farZ, 2.0f, center);
+            std::uint32_t first, last;
+            ADH_CHECK(GetSliceRange(grid, first, last));
+            ADH_CHECK(last == LightGrid::gridZ - 1u);
+            CheckCoverage(grid, center, 2.0f);
+        }
+    }
+
+    void TestOutsideIsDropped() {
+        for (const auto& camera : cameras) {
+            Vector3D center;
+            std::uint32_t first, last;
+            ADH_CHECK(!GetSliceRange(BinLight(camera, farZ + 2.0f, 1.0f, center), first, last));
+            ADH_CHECK(!GetSliceRange(BinLight(camera, -2.0f, 1.0f, center), first, last));
+            ADH_CHECK(!GetSliceRange(BinLight(camera, nearZ - 0.2f, 0.1f, center), first, last));
+        }
+
+        // A view without SetView() stays empty
+        LightGrid grid{ 2u, 64u };
+        grid.SetView(0u, xmm::Matrix{ 1.0f }, xmm::PerspectiveLH(1.0f, 1.0f, nearZ, farZ), nearZ, farZ);
+        Array<LightData> lights;
+        auto& light{ lights.EmplaceBack() };
+        light          = {};
+        light.position = xmm::Vector{ 0.0f, 0.0f, 10.0f, 1.0f };
+        ADH_CHECK(grid.Bin(lights) == grid.GetIndices(0u).GetSize());
+        ADH_CHECK(!grid.GetIndices(0u).IsEmpty());
+        ADH_CHECK(grid.GetIndices(1u).IsEmpty());
+    }
+} // namespace
+
+int main() {
+    TestNearSlice();
+    TestFarSlice();
+    TestAcrossThePlanes();
+    TestOutsideIsDropped();
+    return test::GetResult();
+}
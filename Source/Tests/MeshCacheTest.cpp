@@ -0,0 +1,129 @@
+#include "Test.hpp"
+#include <Scene/MeshCache.hpp>
+
+#include <cstdint>
+
+using namespace adh;
+
+namespace {
+    using Header = MeshCache::FileHeader;
+
+    std::uint64_t Align(std::uint64_t offset) {
+        return (offset + MeshCache::blobAlignment - 1u) & ~static_cast<std::uint64_t>(MeshCache::blobAlignment - 1u);
+    }
+
+    // Laid out the way MeshCache::Save() writes it, two LODs
+    Header MakeHeader(std::uint32_t options, std::uint64_t& fileSize) {
+        Header header{};
+        header.magic          = MeshCache::magic;
+        header.version        = MeshCache::version;
+        header.options        = options;
+        header.vertexStride   = MeshCache::GetVertexStride(options);
+        header.vertexCount    = 100u;
+        header.indexCount     = 600u;
+        header.lodCount       = 2u;
+        header.lods[0]        = { 0u, 480u, 0.0f };
+        header.lods[1]        = { 480u, 120u, 0.1f };
+        header.vertexOffset   = Align(sizeof(Header));
+        header.positionOffset = Align(header.vertexOffset + std::uint64_t{ header.vertexStride } * header.vertexCount);
+        header.indexOffset    = Align(header.positionOffset + sizeof(Vector3D) * header.vertexCount);
+        fileSize              = header.indexOffset + sizeof(std::uint32_t) * header.indexCount;
+        return header;
+    }
+
+    void TestWrittenHeaderIsValid() {
+        for (auto options : { 0u, MeshCache::packedVertices }) {
+            std::uint64_t fileSize;
+            auto header{ MakeHeader(options, fileSize) };
+            ADH_CHECK(MeshCache::IsValid(header, fileSize, options));
+            ADH_CHECK(MeshCache::IsValid(header, fileSize + 64u, options));
+        }
+        ADH_CHECK(MeshCache::GetVertexStride(0u) == sizeof(Vertex));
+        ADH_CHECK(MeshCache::GetVertexStride(MeshCache::packedVertices) == sizeof(PackedVertex));
+    }
+
+    void TestStaleHeaderIsRejected() {
+        std::uint64_t fileSize;
+        auto valid{ MakeHeader(0u, fileSize) };
+
+        auto header{ valid };
+        header.magic = 0u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+
+        header         = valid;
+        header.version = MeshCache::version + 1u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+
+        // Written with other import options, or by a build with another vertex layout
+        ADH_CHECK(!MeshCache::IsValid(valid, fileSize, MeshCache::packedVertices));
+        header              = valid;
+        header.vertexStride = sizeof(Vertex) + 4u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+    }
+
+    void TestTruncatedFileIsRejected() {
+        std::uint64_t fileSize;
+        auto header{ MakeHeader(0u, fileSize) };
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize - 1u, 0u));
+        ADH_CHECK(!MeshCache::IsValid(header, header.indexOffset, 0u));
+        ADH_CHECK(!MeshCache::IsValid(header, sizeof(Header), 0u));
+    }
+
+    void TestBadLayoutIsRejected() {
+        std::uint64_t fileSize;
+        auto valid{ MakeHeader(0u, fileSize) };
+
+        auto header{ valid };
+        header.lodCount = 0u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+        header.lodCount = MeshLod::maxCount + 1u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+
+        // Blobs overlapping the header or each other
+        header              = valid;
+        header.vertexOffset = 0u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+        header                = valid;
+        header.positionOffset = valid.vertexOffset;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+        header             = valid;
+        header.indexOffset = valid.positionOffset;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+
+        // Every LOD must be inside the indices, not only the last one
+        header         = valid;
+        header.lods[0] = { 0u, 601u, 0.0f };
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+        header         = valid;
+        header.lods[1] = { ~0u, 2u, 0.1f };
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+    }
+
+    void TestWrappingOffsetsAreRejected() {
+        std::uint64_t fileSize;
+        auto valid{ MakeHeader(0u, fileSize) };
+
+        // indexOffset + indexCount * 4 wraps to a small number
+        auto header{ valid };
+        header.indexOffset = ~std::uint64_t{} - 15u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+
+        header                = valid;
+        header.positionOffset = ~std::uint64_t{} - 15u;
+        header.indexOffset    = ~std::uint64_t{} - 15u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+
+        header              = valid;
+        header.vertexOffset = ~std::uint64_t{} - 15u;
+        ADH_CHECK(!MeshCache::IsValid(header, fileSize, 0u));
+    }
+} // namespace
+
+int main() {
+    TestWrittenHeaderIsValid();
+    TestStaleHeaderIsRejected();
+    TestTruncatedFileIsRejected();
+    TestBadLayoutIsRejected();
+    TestWrappingOffsetsAreRejected();
+    return test::GetResult();
+}
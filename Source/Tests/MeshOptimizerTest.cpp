@@ -0,0 +1,140 @@
+#include "Test.hpp"
+#include <Scene/MeshOptimizer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace adh;
+
+namespace {
+    using Triangle = std::array<std::uint32_t, 3>;
+
+    struct Mesh {
+        Array<Vector3D> positions;
+        Array<std::uint32_t> indices;
+    };
+
+    // Grid of cellCount x cellCount quads in the xy plane with its triangles shuffled, so the
+    // cache has something to gain
+    Mesh MakeShuffledGrid(int cellCount) {
+        Mesh mesh;
+        for (int y{}; y <= cellCount; ++y) {
+            for (int x{}; x <= cellCount; ++x) {
+                mesh.positions.EmplaceBack(Vector3D{ static_cast<float>(x), static_cast<float>(y), 0.0f });
+            }
+        }
+        std::vector<Triangle> triangles;
+        auto row{ static_cast<std::uint32_t>(cellCount + 1) };
+        for (std::uint32_t y{}; y != static_cast<std::uint32_t>(cellCount); ++y) {
+            for (std::uint32_t x{}; x != static_cast<std::uint32_t>(cellCount); ++x) {
+                auto i{ y * row + x };
+                triangles.push_back({ i, i + 1u, i + row + 1u });
+                triangles.push_back({ i, i + row + 1u, i + row });
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937{ 7u });
+        for (const auto& triangle : triangles) {
+            for (auto index : triangle) {
+                mesh.indices.EmplaceBack(index);
+            }
+        }
+        return mesh;
+    }
+
+    // Every triangle rotated so its smallest index is first, which keeps the winding, then sorted
+    std::vector<Triangle> GetTriangles(const Array<std::uint32_t>& indices, std::size_t first, std::size_t count) {
+        std::vector<Triangle> triangles;
+        for (auto i{ first }; i != first + count; i += 3u) {
+            Triangle triangle{ indices[i], indices[i + 1u], indices[i + 2u] };
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    void TestVertexCacheKeepsTriangles() {
+        auto mesh{ MakeShuffledGrid(24) };
+        auto vertexCount{ static_cast<std::uint32_t>(mesh.positions.GetSize()) };
+        auto before{ GetTriangles(mesh.indices, 0u, mesh.indices.GetSize()) };
+        auto statisticsBefore{ MeshOptimizer::Analyze(mesh.indices, 0u, mesh.indices.GetSize(), vertexCount) };
+
+        MeshOptimizer::OptimizeVertexCache(mesh.indices, 0u, mesh.indices.GetSize(), vertexCount);
+        ADH_CHECK(GetTriangles(mesh.indices, 0u, mesh.indices.GetSize()) == before);
+
+        auto statisticsAfter{ MeshOptimizer::Analyze(mesh.indices, 0u, mesh.indices.GetSize(), vertexCount) };
+        ADH_CHECK(statisticsAfter.acmr < statisticsBefore.acmr);
+        ADH_CHECK(statisticsAfter.acmr >= 0.5f && statisticsAfter.acmr <= 1.0f);
+        ADH_CHECK(statisticsAfter.atvr >= 1.0f);
+    }
+
+    void TestVertexCacheLeavesOtherRanges() {
+        auto mesh{ MakeShuffledGrid(8) };
+        auto vertexCount{ static_cast<std::uint32_t>(mesh.positions.GetSize()) };
+        auto half{ mesh.indices.GetSize() / 6u * 3u };
+        Array<std::uint32_t> original{ mesh.indices };
+
+        MeshOptimizer::OptimizeVertexCache(mesh.indices, half, mesh.indices.GetSize() - half, vertexCount);
+        ADH_CHECK(std::equal(mesh.indices.GetData(), mesh.indices.GetData() + half, original.GetData()));
+        ADH_CHECK(GetTriangles(mesh.indices, half, mesh.indices.GetSize() - half) ==
+                  GetTriangles(original, half, original.GetSize() - half));
+    }
+
+    void TestOverdrawKeepsTriangles() {
+        auto mesh{ MakeShuffledGrid(16) };
+        auto vertexCount{ static_cast<std::uint32_t>(mesh.positions.GetSize()) };
+        auto before{ GetTriangles(mesh.indices, 0u, mesh.indices.GetSize()) };
+        MeshOptimizer::OptimizeVertexCache(mesh.indices, 0u, mesh.indices.GetSize(), vertexCount);
+        auto statisticsCache{ MeshOptimizer::Analyze(mesh.indices, 0u, mesh.indices.GetSize(), vertexCount) };
+
+        constexpr float threshold{ 1.05f };
+        MeshOptimizer::OptimizeOverdraw(mesh.indices, 0u, mesh.indices.GetSize(), mesh.positions, threshold);
+        ADH_CHECK(GetTriangles(mesh.indices, 0u, mesh.indices.GetSize()) == before);
+
+        // Clusters are only split while the miss ratio stays close to the cache order
+        auto statisticsOverdraw{ MeshOptimizer::Analyze(mesh.indices, 0u, mesh.indices.GetSize(), vertexCount) };
+        ADH_CHECK(statisticsOverdraw.acmr <= statisticsCache.acmr * threshold + 1e-3f);
+    }
+
+    void TestVertexFetchRemapsInFirstUse() {
+        // Vertex 1 and 4 are unused, the rest is first used in the order 3, 0, 5, 2
+        Array<Vector3D> positions;
+        for (int i{}; i != 6; ++i) {
+            positions.EmplaceBack(Vector3D{ static_cast<float>(i), 0.0f, 0.0f });
+        }
+        Array<std::uint32_t> indices;
+        for (std::uint32_t index : { 3u, 0u, 5u, 5u, 0u, 2u }) {
+            indices.EmplaceBack(index);
+        }
+        Array<Vector3D> original{ positions };
+        Array<std::uint32_t> originalIndices{ indices };
+
+        Array<std::uint32_t> remap;
+        auto usedCount{ MeshOptimizer::OptimizeVertexFetch(indices, static_cast<std::uint32_t>(positions.GetSize()), remap) };
+        ADH_CHECK(usedCount == 4u);
+        ADH_CHECK(remap.GetSize() == positions.GetSize());
+        ADH_CHECK(remap[3] == 0u && remap[0] == 1u && remap[5] == 2u && remap[2] == 3u);
+        ADH_CHECK(remap[1] == MeshOptimizer::invalidIndex && remap[4] == MeshOptimizer::invalidIndex);
+
+        const std::uint32_t expected[]{ 0u, 1u, 2u, 2u, 1u, 3u };
+        ADH_CHECK(std::equal(indices.GetData(), indices.GetData() + indices.GetSize(), expected));
+
+        // Every index still points at the position it did before
+        RemapVertices(positions, remap, usedCount);
+        ADH_CHECK(positions.GetSize() == usedCount);
+        for (std::size_t i{}; i != indices.GetSize(); ++i) {
+            ADH_CHECK(positions[indices[i]].x == original[originalIndices[i]].x);
+        }
+    }
+} // namespace
+
+int main() {
+    TestVertexCacheKeepsTriangles();
+    TestVertexCacheLeavesOtherRanges();
+    TestOverdrawKeepsTriangles();
+    TestVertexFetchRemapsInFirstUse();
+    return test::GetResult();
+}
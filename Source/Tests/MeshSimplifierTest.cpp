@@ -0,0 +1,159 @@
+#include "Test.hpp"
+#include <Scene/MeshSimplifier.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <tuple>
+
+using namespace adh;
+
+namespace {
+    struct Mesh {
+        Array<Vector3D> positions;
+        Array<std::uint32_t> indices;
+    };
+
+    // Unit cube, every face a grid of cellCount x cellCount quads. Vertices on the edges are shared
+    // between faces, so the mesh is closed.
+    Mesh MakeCube(int cellCount) {
+        Mesh mesh;
+        std::map<std::tuple<int, int, int>, std::uint32_t> vertices;
+        auto getVertex{ [&](int x, int y, int z) {
+            auto [it, isNew]{ vertices.emplace(std::tuple{ x, y, z }, static_cast<std::uint32_t>(mesh.positions.GetSize())) };
+            if (isNew) {
+                auto scale{ 1.0f / cellCount };
+                mesh.positions.EmplaceBack(Vector3D{ x * scale - 0.5f, y * scale - 0.5f, z * scale - 0.5f });
+            }
+            return it->second;
+        } };
+
+        // Each face by its normal axis and side, u and v wound so the normal points out
+        for (int axis{}; axis != 3; ++axis) {
+            for (int side{}; side != 2; ++side) {
+                for (int i{}; i != cellCount; ++i) {
+                    for (int j{}; j != cellCount; ++j) {
+                        std::uint32_t quad[4];
+                        int corners[4][2]{ { i, j }, { i + 1, j }, { i + 1, j + 1 }, { i, j + 1 } };
+                        for (int k{}; k != 4; ++k) {
+                            int point[3];
+                            point[axis]           = side * cellCount;
+                            point[(axis + 1) % 3] = corners[k][side ? 0 : 1];
+                            point[(axis + 2) % 3] = corners[k][side ? 1 : 0];
+                            quad[k]               = getVertex(point[0], point[1], point[2]);
+                        }
+                        for (auto index : { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] }) {
+                            mesh.indices.EmplaceBack(index);
+                        }
+                    }
+                }
+            }
+        }
+        return mesh;
+    }
+
+    // Flat grid of cellCount x cellCount quads in the xy plane, all of its outer vertices are on the border
+    Mesh MakeGrid(int cellCount) {
+        Mesh mesh;
+        for (int y{}; y <= cellCount; ++y) {
+            for (int x{}; x <= cellCount; ++x) {
+                mesh.positions.EmplaceBack(Vector3D{ static_cast<float>(x), static_cast<float>(y), 0.0f });
+            }
+        }
+        auto row{ static_cast<std::uint32_t>(cellCount + 1) };
+        for (std::uint32_t y{}; y != static_cast<std::uint32_t>(cellCount); ++y) {
+            for (std::uint32_t x{}; x != static_cast<std::uint32_t>(cellCount); ++x) {
+                auto i{ y * row + x };
+                for (auto index : { i, i + 1u, i + row + 1u, i, i + row + 1u, i + row }) {
+                    mesh.indices.EmplaceBack(index);
+                }
+            }
+        }
+        return mesh;
+    }
+
+    Vector3D GetNormal(const Mesh& mesh, const Array<std::uint32_t>& indices, std::size_t triangle) {
+        const auto& a{ mesh.positions[indices[triangle * 3u]] };
+        const auto& b{ mesh.positions[indices[triangle * 3u + 1u]] };
+        const auto& c{ mesh.positions[indices[triangle * 3u + 2u]] };
+        return Cross(Subtract(b, a), Subtract(c, a));
+    }
+
+    void CheckTriangles(const Mesh& mesh, const Array<std::uint32_t>& indices) {
+        ADH_CHECK(indices.GetSize() % 3u == 0u);
+        for (std::size_t i{}; i < indices.GetSize(); i += 3u) {
+            ADH_CHECK(indices[i] < mesh.positions.GetSize());
+            ADH_CHECK(indices[i + 1u] < mesh.positions.GetSize());
+            ADH_CHECK(indices[i + 2u] < mesh.positions.GetSize());
+            ADH_CHECK(indices[i] != indices[i + 1u] && indices[i + 1u] != indices[i + 2u] && indices[i] != indices[i + 2u]);
+        }
+    }
+
+    void TestCubeCollapsesFlatFaces() {
+        auto cube{ MakeCube(8) };
+        auto result{ MeshSimplifier::Simplify(cube.positions, cube.indices, cube.indices.GetSize() / 4u) };
+        CheckTriangles(cube, result.indices);
+        ADH_CHECK(result.indices.GetSize() <= cube.indices.GetSize() / 4u);
+        ADH_CHECK(result.indices.GetSize() >= 12u * 3u);
+
+        // The faces are flat, nothing moved off its planes and every triangle still faces outwards
+        ADH_CHECK(result.error < 1e-3f);
+        for (std::size_t i{}; i != result.indices.GetSize() / 3u; ++i) {
+            auto normal{ GetNormal(cube, result.indices, i) };
+            const auto& a{ cube.positions[result.indices[i * 3u]] };
+            const auto& b{ cube.positions[result.indices[i * 3u + 1u]] };
+            const auto& c{ cube.positions[result.indices[i * 3u + 2u]] };
+            auto center{ Vector3D{ a.x + b.x + c.x, a.y + b.y + c.y, a.z + b.z + c.z } };
+            ADH_CHECK(Dot(normal, center) > 0.0f);
+        }
+    }
+
+    void TestCubeReachesTarget() {
+        auto cube{ MakeCube(4) };
+        auto result{ MeshSimplifier::Simplify(cube.positions, cube.indices, 0u) };
+        CheckTriangles(cube, result.indices);
+        ADH_CHECK(result.indices.GetSize() < cube.indices.GetSize());
+    }
+
+    void TestGridKeepsBorder() {
+        constexpr int cellCount{ 6 };
+        auto grid{ MakeGrid(cellCount) };
+        auto result{ MeshSimplifier::Simplify(grid.positions, grid.indices, 0u) };
+        CheckTriangles(grid, result.indices);
+        ADH_CHECK(result.indices.GetSize() < grid.indices.GetSize());
+        ADH_CHECK(result.error < 1e-3f);
+
+        // Border vertices never move, every one of them is still used
+        for (std::uint32_t i{}; i != grid.positions.GetSize(); ++i) {
+            const auto& position{ grid.positions[i] };
+            auto isBorder{ position.x == 0.0f || position.y == 0.0f || position.x == cellCount || position.y == cellCount };
+            if (isBorder) {
+                ADH_CHECK(std::find(result.indices.GetData(), result.indices.GetData() + result.indices.GetSize(), i) !=
+                          result.indices.GetData() + result.indices.GetSize());
+            }
+        }
+        // Still covers the whole grid
+        float area{};
+        for (std::size_t i{}; i != result.indices.GetSize() / 3u; ++i) {
+            area += GetNormal(grid, result.indices, i).z * 0.5f;
+        }
+        ADH_CHECK(std::abs(area - cellCount * cellCount) < 1e-3f);
+    }
+
+    void TestTargetAboveCountKeepsMesh() {
+        auto cube{ MakeCube(2) };
+        auto result{ MeshSimplifier::Simplify(cube.positions, cube.indices, cube.indices.GetSize()) };
+        ADH_CHECK(result.indices.GetSize() == cube.indices.GetSize());
+        ADH_CHECK(std::equal(result.indices.GetData(), result.indices.GetData() + result.indices.GetSize(), cube.indices.GetData()));
+        ADH_CHECK(result.error == 0.0f);
+    }
+} // namespace
+
+int main() {
+    TestCubeCollapsesFlatFaces();
+    TestCubeReachesTarget();
+    TestGridKeepsBorder();
+    TestTargetAboveCountKeepsMesh();
+    return test::GetResult();
+}
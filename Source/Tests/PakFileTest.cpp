@@ -0,0 +1,251 @@
+#include "Test.hpp"
+#include <Asset/PakBuilder.hpp>
+#include <Std/PakFile.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace adh;
+
+namespace {
+    using Bytes = std::vector<std::uint8_t>;
+
+    Bytes Compress(const Bytes& source) {
+        Bytes compressed(PakBuilder::GetCompressBound(source.size()));
+        compressed.resize(PakBuilder::Compress(source.data(), source.size(), compressed.data()));
+        return compressed;
+    }
+
+    bool Decompress(const Bytes& compressed, std::size_t size, Bytes& result) {
+        result.assign(size, 0u);
+        return PakFile::Decompress(compressed.data(), compressed.size(), result.data(), size);
+    }
+
+    // Bytes drawn from alphabetSize values, small alphabets make long matches
+    Bytes MakeData(std::mt19937& random, std::size_t size, std::uint32_t alphabetSize) {
+        Bytes data(size);
+        for (auto& byte : data) {
+            byte = static_cast<std::uint8_t>(random() % alphabetSize);
+        }
+        return data;
+    }
+
+    void WriteFile(const std::filesystem::path& path, const Bytes& data) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    Bytes ReadFile(const std::filesystem::path& path) {
+        std::ifstream file{ path, std::ios::binary };
+        return Bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    void TestLz4RoundTrip() {
+        std::mt19937 random{ 1u };
+        for (int i{}; i != 500; ++i) {
+            auto data{ MakeData(random, 1u + random() % 5000u, 1u + random() % 20u) };
+            Bytes result;
+            if (!Decompress(Compress(data), data.size(), result) || result != data) {
+                ADH_CHECK(result == data);
+                return;
+            }
+        }
+        // Sizes around the match limit, long literal runs and long matches that need extra length bytes
+        for (std::size_t size : { 1u, 4u, 12u, 13u, 17u, 300u, 70000u }) {
+            for (std::uint32_t alphabetSize : { 1u, 256u }) {
+                auto data{ MakeData(random, size, alphabetSize) };
+                Bytes result;
+                ADH_CHECK(Decompress(Compress(data), data.size(), result) && result == data);
+            }
+        }
+    }
+
+    void TestLz4Shrinks() {
+        std::mt19937 random{ 2u };
+        auto pattern{ MakeData(random, 37u, 256u) };
+        Bytes repetitive;
+        for (int i{}; i != 300; ++i) {
+            repetitive.insert(repetitive.end(), pattern.begin(), pattern.end());
+        }
+        ADH_CHECK(Compress(repetitive).size() < repetitive.size() / 10u);
+        Bytes zeros(10000u);
+        ADH_CHECK(Compress(zeros).size() < 100u);
+
+        // Incompressible data only grows by the bound
+        auto noise{ MakeData(random, 10000u, 256u) };
+        ADH_CHECK(Compress(noise).size() <= PakBuilder::GetCompressBound(noise.size()));
+    }
+
+    void TestLz4RejectsMalformed() {
+        std::mt19937 random{ 3u };
+        auto data{ MakeData(random, 2000u, 8u) };
+        auto compressed{ Compress(data) };
+        Bytes result;
+
+        // Any truncation, and sizes other than the original
+        for (std::size_t size{}; size != compressed.size(); ++size) {
+            Bytes truncated{ compressed.begin(), compressed.begin() + static_cast<std::ptrdiff_t>(size) };
+            if (Decompress(truncated, data.size(), result)) {
+                ADH_CHECK(!Decompress(truncated, data.size(), result));
+                break;
+            }
+        }
+        ADH_CHECK(!Decompress(compressed, data.size() - 1u, result));
+        ADH_CHECK(!Decompress(compressed, data.size() + 1u, result));
+
+        // One literal, then matches with offset 0 and an offset before the start
+        ADH_CHECK(!Decompress(Bytes{ 0x10u, 'a', 0x00u, 0x00u }, 5u, result));
+        ADH_CHECK(!Decompress(Bytes{ 0x10u, 'a', 0x02u, 0x00u }, 5u, result));
+        ADH_CHECK(Decompress(Bytes{ 0x10u, 'a', 0x01u, 0x00u }, 5u, result) && result == Bytes(5u, 'a'));
+
+        // Length bytes running past the end
+        ADH_CHECK(!Decompress(Bytes{ 0xF0u, 255u, 255u }, 600u, result));
+
+        // Garbage must fail or decode, never read or write out of bounds
+        for (int i{}; i != 2000; ++i) {
+            auto garbage{ MakeData(random, 1u + random() % 64u, 256u) };
+            Decompress(garbage, 1u + random() % 256u, result);
+        }
+    }
+
+    struct Pak {
+        std::filesystem::path root;
+        std::string pakPath;
+        Bytes text;
+        Bytes noise;
+    };
+
+    Pak BuildPak() {
+        Pak pak;
+        pak.root = std::filesystem::temp_directory_path() / "AdHocPakFileTest";
+        std::filesystem::remove_all(pak.root);
+
+        std::mt19937 random{ 4u };
+        std::string line{ "The quick brown fox jumps over the lazy dog. " };
+        for (int i{}; i != 200; ++i) {
+            pak.text.insert(pak.text.end(), line.begin(), line.end());
+        }
+        pak.noise = MakeData(random, 5000u, 256u);
+        WriteFile(pak.root / "Assets/text.txt", pak.text);
+        WriteFile(pak.root / "Assets/Sub/noise.bin", pak.noise);
+        WriteFile(pak.root / "Assets/empty", {});
+        WriteFile(pak.root / "Assets/.hidden", pak.text);
+        WriteFile(pak.root / "Assets/mesh.adhmesh.tmp", pak.text);
+        WriteFile(pak.root / "Other/skipped.txt", pak.text);
+
+        PakBuilder::Statistics statistics;
+        pak.pakPath = (pak.root / "Data.pak").string();
+        auto rootDirectory{ pak.root.generic_string() + "/" };
+        ADH_CHECK(PakBuilder::Build(rootDirectory, { "Assets" }, pak.pakPath, statistics));
+        ADH_CHECK(statistics.fileCount == 3u);
+        ADH_CHECK(statistics.compressedCount == 1u);
+        ADH_CHECK(statistics.originalSize == pak.text.size() + pak.noise.size());
+        ADH_CHECK(statistics.packedSize < statistics.originalSize);
+        ADH_CHECK(!std::filesystem::exists(pak.pakPath + ".tmp"));
+        return pak;
+    }
+
+    void TestBuildAndRead(const Pak& pak) {
+        PakFile file;
+        ADH_CHECK(file.Open(pak.pakPath.data()));
+        ADH_CHECK(file.GetEntryCount() == 3u);
+        for (const auto& entry : file) {
+            ADH_CHECK(entry.offset % PakFile::blobAlignment == 0u);
+        }
+
+        auto text{ file.Find("Assets/text.txt") };
+        auto noise{ file.Find("Assets/Sub/noise.bin") };
+        auto empty{ file.Find("Assets/empty") };
+        ADH_CHECK(text && text->compression == PakFile::Compression::eLZ4);
+        ADH_CHECK(noise && noise->compression == PakFile::Compression::eNone);
+        ADH_CHECK(empty && !empty->size);
+        ADH_CHECK(!file.Find("Assets/.hidden"));
+        ADH_CHECK(!file.Find("Assets/mesh.adhmesh.tmp"));
+        ADH_CHECK(!file.Find("Other/skipped.txt"));
+        ADH_CHECK(!file.Find("assets/text.txt"));
+        if (!text || !noise || !empty) {
+            return;
+        }
+        ADH_CHECK(file.GetPath(*text) == "Assets/text.txt");
+
+        MappedFile mapped;
+        ADH_CHECK(file.Read(*text, mapped) && mapped.GetSize() == pak.text.size() &&
+                  !std::memcmp(mapped.GetData(), pak.text.data(), pak.text.size()));
+        ADH_CHECK(file.Read(*noise, mapped) && mapped.GetSize() == pak.noise.size() &&
+                  !std::memcmp(mapped.GetData(), pak.noise.data(), pak.noise.size()));
+        ADH_CHECK(!file.Read(*empty, mapped));
+    }
+
+    // Open() rejects the pak after patch changed its bytes
+    template <typename Func>
+    bool Opens(const Pak& pak, const Bytes& original, Func&& patch) {
+        auto bytes{ original };
+        patch(bytes);
+        auto path{ pak.root / "Corrupt.pak" };
+        WriteFile(path, bytes);
+        PakFile file;
+        return file.Open(path.string().data());
+    }
+
+    void TestCorruptPakIsRejected(const Pak& pak) {
+        auto original{ ReadFile(pak.pakPath) };
+        PakFile::Header header;
+        std::memcpy(&header, original.data(), sizeof(header));
+        auto patchHeader{ [](auto&& change) {
+            return [change](Bytes& bytes) {
+                PakFile::Header header;
+                std::memcpy(&header, bytes.data(), sizeof(header));
+                change(header);
+                std::memcpy(bytes.data(), &header, sizeof(header));
+            };
+        } };
+        // Of the first entry
+        auto patchEntry{ [&header](auto&& change) {
+            return [change, offset = header.indexOffset](Bytes& bytes) {
+                PakFile::Entry entry;
+                std::memcpy(&entry, bytes.data() + offset, sizeof(entry));
+                change(entry);
+                std::memcpy(bytes.data() + offset, &entry, sizeof(entry));
+            };
+        } };
+        constexpr auto huge{ ~std::uint64_t{} & ~std::uint64_t{ 7u } };
+
+        ADH_CHECK(Opens(pak, original, [](Bytes&) {}));
+        ADH_CHECK(!Opens(pak, original, [](Bytes& bytes) { bytes.resize(sizeof(PakFile::Header) - 1u); }));
+        ADH_CHECK(!Opens(pak, original, [&header](Bytes& bytes) { bytes.resize(header.nameOffset + header.nameSize - 1u); }));
+        ADH_CHECK(!Opens(pak, original, patchHeader([](PakFile::Header& h) { ++h.magic; })));
+        ADH_CHECK(!Opens(pak, original, patchHeader([](PakFile::Header& h) { ++h.version; })));
+        ADH_CHECK(!Opens(pak, original, patchHeader([](PakFile::Header& h) { h.indexOffset += 4u; })));
+        ADH_CHECK(!Opens(pak, original, patchHeader([huge](PakFile::Header& h) { h.indexOffset = huge; })));
+        ADH_CHECK(!Opens(pak, original, patchHeader([](PakFile::Header& h) { h.entryCount = ~0u; })));
+        ADH_CHECK(!Opens(pak, original, patchHeader([huge](PakFile::Header& h) { h.nameOffset = huge; })));
+        ADH_CHECK(!Opens(pak, original, patchHeader([huge](PakFile::Header& h) { h.nameSize = huge; })));
+        ADH_CHECK(!Opens(pak, original, patchEntry([huge](PakFile::Entry& e) { e.offset = huge; })));
+        ADH_CHECK(!Opens(pak, original, patchEntry([huge](PakFile::Entry& e) { e.size = huge; })));
+        ADH_CHECK(!Opens(pak, original, patchEntry([](PakFile::Entry& e) { e.nameOffset = ~0u; })));
+        ADH_CHECK(!Opens(pak, original, patchEntry([](PakFile::Entry& e) { e.nameSize = ~0u; })));
+        ADH_CHECK(!Opens(pak, original, patchEntry([](PakFile::Entry& e) { e.compression = static_cast<PakFile::Compression>(7u); })));
+        ADH_CHECK(!Opens(pak, original, patchEntry([](PakFile::Entry& e) {
+            e.compression  = PakFile::Compression::eNone;
+            e.originalSize = e.size + 1u;
+        })));
+    }
+} // namespace
+
+int main() {
+    TestLz4RoundTrip();
+    TestLz4Shrinks();
+    TestLz4RejectsMalformed();
+    auto pak{ BuildPak() };
+    TestBuildAndRead(pak);
+    TestCorruptPakIsRejected(pak);
+    std::error_code error;
+    std::filesystem::remove_all(pak.root, error);
+    return test::GetResult();
+}
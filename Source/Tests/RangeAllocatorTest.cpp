@@ -0,0 +1,122 @@
+#include "Test.hpp"
+#include <Std/RangeAllocator.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace adh;
+
+namespace {
+    bool HasBlocks(const RangeAllocator& allocator, const std::vector<RangeAllocator::Block>& expected) {
+        const auto& blocks{ allocator.GetFreeBlocks() };
+        if (blocks.size() != expected.size()) {
+            return false;
+        }
+        for (std::size_t i{}; i != blocks.size(); ++i) {
+            if (blocks[i].head != expected[i].head || blocks[i].tail != expected[i].tail) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void TestAllocateUntilFull() {
+        RangeAllocator allocator;
+        allocator.Create(100u);
+        std::uint32_t first{};
+        ADH_CHECK(allocator.Allocate(40u, first) && first == 0u);
+        ADH_CHECK(allocator.Allocate(60u, first) && first == 40u);
+        ADH_CHECK(allocator.GetFreeBlocks().empty());
+        ADH_CHECK(!allocator.Allocate(1u, first));
+
+        RangeAllocator empty;
+        empty.Create(0u);
+        ADH_CHECK(!empty.Allocate(1u, first));
+    }
+
+    void TestTooLargeFails() {
+        RangeAllocator allocator;
+        allocator.Create(100u);
+        std::uint32_t first{ 7u };
+        ADH_CHECK(!allocator.Allocate(101u, first));
+        ADH_CHECK(first == 7u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 100u } }));
+    }
+
+    void TestFreeMergesNeighbours() {
+        RangeAllocator allocator;
+        allocator.Create(100u);
+        std::uint32_t a, b, c, d;
+        allocator.Allocate(10u, a);
+        allocator.Allocate(20u, b);
+        allocator.Allocate(30u, c);
+        allocator.Allocate(40u, d);
+
+        // Nothing free around them, kept apart and in order
+        allocator.Free(c, 30u);
+        allocator.Free(a, 10u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 10u }, { 30u, 60u } }));
+
+        // Joins the blocks on both sides
+        allocator.Free(b, 20u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 60u } }));
+
+        // Joins the block before it
+        allocator.Free(d, 40u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 100u } }));
+    }
+
+    void TestFreeMergesWithNext() {
+        RangeAllocator allocator;
+        allocator.Create(100u);
+        std::uint32_t a, b;
+        allocator.Allocate(50u, a);
+        allocator.Allocate(25u, b);
+        allocator.Free(b, 25u);
+        ADH_CHECK(HasBlocks(allocator, { { 50u, 100u } }));
+        allocator.Free(a, 50u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 100u } }));
+    }
+
+    void TestFirstFit() {
+        RangeAllocator allocator;
+        allocator.Create(100u);
+        std::uint32_t a, b, c, d;
+        allocator.Allocate(10u, a);
+        allocator.Allocate(30u, b);
+        allocator.Allocate(10u, c);
+        allocator.Allocate(50u, d);
+        allocator.Free(a, 10u);
+        allocator.Free(c, 10u);
+        allocator.Free(d, 50u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 10u }, { 40u, 100u } }));
+
+        // The first block that holds it, not the best one
+        std::uint32_t first{};
+        ADH_CHECK(allocator.Allocate(8u, first) && first == 0u);
+        ADH_CHECK(allocator.Allocate(8u, first) && first == 40u);
+        ADH_CHECK(allocator.Allocate(2u, first) && first == 8u);
+        ADH_CHECK(HasBlocks(allocator, { { 48u, 100u } }));
+    }
+
+    void TestCreateResets() {
+        RangeAllocator allocator;
+        allocator.Create(100u);
+        std::uint32_t first;
+        allocator.Allocate(60u, first);
+        allocator.Create(30u);
+        ADH_CHECK(HasBlocks(allocator, { { 0u, 30u } }));
+        allocator.Destroy();
+        ADH_CHECK(allocator.GetFreeBlocks().empty());
+    }
+} // namespace
+
+int main() {
+    TestAllocateUntilFull();
+    TestTooLargeFails();
+    TestFreeMergesNeighbours();
+    TestFreeMergesWithNext();
+    TestFirstFit();
+    TestCreateResets();
+    return test::GetResult();
+}
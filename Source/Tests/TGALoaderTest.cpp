@@ -0,0 +1,203 @@
+#include "Test.hpp"
+#include <Std/TGALoader.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace adh;
+
+namespace {
+    using Bytes = std::vector<std::uint8_t>;
+
+    constexpr std::uint8_t topDown{ 0x20u };
+    constexpr std::uint8_t rightToLeft{ 0x10u };
+
+    struct Packet {
+        bool isRun;
+        std::uint32_t count;
+    };
+
+    struct Image {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t bytesPerPixel;
+        Bytes pixels; // In file order, BGR(A) or grey
+    };
+
+    std::string GetPath() {
+        return (std::filesystem::temp_directory_path() / "AdHocTGALoaderTest.tga").string();
+    }
+
+    Bytes MakeHeader(const Image& image, std::uint8_t imageType, std::uint8_t descriptor) {
+        TGAHeader header{};
+        header.IDLenght        = 3;
+        header.imageType       = static_cast<char>(imageType);
+        header.width           = static_cast<short>(image.width);
+        header.height          = static_cast<short>(image.height);
+        header.bitsPerPixel    = static_cast<char>(image.bytesPerPixel * 8u);
+        header.imageDescriptor = static_cast<char>(descriptor);
+        Bytes bytes(sizeof(TGAHeader));
+        std::memcpy(bytes.data(), &header, sizeof(TGAHeader));
+        // An image ID the decoder must skip
+        bytes.insert(bytes.end(), { 'a', 'd', 'h' });
+        return bytes;
+    }
+
+    Bytes EncodePlain(const Image& image, std::uint8_t descriptor) {
+        auto bytes{ MakeHeader(image, image.bytesPerPixel == 1u ? 3u : 2u, descriptor) };
+        bytes.insert(bytes.end(), image.pixels.begin(), image.pixels.end());
+        return bytes;
+    }
+
+    // A run packet repeats the first pixel of its span, the image must have count equal pixels there
+    Bytes EncodeRunLength(const Image& image, const std::vector<Packet>& packets, std::uint8_t descriptor) {
+        auto bytes{ MakeHeader(image, image.bytesPerPixel == 1u ? 11u : 10u, descriptor) };
+        std::size_t pixel{};
+        for (const auto& packet : packets) {
+            bytes.push_back(static_cast<std::uint8_t>((packet.isRun ? 0x80u : 0u) | (packet.count - 1u)));
+            auto first{ image.pixels.begin() + pixel * image.bytesPerPixel };
+            auto size{ (packet.isRun ? 1u : packet.count) * image.bytesPerPixel };
+            bytes.insert(bytes.end(), first, first + size);
+            pixel += packet.count;
+        }
+        return bytes;
+    }
+
+    void WriteFile(const Bytes& bytes) {
+        std::ofstream file{ GetPath(), std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    // RGBA8 rows bottom first, left to right, of the pixels stored in the order descriptor gives
+    Bytes GetExpected(const Image& image, std::uint8_t descriptor) {
+        Bytes rgba;
+        for (std::uint32_t row{}; row != image.height; ++row) {
+            for (std::uint32_t column{}; column != image.width; ++column) {
+                auto fileRow{ (descriptor & topDown) ? image.height - 1u - row : row };
+                auto fileColumn{ (descriptor & rightToLeft) ? image.width - 1u - column : column };
+                auto p{ &image.pixels[(std::size_t{ fileRow } * image.width + fileColumn) * image.bytesPerPixel] };
+                if (image.bytesPerPixel == 1u) {
+                    rgba.insert(rgba.end(), { p[0], p[0], p[0], 255u });
+                } else {
+                    rgba.insert(rgba.end(), { p[2], p[1], p[0], image.bytesPerPixel == 4u ? p[3] : std::uint8_t{ 255u } });
+                }
+            }
+        }
+        return rgba;
+    }
+
+    bool Decode(const Bytes& file, Bytes& rgba) {
+        WriteFile(file);
+        TGALoader tga;
+        if (!tga.Open(GetPath().data())) {
+            return false;
+        }
+        rgba.assign(tga.GetSize(), 0u);
+        return tga.Read(rgba.data());
+    }
+
+    // 5x3, file order: a run of 7 over the first row into the second, 6 raw pixels over the second
+    // into the third and a run of 2
+    Image MakeRunImage(std::uint32_t bytesPerPixel) {
+        Image image{ 5u, 3u, bytesPerPixel };
+        for (std::uint32_t i{}; i != 15u; ++i) {
+            auto value{ i < 7u ? 0u : i < 13u ? i : 13u };
+            for (std::uint32_t c{}; c != bytesPerPixel; ++c) {
+                image.pixels.push_back(static_cast<std::uint8_t>(value * 17u + c * 60u + 3u));
+            }
+        }
+        return image;
+    }
+
+    const std::vector<Packet> runPackets{ { true, 7u }, { false, 6u }, { true, 2u } };
+
+    void TestRunLengthAcrossRows() {
+        for (auto bytesPerPixel : { 1u, 3u, 4u }) {
+            auto image{ MakeRunImage(bytesPerPixel) };
+            Bytes rgba;
+            ADH_CHECK(Decode(EncodeRunLength(image, runPackets, 0u), rgba));
+            ADH_CHECK(rgba == GetExpected(image, 0u));
+        }
+
+        // A run spanning two whole rows and the start of a third
+        auto image{ MakeRunImage(3u) };
+        image.width  = 3u;
+        image.height = 5u;
+        Bytes rgba;
+        ADH_CHECK(Decode(EncodeRunLength(image, runPackets, 0u), rgba));
+        ADH_CHECK(rgba == GetExpected(image, 0u));
+    }
+
+    void TestKnownImage() {
+        // 2x2 BGR, bottom row red then green, top row blue then white, one raw packet and one run
+        Image image{ 2u, 2u, 3u, { 0u, 0u, 255u, 0u, 255u, 0u, 255u, 0u, 0u, 255u, 255u, 255u } };
+        Bytes rgba;
+        ADH_CHECK(Decode(EncodeRunLength(image, { { false, 3u }, { true, 1u } }, 0u), rgba));
+        const Bytes expected{ 255u, 0u, 0u, 255u, 0u, 255u, 0u, 255u, 0u, 0u, 255u, 255u, 255u, 255u, 255u, 255u };
+        ADH_CHECK(rgba == expected);
+    }
+
+    void TestOrigins() {
+        // Every origin, plain and run length encoded. 32 bit rows of five take the SSE path and
+        // the scalar tail, reversed as well.
+        for (std::uint8_t descriptor : { std::uint8_t{}, topDown, rightToLeft, static_cast<std::uint8_t>(topDown | rightToLeft) }) {
+            for (auto bytesPerPixel : { 1u, 3u, 4u }) {
+                auto image{ MakeRunImage(bytesPerPixel) };
+                auto expected{ GetExpected(image, descriptor) };
+                Bytes rgba;
+                ADH_CHECK(Decode(EncodeRunLength(image, runPackets, descriptor), rgba));
+                ADH_CHECK(rgba == expected);
+                ADH_CHECK(Decode(EncodePlain(image, descriptor), rgba));
+                ADH_CHECK(rgba == expected);
+            }
+        }
+    }
+
+    void TestBands() {
+        // A top down image read in bands of two rows comes out bottom band last
+        auto image{ MakeRunImage(4u) };
+        auto expected{ GetExpected(image, topDown) };
+        WriteFile(EncodeRunLength(image, runPackets, topDown));
+        TGALoader tga;
+        ADH_CHECK(tga.Open(GetPath().data()));
+        std::size_t rowSize{ 4u * image.width };
+        Bytes band(2u * rowSize);
+        std::uint32_t firstRow;
+        ADH_CHECK(tga.ReadRows(band.data(), 2u, firstRow));
+        ADH_CHECK(firstRow == 1u);
+        ADH_CHECK(Bytes(band.begin(), band.end()) == Bytes(expected.begin() + rowSize, expected.end()));
+        ADH_CHECK(tga.GetRowsLeft() == 1u);
+        ADH_CHECK(tga.ReadRows(band.data(), 2u, firstRow));
+        ADH_CHECK(firstRow == 0u);
+        ADH_CHECK(Bytes(band.begin(), band.begin() + rowSize) == Bytes(expected.begin(), expected.begin() + rowSize));
+    }
+
+    void TestTruncatedFile() {
+        auto image{ MakeRunImage(3u) };
+        auto file{ EncodeRunLength(image, runPackets, 0u) };
+        file.resize(file.size() - 4u);
+        Bytes rgba;
+        ADH_CHECK(!Decode(file, rgba));
+
+        // Plain images are checked when they're opened
+        file = EncodePlain(image, 0u);
+        file.pop_back();
+        WriteFile(file);
+        TGALoader tga;
+        ADH_CHECK(!tga.Open(GetPath().data()));
+    }
+} // namespace
+
+int main() {
+    TestKnownImage();
+    TestRunLengthAcrossRows();
+    TestOrigins();
+    TestBands();
+    TestTruncatedFile();
+    std::filesystem::remove(GetPath());
+    return test::GetResult();
+}
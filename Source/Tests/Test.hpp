@@ -0,0 +1,28 @@
+#pragma once
+#include <iostream>
+
+namespace adh {
+    namespace test {
+        inline int& GetFailureCount() noexcept {
+            static int failureCount{};
+            return failureCount;
+        }
+
+        // Returned from main(), ctest fails the test on anything but zero
+        inline int GetResult() noexcept {
+            if (GetFailureCount()) {
+                std::cerr << GetFailureCount() << " checks failed" << std::endl;
+            }
+            return GetFailureCount() ? 1 : 0;
+        }
+    } // namespace test
+} // namespace adh
+
+// Reports the condition and keeps going, so one run shows every failed check
+#define ADH_CHECK(condition)                                                                          \
+    do {                                                                                              \
+        if (!(condition)) {                                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+            ++adh::test::GetFailureCount();                                                           \
+        }                                                                                             \
+    } while (false)
@@ -0,0 +1,131 @@
+#include "Test.hpp"
+#include <Asset/TextureCache.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+using namespace adh;
+
+namespace {
+    using Header = TextureCache::FileHeader;
+
+    constexpr auto encoding{ TextureCache::Encoding::eDefault };
+
+    // Laid out the way TextureCache::Cook() writes a 256x128 BC1 texture with its whole chain
+    Header MakeHeader(std::uint64_t& fileSize) {
+        Header header{};
+        header.magic      = TextureCache::magic;
+        header.version    = TextureCache::version;
+        header.encoding   = static_cast<std::uint32_t>(encoding);
+        header.format     = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        header.width      = 256u;
+        header.height     = 128u;
+        header.mipLevels  = 9u;
+        header.dataOffset = (sizeof(Header) + TextureCache::blobAlignment - 1u) & ~static_cast<std::uint64_t>(TextureCache::blobAlignment - 1u);
+        header.dataSize   = TextureCache::GetDataSize(BlockCompressor::Format::eBC1, { header.width, header.height }, header.mipLevels);
+        fileSize          = header.dataOffset + header.dataSize;
+        return header;
+    }
+
+    void TestDataSize() {
+        // 256x128 down to 1x1, the levels under 4x4 are one block each
+        std::uint64_t size{};
+        for (std::uint32_t i{}; i != 9u; ++i) {
+            auto width{ std::max(256u >> i, 1u) };
+            auto height{ std::max(128u >> i, 1u) };
+            size += 8u * ((width + 3u) / 4u) * ((height + 3u) / 4u);
+        }
+        ADH_CHECK(TextureCache::GetDataSize(BlockCompressor::Format::eBC1, { 256u, 128u }, 9u) == size);
+        ADH_CHECK(TextureCache::GetDataSize(BlockCompressor::Format::eBC3, { 5u, 3u }, 1u) == 32u);
+
+        auto extent{ TextureCache::GetMipExtent({ 256u, 128u }, 8u) };
+        ADH_CHECK(extent.width == 1u && extent.height == 1u);
+        extent = TextureCache::GetMipExtent({ 5u, 3u }, 1u);
+        ADH_CHECK(extent.width == 2u && extent.height == 1u);
+    }
+
+    void TestWrittenHeaderIsValid() {
+        std::uint64_t fileSize;
+        auto header{ MakeHeader(fileSize) };
+        ADH_CHECK(TextureCache::IsValid(header, fileSize, encoding));
+        ADH_CHECK(TextureCache::IsValid(header, fileSize + 64u, encoding));
+
+        // Every format the cache writes
+        for (auto [format, blockFormat] : { std::pair{ VK_FORMAT_BC3_UNORM_BLOCK, BlockCompressor::Format::eBC3 },
+                                            std::pair{ VK_FORMAT_BC5_UNORM_BLOCK, BlockCompressor::Format::eBC5 },
+                                            std::pair{ VK_FORMAT_BC7_UNORM_BLOCK, BlockCompressor::Format::eBC7 } }) {
+            auto other{ header };
+            other.format   = format;
+            other.dataSize = TextureCache::GetDataSize(blockFormat, { other.width, other.height }, other.mipLevels);
+            ADH_CHECK(TextureCache::IsValid(other, other.dataOffset + other.dataSize, encoding));
+        }
+    }
+
+    void TestHeaderFieldsAreChecked() {
+        std::uint64_t fileSize;
+        const auto valid{ MakeHeader(fileSize) };
+
+        auto header{ valid };
+        header.magic = 0u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+
+        header         = valid;
+        header.version = TextureCache::version + 1u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+
+        // Cooked with another ADH_TEXTURE_FORMAT
+        ADH_CHECK(!TextureCache::IsValid(valid, fileSize, TextureCache::Encoding::eHighQuality));
+
+        header        = valid;
+        header.format = VK_FORMAT_R8G8B8A8_UNORM;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+
+        header       = valid;
+        header.width = 0u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+
+        header        = valid;
+        header.height = TextureCache::maxExtent + 1u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+
+        header           = valid;
+        header.mipLevels = 0u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+        header.mipLevels = TextureCache::maxMipLevels + 1u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+
+        // The data size must be the one of the format, extent and mip count
+        header           = valid;
+        header.mipLevels = 8u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+        header          = valid;
+        header.dataSize = valid.dataSize - 8u;
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize, encoding));
+    }
+
+    void TestTruncatedFileIsRejected() {
+        std::uint64_t fileSize;
+        auto header{ MakeHeader(fileSize) };
+        ADH_CHECK(!TextureCache::IsValid(header, fileSize - 1u, encoding));
+        ADH_CHECK(!TextureCache::IsValid(header, sizeof(Header), encoding));
+
+        // Inside the header
+        auto overlapping{ header };
+        overlapping.dataOffset = sizeof(Header) - 8u;
+        ADH_CHECK(!TextureCache::IsValid(overlapping, fileSize, encoding));
+
+        // An offset past the end can't wrap the bound
+        auto wrapping{ header };
+        wrapping.dataOffset = ~std::uint64_t{} - header.dataSize + 2u;
+        ADH_CHECK(!TextureCache::IsValid(wrapping, fileSize, encoding));
+    }
+} // namespace
+
+int main() {
+    TestDataSize();
+    TestWrittenHeaderIsValid();
+    TestHeaderFieldsAreChecked();
+    TestTruncatedFileIsRejected();
+    return test::GetResult();
+}
@@ -0,0 +1,153 @@
+#include "Test.hpp"
+#include <Scene/VertexPacker.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+using namespace adh;
+
+namespace {
+    // Exact for every half, the reference ToHalf() must invert
+    float FromHalf(std::uint16_t half) {
+        auto sign{ (half & 0x8000u) ? -1.0f : 1.0f };
+        auto exponent{ (half >> 10u) & 0x1Fu };
+        auto mantissa{ half & 0x3FFu };
+        if (!exponent) {
+            return sign * std::ldexp(static_cast<float>(mantissa), -24);
+        }
+        return sign * std::ldexp(static_cast<float>(mantissa | 0x400u), static_cast<int>(exponent) - 25);
+    }
+
+    Vector3D Normalize(const Vector3D& vector) {
+        auto length{ std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z) };
+        return Vector3D{ vector.x / length, vector.y / length, vector.z / length };
+    }
+
+    // From the cross and dot product in double, acos() of a float dot can't resolve small angles
+    float GetAngle(const Vector3D& lhs, const Vector3D& rhs) {
+        double a[3]{ lhs.x, lhs.y, lhs.z };
+        double b[3]{ rhs.x, rhs.y, rhs.z };
+        auto x{ a[1] * b[2] - a[2] * b[1] };
+        auto y{ a[2] * b[0] - a[0] * b[2] };
+        auto z{ a[0] * b[1] - a[1] * b[0] };
+        return static_cast<float>(std::atan2(std::sqrt(x * x + y * y + z * z), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]));
+    }
+
+    void TestOctahedralRoundTrip() {
+        // Spread over the sphere, both hemispheres and the folded diagonals
+        constexpr int count{ 20000 };
+        float maxAngle{};
+        for (int i{}; i != count; ++i) {
+            auto z{ 1.0f - 2.0f * (i + 0.5f) / count };
+            auto radius{ std::sqrt(1.0f - z * z) };
+            auto phi{ 2.39996323f * i };
+            Vector3D normal{ radius * std::cos(phi), radius * std::sin(phi), z };
+            std::int16_t encoded[2];
+            VertexPacker::EncodeOctahedral(normal, encoded);
+            maxAngle = std::fmax(maxAngle, GetAngle(normal, VertexPacker::DecodeOctahedral(encoded)));
+        }
+        // 16 bit octahedral stays within a ten thousandth of a radian
+        ADH_CHECK(maxAngle < 1e-4f);
+    }
+
+    void TestOctahedralAxes() {
+        const Vector3D axes[]{ { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+                               { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } };
+        for (const auto& axis : axes) {
+            std::int16_t encoded[2];
+            VertexPacker::EncodeOctahedral(axis, encoded);
+            ADH_CHECK(GetAngle(axis, VertexPacker::DecodeOctahedral(encoded)) < 1e-3f);
+        }
+
+        // Unnormalized input is encoded by direction
+        std::int16_t scaled[2];
+        std::int16_t unit[2];
+        VertexPacker::EncodeOctahedral(Vector3D{ 3.0f, -4.0f, -12.0f }, scaled);
+        VertexPacker::EncodeOctahedral(Normalize(Vector3D{ 3.0f, -4.0f, -12.0f }), unit);
+        ADH_CHECK(std::abs(scaled[0] - unit[0]) <= 1 && std::abs(scaled[1] - unit[1]) <= 1);
+
+        // -32768 is a valid SNORM and decodes like -32767
+        const std::int16_t lowest[2]{ -32768, 0 };
+        const std::int16_t clamped[2]{ -32767, 0 };
+        ADH_CHECK(GetAngle(VertexPacker::DecodeOctahedral(lowest), VertexPacker::DecodeOctahedral(clamped)) < 1e-6f);
+    }
+
+    void TestHalfRoundTrip() {
+        // Every finite half survives the trip through float
+        for (std::uint32_t half{}; half != 0x10000u; ++half) {
+            if ((half & 0x7C00u) == 0x7C00u) {
+                continue;
+            }
+            auto result{ VertexPacker::ToHalf(FromHalf(static_cast<std::uint16_t>(half))) };
+            if (result != half) {
+                ADH_CHECK(result == half);
+                break;
+            }
+        }
+    }
+
+    void TestHalfRounding() {
+        ADH_CHECK(VertexPacker::ToHalf(1.0f) == 0x3C00u);
+        ADH_CHECK(VertexPacker::ToHalf(-2.0f) == 0xC000u);
+        ADH_CHECK(VertexPacker::ToHalf(65504.0f) == 0x7BFFu);
+
+        // Ties go to the even mantissa
+        ADH_CHECK(VertexPacker::ToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3C00u);
+        ADH_CHECK(VertexPacker::ToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3C02u);
+        ADH_CHECK(VertexPacker::ToHalf(std::ldexp(1.0f, -25)) == 0x0000u);
+        ADH_CHECK(VertexPacker::ToHalf(3.0f * std::ldexp(1.0f, -25)) == 0x0002u);
+
+        // A carry out of the mantissa moves into the exponent
+        ADH_CHECK(VertexPacker::ToHalf(2047.5f) == 0x6800u);
+
+        ADH_CHECK(VertexPacker::ToHalf(65520.0f) == 0x7C00u);
+        ADH_CHECK(VertexPacker::ToHalf(-1e10f) == 0xFC00u);
+        ADH_CHECK(VertexPacker::ToHalf(INFINITY) == 0x7C00u);
+        ADH_CHECK(VertexPacker::ToHalf(NAN) == 0x7E00u);
+        ADH_CHECK(VertexPacker::ToHalf(-0.0f) == 0x8000u);
+    }
+
+    void TestPackPositions() {
+        Vector3D boundsMin{ -1.0f, 2.0f, 5.0f };
+        Vector3D boundsMax{ 3.0f, 2.0f, 6.0f };
+        Array<Vertex> vertices;
+        vertices.EmplaceBack(Vertex{ boundsMin, Vector3D{ 0.0f, 0.0f, 1.0f }, Vector2D{ 0.0f, 1.0f } });
+        vertices.EmplaceBack(Vertex{ boundsMax, Vector3D{ 0.0f, -1.0f, 0.0f }, Vector2D{ 0.5f, 0.25f } });
+        vertices.EmplaceBack(Vertex{ Vector3D{ 0.3f, 2.0f, 5.7f }, Vector3D{ 1.0f, 1.0f, 1.0f }, Vector2D{ 2.0f, -1.0f } });
+        // Outside the bounds, clamped
+        vertices.EmplaceBack(Vertex{ Vector3D{ -5.0f, 2.0f, 9.0f }, Vector3D{ 1.0f, 0.0f, 0.0f }, Vector2D{} });
+
+        Array<PackedVertex> packed;
+        VertexPacker::Pack(vertices, boundsMin, boundsMax, packed);
+        ADH_CHECK(packed.GetSize() == vertices.GetSize());
+        ADH_CHECK(packed[0].position[0] == 0u && packed[0].position[2] == 0u);
+        ADH_CHECK(packed[1].position[0] == 65535u && packed[1].position[2] == 65535u);
+        ADH_CHECK(packed[3].position[0] == 0u && packed[3].position[2] == 65535u);
+
+        // The y axis is flat, every vertex is at its minimum
+        for (std::size_t i{}; i != packed.GetSize(); ++i) {
+            ADH_CHECK(packed[i].position[1] == 0u);
+            ADH_CHECK(packed[i].position[3] == 0u);
+        }
+
+        // Within half a step of the bounds divided into 65535
+        for (std::size_t axis : { 0u, 2u }) {
+            auto extent{ boundsMax[axis] - boundsMin[axis] };
+            auto unpacked{ boundsMin[axis] + packed[2].position[axis] / 65535.0f * extent };
+            ADH_CHECK(std::abs(unpacked - vertices[2].position[axis]) <= 0.5f * extent / 65535.0f + 1e-6f);
+        }
+
+        ADH_CHECK(GetAngle(VertexPacker::DecodeOctahedral(packed[2].normals), Normalize(vertices[2].normals)) < 1e-3f);
+        ADH_CHECK(packed[1].textureCoords[0] == 0x3800u && packed[1].textureCoords[1] == 0x3400u);
+        ADH_CHECK(packed[2].textureCoords[0] == 0x4000u && packed[2].textureCoords[1] == 0xBC00u);
+    }
+} // namespace
+
+int main() {
+    TestOctahedralRoundTrip();
+    TestOctahedralAxes();
+    TestHalfRoundTrip();
+    TestHalfRounding();
+    TestPackPositions();
+    return test::GetResult();
+}
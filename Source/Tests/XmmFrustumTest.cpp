@@ -0,0 +1,236 @@
+#include "Test.hpp"
+#include <Math/Math.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+using namespace adh;
+
+namespace {
+    using Plane = std::array<float, 4>;
+    using Planes = std::array<Plane, xmm::Frustum::eCount>;
+    using Point = std::array<float, 3>;
+
+    // Cases closer than this to a plane are left out, the two sides round differently there
+    constexpr float epsilon{ 1e-3f };
+
+    // Row r of the column vector matrix, element (r, c) is stored in column c
+    Plane GetRow(const xmm::Matrix& matrix, std::size_t r) {
+        return { matrix.f[0][r], matrix.f[1][r], matrix.f[2][r], matrix.f[3][r] };
+    }
+
+    // Gribb/Hartmann one element at a time
+    Planes ExtractPlanes(const xmm::Matrix& viewProjection) {
+        Plane rows[4];
+        for (std::size_t r{}; r != 4u; ++r) {
+            rows[r] = GetRow(viewProjection, r);
+        }
+        Planes planes;
+        for (std::size_t i{}; i != 4u; ++i) {
+            planes[xmm::Frustum::eLeft][i]   = rows[3][i] + rows[0][i];
+            planes[xmm::Frustum::eRight][i]  = rows[3][i] - rows[0][i];
+            planes[xmm::Frustum::eBottom][i] = rows[3][i] + rows[1][i];
+            planes[xmm::Frustum::eTop][i]    = rows[3][i] - rows[1][i];
+            planes[xmm::Frustum::eNear][i]   = ADH_MATH_DEPTH_TO_MINUS_ONE ? rows[3][i] + rows[2][i] : rows[2][i];
+            planes[xmm::Frustum::eFar][i]    = rows[3][i] - rows[2][i];
+        }
+        for (auto& plane : planes) {
+            auto length{ std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]) };
+            for (auto& value : plane) {
+                value /= length;
+            }
+        }
+        return planes;
+    }
+
+    float GetDistance(const Plane& plane, const Point& point) {
+        return plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2] + plane[3];
+    }
+
+    // Inside the clip volume, without the planes
+    bool IsInsideClip(const xmm::Matrix& viewProjection, const Point& point) {
+        float clip[4];
+        for (std::size_t r{}; r != 4u; ++r) {
+            clip[r] = GetDistance(GetRow(viewProjection, r), point);
+        }
+        auto nearZ{ ADH_MATH_DEPTH_TO_MINUS_ONE ? -clip[3] : 0.0f };
+        return std::abs(clip[0]) <= clip[3] && std::abs(clip[1]) <= clip[3] && clip[2] >= nearZ && clip[2] <= clip[3];
+    }
+
+    // Signed distance of the nearest point to each plane, false if one is too close to call
+    bool IsSphereInside(const Planes& planes, const Point& center, float radius, bool& isInside) {
+        isInside = true;
+        for (const auto& plane : planes) {
+            auto distance{ GetDistance(plane, center) + radius };
+            if (std::abs(distance) < epsilon) {
+                return false;
+            }
+            isInside = isInside && distance >= 0.0f;
+        }
+        return true;
+    }
+
+    // Outside when all eight corners are behind one plane
+    bool IsBoxInside(const Planes& planes, const Point& min, const Point& max, bool& isInside) {
+        isInside = true;
+        for (const auto& plane : planes) {
+            auto farthest{ -INFINITY };
+            for (std::size_t corner{}; corner != 8u; ++corner) {
+                Point point{ corner & 1u ? max[0] : min[0], corner & 2u ? max[1] : min[1], corner & 4u ? max[2] : min[2] };
+                farthest = std::max(farthest, GetDistance(plane, point));
+            }
+            if (std::abs(farthest) < epsilon) {
+                return false;
+            }
+            isInside = isInside && farthest >= 0.0f;
+        }
+        return true;
+    }
+
+    struct Camera {
+        Vector3D eye;
+        Vector3D focus;
+        float fovY;
+        float aspectRatio;
+        float nearZ;
+        float farZ;
+
+        xmm::Matrix GetViewProjection() const {
+            return xmm::PerspectiveRH(fovY, aspectRatio, nearZ, farZ) * xmm::LookAtRH(eye, focus, Vector3D{ 0.0f, 1.0f, 0.0f });
+        }
+    };
+
+    const Camera cameras[]{
+        { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, 1.0f, 16.0f / 9.0f, 0.1f, 100.0f },
+        { { 3.0f, 2.0f, 5.0f }, { -4.0f, 0.5f, -2.0f }, 0.7f, 1.0f, 1.0f, 50.0f },
+        { { -10.0f, 4.0f, 8.0f }, { 2.0f, -1.0f, 3.0f }, 1.4f, 2.35f, 0.5f, 30.0f },
+    };
+
+    void TestPlanes() {
+        for (const auto& camera : cameras) {
+            auto viewProjection{ camera.GetViewProjection() };
+            auto expected{ ExtractPlanes(viewProjection) };
+            xmm::Frustum frustum{ viewProjection };
+            for (std::size_t i{}; i != xmm::Frustum::eCount; ++i) {
+                for (std::size_t c{}; c != 4u; ++c) {
+                    ADH_CHECK(std::abs(frustum[i][c] - expected[i][c]) <= 1e-4f * std::max(1.0f, std::abs(expected[i][c])));
+                }
+            }
+
+            // Straight ahead between the near and far plane, and behind the eye
+            Vector3D forward{ Normalize(camera.focus - camera.eye) };
+            auto ahead{ camera.eye + forward * ((camera.nearZ + camera.farZ) * 0.5f) };
+            auto behind{ camera.eye - forward * 2.0f };
+            ADH_CHECK(frustum.Intersects(xmm::Vector{ ahead[0], ahead[1], ahead[2], 1.0f }, 0.0f));
+            ADH_CHECK(!frustum.Intersects(xmm::Vector{ behind[0], behind[1], behind[2], 1.0f }, 1.0f));
+        }
+    }
+
+    void TestSpheres() {
+        std::mt19937 random{ 11u };
+        std::uniform_real_distribution<float> position{ -60.0f, 60.0f };
+        std::uniform_real_distribution<float> size{ 0.0f, 8.0f };
+        for (const auto& camera : cameras) {
+            auto viewProjection{ camera.GetViewProjection() };
+            auto planes{ ExtractPlanes(viewProjection) };
+            xmm::Frustum frustum{ viewProjection };
+            std::size_t tested{};
+            for (std::size_t i{}; i != 20000u; ++i) {
+                Point center{ position(random), position(random), position(random) };
+                auto radius{ i & 1u ? size(random) : 0.0f };
+                bool isInside;
+                if (!IsSphereInside(planes, center, radius, isInside)) {
+                    continue;
+                }
+                ++tested;
+                ADH_CHECK(frustum.Intersects(xmm::Vector{ center[0], center[1], center[2], 1.0f }, radius) == isInside);
+                // A point is inside the planes exactly when it's inside the clip volume
+                if (radius == 0.0f) {
+                    ADH_CHECK(IsInsideClip(viewProjection, center) == isInside);
+                }
+            }
+            ADH_CHECK(tested > 19000u);
+        }
+    }
+
+    void TestBoxes() {
+        std::mt19937 random{ 23u };
+        std::uniform_real_distribution<float> position{ -60.0f, 60.0f };
+        std::uniform_real_distribution<float> size{ 0.0f, 10.0f };
+        for (const auto& camera : cameras) {
+            auto viewProjection{ camera.GetViewProjection() };
+            auto planes{ ExtractPlanes(viewProjection) };
+            xmm::Frustum frustum{ viewProjection };
+            std::size_t tested{};
+            std::size_t inside{};
+            for (std::size_t i{}; i != 20000u; ++i) {
+                Point center{ position(random), position(random), position(random) };
+                Point extents{ size(random), size(random), size(random) };
+                Point min{ center[0] - extents[0], center[1] - extents[1], center[2] - extents[2] };
+                Point max{ center[0] + extents[0], center[1] + extents[1], center[2] + extents[2] };
+                bool isInside;
+                if (!IsBoxInside(planes, min, max, isInside)) {
+                    continue;
+                }
+                ++tested;
+                inside += isInside;
+                ADH_CHECK(frustum.Intersects(xmm::Vector{ center[0], center[1], center[2], 1.0f },
+                                             xmm::Vector{ extents[0], extents[1], extents[2], 0.0f }) == isInside);
+            }
+            // Both answers come up often enough to mean something
+            ADH_CHECK(tested > 19000u);
+            ADH_CHECK(inside > 100u && tested - inside > 100u);
+        }
+    }
+
+    void TestTransformedBoxes() {
+        std::mt19937 random{ 37u };
+        std::uniform_real_distribution<float> position{ -40.0f, 40.0f };
+        std::uniform_real_distribution<float> size{ 0.1f, 4.0f };
+        std::uniform_real_distribution<float> angle{ -3.0f, 3.0f };
+        for (const auto& camera : cameras) {
+            auto viewProjection{ camera.GetViewProjection() };
+            auto planes{ ExtractPlanes(viewProjection) };
+            xmm::Frustum frustum{ viewProjection };
+            for (std::size_t i{}; i != 5000u; ++i) {
+                xmm::Matrix model{ 1.0f };
+                model = xmm::Translate(model, Vector3D{ position(random), position(random), position(random) });
+                model = xmm::Rotate(model, angle(random), Normalize(Vector3D{ angle(random), angle(random), angle(random) + 3.5f }));
+                model = xmm::Scale(model, Vector3D{ size(random), size(random), size(random) });
+                Point center{ angle(random), angle(random), angle(random) };
+                Point extents{ size(random), size(random), size(random) };
+
+                // Enclosing box of the eight transformed corners
+                Point min{ INFINITY, INFINITY, INFINITY };
+                Point max{ -INFINITY, -INFINITY, -INFINITY };
+                for (std::size_t corner{}; corner != 8u; ++corner) {
+                    Point local{ center[0] + (corner & 1u ? extents[0] : -extents[0]),
+                                 center[1] + (corner & 2u ? extents[1] : -extents[1]),
+                                 center[2] + (corner & 4u ? extents[2] : -extents[2]) };
+                    for (std::size_t r{}; r != 3u; ++r) {
+                        auto world{ GetDistance(GetRow(model, r), local) };
+                        min[r] = std::min(min[r], world);
+                        max[r] = std::max(max[r], world);
+                    }
+                }
+                bool isInside;
+                if (!IsBoxInside(planes, min, max, isInside)) {
+                    continue;
+                }
+                ADH_CHECK(frustum.Intersects(model, xmm::Vector{ center[0], center[1], center[2], 1.0f },
+                                             xmm::Vector{ extents[0], extents[1], extents[2], 0.0f }) == isInside);
+            }
+        }
+    }
+} // namespace
+
+int main() {
+    TestPlanes();
+    TestSpheres();
+    TestBoxes();
+    TestTransformedBoxes();
+    return test::GetResult();
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <Math/Math.hpp>
 
+#include <cstdint>
+
 namespace adh {
     struct Vertex {
         Vertex() = default;
@@ -12,4 +14,13 @@ namespace adh {
         Vector3D normals;
         Vector2D textureCoords;
     };
+
+    // Half the size of a Vertex, written by VertexPacker
+    struct PackedVertex {
+        std::uint16_t position[4];      // UNORM inside the mesh bounds, w is unused
+        std::int16_t normals[2];        // SNORM octahedral
+        std::uint16_t textureCoords[2]; // Half floats
+    };
+
+    static_assert(sizeof(PackedVertex) == 16u, "PackedVertex must match the packed vertex layout!");
 } // namespace adh